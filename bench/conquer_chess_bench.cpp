@@ -0,0 +1,320 @@
+/// Benchmarks of the rules engine, without the graphics.
+///
+/// Usage:
+///
+///   conquer_chess_bench [filter]
+///   conquer_chess_bench --perft [depth]
+///   conquer_chess_bench --lockstep [n_frames] [input_delay]
+///   conquer_chess_bench --rollback [n_frames] [latency] [packet_loss]
+///   conquer_chess_bench --spectate [n_spectators] [n_ticks]
+///   conquer_chess_bench --fen [corpus_folder]
+///   conquer_chess_bench --pacer [target_fps] [n_frames]
+///
+/// The first form runs all benchmarks of which the name contains the filter
+/// and writes the results as JSON to stdout,
+/// e.g. 'conquer_chess_bench is_checkmate > is_checkmate.json'.
+///
+/// The second form runs a perft on the benchmarked starting positions,
+/// compares the node counts with chess-library
+/// and writes the results as JSON to stdout.
+///
+/// The third form plays two games in lockstep over a loopback,
+/// with random user inputs, and writes the bandwidth as JSON to stdout.
+///
+/// The fourth form plays two games with rollback over a loopback
+/// with the latency in frames and the chance a packet is lost,
+/// with random user inputs, and writes the cost of the rollbacks
+/// as JSON to stdout.
+///
+/// The fifth form plays a game with random user inputs,
+/// broadcasts it to spectators over a loopback,
+/// and writes the bandwidth per spectator and the encoding cost
+/// as JSON to stdout.
+///
+/// The sixth form reads the FEN strings in the files of a folder,
+/// by default the FEN fuzzing corpus of chess-library,
+/// compares the pieces and active color with chess-library
+/// and writes the number of FEN strings encoded and decoded per second
+/// as JSON to stdout.
+///
+/// The seventh form paces frames without work at the target frame rate
+/// and writes the frame time percentiles and missed deadlines
+/// as JSON to stdout.
+#include "benchmark.h"
+#include "fen_string.h"
+#include "frame_pacer.h"
+#include "game.h"
+#include "lockstep_session.h"
+#include "perft.h"
+#include "rollback_session.h"
+#include "pieces.h"
+#include "spectator_broadcaster.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wshadow"
+#pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
+#include "../chess-library/include/chess.hpp"
+#pragma GCC diagnostic pop
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+/// Run a perft on the benchmarked starting positions
+void run_perfts(const int depth)
+{
+  std::cout << "{\n  \"perft\": [";
+  bool is_first{true};
+  for (const auto t: get_benchmark_starting_positions())
+  {
+    const game g{create_game_with_starting_position(t)};
+    const perft_result r{measure_perft(g, depth)};
+    const auto n_reference_nodes{
+      perft_reference(to_perft_fen_string(g, chess_color::white), depth)
+    };
+    if (!is_first) std::cout << ',';
+    is_first = false;
+    std::cout << "\n    {"
+      << "\"position\": \"" << to_str(t) << "\", "
+      << "\"depth\": " << depth << ", "
+      << "\"nodes\": " << r.get_n_nodes() << ", "
+      << "\"reference_nodes\": " << n_reference_nodes << ", "
+      << "\"seconds\": " << r.get_n_seconds() << ", "
+      << "\"nodes_per_second\": " << r.get_nodes_per_second()
+      << "}"
+    ;
+  }
+  std::cout << "\n  ]\n}\n";
+}
+
+/// Play two games in lockstep over a loopback
+void run_lockstep(const int n_frames, const int input_delay)
+{
+  const lockstep_loopback_result r{run_lockstep_loopback(n_frames, input_delay)};
+  std::cout << "{\n"
+    << "  \"lockstep\": {"
+    << "\"frames\": " << n_frames << ", "
+    << "\"input_delay\": " << input_delay << ", "
+    << "\"seconds_played\": " << r.get_n_secs() << ", "
+    << "\"stalls\": " << r.get_n_stalls() << ", "
+    << "\"bytes_sent\": " << r.get_n_bytes_sent() << ", "
+    << "\"bytes_per_minute_per_player\": " << r.get_n_bytes_per_minute() << ", "
+    << "\"desync\": " << (r.is_desync() ? "true" : "false")
+    << "}\n}\n"
+  ;
+}
+
+/// Play two games with rollback over a loopback
+void run_rollback(const int n_frames, const int latency, const double packet_loss)
+{
+  const rollback_loopback_result r{run_rollback_loopback(n_frames, latency, packet_loss)};
+  std::cout << "{\n"
+    << "  \"rollback\": {"
+    << "\"frames\": " << n_frames << ", "
+    << "\"latency\": " << latency << ", "
+    << "\"packet_loss\": " << packet_loss << ", "
+    << "\"seconds_played\": " << r.get_n_secs() << ", "
+    << "\"stalls\": " << r.get_n_stalls() << ", "
+    << "\"rollbacks\": " << r.get_n_rollbacks() << ", "
+    << "\"rollback_frames\": " << r.get_n_rollback_frames() << ", "
+    << "\"rollback_frames_per_second_per_player\": " << r.get_n_rollback_frames_per_second() << ", "
+    << "\"resimulation_seconds\": " << r.get_n_resimulation_secs() << ", "
+    << "\"resimulation_ms_per_frame\": " << r.get_resimulation_ms_per_frame() << ", "
+    << "\"desync\": " << (r.is_desync() ? "true" : "false")
+    << "}\n}\n"
+  ;
+}
+
+/// Broadcast a game to spectators over a loopback
+void run_spectate(const int n_spectators, const int n_ticks)
+{
+  const spectator_broadcast_result r{run_spectator_broadcast(n_spectators, n_ticks)};
+  std::cout << "{\n"
+    << "  \"spectate\": {"
+    << "\"spectators\": " << r.get_n_spectators() << ", "
+    << "\"ticks\": " << r.get_n_ticks() << ", "
+    << "\"seconds_played\": " << r.get_n_secs() << ", "
+    << "\"bytes_sent\": " << r.get_n_bytes_sent() << ", "
+    << "\"bytes_per_second_per_spectator\": " << r.get_n_bytes_per_second() << ", "
+    << "\"encode_ms_per_tick\": " << r.get_encode_ms_per_tick() << ", "
+    << "\"in_sync\": " << (r.is_in_sync() ? "true" : "false")
+    << "}\n}\n"
+  ;
+}
+
+/// Encode and decode the FEN strings of a fuzzing corpus
+void run_fen_corpus(const std::string& folder)
+{
+  std::vector<std::string> filenames;
+  for (const auto& f: std::filesystem::directory_iterator(folder))
+  {
+    if (f.is_regular_file()) filenames.push_back(f.path().string());
+  }
+  std::sort(std::begin(filenames), std::end(filenames));
+
+  std::vector<std::string> fens;
+  int n_mismatches{0};
+  for (const auto& filename: filenames)
+  {
+    std::ifstream f(filename);
+    std::string fen;
+    std::getline(f, fen);
+    chess::Board board;
+    if (fen.empty() || !board.setFen(fen)) continue;
+    const auto pieces{create_pieces_from_fen_string(fen_string(fen))};
+    const chess_color color{get_color(fen_string(fen))};
+    // Only the pieces and the active color are compared
+    const std::string expected{board.getFen(false)};
+    const std::string created{to_fen_str(pieces, color, "-", "-")};
+    if (created.substr(0, created.find(' ') + 2) != expected.substr(0, expected.find(' ') + 2))
+    {
+      ++n_mismatches;
+    }
+    fens.push_back(fen);
+  }
+
+  const int n_repeats{10000};
+  std::vector<std::vector<piece>> pieces;
+  int n_characters{0};
+  const auto start_decode{std::chrono::steady_clock::now()};
+  for (int i{0}; i != n_repeats; ++i)
+  {
+    for (const auto& fen: fens) pieces.push_back(create_pieces_from_fen_string(fen_string(fen)));
+    if (i != n_repeats - 1) pieces.resize(0);
+  }
+  const std::chrono::duration<double> decode_duration{std::chrono::steady_clock::now() - start_decode};
+  const auto start_encode{std::chrono::steady_clock::now()};
+  std::array<char, get_max_fen_str_size()> buffer;
+  for (int i{0}; i != n_repeats; ++i)
+  {
+    for (const auto& p: pieces) n_characters += to_fen_chars(p, buffer);
+  }
+  const std::chrono::duration<double> encode_duration{std::chrono::steady_clock::now() - start_encode};
+  const double n_conversions{static_cast<double>(n_repeats) * fens.size()};
+
+  std::cout << "{\n"
+    << "  \"fen\": {"
+    << "\"files\": " << filenames.size() << ", "
+    << "\"fens\": " << fens.size() << ", "
+    << "\"mismatches\": " << n_mismatches << ", "
+    << "\"characters\": " << n_characters << ", "
+    << "\"decoded_per_second\": " << n_conversions / decode_duration.count() << ", "
+    << "\"encoded_per_second\": " << n_conversions / encode_duration.count()
+    << "}\n}\n"
+  ;
+}
+
+/// Pace frames at a target frame rate, with real sleeping
+void run_pacer(const double target_fps, const int n_frames)
+{
+  frame_pacer p(target_fps);
+  for (int i{0}; i != n_frames; ++i) p.tick();
+  std::cout << "{\n"
+    << "  \"pacer\": {"
+    << "\"target_fps\": " << target_fps << ", "
+    << "\"frames\": " << n_frames << ", "
+    << "\"target_frame_ms\": " << 1000.0 / target_fps << ", "
+    << "\"p50_frame_ms\": " << p.get_frame_time_percentile_ms(50.0) << ", "
+    << "\"p95_frame_ms\": " << p.get_frame_time_percentile_ms(95.0) << ", "
+    << "\"p99_frame_ms\": " << p.get_frame_time_percentile_ms(99.0) << ", "
+    << "\"missed_deadlines\": " << p.get_n_missed_deadlines() << ", "
+    << "\"fps\": " << p.get_fps()
+    << "}\n}\n"
+  ;
+}
+
+int main(int argc, char* argv[])
+{
+  const std::string usage{
+    std::string("Usage: ") + argv[0] + " [filter]\n"
+    + "       " + argv[0] + " --perft [depth]\n"
+    + "       " + argv[0] + " --lockstep [n_frames] [input_delay]\n"
+    + "       " + argv[0] + " --rollback [n_frames] [latency] [packet_loss]\n"
+    + "       " + argv[0] + " --spectate [n_spectators] [n_ticks]\n"
+    + "       " + argv[0] + " --fen [corpus_folder]\n"
+    + "       " + argv[0] + " --pacer [target_fps] [n_frames]\n"
+  };
+  if (argc > 1 && std::string(argv[1]) == "--pacer")
+  {
+    if (argc > 4)
+    {
+      std::cerr << usage;
+      return 1;
+    }
+    run_pacer(
+      argc >= 3 ? std::stod(argv[2]) : 60.0,
+      argc == 4 ? std::stoi(argv[3]) : 600
+    );
+    return 0;
+  }
+  if (argc > 1 && std::string(argv[1]) == "--fen")
+  {
+    if (argc > 3)
+    {
+      std::cerr << usage;
+      return 1;
+    }
+    run_fen_corpus(argc == 3 ? argv[2] : "chess-library/fuzz/corpus-fen/fen");
+    return 0;
+  }
+  if (argc > 1 && std::string(argv[1]) == "--spectate")
+  {
+    if (argc > 4)
+    {
+      std::cerr << usage;
+      return 1;
+    }
+    run_spectate(
+      argc >= 3 ? std::stoi(argv[2]) : 100,
+      argc == 4 ? std::stoi(argv[3]) : 1800
+    );
+    return 0;
+  }
+  if (argc > 1 && std::string(argv[1]) == "--rollback")
+  {
+    if (argc > 5)
+    {
+      std::cerr << usage;
+      return 1;
+    }
+    run_rollback(
+      argc >= 3 ? std::stoi(argv[2]) : 1800,
+      argc >= 4 ? std::stoi(argv[3]) : 3,
+      argc == 5 ? std::stod(argv[4]) : 0.05
+    );
+    return 0;
+  }
+  if (argc > 1 && std::string(argv[1]) == "--lockstep")
+  {
+    if (argc > 4)
+    {
+      std::cerr << usage;
+      return 1;
+    }
+    run_lockstep(
+      argc >= 3 ? std::stoi(argv[2]) : 1800,
+      argc == 4 ? std::stoi(argv[3]) : get_default_lockstep_input_delay()
+    );
+    return 0;
+  }
+  if (argc > 1 && std::string(argv[1]) == "--perft")
+  {
+    if (argc > 3)
+    {
+      std::cerr << usage;
+      return 1;
+    }
+    run_perfts(argc == 3 ? std::stoi(argv[2]) : 2);
+    return 0;
+  }
+  if (argc > 2)
+  {
+    std::cerr << usage;
+    return 1;
+  }
+  const std::string filter{argc == 2 ? argv[1] : ""};
+  std::cout << to_json(run_all_benchmarks(filter));
+}
@@ -46,6 +46,9 @@ private:
 
   /// The layout of this window
   about_view_layout m_layout;
+
+  /// The about screen never changes by itself
+  bool is_retained_impl() const noexcept override { return true; }
 };
 
 /// Show where the panels will be drawn
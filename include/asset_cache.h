@@ -0,0 +1,174 @@
+#ifndef ASSET_CACHE_H
+#define ASSET_CACHE_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifndef LOGIC_ONLY
+#include <SFML/Audio/SoundBuffer.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#endif // LOGIC_ONLY
+
+class memory_mapped_file;
+
+std::string get_default_asset_cache_filename() noexcept;
+
+/// The type of asset in an \link{asset_cache}
+enum class asset_type : std::uint32_t
+{
+  texture = 1,
+  sound = 2
+};
+
+/// A decoded asset in an \link{asset_cache}.
+///
+/// For a texture, 'a' and 'b' are the width and height
+/// and the data are the RGBA pixels.
+/// For a sound, 'a' and 'b' are the channel count and sample rate
+/// and the data are the 16-bit PCM samples.
+class asset_cache_entry
+{
+public:
+  asset_cache_entry(
+    const asset_type t = asset_type::texture,
+    const std::uint32_t a = 0,
+    const std::uint32_t b = 0
+  );
+
+  auto get_a() const noexcept { return m_a; }
+  auto get_b() const noexcept { return m_b; }
+
+  /// Get the FNV-1a hash of the source file's content
+  auto get_content_hash() const noexcept { return m_content_hash; }
+
+  /// Get the decoded data
+  const std::uint8_t* get_data() const noexcept;
+
+  /// Get the size of the decoded data, in bytes
+  std::uint64_t get_data_size() const noexcept;
+
+  auto get_type() const noexcept { return m_type; }
+
+private:
+
+  asset_type m_type;
+  std::uint32_t m_a;
+  std::uint32_t m_b;
+
+  std::uint64_t m_content_hash{0};
+
+  /// The size of the source file, in bytes
+  std::uint64_t m_source_size{0};
+
+  /// The last write time of the source file
+  std::int64_t m_source_time{0};
+
+  /// The decoded data, if it is stored in the memory-mapped cache file
+  const std::uint8_t* m_mapped_data{nullptr};
+  std::uint64_t m_mapped_size{0};
+
+  /// The decoded data, if it is decoded during this run
+  std::vector<std::uint8_t> m_owned_data;
+
+  friend class asset_cache;
+};
+
+/// A cache of decoded textures and sounds.
+///
+/// Decoding all JPG, PNG and OGG files takes most of the loading time.
+/// The first run decodes these files and writes the raw RGBA pixels
+/// and PCM samples to one cache file.
+/// Later runs memory-map that file and upload the data directly.
+///
+/// An entry is up to date if the size and last write time of its
+/// source file are unchanged, or, if these have changed
+/// (e.g. after a fresh checkout), if the content hash is unchanged.
+///
+/// Use \link{asset_cache::get} to get the one-and-only asset cache.
+class asset_cache
+{
+public:
+  explicit asset_cache(const std::string& filename = get_default_asset_cache_filename());
+  asset_cache(const asset_cache&) = delete;
+  asset_cache& operator=(const asset_cache&) = delete;
+  ~asset_cache();
+
+  /// Get the one-and-only asset cache
+  static asset_cache& get();
+
+  /// Add a decoded asset,
+  /// replacing the earlier entry of the same source file, if any
+  void add(
+    const std::string& source_filename,
+    const asset_type t,
+    const std::uint32_t a,
+    const std::uint32_t b,
+    std::vector<std::uint8_t> data
+  );
+
+  /// Find the up-to-date decoded asset of a source file.
+  /// Returns nullptr if there is none.
+  const asset_cache_entry * find(
+    const std::string& source_filename,
+    const asset_type t
+  );
+
+  const auto& get_filename() const noexcept { return m_filename; }
+
+  int get_n_entries() const noexcept { return static_cast<int>(m_entries.size()); }
+  int get_n_hits() const noexcept { return m_n_hits; }
+  int get_n_misses() const noexcept { return m_n_misses; }
+
+  /// Does the cache differ from the cache file?
+  bool is_dirty() const noexcept { return m_is_dirty; }
+
+  /// Write the cache file, if the cache has changed
+  void save();
+
+private:
+
+  std::map<std::string, asset_cache_entry> m_entries;
+
+  std::string m_filename;
+
+  bool m_is_dirty{false};
+
+  std::unique_ptr<memory_mapped_file> m_mapped_file;
+
+  int m_n_hits{0};
+  int m_n_misses{0};
+
+  /// Read the cache file, if it exists and is valid
+  void read();
+
+  /// Write the cache file
+  void write() const;
+};
+
+/// Calculate the FNV-1a hash of a file's content
+std::uint64_t calc_file_hash(const std::string& filename);
+
+/// Calculate the FNV-1a hash of data
+std::uint64_t calc_fnv1a_hash(
+  const std::uint8_t * const data,
+  const std::uint64_t size,
+  std::uint64_t hash = 14695981039346656037ull
+) noexcept;
+
+#ifndef LOGIC_ONLY
+
+/// Load a texture, using the \link{asset_cache} when possible
+bool load_from_file(sf::Texture& texture, const std::string& filename);
+
+/// Load a sound buffer, using the \link{asset_cache} when possible
+bool load_from_file(sf::SoundBuffer& buffer, const std::string& filename);
+
+#endif // LOGIC_ONLY
+
+/// Test this class and its free functions
+void test_asset_cache();
+
+#endif // ASSET_CACHE_H
@@ -0,0 +1,74 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "starting_position_type.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/// The result of a benchmark,
+/// i.e. the time per iteration of some repeated runs
+class benchmark_result
+{
+public:
+  explicit benchmark_result(
+    const std::string& name,
+    const int n_iterations,
+    const std::vector<double>& ns_per_iteration
+  );
+
+  /// Get the fastest time per iteration, in nanoseconds
+  double get_min_ns() const noexcept;
+
+  /// Get the median time per iteration, in nanoseconds
+  double get_median_ns() const noexcept;
+
+  const auto& get_name() const noexcept { return m_name; }
+
+  /// Get the number of iterations per run
+  auto get_n_iterations() const noexcept { return m_n_iterations; }
+
+  /// Get the time per iteration per run, in nanoseconds
+  const auto& get_ns_per_iteration() const noexcept { return m_ns_per_iteration; }
+
+private:
+  std::string m_name;
+  int m_n_iterations;
+  std::vector<double> m_ns_per_iteration;
+};
+
+/// Run a benchmark.
+///
+/// First the number of iterations is doubled until
+/// one run takes at least 'min_run_time_secs'.
+/// Then that number of iterations is run 'n_runs' times.
+benchmark_result run_benchmark(
+  const std::string& name,
+  const std::function<void()>& f,
+  const double min_run_time_secs = 0.05,
+  const int n_runs = 5
+);
+
+/// Get the starting positions that are benchmarked
+std::vector<starting_position_type> get_benchmark_starting_positions() noexcept;
+
+/// Run all benchmarks of the rules engine,
+/// of which the name contains 'filter'
+std::vector<benchmark_result> run_all_benchmarks(
+  const std::string& filter = "",
+  const double min_run_time_secs = 0.05,
+  const int n_runs = 5
+);
+
+/// Convert the benchmark results to JSON
+std::string to_json(const std::vector<benchmark_result>& results);
+
+/// Test this class and its free functions
+void test_benchmark();
+
+/// Test these functions by running the benchmarks,
+/// which is slow
+void test_benchmark_long();
+
+#endif // BENCHMARK_H
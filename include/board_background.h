@@ -0,0 +1,56 @@
+#ifndef BOARD_BACKGROUND_H
+#define BOARD_BACKGROUND_H
+
+#ifndef LOGIC_ONLY
+
+#include "ccfwd.h"
+#include "race.h"
+#include "screen_rect.h"
+
+#include <SFML/Graphics/RenderTexture.hpp>
+
+#include <memory>
+#include <optional>
+
+/// The parts of a game that do not change during a game:
+/// the map and the squares of the chessboard.
+///
+/// These are drawn once on a texture,
+/// so that drawing the background is a single draw call.
+/// The texture is only drawn again when the layout
+/// or the race of the map changes.
+class board_background
+{
+public:
+  board_background() = default;
+  board_background(const board_background&) = delete;
+  board_background& operator=(const board_background&) = delete;
+
+  /// Draw the background,
+  /// composing it first if the layout or race has changed
+  /// @param layout the layout of the game
+  /// @param map_race the race whose map is shown
+  void draw(const game_view_layout& layout, const race map_race);
+
+private:
+
+  /// The background and the squares, if composed
+  std::unique_ptr<sf::RenderTexture> m_texture;
+
+  /// The area of the background the texture was composed for
+  std::optional<screen_rect> m_background_rect;
+
+  /// The area of the board the texture was composed for
+  std::optional<screen_rect> m_board_rect;
+
+  /// The race of the map the texture was composed for
+  std::optional<race> m_race;
+
+  /// Draw the map and the squares on the texture.
+  /// @return if this succeeded
+  bool compose(const game_view_layout& layout, const race map_race);
+};
+
+#endif // LOGIC_ONLY
+
+#endif // BOARD_BACKGROUND_H
@@ -1,16 +1,21 @@
 #ifndef BOARD_LAYOUT_H
 #define BOARD_LAYOUT_H
 
+#include "screen_coordinate.h"
 #include "screen_rect.h"
 
 #include "square_layout.h"
 
-#include <vector>
+#include <array>
 
 /// The layout of a chess board.
 ///
 /// It fits exactly within the screen rectangle
-/// and there are no gaps or overlap between the squares
+/// and there are no gaps or overlap between the squares.
+///
+/// All rectangles are calculated once, at construction,
+/// so drawing a board only reads these.
+/// Create a new layout when the screen is resized
 class board_layout
 {
 public:
@@ -32,13 +37,28 @@ public:
   /// - (7,7) is h8
   const square_layout& get_square(const int x, const int y) const;
 
+  /// Get the center of the square,
+  /// using the same coordinates as \link{board_layout::get_square}
+  const screen_coordinate& get_square_center(const int x, const int y) const;
+
+  /// Get the rectangles of all squares,
+  /// with the square at (x, y) at index `x + (8 * y)`
+  const auto& get_squares() const noexcept { return m_squares; }
+
 private:
 
   screen_rect m_background;
 
-  std::vector<std::vector<square_layout>> m_rects;
+  /// The centers of the squares, indexed as m_squares
+  std::array<screen_coordinate, 64> m_centers;
+
+  /// The squares, with the square at (x, y) at index `x + (8 * y)`
+  std::array<square_layout, 64> m_squares;
 };
 
+/// Get the index of square at (x, y) in \link{board_layout::get_squares}
+constexpr int get_square_index(const int x, const int y) noexcept { return x + (8 * y); }
+
 int get_height(const board_layout& b);
 
 int get_width(const board_layout& b);
@@ -29,6 +29,14 @@ public:
   /// so that users can submit a bug report
   auto get_do_assert_to_log() const noexcept{ return m_do_assert_to_log; }
 
+  /// Quit the game when the loading is done,
+  /// to measure the time to the first frame
+  auto get_do_exit_after_loading() const noexcept { return m_do_exit_after_loading; }
+
+  /// Run the slow tests, that use threads, sockets or wall-clock time,
+  /// as set by '--long-tests'
+  auto get_do_long_test() const noexcept { return m_do_long_test; }
+
   auto get_do_profile() const noexcept { return m_do_profile; }
   auto get_do_test() const noexcept { return m_do_test; }
   auto get_do_play_standard_random_game() const noexcept { return m_do_play_standard_random_game; }
@@ -36,6 +44,15 @@ public:
   /// Show the in-game debug info at the start
   auto get_do_show_debug_info() const noexcept { return m_do_show_debug_info; }
 
+  /// Get the name of the file to write the trace-event JSON to,
+  /// as set by '--trace <file>'.
+  /// Empty if there is no tracing
+  const auto& get_trace_filename() const noexcept { return m_trace_filename; }
+
+  /// Let the display wait for the screen refresh,
+  /// instead of letting the frame pacer sleep
+  auto get_do_use_vsync() const noexcept { return m_do_use_vsync; }
+
 
 private:
 
@@ -52,10 +69,15 @@ private:
 
 
   bool m_do_assert_to_log{false};
+  bool m_do_exit_after_loading{false};
+  bool m_do_long_test{false};
   bool m_do_play_standard_random_game{false};
   bool m_do_profile{false};
   bool m_do_show_debug_info{false};
   bool m_do_test{true};
+  bool m_do_use_vsync{false};
+
+  std::string m_trace_filename;
 
   friend std::ostream& operator<<(std::ostream& os, const cc_cli_options& options) noexcept;
 
@@ -73,6 +73,8 @@ private:
   /// Change the selected item, from spacebar or LMB click
   void change_selected();
 
+  /// The controls only change due to user input
+  bool is_retained_impl() const noexcept override { return true; }
 };
 
 /// @param is_active if the panel is active:
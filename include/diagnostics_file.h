@@ -2,6 +2,7 @@
 #define DIAGNOSTICS_FILE_H
 
 #include "ccfwd.h"
+#include "diagnostics_log.h"
 
 #include <string>
 
@@ -11,11 +12,13 @@ std::string get_default_diagnostics_filename()  noexcept;
 ///
 /// Conquer Chess produces a diagnostics file to help fix bugs quicker.
 ///
-/// This file is always appended, so that a user never looses information
+/// This file is always appended, so that a user never looses information.
+/// All text is added to a \link{diagnostics_log},
+/// so adding text does not wait for the file system
 class diagnostics_file
 {
 public:
-  diagnostics_file(const std::string filename = get_default_diagnostics_filename());
+  explicit diagnostics_file(diagnostics_log& log = get_diagnostics_log());
 
   /// Add the command-line options to the file
   void add_cli_options(const cc_cli_options& options);
@@ -26,13 +29,26 @@ public:
   /// Add the header, i.e. the most basic info, to the file
   void add_header();
 
+  /// Add the time it took to load the game,
+  /// i.e. from the creation of the main window
+  /// until the first frame of the main menu,
+  /// and how well the asset cache performed
+  void add_loading_time(
+    const double seconds,
+    const int n_asset_cache_hits,
+    const int n_asset_cache_misses
+  );
+
   /// Add the screen size to the file.
   ///
   /// Called upon a screen resize
   void add_screen_size(const int width, const int height);
 
 private:
-  std::string m_filename;
+  diagnostics_log * m_log;
+
+  /// Add the text, one message per line
+  void add_lines(const std::string& text);
 };
 
 /// Test the about_view_layout class
@@ -0,0 +1,192 @@
+#ifndef DIAGNOSTICS_LOG_H
+#define DIAGNOSTICS_LOG_H
+
+#include "log_severity.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/// Get the default maximum number of messages
+/// a \link{diagnostics_log} accepts per second,
+/// errors excluded
+constexpr int get_default_diagnostics_log_max_messages_per_second() { return 100; }
+
+/// Get the maximum length of a message in a \link{diagnostics_log}.
+/// Longer messages are truncated
+constexpr int get_diagnostics_log_max_message_length() { return 256; }
+
+/// A log that is cheap enough to use in every frame.
+///
+/// Messages are added to a ring buffer in memory, without locking,
+/// from any thread.
+/// A writer thread appends these to the file
+/// at a fixed interval, when flushed, or upon an error.
+/// The ring buffer keeps the most recent messages,
+/// so these can be dumped when the program aborts,
+/// see \link{diagnostics_log::dump}.
+///
+/// If more than a maximum number of messages per second are added,
+/// these are dropped and counted instead, so that a burst
+/// of messages (e.g. when resizing a window) does not flood the file.
+///
+/// Use \link{get_diagnostics_log} to get the log of the process
+class diagnostics_log
+{
+public:
+  /// @param capacity the number of messages in the ring buffer,
+  ///   must be a power of two
+  explicit diagnostics_log(
+    const std::string& filename,
+    const int capacity = 1024,
+    const int max_messages_per_second = get_default_diagnostics_log_max_messages_per_second()
+  );
+  diagnostics_log(const diagnostics_log&) = delete;
+  diagnostics_log& operator=(const diagnostics_log&) = delete;
+
+  /// Writes the messages not written yet
+  ~diagnostics_log();
+
+  /// Add a message.
+  ///
+  /// Can be called from any thread
+  void add(const log_severity s, const std::string& text) noexcept;
+
+  /// Write the most recent messages in the ring buffer,
+  /// including those already written to file.
+  ///
+  /// Does not allocate, so that it can be called
+  /// from a signal handler
+  void dump(std::FILE * const f) const noexcept;
+
+  /// Write all messages added, waits until these are written
+  void flush();
+
+  const auto& get_filename() const noexcept { return m_filename; }
+
+  /// Get the least severe messages that are added
+  auto get_min_severity() const noexcept { return m_min_severity.load(); }
+
+  /// Get the number of messages that were overwritten in the ring buffer
+  /// before these were written to file
+  int get_n_dropped() const noexcept { return m_n_dropped; }
+
+  /// Get the number of messages that were dropped,
+  /// because too many messages were added per second
+  int get_n_rate_limited() const noexcept { return m_n_rate_limited; }
+
+  /// Only add messages of this severity or more severe
+  void set_min_severity(const log_severity s) noexcept { m_min_severity = s; }
+
+private:
+
+  /// A message in the ring buffer.
+  ///
+  /// The sequence number is odd while the message is written
+  /// and even when it is done, so that a reader can detect
+  /// if the message was overwritten while reading it
+  struct entry
+  {
+    std::atomic<std::uint64_t> m_sequence{0};
+    log_severity m_severity{log_severity::debug};
+    double m_time_secs{0.0};
+    int m_length{0};
+    std::array<char, get_diagnostics_log_max_message_length()> m_text;
+  };
+
+  /// The result of reading an entry
+  enum class read_result { ok, not_written_yet, overwritten };
+
+  std::string m_filename;
+
+  /// The ring buffer
+  std::unique_ptr<entry[]> m_entries;
+
+  std::uint64_t m_index_mask;
+
+  int m_max_messages_per_second;
+
+  std::atomic<log_severity> m_min_severity{log_severity::debug};
+
+  /// The number of messages added, also the index of the next message
+  std::atomic<std::uint64_t> m_n_added{0};
+
+  /// The number of messages read by the writer thread,
+  /// only used by the writer thread
+  std::uint64_t m_n_read{0};
+
+  /// The number of messages written, or dropped
+  std::uint64_t m_n_done{0};
+
+  std::atomic<int> m_n_dropped{0};
+
+  std::atomic<int> m_n_rate_limited{0};
+
+  /// The number of messages added in the current second
+  std::atomic<int> m_n_in_rate_window{0};
+
+  /// The current second, since the log started
+  std::atomic<std::int64_t> m_rate_window{0};
+
+  std::chrono::steady_clock::time_point m_start;
+
+  /// Protects m_must_flush, m_must_stop and m_n_done
+  std::mutex m_mutex;
+
+  /// Wakes up the writer thread
+  std::condition_variable m_wake_writer;
+
+  /// Notifies that messages have been written
+  std::condition_variable m_messages_written;
+
+  bool m_must_flush{false};
+
+  bool m_must_stop{false};
+
+  std::thread m_writer;
+
+  /// Get the time since the log started, in seconds
+  double get_time_secs() const noexcept;
+
+  /// Has the maximum number of messages in this second been reached?
+  bool is_rate_limited() noexcept;
+
+  /// Read the message with index 'i'
+  read_result read(
+    const std::uint64_t i,
+    log_severity& s,
+    double& time_secs,
+    std::array<char, get_diagnostics_log_max_message_length()>& text,
+    int& length
+  ) const noexcept;
+
+  /// Write the messages until m_must_stop is set
+  void run();
+};
+
+/// Write the most recent messages of the log of the process
+/// with \link{diagnostics_log::dump}, if that log has been created.
+///
+/// Does not create the log, so that it can be called
+/// from a signal handler.
+/// @return true if the log has been created and is dumped
+bool dump_diagnostics_log(std::FILE * const f) noexcept;
+
+/// Get the log of the process, that writes to the diagnostics file.
+///
+/// The first call creates the log, which opens the file
+/// and starts a thread, so call this before
+/// \link{dump_diagnostics_log} is used in a signal handler
+diagnostics_log& get_diagnostics_log();
+
+/// Test this class and its free functions
+void test_diagnostics_log();
+
+#endif // DIAGNOSTICS_LOG_H
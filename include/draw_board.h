@@ -10,10 +10,14 @@
 #include <vector>
 
 /// Draw the pieces
+/// @param progresses the progress of the pieces' current actions,
+///   by the index of the piece, see \link{interpolate}.
+///   If empty, the pieces' own progress is used
 void draw_pieces(
   const game_controller& c,
   const board_layout& layout,
-  const bool indicate_protectedness
+  const bool indicate_protectedness,
+  const std::vector<double>& progresses = {}
 );
 
 /// Draw the squares of a chessboard at the window target rectangle's location
@@ -29,9 +33,13 @@ void draw_unit_health_bars(
 );
 
 /// Show the paths the units are taking on-screen
+/// @param progresses the progress of the pieces' current actions,
+///   by the index of the piece, see \link{interpolate}.
+///   If empty, the pieces' own progress is used
 void draw_unit_paths(
   const std::vector<piece>& pieces,
-  const board_layout& layout
+  const board_layout& layout,
+  const std::vector<double>& progresses = {}
 );
 
 #endif // LOGIC_ONLY
@@ -0,0 +1,49 @@
+#ifndef FEN_POSITION_H
+#define FEN_POSITION_H
+
+#include "ccfwd.h"
+#include "chess_color.h"
+#include "piece_type.h"
+
+#include <array>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/// The pieces and the active color of a FEN string,
+/// without creating a \link{game} or \link{piece}s.
+///
+/// Each square holds the FEN character of its piece,
+/// e.g. 'K' for a white king, or '\0' if it is empty.
+class fen_position
+{
+public:
+  /// An empty board, white is active
+  fen_position();
+
+  explicit fen_position(const fen_string& s);
+
+  chess_color get_active_color() const noexcept { return m_active_color; }
+
+  /// Get the color and type of the piece at a square, if any
+  std::optional<std::pair<chess_color, piece_type>> get_piece_at(const square& s) const noexcept;
+
+  /// Get the squares of the pieces of a type and color,
+  /// in the order of the FEN string, i.e. from a8 to h1
+  std::vector<square> get_squares(const piece_type type, const chess_color color) const;
+
+  /// Is there a piece at the square?
+  bool is_piece_at(const square& s) const noexcept;
+
+private:
+  chess_color m_active_color;
+
+  /// The FEN characters, index is (rank * 8) + file,
+  /// where rank and file are zero-based
+  std::array<char, 64> m_squares;
+};
+
+/// Test this class and its free functions
+void test_fen_position();
+
+#endif // FEN_POSITION_H
@@ -0,0 +1,80 @@
+#ifndef FEN_POSITION_CACHE_H
+#define FEN_POSITION_CACHE_H
+
+#include "ccfwd.h"
+#include "fen_position.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/// Get the default number of positions a \link{fen_position_cache} holds
+constexpr int get_default_fen_position_cache_size() { return 1024; }
+
+/// Remembers the most recently used \link{fen_position}s,
+/// keyed by the hash of their FEN string,
+/// so that a FEN string is parsed once
+/// for all the questions asked about it.
+///
+/// When full, the least recently used position is dropped.
+/// Can be used from any thread.
+class fen_position_cache
+{
+public:
+  explicit fen_position_cache(const int max_size = get_default_fen_position_cache_size());
+  fen_position_cache(const fen_position_cache&) = delete;
+  fen_position_cache& operator=(const fen_position_cache&) = delete;
+
+  /// Get the position of a FEN string, from the cache if it is there.
+  /// Can be called from any thread
+  fen_position get(const fen_string& s);
+
+  auto get_max_size() const noexcept { return m_max_size; }
+
+  /// Get the number of times a position was in the cache
+  std::int64_t get_n_hits() const noexcept { return m_n_hits.load(); }
+
+  /// Get the number of times a position had to be parsed
+  std::int64_t get_n_misses() const noexcept { return m_n_misses.load(); }
+
+  /// Get the number of positions in the cache
+  int get_size() const noexcept;
+
+private:
+
+  struct entry
+  {
+    std::size_t m_hash;
+    std::string m_fen_str;
+    fen_position m_position;
+  };
+
+  /// The positions, the most recently used first
+  std::list<entry> m_entries;
+
+  /// Where each hash is in \link{m_entries}
+  std::unordered_map<std::size_t, std::list<entry>::iterator> m_index;
+
+  int m_max_size;
+
+  mutable std::mutex m_mutex;
+
+  std::atomic<std::int64_t> m_n_hits{0};
+  std::atomic<std::int64_t> m_n_misses{0};
+};
+
+/// Get the cache shared by all code that reads FEN strings
+fen_position_cache& get_fen_position_cache();
+
+/// Get the fraction of the requests that were in the cache,
+/// or 0.0 if there were none
+double get_hit_rate(const fen_position_cache& c) noexcept;
+
+/// Test this class and its free functions
+void test_fen_position_cache();
+
+#endif // FEN_POSITION_CACHE_H
@@ -0,0 +1,124 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include "fps_clock.h"
+
+#include <SFML/System.hpp>
+
+#include <string>
+#include <vector>
+
+/// Paces the frames to reach a target frame rate.
+///
+/// Each frame has a deadline, one frame period after the previous one.
+/// After the work of a frame is done, the pacer sleeps until
+/// shortly before the deadline and then spin-waits the last bit,
+/// as a sleep may take longer than requested.
+/// If the work takes longer than a frame period,
+/// the deadline is missed and the next deadline
+/// is one frame period from now.
+///
+/// When vsync is used, the display waits for the screen
+/// and the pacer only measures.
+///
+/// The pacing itself is done by \link{frame_pacer::end_work}
+/// and \link{frame_pacer::end_frame}, that take the time
+/// instead of reading a clock, so that these can be tested
+/// without sleeping.
+class frame_pacer
+{
+public:
+  explicit frame_pacer(const double target_fps = 60.0);
+
+  /// Get the number of frames per second, of the last frame
+  double get_fps() const noexcept { return m_fps_clock.get_fps(); }
+
+  /// Get the percentile of the recent frame times, in milliseconds.
+  /// @param p the percentile, from 0.0 to 100.0, e.g. 95.0
+  double get_frame_time_percentile_ms(const double p) const;
+
+  /// Get the time of the work done in the last frame,
+  /// i.e. excluding the waiting, in milliseconds
+  double get_last_work_time_ms() const noexcept { return m_last_work_time_ms; }
+
+  /// Get the number of frames that were not done before their deadline
+  int get_n_missed_deadlines() const noexcept { return m_n_missed_deadlines; }
+
+  /// Get the number of recent frame times kept
+  int get_n_frame_times() const noexcept { return static_cast<int>(m_frame_times_ms.size()); }
+
+  auto get_target_fps() const noexcept { return m_target_fps; }
+
+  auto get_use_vsync() const noexcept { return m_use_vsync; }
+
+  /// Sets the target frame rate
+  void set_target_fps(const double fps);
+
+  /// Indicate the work of a frame is done at a time,
+  /// in microseconds since the pacer was created.
+  /// @return the time until which to wait, in microseconds
+  sf::Int64 end_work(const sf::Int64 work_end_microseconds);
+
+  /// Indicate a frame has ended at a time, after waiting,
+  /// in microseconds since the pacer was created
+  void end_frame(const sf::Int64 frame_end_microseconds);
+
+  /// Use vsync, in which case the pacer does not wait.
+  ///
+  /// This does not enable vsync on the window
+  void set_use_vsync(const bool use_vsync) noexcept { m_use_vsync = use_vsync; }
+
+  /// Indicate the work of a frame is done.
+  /// This class will wait here until the frame's deadline,
+  /// using \link{frame_pacer::end_work} and \link{frame_pacer::end_frame}
+  void tick();
+
+private:
+
+  /// The clock that keeps track of the frames per second
+  fps_clock m_fps_clock;
+
+  /// The clock that measures the deadlines
+  sf::Clock m_clock;
+
+  /// The deadline of the current frame, in microseconds on m_clock
+  sf::Int64 m_deadline_microseconds{0};
+
+  /// The recent frame times, as a ring buffer
+  std::vector<double> m_frame_times_ms;
+
+  /// The index of the next frame time in m_frame_times_ms
+  int m_frame_times_index{0};
+
+  /// The time the last frame ended, in microseconds on m_clock
+  sf::Int64 m_last_frame_end_microseconds{0};
+
+  double m_last_work_time_ms{0.0};
+
+  int m_n_missed_deadlines{0};
+
+  double m_target_fps;
+
+  bool m_use_vsync{false};
+
+  /// Add a frame time to the ring buffer
+  void add_frame_time(const double ms);
+};
+
+/// Get the maximum number of frame times kept
+/// by a \link{frame_pacer} to calculate its percentiles
+constexpr int get_frame_pacer_n_frame_times() { return 256; }
+
+/// Get the time before a deadline
+/// at which a \link{frame_pacer} stops sleeping and starts spinning,
+/// in microseconds
+constexpr int get_frame_pacer_spin_time_microseconds() { return 2000; }
+
+/// Get the frame time percentiles and missed deadlines
+/// in a short text, e.g. for the debug overlay
+std::string get_frame_times_str(const frame_pacer& p);
+
+/// Test this class and its free functions
+void test_frame_pacer();
+
+#endif // FRAME_PACER_H
@@ -0,0 +1,35 @@
+#ifndef FRAME_PHASE_H
+#define FRAME_PHASE_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/// A phase of a frame in the \link{main_window},
+/// in the order these are done
+enum class frame_phase
+{
+  /// Processing the events
+  events,
+
+  /// Ticking the current view, i.e. 'view::tick'
+  tick,
+
+  /// Drawing the current view, i.e. 'view::draw'
+  draw,
+
+  /// Displaying the frame and waiting for the next one
+  display
+};
+
+/// Get all the frame_phase values
+std::vector<frame_phase> get_all_frame_phases() noexcept;
+
+/// Test this class and its free functions
+void test_frame_phase();
+
+std::string to_str(const frame_phase p) noexcept;
+
+std::ostream& operator<<(std::ostream& os, const frame_phase p) noexcept;
+
+#endif // FRAME_PHASE_H
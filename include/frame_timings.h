@@ -0,0 +1,81 @@
+#ifndef FRAME_TIMINGS_H
+#define FRAME_TIMINGS_H
+
+#include "ccfwd.h"
+#include "frame_phase.h"
+
+#include <array>
+#include <string>
+#include <vector>
+
+/// The time spent in each phase of a frame
+class frame_timing
+{
+public:
+  frame_timing();
+
+  /// Get the time spent in a phase, in milliseconds
+  double get_ms(const frame_phase p) const noexcept;
+
+  /// Set the time spent in a phase, in milliseconds
+  void set_ms(const frame_phase p, const double ms) noexcept;
+
+private:
+
+  std::array<double, 4> m_ms;
+};
+
+/// Get the total time of a frame, in milliseconds
+double get_total_ms(const frame_timing& t) noexcept;
+
+/// The timings of the recent frames, in a rolling ring buffer
+class frame_timings
+{
+public:
+  explicit frame_timings(const int max_n_frames = 300);
+
+  /// Add the timing of a frame,
+  /// overwriting the oldest if the buffer is full
+  void add(const frame_timing& t);
+
+  /// Get the timings, from oldest to newest
+  std::vector<frame_timing> get() const;
+
+  int get_max_n_frames() const noexcept { return m_max_n_frames; }
+
+  int get_n_frames() const noexcept { return static_cast<int>(m_timings.size()); }
+
+private:
+
+  int m_max_n_frames;
+
+  /// The timings, as a ring buffer
+  std::vector<frame_timing> m_timings;
+
+  /// The index of the next timing in m_timings
+  int m_index{0};
+};
+
+/// Get the default name of the file the frame timings are saved to
+std::string get_default_frame_timings_filename() noexcept;
+
+/// Get the mean time spent in a phase, in milliseconds
+double get_mean_ms(const frame_timings& t, const frame_phase p);
+
+/// Save the frame timings to a CSV file, one row per frame
+void save_to_csv(const frame_timings& t, const std::string& filename);
+
+/// Convert the frame timings to CSV text, with a header row
+std::string to_csv_str(const frame_timings& t);
+
+#ifndef LOGIC_ONLY
+
+/// Draw the frame timings as a graph, with one line per phase
+void draw_frame_timings(const frame_timings& t, const screen_rect& r);
+
+#endif // LOGIC_ONLY
+
+/// Test this class and its free functions
+void test_frame_timings();
+
+#endif // FRAME_TIMINGS_H
@@ -148,13 +148,15 @@ void clear_piece_messages(game& g) noexcept;
 action_history collect_action_history(const game& g);
 
 /// Collect all valid moves and attackes at a board
-/// for all pieces
+/// for all pieces.
+/// Only legal actions are collected, see \link{king_safety}
 /// @see use 'collect_all_user_inputs'
 /// to get all the 'user_input's from a game
 std::vector<piece_action> collect_all_piece_actions(const game& g);
 
 /// Collect all valid moves and attackes at a board
-/// for all pieces of a certain color
+/// for all pieces of a certain color.
+/// Only legal actions are collected, see \link{king_safety}
 std::vector<piece_action> collect_all_piece_actions(
   const game& g,
   const chess_color player_color
@@ -9,8 +9,11 @@
 #include "side.h"
 #include "user_inputs.h"
 
+#include <cstdint>
 #include <map>
 #include <iosfwd>
+#include <optional>
+#include <vector>
 
 /// The class that acts as a controller for \link{game}.
 ///
@@ -47,8 +50,14 @@ public:
   /// Get the game
   const game& get_game() const noexcept { return m_game; }
 
-  /// Get the game
-  game& get_game() noexcept { return m_game; }
+  /// Get the game, to change it.
+  ///
+  /// As the game may be changed, this forgets the remembered
+  /// piece actions, see \link{get_piece_actions}.
+  /// Do not keep the reference: a change made after
+  /// the piece actions are remembered again goes unnoticed.
+  /// To only read the game, use the const overload
+  game& get_game() noexcept { ++m_game_version; return m_game; }
 
   /// Get the game
   const auto& get_lobby_options() const noexcept { return m_lobby_options; }
@@ -62,6 +71,15 @@ public:
   /// Get a player's physical controller
   const physical_controller& get_physical_controller(const side player_side) const noexcept;
 
+  /// Get the types of actions, if any, a player could by pressing an action key.
+  ///
+  /// The actions are remembered per side, until the cursor
+  /// moves to another square or in or out of the click distance
+  /// of the square's center, the selected piece changes
+  /// or the game changes.
+  /// Use \link{collect_piece_actions} to always calculate these
+  const std::vector<piece_action_type>& get_piece_actions(const side player_side) const noexcept;
+
   /// Set a player's cursor's position
   void set_cursor_pos(const game_coordinate& pos, const side player_side) noexcept;
 
@@ -79,9 +97,28 @@ private:
   /// The game it controls
   game m_game;
 
+  /// Increases when m_game may have changed,
+  /// so that the remembered piece actions are calculated again
+  std::int64_t m_game_version{0};
+
   /// The options as set in the lobby: sides, colors, races
   lobby_options m_lobby_options;
 
+  /// The piece actions of a player, as remembered by \link{get_piece_actions}
+  struct piece_actions_memo
+  {
+    square m_cursor_square;
+    std::optional<piece_id> m_selected_piece_id;
+    std::int64_t m_game_version;
+    /// Is the cursor within the click distance of its square's center?
+    /// Only then a piece can be selected
+    bool m_is_cursor_near_center;
+    std::vector<piece_action_type> m_actions;
+  };
+
+  /// The remembered piece actions per player
+  mutable std::map<side, piece_actions_memo> m_piece_actions_memos;
+
   /// The selected squares, if any.
   ///
   /// Use \link{check_selected_pieces_exist} if the pieces that
@@ -121,6 +158,12 @@ void add_user_input(game_controller& c, const user_input& input);
 /// Add a user_inputs. These will be processed in 'game::tick'
 void add_user_inputs(game_controller& c, const user_inputs& input);
 
+/// Calculate a hash of the state of the game and the cursors,
+/// e.g. to detect that two networked games differ.
+///
+/// The same state gives the same hash,
+/// also on another computer running the same executable
+std::uint64_t calc_hash(const game_controller& c) noexcept;
 
 /// Can the player attack?
 bool can_attack(
@@ -182,6 +225,14 @@ bool can_unselect(
 /// Get all the sound effects to be processed
 std::vector<message> collect_messages(const game_controller& g) noexcept;
 
+/// Calculate the types of actions, if any, a player could by pressing an action key.
+///
+/// Prefer \link{get_piece_actions}, that remembers these
+std::vector<piece_action_type> collect_piece_actions(
+  const game_controller& c,
+  const side player_side
+) noexcept;
+
 ///Collect all the piece IDs of the selected pieces, if any
 std::vector<piece_id> collect_selected_piece_ids(const game_controller& c);
 
@@ -245,6 +296,8 @@ const in_game_time& get_in_game_time(
 ///
 /// For example, action 1 typically un-/selects pieces, where
 /// action 4 is only used to promote to a knight.
+///
+/// These are remembered, see \link{game_controller::get_piece_actions}
 std::vector<piece_action_type> get_piece_actions(
   const game_controller& c,
   const side player_side
@@ -0,0 +1,204 @@
+#ifndef GAME_SIMULATION_H
+#define GAME_SIMULATION_H
+
+#include "ccfwd.h"
+#include "delta_t.h"
+#include "game_controller.h"
+#include "game_speed.h"
+#include "message.h"
+#include "spsc_queue.h"
+#include "triple_buffer.h"
+#include "user_inputs.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Get the default number of simulation steps per second
+constexpr double get_default_simulation_frequency() { return 120.0; }
+
+/// An immutable state of a \link{game_simulation},
+/// as passed to the renderer
+class game_snapshot
+{
+public:
+  explicit game_snapshot(
+    const game_controller& c = game_controller(),
+    const int n_steps = 0
+  );
+
+  const auto& get_game_controller() const noexcept { return m_game_controller; }
+
+  /// The number of simulation steps done to reach this state
+  auto get_n_steps() const noexcept { return m_n_steps; }
+
+private:
+  game_controller m_game_controller;
+  int m_n_steps;
+};
+
+/// Runs a \link{game_controller} with a fixed timestep,
+/// on its own thread.
+///
+/// Each step has the same delta_t, regardless of the frame rate,
+/// so that the same user inputs in the same steps
+/// give the same game.
+/// After each step, the new state is published
+/// in a lock-free \link{triple_buffer},
+/// so that the renderer never waits for the simulation
+/// and vice versa.
+///
+/// The user inputs are passed to the simulation thread
+/// in a lock-free \link{spsc_queue}, stamped with the time
+/// they were added, so that a slow frame of the renderer
+/// never blocks the simulation.
+///
+/// The simulation does not process the pieces' messages,
+/// it collects these for the renderer instead,
+/// see \link{game_simulation::collect_messages}.
+class game_simulation
+{
+public:
+  explicit game_simulation(
+    const game_controller& c = game_controller(),
+    const game_speed speed = get_default_game_speed(),
+    const double steps_per_second = get_default_simulation_frequency()
+  );
+  game_simulation(const game_simulation&) = delete;
+  game_simulation& operator=(const game_simulation&) = delete;
+  ~game_simulation();
+
+  /// Add user inputs, to be applied at the start of the next step.
+  ///
+  /// The inputs are stamped with the current time.
+  /// When the queue to the simulation is full, the inputs wait,
+  /// see \link{game_simulation::flush_user_inputs}.
+  /// No input is lost, only mouse moves are combined.
+  /// Only to be called by the (one) thread that processes the events
+  void add_user_inputs(const user_inputs& inputs);
+
+  /// Get the messages the pieces have sent since the previous call.
+  ///
+  /// Can be called from any thread
+  std::vector<message> collect_messages();
+
+  /// Pass the user inputs that waited because the queue was full.
+  ///
+  /// Call this every frame, so that these are applied
+  /// also when no new user inputs are added.
+  /// Only to be called by the (one) thread that processes the events
+  void flush_user_inputs();
+
+  /// Get the in-game time that passes per step
+  delta_t get_delta_t() const noexcept;
+
+  /// Get the most recently published state.
+  ///
+  /// Only to be called by the (one) renderer thread
+  const game_snapshot& get_snapshot() noexcept { return m_snapshots.get_front(); }
+
+  /// Are there user inputs waiting because the queue was full?
+  ///
+  /// Only to be called by the (one) thread that processes the events
+  bool has_waiting_user_inputs() const noexcept;
+
+  /// Get the real time between two steps, in seconds
+  double get_step_time_secs() const noexcept { return 1.0 / m_steps_per_second; }
+
+  /// Is the time from adding user inputs to a piece starting an action measured?
+  bool get_measure_input_latency() const noexcept { return m_measure_input_latency; }
+
+  /// Is the simulation running on its own thread?
+  bool is_running() const noexcept { return m_thread.joinable(); }
+
+  /// Measure the time from adding user inputs to
+  /// a piece starting an action, in the 'input_to_action_ms' histogram.
+  ///
+  /// To do so, the user inputs are applied one event at a time,
+  /// instead of all at once.
+  /// Can be called from any thread
+  void set_measure_input_latency(const bool b) noexcept { m_measure_input_latency = b; }
+
+  /// Start the simulation thread
+  void start();
+
+  /// Do one step.
+  ///
+  /// Only to be called by the simulation thread,
+  /// or when the simulation thread is not running (e.g. in tests)
+  void step();
+
+  /// Stop the simulation thread, if it is running
+  void stop();
+
+private:
+
+  /// The game controller, only used by the simulation thread
+  game_controller m_game_controller;
+
+  /// The user inputs of one event, with the time they were added
+  struct timed_user_inputs
+  {
+    user_inputs m_user_inputs;
+    std::chrono::steady_clock::time_point m_time;
+  };
+
+  /// The user inputs to be applied in the next step,
+  /// from the thread that processes the events
+  spsc_queue<timed_user_inputs> m_user_inputs;
+
+  /// The user inputs that did not fit in m_user_inputs, combined into one,
+  /// so that mouse moves replace each other and no key or button is lost.
+  /// Only used by the thread that processes the events
+  timed_user_inputs m_waiting_user_inputs;
+
+  /// The messages collected since the last
+  /// call to \link{game_simulation::collect_messages}
+  std::vector<message> m_messages;
+
+  /// Protects m_messages
+  std::mutex m_mutex;
+
+  std::atomic<bool> m_measure_input_latency{false};
+
+  /// The number of steps done
+  int m_n_steps{0};
+
+  /// The published states
+  triple_buffer<game_snapshot> m_snapshots;
+
+  game_speed m_speed;
+
+  double m_steps_per_second;
+
+  std::atomic<bool> m_must_stop{false};
+
+  std::thread m_thread;
+
+  /// Do steps until m_must_stop is set
+  void run();
+};
+
+/// Get the progress of the pieces' current actions
+/// between two snapshots, as shown by the renderer.
+///
+/// The pieces themselves are read from 'to', so that
+/// only the progresses are updated every frame.
+/// 'progresses' gets the progress of each piece in 'to', in the same order,
+/// and reuses its memory when called with the same vector every frame.
+/// A piece that is absent in 'from' or does another action there
+/// gets its progress in 'to'
+/// @param f the fraction from 'from' (0.0) to 'to' (1.0)
+void interpolate(
+  const game_snapshot& from,
+  const game_snapshot& to,
+  const double f,
+  std::vector<double>& progresses
+);
+
+/// Test this class and its free functions
+void test_game_simulation();
+
+#endif // GAME_SIMULATION_H
@@ -0,0 +1,36 @@
+#ifndef GAME_STATISTICS_FILE_FORMAT_H
+#define GAME_STATISTICS_FILE_FORMAT_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/// The format of a \link{game_statistics_output_file}
+enum class game_statistics_file_format
+{
+  /// Comma-separated values, one row per line, with a header line
+  csv,
+
+  /// Compact binary columns, written in blocks.
+  ///
+  /// All integers are 32-bit unsigned, all values are 32-bit floats,
+  /// both in the byte order of the machine.
+  /// The file starts with the magic characters 'CCGS',
+  /// the number of columns and the column headers,
+  /// each header as its length followed by its characters.
+  /// Then follow the blocks: each block starts with its number of rows,
+  /// followed by the values of the first column, then of the second, etc.
+  binary
+};
+
+/// Get all the game_statistics_file_format values
+std::vector<game_statistics_file_format> get_all_game_statistics_file_formats() noexcept;
+
+/// Test this class and its free functions
+void test_game_statistics_file_format();
+
+std::string to_str(const game_statistics_file_format f) noexcept;
+
+std::ostream& operator<<(std::ostream& os, const game_statistics_file_format f) noexcept;
+
+#endif // GAME_STATISTICS_FILE_FORMAT_H
@@ -2,27 +2,121 @@
 #define GAME_STATISTICS_OUTPUT_FILE_H
 
 #include "ccfwd.h"
+#include "game_statistics_file_format.h"
+#include "spsc_queue.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <iosfwd>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
-/// File to save the game statistics too
+/// Get the default time between two writes
+/// of a \link{game_statistics_output_file}, in seconds
+constexpr double get_default_game_statistics_flush_interval_secs() { return 1.0; }
+
+/// File to save the game statistics too.
+///
+/// The rows are added without waiting for the file system:
+/// these are passed via a lock-free \link{spsc_queue}
+/// to a writer thread, that writes these in batches,
+/// at a fixed interval, when flushed and when destroyed.
+///
+/// Rows are added by one thread only
 class game_statistics_output_file
 {
 public:
-  game_statistics_output_file(const std::string& filename);
+  explicit game_statistics_output_file(
+    const std::string& filename,
+    const game_statistics_file_format format = game_statistics_file_format::csv,
+    const double flush_interval_secs = get_default_game_statistics_flush_interval_secs()
+  );
+  game_statistics_output_file(const game_statistics_output_file&) = delete;
+  game_statistics_output_file& operator=(const game_statistics_output_file&) = delete;
+
+  /// Writes the rows not written yet
+  ~game_statistics_output_file();
 
+  /// Add the statistics of the game as a row.
+  ///
+  /// If the queue is full, the row is dropped
   void add_to_file(const game_controller& g);
 
+  /// Write all rows added, waits until these are written
+  void flush();
+
+  const auto& get_filename() const noexcept { return m_filename; }
+
+  auto get_format() const noexcept { return m_format; }
+
+  /// Get the number of rows that were dropped,
+  /// because the queue was full
+  int get_n_dropped_rows() const noexcept { return m_n_dropped_rows; }
+
 private:
 
   std::string m_filename;
+
+  game_statistics_file_format m_format;
+
+  /// The time between two writes
+  double m_flush_interval_secs;
+
+  /// The rows added, but not written yet
+  spsc_queue<std::vector<double>> m_rows;
+
+  /// The number of rows added to the queue
+  std::atomic<int> m_n_rows_added{0};
+
+  /// The number of rows written
+  int m_n_rows_written{0};
+
+  int m_n_dropped_rows{0};
+
+  /// Protects m_must_flush, m_must_stop and m_n_rows_written
+  std::mutex m_mutex;
+
+  /// Wakes up the writer thread
+  std::condition_variable m_wake_writer;
+
+  /// Notifies that rows have been written
+  std::condition_variable m_rows_written;
+
+  bool m_must_flush{false};
+
+  bool m_must_stop{false};
+
+  std::thread m_writer;
+
+  /// Write the rows until m_must_stop is set
+  void run();
 };
 
 /// Get the column headers as one, comma-seperated string
 std::string get_column_headers_as_str();
 
+/// Get the default filename of a \link{game_statistics_output_file}
+std::string get_default_game_statistics_filename() noexcept;
+
+/// Read the rows of a \link{game_statistics_output_file}
+/// in the binary format
+std::vector<std::vector<double>> read_binary_game_statistics_file(const std::string& filename);
+
 void test_game_statistics_output_file();
 
-#endif // GAME_STATISTICS_OUTPUT_FILE_H
+/// Write the rows to a stream, in a format
+void write_game_statistics_rows(
+  std::ostream& os,
+  const std::vector<std::vector<double>>& rows,
+  const game_statistics_file_format format
+);
+
+/// Write the header of a \link{game_statistics_output_file} to a stream
+void write_game_statistics_header(
+  std::ostream& os,
+  const game_statistics_file_format format
+);
 
+#endif // GAME_STATISTICS_OUTPUT_FILE_H
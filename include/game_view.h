@@ -4,11 +4,13 @@
 #ifndef LOGIC_ONLY
 
 #include "ccfwd.h"
+#include "board_background.h"
 #include "controls_bar.h"
 #include "physical_controller.h"
 //#include "game.h"
 #include "game_log.h"
 #include "game_controller.h"
+#include "game_simulation.h"
 #include "game_view_layout.h"
 #include "game_statistics_output_file.h"
 #include "game_statistics_in_time.h"
@@ -16,6 +18,8 @@
 
 #include <SFML/Graphics.hpp>
 
+#include <memory>
+#include <vector>
 //#include <optional>
 
 /// The Game dialog.
@@ -37,9 +41,10 @@ public:
   /// The the elapsed time in seconds
   double get_elapsed_time_secs() const noexcept;
 
-  const auto& get_game() const noexcept { return m_game_controller.get_game(); }
+  const auto& get_game() const noexcept { return get_game_controller().get_game(); }
 
-  const auto& get_game_controller() const noexcept { return m_game_controller; }
+  /// Get the game controller shown, i.e. the one of the latest snapshot
+  const auto& get_game_controller() const noexcept { return m_latest_snapshot.get_game_controller(); }
 
   const auto& get_game_options() const noexcept { return m_game_options; }
 
@@ -48,6 +53,10 @@ public:
   /// Get the text log, i.e. things pieces have to say
   const auto& get_log() const noexcept { return m_log; }
 
+  /// Get the progress of the pieces' current actions as shown,
+  /// by the index of the piece in \link{get_game}
+  const auto& get_piece_progresses() const noexcept { return m_piece_progresses; }
+
   const auto& get_physical_controllers() const noexcept { return m_pc; }
 
   [[nodiscard]] replay get_replay() const;
@@ -69,6 +78,9 @@ public:
 
 private:
 
+  /// The map and the squares, drawn in one go
+  board_background m_board_background;
+
   /// The game clock, to measure the elapsed time
   sf::Clock m_clock;
 
@@ -76,8 +88,21 @@ private:
 
   game_options m_game_options;
 
-  /// The game controller, interacts with game
-  game_controller m_game_controller;
+  /// The simulation, that runs the game on its own thread
+  std::unique_ptr<game_simulation> m_simulation;
+
+  /// The two latest snapshots of the simulation,
+  /// to interpolate between
+  game_snapshot m_previous_snapshot;
+  game_snapshot m_latest_snapshot;
+
+  /// The time since the latest snapshot arrived
+  sf::Clock m_snapshot_clock;
+
+  /// The progress of the pieces' current actions as shown,
+  /// interpolated between the two latest snapshots.
+  /// Its memory is reused every frame, see \link{interpolate}
+  std::vector<double> m_piece_progresses;
 
   /// The game logic
   game_view_layout m_layout;
@@ -95,11 +120,15 @@ private:
 
 
   /// Play the new sound effects
-  void play_pieces_sound_effects();
+  void play_pieces_sound_effects(const std::vector<message>& messages);
 
   /// Read the pieces' messages and play their sounds
   void process_piece_messages();
 
+  /// Get the newest snapshot of the simulation and
+  /// interpolate the progress of the pieces shown
+  void update_game_controller();
+
   /// Show the mouse cursor on-screen
   void show_mouse_cursor();
 };
@@ -154,10 +183,9 @@ void process_event(
 );
 
 
-/// Show the map of the window
-void draw_background(game_view& view);
-
-/// Show the board: squares, unit paths, pieces, health bars
+/// Show the board: unit paths, pieces, health bars.
+///
+/// The squares are part of the \link{board_background}
 void draw_board(
   game_view& view,
   const bool show_occupied
@@ -197,9 +225,6 @@ void draw_possible_moves(game_view& view);
 /// Show the info on the side-bar on-screen for a player
 void show_sidebar(game_view& view, const side player_side);
 
-/// Show the squares of the board on-screen
-void draw_squares(game_view& view);
-
 /// Show the highlighted square under the cursor on-screen for a player
 void draw_cursor(
   game_view& view,
@@ -0,0 +1,93 @@
+#ifndef INPUT_REPLAY_H
+#define INPUT_REPLAY_H
+
+#include "ccfwd.h"
+#include "delta_t.h"
+#include "game_controller.h"
+#include "user_inputs.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// A replay of a game played over a network,
+/// as the user inputs of both players per frame.
+///
+/// As the game is deterministic, playing these user inputs again
+/// from the same start gives the same game,
+/// see \link{play_input_replay}.
+/// Only the frames with user inputs are stored,
+/// so a replay is small, even for a long game.
+class input_replay
+{
+public:
+  /// @param dt the in-game time per simulation step
+  /// @param n_steps_per_frame the number of simulation steps per frame
+  explicit input_replay(
+    const delta_t& dt = delta_t(1.0),
+    const int n_steps_per_frame = 1
+  );
+
+  /// Add the user inputs of both players of the next frame
+  void add_frame(const user_inputs& inputs);
+
+  auto get_delta_t() const noexcept { return m_delta_t; }
+
+  /// Get the frames with user inputs,
+  /// as the index of the frame and its user inputs
+  const auto& get_frames() const noexcept { return m_frames; }
+
+  /// Get the number of frames, including the ones without user inputs
+  auto get_n_frames() const noexcept { return m_n_frames; }
+
+  auto get_n_steps_per_frame() const noexcept { return m_n_steps_per_frame; }
+
+private:
+  delta_t m_delta_t;
+
+  std::vector<std::pair<int, user_inputs>> m_frames;
+
+  int m_n_frames{0};
+
+  int m_n_steps_per_frame;
+};
+
+/// Read an \link{input_replay} from a file,
+/// as saved by \link{save_input_replay}.
+///
+/// Throws a std::runtime_error if the file cannot be read
+/// or is not an input replay
+input_replay load_input_replay(const std::string& filename);
+
+/// Play the user inputs of a replay,
+/// starting from a game.
+/// @return the game after the last frame
+game_controller play_input_replay(
+  const input_replay& r,
+  const game_controller& c = game_controller()
+);
+
+/// Save an \link{input_replay} to a file, in a binary format.
+///
+/// Throws a std::runtime_error if the file cannot be written
+void save_input_replay(
+  const input_replay& r,
+  const std::string& filename
+);
+
+/// Test this class and its free functions
+void test_input_replay();
+
+/// Convert to the bytes of the binary format
+std::vector<std::uint8_t> to_bytes(const input_replay& r);
+
+/// Convert the bytes of the binary format.
+/// @return the replay, or an empty optional if the bytes
+///   are not an input replay
+std::optional<input_replay> to_input_replay(const std::vector<std::uint8_t>& bytes);
+
+bool operator==(const input_replay& lhs, const input_replay& rhs) noexcept;
+
+#endif // INPUT_REPLAY_H
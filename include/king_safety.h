@@ -0,0 +1,89 @@
+#ifndef KING_SAFETY_H
+#define KING_SAFETY_H
+
+#include "ccfwd.h"
+#include "chess_color.h"
+#include "piece_type.h"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/// What threatens the king of one color,
+/// computed in one pass over the pieces,
+/// to determine which \link{piece_action}s are legal.
+///
+/// Squares are bits in a 64-bit mask,
+/// where the index is (rank * 8) + file,
+/// with rank and file zero-based.
+///
+/// If a player has no king, all actions are legal.
+class king_safety
+{
+public:
+  /// @param pieces the pieces, if two pieces are at the same square,
+  ///   the first one is used
+  /// @param color the color of the king
+  explicit king_safety(
+    const std::vector<piece>& pieces,
+    const chess_color color
+  );
+
+  /// Get the squares attacked by the enemy,
+  /// as if the king was not on the board,
+  /// so that the king cannot escape along the line of a check
+  auto get_attacked() const noexcept { return m_attacked; }
+
+  /// Get the squares a piece other than the king
+  /// can move to, to capture or block the checking piece.
+  /// All squares if the king is not in check
+  auto get_check_mask() const noexcept { return m_check_mask; }
+
+  auto get_color() const noexcept { return m_color; }
+
+  /// Get the number of enemy pieces that check the king
+  auto get_n_checkers() const noexcept { return m_n_checkers; }
+
+  /// Is the king in check?
+  bool is_in_check() const noexcept { return m_n_checkers > 0; }
+
+  /// Can the action be done without leaving the king in check?
+  bool is_legal(const piece_action& action) const noexcept;
+
+  /// Is the piece at the square pinned to the king?
+  bool is_pinned(const square& s) const noexcept;
+
+private:
+
+  /// The squares attacked by the enemy, without the king on the board
+  std::uint64_t m_attacked;
+
+  /// The color and type of the piece at each square, if any
+  std::array<std::optional<std::pair<chess_color, piece_type>>, 64> m_board;
+
+  std::uint64_t m_check_mask;
+
+  chess_color m_color;
+
+  /// The square of the king, if any
+  std::optional<int> m_king_index;
+
+  int m_n_checkers;
+
+  /// The squares a pinned piece can move to,
+  /// all squares for a piece that is not pinned
+  std::array<std::uint64_t, 64> m_pin_masks;
+
+  /// Would the king be attacked with this board,
+  /// used for the rare en-passant captures
+  bool is_king_attacked(
+    const std::array<std::optional<std::pair<chess_color, piece_type>>, 64>& board
+  ) const noexcept;
+};
+
+/// Test this class and its free functions
+void test_king_safety();
+
+#endif // KING_SAFETY_H
@@ -92,6 +92,10 @@ private:
 
   /// Is RHS ready to start?
   bool m_rhs_start;
+
+  /// The lobby changes due to user input and,
+  /// while counting down, every tick
+  bool is_retained_impl() const noexcept override { return true; }
 };
 
 /// The background image
@@ -0,0 +1,76 @@
+#ifndef LOCKSTEP_MESSAGE_H
+#define LOCKSTEP_MESSAGE_H
+
+#include "side.h"
+#include "user_inputs.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/// The message a \link{lockstep_session} sends to its peer,
+/// once per frame.
+///
+/// It holds the sender's user inputs of all frames
+/// the peer has not acknowledged yet,
+/// so that a lost message does no harm,
+/// as the next message has the same inputs.
+class lockstep_message
+{
+public:
+  /// @param first_frame the frame of the first user inputs
+  /// @param inputs the sender's user inputs, one per frame,
+  ///   starting at the first frame
+  /// @param ack_frame the last frame up to which the sender
+  ///   has received all user inputs of the receiver,
+  ///   or -1 if none
+  /// @param hash_frame the frame of the hash, or -1 if there is no hash
+  /// @param hash the hash of the state of the game after the hash frame,
+  ///   see \link{calc_hash}. Only sent if there is a hash frame
+  explicit lockstep_message(
+    const int first_frame = 0,
+    const std::vector<user_inputs>& inputs = {},
+    const int ack_frame = -1,
+    const int hash_frame = -1,
+    const std::uint64_t hash = 0
+  );
+
+  auto get_ack_frame() const noexcept { return m_ack_frame; }
+  auto get_first_frame() const noexcept { return m_first_frame; }
+  auto get_hash() const noexcept { return m_hash; }
+  auto get_hash_frame() const noexcept { return m_hash_frame; }
+  const auto& get_inputs() const noexcept { return m_inputs; }
+
+private:
+  int m_first_frame;
+  std::vector<user_inputs> m_inputs;
+  int m_ack_frame;
+  int m_hash_frame;
+  std::uint64_t m_hash;
+};
+
+/// Get the maximum number of frames of user inputs
+/// in one \link{lockstep_message}
+constexpr int get_lockstep_message_max_n_frames() { return 255; }
+
+/// Test this class and its free functions
+void test_lockstep_message();
+
+/// Convert to the bytes sent over the network.
+///
+/// The side of the user inputs is not sent,
+/// as the receiver knows the side of its peer
+std::vector<std::uint8_t> to_bytes(const lockstep_message& m);
+
+/// Convert the bytes received over the network.
+/// @param sender the side of the peer that sent the message
+/// @return the message, or an empty optional if the bytes
+///   are not a lockstep message
+std::optional<lockstep_message> to_lockstep_message(
+  const std::vector<std::uint8_t>& bytes,
+  const side sender
+);
+
+bool operator==(const lockstep_message& lhs, const lockstep_message& rhs) noexcept;
+
+#endif // LOCKSTEP_MESSAGE_H
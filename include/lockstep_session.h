@@ -0,0 +1,290 @@
+#ifndef LOCKSTEP_SESSION_H
+#define LOCKSTEP_SESSION_H
+
+#include "ccfwd.h"
+#include "delta_t.h"
+#include "game_controller.h"
+#include "game_simulation.h"
+#include "game_speed.h"
+#include "lockstep_message.h"
+#include "message.h"
+#include "net_transport.h"
+#include "side.h"
+#include "user_inputs.h"
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <vector>
+
+/// Get the default number of frames
+/// between a user input and the frame it is done in
+constexpr int get_default_lockstep_input_delay() { return 3; }
+
+/// Get the default number of frames
+/// between two checks that both games are the same
+constexpr int get_default_lockstep_hash_interval() { return 30; }
+
+/// Get the number of frames after calculating a hash
+/// in which it is sent to the peer,
+/// so that it arrives even if some messages are lost
+constexpr int get_lockstep_n_hash_resend_frames() { return 8; }
+
+/// Get the default number of simulation steps per lockstep frame
+constexpr int get_default_lockstep_n_steps_per_frame() { return 4; }
+
+/// One side of a game played over a network,
+/// in deterministic lockstep.
+///
+/// Only the user inputs are sent, never the state of the game.
+/// A frame is only done when the user inputs
+/// of both players for that frame are known,
+/// so that both games do the same frames with the same inputs
+/// and stay the same.
+///
+/// To give the user inputs time to arrive,
+/// a local user input is done after an input delay,
+/// see \link{lockstep_session::set_input_delay}.
+/// If the peer's user inputs have not arrived yet,
+/// the session stalls.
+///
+/// Every so many frames, the sessions exchange a hash
+/// of their game, see \link{calc_hash},
+/// to detect that the games are different, i.e. a desync.
+///
+/// Both sessions must be created with the same game
+/// and the same settings.
+class lockstep_session
+{
+public:
+  /// @param c the game at the start
+  /// @param local_side the side of the local player
+  /// @param transport sends and receives the messages of the peer.
+  ///   Must outlive this session
+  /// @param input_delay the number of frames between
+  ///   a user input and the frame it is done in
+  /// @param hash_interval the number of frames between
+  ///   two checks that both games are the same
+  /// @param n_steps_per_frame the number of simulation steps per frame
+  explicit lockstep_session(
+    const game_controller& c,
+    const side local_side,
+    net_transport& transport,
+    const int input_delay = get_default_lockstep_input_delay(),
+    const int hash_interval = get_default_lockstep_hash_interval(),
+    const int n_steps_per_frame = get_default_lockstep_n_steps_per_frame(),
+    const game_speed speed = get_default_game_speed(),
+    const double steps_per_second = get_default_simulation_frequency()
+  );
+
+  /// Add the user inputs of the local player,
+  /// to be done in the next frame that is scheduled.
+  ///
+  /// The user inputs of the other side are ignored
+  void add_local_inputs(const user_inputs& inputs);
+
+  /// Get the messages the pieces have sent since the previous call
+  std::vector<message> collect_messages();
+
+  /// Get the first frame at which the games differ, if any
+  const auto& get_desync_frame() const noexcept { return m_desync_frame; }
+
+  /// Get the number of frames done
+  auto get_frame() const noexcept { return m_frame; }
+
+  const auto& get_game_controller() const noexcept { return m_game_controller; }
+
+  auto get_input_delay() const noexcept { return m_input_delay; }
+
+  auto get_local_side() const noexcept { return m_local_side; }
+
+  /// Get the mean time between sending user inputs
+  /// and the peer acknowledging these, in frames,
+  /// or -1.0 if unknown
+  auto get_mean_round_trip_frames() const noexcept { return m_mean_round_trip_frames; }
+
+  /// Get the number of ticks in which no frame was done,
+  /// as the peer's user inputs had not arrived yet
+  auto get_n_stalls() const noexcept { return m_n_stalls; }
+
+  /// Get the number of simulation steps per frame
+  auto get_n_steps_per_frame() const noexcept { return m_n_steps_per_frame; }
+
+  /// Get the input delay that is just long enough
+  /// for the peer's user inputs to arrive in time,
+  /// based on the measured round trip time
+  int get_recommended_input_delay() const noexcept;
+
+  const auto& get_transport() const noexcept { return m_transport; }
+
+  /// Set the number of frames between
+  /// a user input and the frame it is done in.
+  ///
+  /// Can be changed during a game, by either peer.
+  /// A longer delay causes fewer stalls,
+  /// a shorter delay makes the game respond faster
+  void set_input_delay(const int input_delay);
+
+  /// Send and receive the messages
+  /// and do the next frame, if the peer's user inputs have arrived.
+  /// @return true if a frame was done
+  bool tick();
+
+private:
+
+  game_controller m_game_controller;
+
+  /// The first frame at which the games differ, if any
+  std::optional<int> m_desync_frame;
+
+  /// The in-game time per simulation step
+  delta_t m_delta_t;
+
+  /// The next frame to do
+  int m_frame{0};
+
+  int m_hash_interval;
+
+  int m_input_delay;
+
+  /// The most recent frame of which the hash was calculated, or -1
+  int m_last_hash_frame{-1};
+
+  std::uint64_t m_last_hash{0};
+
+  /// The frame the local user inputs were last scheduled for
+  int m_last_scheduled_frame;
+
+  /// The hashes of the local game, per frame
+  std::map<int, std::uint64_t> m_local_hashes;
+
+  /// The local user inputs per frame,
+  /// until done and acknowledged by the peer
+  std::map<int, user_inputs> m_local_inputs;
+
+  side m_local_side;
+
+  /// The mean round trip time in frames, or -1.0 if unknown
+  double m_mean_round_trip_frames{-1.0};
+
+  std::vector<message> m_messages;
+
+  /// The number of the peer's frames received,
+  /// i.e. all of the peer's frames before it are known
+  int m_n_remote_frames;
+
+  int m_n_stalls{0};
+
+  int m_n_steps_per_frame;
+
+  int m_n_ticks{0};
+
+  /// The local user inputs for the next frame that is scheduled
+  user_inputs m_pending_inputs;
+
+  /// The last frame the peer acknowledged
+  /// to have the local user inputs of
+  int m_remote_ack_frame;
+
+  /// The hashes of the peer's game, per frame
+  std::map<int, std::uint64_t> m_remote_hashes;
+
+  /// The peer's user inputs per frame, until done
+  std::map<int, user_inputs> m_remote_inputs;
+
+  /// The tick at which the local user inputs
+  /// of a frame were first sent
+  std::map<int, int> m_send_ticks;
+
+  net_transport& m_transport;
+
+  /// Compare the local and peer's hashes of the same frames
+  void check_hashes();
+
+  /// Do the next frame, with the user inputs of both players
+  void do_frame();
+
+  /// Process a message of the peer
+  void process_message(const lockstep_message& m);
+
+  /// Receive all messages of the peer
+  void receive();
+
+  /// Schedule the pending local user inputs,
+  /// so that each frame up to the input delay has these
+  void schedule_local_inputs();
+
+  /// Send the local user inputs the peer has not acknowledged yet
+  void send();
+};
+
+/// Do one frame of a game played over a network:
+/// add the user inputs of both players,
+/// then do the simulation steps, until there is a winner.
+///
+/// Both computers must call this with the same arguments,
+/// for their games to stay the same
+void do_lockstep_frame(
+  game_controller& c,
+  const user_inputs& inputs,
+  const int n_steps,
+  const delta_t& dt
+);
+
+/// The result of \link{run_lockstep_loopback}
+class lockstep_loopback_result
+{
+public:
+  explicit lockstep_loopback_result(
+    const int n_frames,
+    const int n_stalls,
+    const std::int64_t n_bytes_sent,
+    const double n_secs,
+    const bool is_desync
+  );
+
+  /// Get the number of bytes sent by one player per minute of play
+  double get_n_bytes_per_minute() const noexcept;
+
+  /// Get the number of frames done by both players
+  auto get_n_frames() const noexcept { return m_n_frames; }
+
+  /// Get the number of bytes sent by both players
+  auto get_n_bytes_sent() const noexcept { return m_n_bytes_sent; }
+
+  /// Get the number of seconds of play
+  auto get_n_secs() const noexcept { return m_n_secs; }
+
+  /// Get the number of stalls of both players
+  auto get_n_stalls() const noexcept { return m_n_stalls; }
+
+  /// Did the games differ?
+  auto is_desync() const noexcept { return m_is_desync; }
+
+private:
+  int m_n_frames;
+  int m_n_stalls;
+  std::int64_t m_n_bytes_sent;
+  double m_n_secs;
+  bool m_is_desync;
+};
+
+/// Play two games in lockstep, in one process,
+/// over a \link{loopback_transport}, with random user inputs.
+///
+/// Both games should be the same at the end
+lockstep_loopback_result run_lockstep_loopback(
+  const int n_frames,
+  const int input_delay = get_default_lockstep_input_delay(),
+  const int n_steps_per_frame = get_default_lockstep_n_steps_per_frame(),
+  const int seed = 42
+);
+
+/// Test this class and its free functions
+void test_lockstep_session();
+
+/// Test this class with threads, sockets or wall-clock time,
+/// which is slow
+void test_lockstep_session_long();
+
+#endif // LOCKSTEP_SESSION_H
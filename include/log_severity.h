@@ -0,0 +1,28 @@
+#ifndef LOG_SEVERITY_H
+#define LOG_SEVERITY_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/// The severity of a message in the \link{diagnostics_log},
+/// from least to most severe
+enum class log_severity
+{
+  debug,
+  info,
+  warning,
+  error
+};
+
+/// Get all the log_severity values
+std::vector<log_severity> get_all_log_severities() noexcept;
+
+/// Test this class and its free functions
+void test_log_severity();
+
+std::string to_str(const log_severity s) noexcept;
+
+std::ostream& operator<<(std::ostream& os, const log_severity s) noexcept;
+
+#endif // LOG_SEVERITY_H
@@ -5,7 +5,9 @@
 
 #include "ccfwd.h"
 #include "cc_cli_options.h"
-#include "sleep_scheduler.h"
+#include "frame_pacer.h"
+#include "frame_timings.h"
+#include "metrics.h"
 #include "program_state.h"
 #include "game_options.h"
 #include "lobby_options.h"
@@ -17,6 +19,13 @@
 #include <memory>
 #include <map>
 
+/// Get the frame rate of the main window
+constexpr double get_focused_target_fps() { return 60.0; }
+
+/// Get the frame rate of the main window
+/// when it is not focused and its view retains its drawing
+constexpr double get_unfocused_target_fps() { return 10.0; }
+
 /// The single main window.
 class main_window
 {
@@ -29,6 +38,12 @@ public:
   const auto& get_program_state() const noexcept { return m_program_state; }
 
 private:
+  /// Measures the time to the first frame of the main menu.
+  ///
+  /// Must be the first data member,
+  /// to start before the other data members are created
+  sf::Clock m_loading_clock;
+
   /// The command-line options at startup
   cc_cli_options m_cli_options;
 
@@ -44,11 +59,45 @@ private:
   /// The replay of the last game
   replay m_replay;
 
-  /// Sleeps to achieve a frame rate of 50-60 frames per second
-  sleep_scheduler m_sleep_scheduler;
+  /// Waits to achieve a frame rate of 60 frames per second,
+  /// or less when idle, see \link{main_window::update_target_fps}
+  frame_pacer m_frame_pacer{get_focused_target_fps()};
+
+  /// Does the window have the focus?
+  bool m_has_focus{true};
 
   program_state m_program_state{program_state::loading};
 
+  /// Measures the time spent in each phase of a frame
+  sf::Clock m_frame_phase_clock;
+
+  /// The timing of the current frame
+  frame_timing m_frame_timing;
+
+  /// The timings of the recent frames
+  frame_timings m_frame_timings;
+
+  /// Measures the time since the metrics were last snapshotted
+  sf::Clock m_metrics_clock;
+
+  /// The CPU time used by the process when the metrics were last snapshotted,
+  /// in seconds
+  double m_metrics_cpu_secs{get_process_cpu_secs()};
+
+  /// The most recent snapshot of the metrics
+  metrics_snapshot m_metrics_snapshot;
+
+  /// The snapshot of the metrics when these were last
+  /// added to the diagnostics log
+  metrics_snapshot m_metrics_log_snapshot;
+
+  /// The change of the metrics in the last second, for the debug overlay
+  std::string m_metrics_str;
+
+  /// The current frame phase has ended:
+  /// store its time and start timing the next phase
+  void end_frame_phase(const frame_phase p);
+
   /// Process all events
   /// @return if the user wants to quit
   bool process_events();
@@ -71,6 +120,15 @@ private:
   /// Draw the debug info over the current state
   void show_debug_info();
 
+  /// Snapshot the metrics, if a second has passed since the last snapshot.
+  /// Their change is added to the diagnostics log as one line,
+  /// once per \link{get_metrics_log_interval_secs}
+  void update_metrics();
+
+  /// Lower the frame rate when the window is not focused
+  /// and the view retains its drawing, as nothing changes then
+  void update_target_fps();
+
   /// Go to the next state (if any).
   ///
   /// Makes the screen do its thing,
@@ -0,0 +1,143 @@
+#ifndef MATCH_SERVER_H
+#define MATCH_SERVER_H
+
+#include "ccfwd.h"
+#include "game_controller.h"
+#include "game_simulation.h"
+#include "lockstep_session.h"
+#include "net_transport.h"
+#include "server_match.h"
+#include "thread_pool.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/// Get the default number of frames per second of a \link{match_server}
+constexpr double get_default_match_server_frame_rate()
+{
+  return get_default_simulation_frequency() / get_default_lockstep_n_steps_per_frame();
+}
+
+/// A headless server that hosts many \link{server_match}es at once.
+///
+/// All matches are ticked at a fixed frame rate.
+/// Each tick, the matches are ticked in parallel,
+/// on a work-stealing \link{thread_pool}.
+/// A match that is done is removed
+/// and its replay is saved, if there is a replay folder.
+///
+/// The time spent on each match is tracked,
+/// see \link{match_server::get_cpu_secs}.
+class match_server
+{
+public:
+  /// @param n_threads the number of worker threads,
+  ///   if zero, one per hardware thread
+  /// @param replay_folder the folder to save the replays of the matches done,
+  ///   if empty, the replays are not saved
+  /// @param n_steps_per_frame the number of simulation steps
+  ///   per frame of a match
+  explicit match_server(
+    const int n_threads = 0,
+    const std::string& replay_folder = "",
+    const int n_steps_per_frame = get_default_lockstep_n_steps_per_frame()
+  );
+
+  /// Add a match.
+  /// @param transport_lhs the transport to the left-hand player's client
+  /// @param transport_rhs the transport to the right-hand player's client
+  /// @return the ID of the match
+  int add_match(
+    std::unique_ptr<net_transport> transport_lhs,
+    std::unique_ptr<net_transport> transport_rhs,
+    const game_controller& c = game_controller(),
+    const int max_n_frames = get_default_server_match_max_n_frames()
+  );
+
+  /// Get the time spent on each match that is not done yet,
+  /// in seconds, per match ID
+  const auto& get_cpu_secs() const noexcept { return m_cpu_secs; }
+
+  /// Get the number of frames per second
+  double get_frame_rate() const noexcept;
+
+  /// Get the matches that are not done yet
+  const auto& get_matches() const noexcept { return m_matches; }
+
+  /// Get the number of frames done by all matches
+  auto get_n_frames() const noexcept { return m_n_frames; }
+
+  /// Get the number of matches that are done
+  auto get_n_matches_done() const noexcept { return m_n_matches_done; }
+
+  /// Get the number of ticks in \link{match_server::run}
+  /// that took longer than a frame
+  auto get_n_late_ticks() const noexcept { return m_n_late_ticks; }
+
+  /// Get the number of ticks done
+  auto get_n_ticks() const noexcept { return m_n_ticks; }
+
+  /// Get the most time spent on one match, in seconds,
+  /// including the matches that are done
+  double get_max_match_cpu_secs() const noexcept;
+
+  /// Get the time spent on all matches, in seconds,
+  /// including the matches that are done
+  double get_total_cpu_secs() const noexcept;
+
+  const auto& get_replay_folder() const noexcept { return m_replay_folder; }
+
+  const auto& get_thread_pool() const noexcept { return m_thread_pool; }
+
+  /// Tick at the frame rate, for a number of ticks
+  void run(const int n_ticks);
+
+  /// Tick all matches once, in parallel,
+  /// then remove the ones that are done
+  void tick();
+
+private:
+
+  std::map<int, double> m_cpu_secs;
+
+  /// The most time spent on one match that is done, in seconds
+  double m_max_done_cpu_secs{0.0};
+
+  /// The time spent on all matches that are done, in seconds
+  double m_total_done_cpu_secs{0.0};
+
+  std::vector<std::unique_ptr<server_match>> m_matches;
+
+  int m_n_frames{0};
+
+  int m_n_late_ticks{0};
+
+  int m_n_matches_done{0};
+
+  int m_n_steps_per_frame;
+
+  int m_n_ticks{0};
+
+  int m_next_id{0};
+
+  std::string m_replay_folder;
+
+  thread_pool m_thread_pool;
+
+  /// Save the replay of a match that is done
+  void save_replay(const server_match& m) const;
+};
+
+/// Get the filename of the replay of a match
+std::string get_match_replay_filename(const int match_id);
+
+/// Test this class and its free functions
+void test_match_server();
+
+/// Test this class with threads, sockets or wall-clock time,
+/// which is slow
+void test_match_server_long();
+
+#endif // MATCH_SERVER_H
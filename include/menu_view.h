@@ -66,6 +66,9 @@ private:
 
   /// The selected main menu item
   menu_view_item m_selected;
+
+  /// The menu only changes due to user input
+  bool is_retained_impl() const noexcept override { return true; }
 };
 
 /// Create a random background image index
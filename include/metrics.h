@@ -0,0 +1,216 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// Get the number of shards of a \link{metric_counter}
+constexpr int get_metric_counter_n_shards() { return 16; }
+
+/// A number that only goes up, e.g. the number of draw calls.
+///
+/// Each thread increments its own shard,
+/// on its own cache line, so that threads
+/// that increment the same counter do not
+/// slow each other down.
+/// Reading the value sums the shards.
+class metric_counter
+{
+public:
+  metric_counter() = default;
+  metric_counter(const metric_counter&) = delete;
+  metric_counter& operator=(const metric_counter&) = delete;
+
+  /// Increase the counter. Can be called from any thread
+  void add(const std::int64_t n = 1) noexcept;
+
+  /// Get the sum of all increments. Can be called from any thread
+  std::int64_t get() const noexcept;
+
+private:
+
+  struct alignas(64) shard
+  {
+    std::atomic<std::int64_t> m_value{0};
+  };
+  std::array<shard, get_metric_counter_n_shards()> m_shards;
+};
+
+/// A number that goes up and down, e.g. the number of pieces
+class metric_gauge
+{
+public:
+  metric_gauge() = default;
+  metric_gauge(const metric_gauge&) = delete;
+  metric_gauge& operator=(const metric_gauge&) = delete;
+
+  /// Get the most recent value. Can be called from any thread
+  double get() const noexcept { return m_value.load(std::memory_order_relaxed); }
+
+  /// Set the value. Can be called from any thread
+  void set(const double value) noexcept { m_value.store(value, std::memory_order_relaxed); }
+
+private:
+  std::atomic<double> m_value{0.0};
+};
+
+/// The distribution of a measured value, e.g. the time of a step,
+/// as the number of values per bucket
+class metric_histogram
+{
+public:
+  /// @param upper_bounds the inclusive upper bounds of the buckets,
+  ///   in increasing order.
+  ///   There is one extra bucket for the values above the last bound
+  explicit metric_histogram(const std::vector<double>& upper_bounds);
+  metric_histogram(const metric_histogram&) = delete;
+  metric_histogram& operator=(const metric_histogram&) = delete;
+
+  /// Add a value. Can be called from any thread
+  void add(const double value) noexcept;
+
+  /// Get the number of values per bucket,
+  /// with the last bucket for the values above the last upper bound
+  std::vector<std::int64_t> get_bucket_counts() const;
+
+  /// Get the number of values added
+  std::int64_t get_count() const noexcept { return m_count.load(std::memory_order_relaxed); }
+
+  /// Get the sum of all values added
+  double get_sum() const noexcept { return m_sum.load(std::memory_order_relaxed); }
+
+  const auto& get_upper_bounds() const noexcept { return m_upper_bounds; }
+
+private:
+  std::vector<double> m_upper_bounds;
+
+  /// One count per bucket, plus one for the values
+  /// above the last upper bound
+  std::unique_ptr<std::atomic<std::int64_t>[]> m_bucket_counts;
+
+  std::atomic<std::int64_t> m_count{0};
+  std::atomic<double> m_sum{0.0};
+};
+
+/// The values of a \link{metric_histogram} at a moment in time
+struct metric_histogram_snapshot
+{
+  std::vector<double> m_upper_bounds;
+  std::vector<std::int64_t> m_bucket_counts;
+  std::int64_t m_count{0};
+  double m_sum{0.0};
+};
+
+/// The values of all metrics at a moment in time,
+/// as created by \link{metrics_registry::get_snapshot}
+struct metrics_snapshot
+{
+  /// The time since the registry was created, in seconds
+  double m_time_secs{0.0};
+
+  std::map<std::string, std::int64_t> m_counters;
+  std::map<std::string, double> m_gauges;
+  std::map<std::string, metric_histogram_snapshot> m_histograms;
+};
+
+/// The metrics of all subsystems, by name.
+///
+/// Getting a metric by name locks, so store the reference, e.g.:
+///
+/// static metric_counter& n_draws{get_metrics().get_counter("draw_calls")};
+/// n_draws.add();
+///
+/// Updating a metric does not lock.
+/// Metrics are never removed, so the references stay valid
+class metrics_registry
+{
+public:
+  metrics_registry();
+  metrics_registry(const metrics_registry&) = delete;
+  metrics_registry& operator=(const metrics_registry&) = delete;
+
+  /// Get the counter with this name, creating it if needed
+  metric_counter& get_counter(const std::string& name);
+
+  /// Get the gauge with this name, creating it if needed
+  metric_gauge& get_gauge(const std::string& name);
+
+  /// Get the histogram with this name, creating it if needed.
+  /// The upper bounds are only used when the histogram is created
+  metric_histogram& get_histogram(
+    const std::string& name,
+    const std::vector<double>& upper_bounds = std::vector<double>()
+  );
+
+  /// Get the current values of all metrics
+  metrics_snapshot get_snapshot() const;
+
+private:
+  std::map<std::string, std::unique_ptr<metric_counter>> m_counters;
+  std::map<std::string, std::unique_ptr<metric_gauge>> m_gauges;
+  std::map<std::string, std::unique_ptr<metric_histogram>> m_histograms;
+
+  /// Protects the maps, not the metrics in them
+  mutable std::mutex m_mutex;
+
+  /// When the registry was created, in seconds since the epoch of a steady clock
+  double m_start_secs;
+};
+
+/// Get the default filename the metrics are saved to
+std::string get_default_metrics_filename() noexcept;
+
+/// Get the default upper bounds of a histogram of times, in milliseconds
+std::vector<double> get_default_metric_histogram_upper_bounds_ms();
+
+/// Get the metrics of the process
+metrics_registry& get_metrics();
+
+/// Get the CPU time used by all threads of the process, in seconds.
+///
+/// Unlike std::clock, which measures the wall time on Windows,
+/// this is the CPU time on every platform
+double get_process_cpu_secs() noexcept;
+
+/// Get the time between two lines of metrics in the diagnostics log,
+/// in seconds, so that these do not crowd out the other messages
+constexpr int get_metrics_log_interval_secs() { return 60; }
+
+/// Get the change in the counters between two snapshots, per second,
+/// the values of the gauges and the mean of the histograms
+/// of the newest snapshot, as a short line, e.g. for the debug overlay
+std::string get_metrics_rates_str(
+  const metrics_snapshot& before,
+  const metrics_snapshot& after
+);
+
+/// Get the same as \link{get_metrics_rates_str},
+/// as one short text per metric
+std::vector<std::string> get_metrics_rates_strs(
+  const metrics_snapshot& before,
+  const metrics_snapshot& after
+);
+
+/// Get the mean value of a histogram,
+/// or zero if no values were added
+double get_mean(const metric_histogram_snapshot& h) noexcept;
+
+/// Save the current metrics as JSON
+void save_metrics(
+  const metrics_registry& r,
+  const std::string& filename = get_default_metrics_filename()
+);
+
+/// Test this class and its free functions
+void test_metrics();
+
+/// Convert to JSON
+std::string to_json(const metrics_snapshot& s);
+
+#endif // METRICS_H
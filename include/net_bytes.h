@@ -0,0 +1,63 @@
+#ifndef NET_BYTES_H
+#define NET_BYTES_H
+
+#include <cstdint>
+#include <vector>
+
+/// Writes values as bytes, to be sent over a network.
+///
+/// All values are little-endian,
+/// so that computers with another byte order read the same values
+class byte_writer
+{
+public:
+  byte_writer() = default;
+
+  void add_double(const double d);
+  void add_int32(const std::int32_t i);
+  void add_uint8(const std::uint8_t i);
+  void add_uint32(const std::uint32_t i);
+  void add_uint64(const std::uint64_t i);
+
+  const auto& get_bytes() const noexcept { return m_bytes; }
+
+private:
+  std::vector<std::uint8_t> m_bytes;
+};
+
+/// Reads the values written by a \link{byte_writer}.
+///
+/// Reading past the end gives zeroes
+/// and makes the reader invalid,
+/// so that a damaged packet can be detected
+/// after reading all its values
+class byte_reader
+{
+public:
+  explicit byte_reader(const std::vector<std::uint8_t>& bytes);
+
+  /// Are all bytes read?
+  bool is_done() const noexcept { return m_index == m_bytes.size(); }
+
+  /// Were all values read within the bytes?
+  bool is_valid() const noexcept { return m_is_valid; }
+
+  double read_double() noexcept;
+  std::int32_t read_int32() noexcept;
+  std::uint8_t read_uint8() noexcept;
+  std::uint32_t read_uint32() noexcept;
+  std::uint64_t read_uint64() noexcept;
+
+private:
+  const std::vector<std::uint8_t>& m_bytes;
+  std::size_t m_index{0};
+  bool m_is_valid{true};
+
+  /// Read an unsigned integer of n_bytes bytes
+  std::uint64_t read(const int n_bytes) noexcept;
+};
+
+/// Test these classes
+void test_net_bytes();
+
+#endif // NET_BYTES_H
@@ -0,0 +1,177 @@
+#ifndef NET_TRANSPORT_H
+#define NET_TRANSPORT_H
+
+#include <SFML/Network.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+/// The abstract base class of the ways to send packets to another game
+///
+/// Class name        |Description
+/// ------------------|-----------------
+/// loopback_transport|To another game in the same process
+/// udp_transport     |To another game over UDP
+///
+/// Packets may be lost, but are never changed.
+/// Only to be used by one thread
+class net_transport
+{
+public:
+  net_transport();
+  virtual ~net_transport();
+  net_transport(const net_transport&) = delete;
+  net_transport& operator=(const net_transport&) = delete;
+
+  /// The number of bytes received
+  auto get_n_bytes_received() const noexcept { return m_n_bytes_received; }
+
+  /// The number of bytes sent
+  auto get_n_bytes_sent() const noexcept { return m_n_bytes_sent; }
+
+  /// The number of packets received
+  auto get_n_packets_received() const noexcept { return m_n_packets_received; }
+
+  /// The number of packets sent
+  auto get_n_packets_sent() const noexcept { return m_n_packets_sent; }
+
+  /// Receive a packet, without waiting.
+  /// @return true if a packet was received
+  bool receive(std::vector<std::uint8_t>& packet);
+
+  /// Send a packet, without waiting
+  void send(const std::vector<std::uint8_t>& packet);
+
+private:
+
+  std::int64_t m_n_bytes_received{0};
+  std::int64_t m_n_bytes_sent{0};
+  int m_n_packets_received{0};
+  int m_n_packets_sent{0};
+
+  /// Receive a packet, without waiting.
+  /// @return true if a packet was received
+  virtual bool receive_impl(std::vector<std::uint8_t>& packet) = 0;
+
+  /// Send a packet, without waiting
+  virtual void send_impl(const std::vector<std::uint8_t>& packet) = 0;
+};
+
+/// The packets in flight between two \link{loopback_transport}s
+class loopback_channel;
+
+/// Sends packets to another \link{loopback_transport}
+/// in the same process, e.g. to test networked games
+/// without a network.
+///
+/// To act like a real network, the packets sent
+/// can be delayed, see \link{loopback_transport::set_latency},
+/// and lost, see \link{loopback_transport::set_packet_loss}.
+///
+/// Use \link{create_loopback_transports} to create a connected pair
+class loopback_transport : public net_transport
+{
+public:
+  loopback_transport(
+    const std::shared_ptr<loopback_channel>& channel,
+    const bool is_first
+  );
+
+  /// Get the number of ticks a sent packet takes to arrive
+  auto get_latency() const noexcept { return m_latency; }
+
+  /// Get the chance that a sent packet is lost
+  auto get_packet_loss() const noexcept { return m_packet_loss; }
+
+  /// Set the number of ticks a sent packet takes to arrive,
+  /// see \link{loopback_transport::tick}
+  void set_latency(const int n_ticks);
+
+  /// Set the chance that a sent packet is lost, from 0.0 to 1.0
+  void set_packet_loss(const double p);
+
+  /// Let time pass, so that the packets sent
+  /// by the other transport come closer to arriving.
+  ///
+  /// Call this on both transports at the same rate,
+  /// e.g. once per frame
+  void tick() noexcept { ++m_n_ticks; }
+
+private:
+
+  std::shared_ptr<loopback_channel> m_channel;
+
+  /// Is this the first transport of the pair?
+  bool m_is_first;
+
+  /// The number of ticks a sent packet takes to arrive
+  int m_latency{0};
+
+  int m_n_ticks{0};
+
+  double m_packet_loss{0.0};
+
+  /// Decides which packets are lost
+  std::mt19937 m_rng_engine;
+
+  bool receive_impl(std::vector<std::uint8_t>& packet) override;
+
+  void send_impl(const std::vector<std::uint8_t>& packet) override;
+};
+
+/// Create two \link{loopback_transport}s that send to each other
+std::pair<
+  std::unique_ptr<loopback_transport>,
+  std::unique_ptr<loopback_transport>
+> create_loopback_transports();
+
+/// Sends packets to another game over UDP.
+///
+/// The socket does not block.
+/// Packets from other addresses than the remote are ignored
+class udp_transport : public net_transport
+{
+public:
+  /// @param local_port the port to receive on,
+  ///   or zero to let the operating system pick a free one,
+  ///   see \link{udp_transport::get_local_port}
+  /// @param remote_address the address of the other game
+  /// @param remote_port the port the other game receives on
+  udp_transport(
+    const unsigned short local_port,
+    const sf::IpAddress& remote_address,
+    const unsigned short remote_port
+  );
+
+  /// Get the port this transport receives on
+  unsigned short get_local_port() const noexcept { return m_socket.getLocalPort(); }
+
+  /// Get the port the other game receives on
+  auto get_remote_port() const noexcept { return m_remote_port; }
+
+  /// Set the port the other game receives on,
+  /// e.g. when the other game's port was picked by its operating system
+  void set_remote_port(const unsigned short remote_port) noexcept { m_remote_port = remote_port; }
+
+private:
+
+  sf::IpAddress m_remote_address;
+  unsigned short m_remote_port;
+  sf::UdpSocket m_socket;
+
+  bool receive_impl(std::vector<std::uint8_t>& packet) override;
+
+  void send_impl(const std::vector<std::uint8_t>& packet) override;
+};
+
+/// Test this class and its free functions
+void test_net_transport();
+
+/// Test this class with threads, sockets or wall-clock time,
+/// which is slow
+void test_net_transport_long();
+
+#endif // NET_TRANSPORT_H
@@ -85,6 +85,8 @@ private:
   /// can be done by LMB, space and right arrow key
   void increase_selected();
 
+  /// The options only change due to user input
+  bool is_retained_impl() const noexcept override { return true; }
 };
 
 void draw_panel(
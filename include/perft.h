@@ -0,0 +1,115 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include "ccfwd.h"
+#include "chess_color.h"
+#include "fen_string.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/// The result of a timed \link{perft}
+class perft_result
+{
+public:
+  explicit perft_result(
+    const int depth,
+    const std::int64_t n_nodes,
+    const double n_seconds
+  );
+
+  auto get_depth() const noexcept { return m_depth; }
+
+  /// Get the number of leaf nodes
+  auto get_n_nodes() const noexcept { return m_n_nodes; }
+
+  /// Get the time it took, in seconds
+  auto get_n_seconds() const noexcept { return m_n_seconds; }
+
+  /// Get the number of leaf nodes per second
+  double get_nodes_per_second() const noexcept;
+
+private:
+  int m_depth;
+  std::int64_t m_n_nodes;
+  double m_n_seconds;
+};
+
+/// Collect the moves of a player, as found by the rules engine,
+/// in UCI notation, e.g. 'e2e4'.
+///
+/// A promotion is a separate action in Conquer Chess,
+/// so a pawn moving to the last rank is one move, e.g. 'e7e8'.
+/// The moves are sorted and unique
+std::vector<std::string> collect_perft_moves(
+  const game& g,
+  const chess_color player_color
+);
+
+/// Collect the legal moves in the position, as found by chess-library,
+/// in UCI notation, e.g. 'e2e4'.
+///
+/// As \link{collect_perft_moves}, a promotion is one move, e.g. 'e7e8'.
+/// The moves are sorted and unique
+std::vector<std::string> collect_reference_perft_moves(const fen_string& s);
+
+/// Apply a piece action fully, i.e. until all pieces are idle.
+///
+/// For a castling, the rook is moved too
+void do_perft_action(game& g, const piece_action& action);
+
+/// Time a \link{perft}
+perft_result measure_perft(
+  const game& g,
+  const int depth,
+  const chess_color player_color = chess_color::white
+);
+
+/// Count the leaf nodes of the game tree, as is done
+/// in classical chess to test a move generator.
+///
+/// The players take turns, starting with 'player_color'.
+/// Each action from \link{collect_all_piece_actions}
+/// is applied fully, see \link{do_perft_action}.
+/// A game that has a winner has no moves left.
+///
+/// As \link{collect_all_piece_actions} only collects legal actions,
+/// see \link{king_safety}, the count is the same
+/// as \link{perft_reference}
+std::int64_t perft(
+  const game& g,
+  const int depth,
+  const chess_color player_color = chess_color::white
+);
+
+/// Count the leaf nodes of the game tree, using chess-library.
+///
+/// A move that captures a king, which only exists in a position
+/// where the player that has just moved is in check,
+/// is counted at depth 1 and has no nodes below it,
+/// as the game has a winner then.
+/// chess-library cannot generate moves without a king
+std::int64_t perft_reference(const fen_string& s, const int depth);
+
+/// Convert the game's position to a FEN string
+/// that chess-library can use as a reference.
+///
+/// Unlike \link{to_fen_string}, the castling availability
+/// is based on the kings and rooks that have not moved yet
+fen_string to_perft_fen_string(
+  const game& g,
+  const chess_color active_color
+);
+
+/// Test this class and its free functions
+void test_perft();
+
+/// Test these functions against chess-library on all positions,
+/// which is slow
+void test_perft_long();
+
+std::ostream& operator<<(std::ostream& os, const perft_result& r) noexcept;
+
+#endif // PERFT_H
@@ -12,6 +12,7 @@
 #include "race.h"
 #include "read_only.h"
 
+#include <cstdint>
 #include <iosfwd>
 #include <string>
 #include <vector>
@@ -231,6 +232,10 @@ void clear_actions(piece& p);
 /// Count the number of actions a piece has
 int count_piece_actions(const piece& p);
 
+/// Count the number of actions added to pieces by this thread,
+/// using \link{piece::add_action}, since the thread started
+std::int64_t count_piece_actions_added_by_this_thread() noexcept;
+
 /// Describe the actions a piece have, e.g. 'idle', or 'moving to (3, 4)'
 std::string describe_actions(const piece& p);
 
@@ -8,6 +8,8 @@
 #include "piece.h"
 #include "starting_position_type.h"
 
+#include <array>
+
 /// Surround the 8x8 strings of a chessboard by coordinats
 /// Without coordinats:
 ///
@@ -427,6 +429,31 @@ std::vector<std::string> to_board_strs(
   const board_to_text_options& options = board_to_text_options()
 ) noexcept;
 
+/// The size of the buffer \link{to_fen_chars} writes to,
+/// which is enough for the longest FEN string:
+/// 64 pieces and 7 slashes, 4 castling characters,
+/// an en passant square, two counters of up to 10 digits
+/// and 5 spaces between the fields
+constexpr int get_max_fen_str_size() { return 71 + 1 + 4 + 2 + 10 + 10 + 5; }
+
+/// Convert pieces to a FEN string, written to a buffer,
+/// in one pass and without allocating memory.
+///
+/// If two pieces are on the same square,
+/// the first one is used.
+/// Throws a std::logic_error if the castling availability,
+/// en passant target square or counters cannot be in a FEN string
+/// @return the number of characters written
+int to_fen_chars(
+  const std::vector<piece>& pieces,
+  std::array<char, get_max_fen_str_size()>& buffer,
+  const chess_color active_color = chess_color::white,
+  const std::string& castling_availability = "KQkq",
+  const std::string& en_passant_target_square = "-",
+  const int halfmove_clock = 0,
+  const int fullmove_number = 1
+);
+
 /// Convert pieces to a FEN string.
 ///
 /// This function does not attempt to be complete.
@@ -4,8 +4,54 @@
 #ifndef LOGIC_ONLY
 
 #include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/Shape.hpp>
+#include <SFML/Graphics/Sprite.hpp>
+#include <SFML/Graphics/Text.hpp>
 
-sf::RenderWindow& get_render_window() noexcept;
+/// The window everything is drawn on.
+///
+/// Counts the draw calls and the texture binds in the metrics,
+/// see \link{get_metrics}.
+/// A texture bind is counted when a shape, sprite or text
+/// uses another texture than the previous one drawn,
+/// as SFML only binds a texture when it changes.
+///
+/// The draw calls can be redirected to another target,
+/// e.g. a texture to retain a drawing between frames,
+/// see \link{render_window::set_draw_target}
+class render_window : public sf::RenderWindow
+{
+public:
+  using sf::RenderWindow::RenderWindow;
+  using sf::RenderWindow::draw;
+
+  /// Let the draw calls draw on another target, e.g. a texture,
+  /// or on this window again if nullptr
+  void set_draw_target(sf::RenderTarget * const target) noexcept { m_draw_target = target; }
+
+  void draw(const sf::Drawable& drawable, const sf::RenderStates& states = sf::RenderStates::Default);
+  void draw(const sf::Shape& shape, const sf::RenderStates& states = sf::RenderStates::Default);
+  void draw(const sf::Sprite& sprite, const sf::RenderStates& states = sf::RenderStates::Default);
+  void draw(const sf::Text& text, const sf::RenderStates& states = sf::RenderStates::Default);
+
+private:
+
+  /// The target the draw calls draw on,
+  /// or nullptr to draw on this window
+  sf::RenderTarget * m_draw_target{nullptr};
+
+  /// The texture of the previous draw call,
+  /// a font for a text, or nullptr for no texture
+  const void * m_last_texture{nullptr};
+
+  /// Count a draw call that uses this texture
+  void count_draw(const void * const texture) noexcept;
+
+  /// Get the target the draw calls draw on
+  sf::RenderTarget& get_draw_target() noexcept;
+};
+
+render_window& get_render_window() noexcept;
 
 #endif // LOGIC_ONLY
 
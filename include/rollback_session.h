@@ -0,0 +1,341 @@
+#ifndef ROLLBACK_SESSION_H
+#define ROLLBACK_SESSION_H
+
+#include "ccfwd.h"
+#include "delta_t.h"
+#include "game_controller.h"
+#include "game_simulation.h"
+#include "game_speed.h"
+#include "lockstep_message.h"
+#include "lockstep_session.h"
+#include "message.h"
+#include "net_transport.h"
+#include "side.h"
+#include "user_inputs.h"
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <vector>
+
+/// Get the default number of frames
+/// between a user input and the frame it is done in
+constexpr int get_default_rollback_input_delay() { return 0; }
+
+/// Get the default maximum number of frames
+/// a \link{rollback_session} can go back in time
+constexpr int get_default_rollback_max_frames() { return 8; }
+
+/// One side of a game played over a network,
+/// with rollback.
+///
+/// Like a \link{lockstep_session}, only the user inputs are sent.
+/// Unlike a \link{lockstep_session}, a frame is done without waiting
+/// for the peer's user inputs, so the local user inputs
+/// are done without delay.
+///
+/// The peer's user inputs that have not arrived yet are predicted
+/// to be none, as a user input is a single event,
+/// e.g. a key press, that is rarely done.
+/// When the peer's user inputs arrive and there were some,
+/// the game goes back to the frame of these,
+/// see \link{rollback_session::get_n_rollbacks},
+/// and all frames since are done again, with the correct user inputs,
+/// before the next frame is done.
+///
+/// To be able to go back, the game at the start
+/// of each recent frame is kept.
+/// If the peer's user inputs are too far behind,
+/// see \link{rollback_session::get_max_rollback_frames},
+/// the session stalls.
+///
+/// Every so many frames, the sessions exchange a hash
+/// of their game, of a frame of which the user inputs
+/// of both players are known, to detect a desync.
+///
+/// Both sessions must be created with the same game
+/// and the same settings.
+class rollback_session
+{
+public:
+  /// @param c the game at the start
+  /// @param local_side the side of the local player
+  /// @param transport sends and receives the messages of the peer.
+  ///   Must outlive this session
+  /// @param input_delay the number of frames between
+  ///   a user input and the frame it is done in.
+  ///   A delay makes rollbacks shorter and rarer
+  /// @param max_rollback_frames the maximum number of frames
+  ///   the session can go back in time
+  /// @param hash_interval the number of frames between
+  ///   two checks that both games are the same
+  /// @param n_steps_per_frame the number of simulation steps per frame
+  explicit rollback_session(
+    const game_controller& c,
+    const side local_side,
+    net_transport& transport,
+    const int input_delay = get_default_rollback_input_delay(),
+    const int max_rollback_frames = get_default_rollback_max_frames(),
+    const int hash_interval = get_default_lockstep_hash_interval(),
+    const int n_steps_per_frame = get_default_lockstep_n_steps_per_frame(),
+    const game_speed speed = get_default_game_speed(),
+    const double steps_per_second = get_default_simulation_frequency()
+  );
+
+  /// Add the user inputs of the local player,
+  /// to be done in the next frame that is scheduled.
+  ///
+  /// The user inputs of the other side are ignored
+  void add_local_inputs(const user_inputs& inputs);
+
+  /// Get the messages the pieces have sent since the previous call.
+  ///
+  /// The messages of frames that are done again are not repeated
+  std::vector<message> collect_messages();
+
+  /// Get the first frame at which the games differ, if any
+  const auto& get_desync_frame() const noexcept { return m_desync_frame; }
+
+  /// Get the number of frames done
+  auto get_frame() const noexcept { return m_frame; }
+
+  /// Get the game at the current frame,
+  /// which may be based on predicted user inputs
+  const auto& get_game_controller() const noexcept { return m_game_controller; }
+
+  auto get_input_delay() const noexcept { return m_input_delay; }
+
+  auto get_local_side() const noexcept { return m_local_side; }
+
+  auto get_max_rollback_frames() const noexcept { return m_max_rollback_frames; }
+
+  /// Get the number of frames done again after a rollback
+  auto get_n_rollback_frames() const noexcept { return m_n_rollback_frames; }
+
+  /// Get the number of times the game went back in time
+  auto get_n_rollbacks() const noexcept { return m_n_rollbacks; }
+
+  /// Get the number of seconds spent on doing frames again
+  auto get_n_resimulation_secs() const noexcept { return m_n_resimulation_secs; }
+
+  /// Get the number of ticks in which no frame was done,
+  /// as the peer's user inputs were too far behind
+  auto get_n_stalls() const noexcept { return m_n_stalls; }
+
+  auto get_n_steps_per_frame() const noexcept { return m_n_steps_per_frame; }
+
+  const auto& get_transport() const noexcept { return m_transport; }
+
+  /// Are the peer's user inputs of all frames done known,
+  /// i.e. is the game at the current frame certain?
+  bool is_confirmed() const noexcept { return m_n_remote_frames >= m_frame; }
+
+  /// Send and receive the messages,
+  /// go back in time if the peer's user inputs were predicted wrong,
+  /// and do the next frame, unless the peer is too far behind.
+  /// @return true if a frame was done
+  bool tick();
+
+  /// Send and receive the messages
+  /// and go back in time if the peer's user inputs were predicted wrong,
+  /// without doing a next frame.
+  ///
+  /// Use this to wait for the peer at the end of a game
+  void synchronize();
+
+private:
+
+  game_controller m_game_controller;
+
+  /// The first frame at which the games differ, if any
+  std::optional<int> m_desync_frame;
+
+  /// The in-game time per simulation step
+  delta_t m_delta_t;
+
+  /// The next frame to do
+  int m_frame{0};
+
+  int m_hash_interval;
+
+  int m_input_delay;
+
+  /// The most recent frame of which the hash was calculated, or -1
+  int m_last_hash_frame{-1};
+
+  std::uint64_t m_last_hash{0};
+
+  /// The tick at which the most recent hash was calculated
+  int m_last_hash_tick{0};
+
+  /// The frame the local user inputs were last scheduled for
+  int m_last_scheduled_frame;
+
+  /// The hashes of the local game, per frame
+  std::map<int, std::uint64_t> m_local_hashes;
+
+  /// The local user inputs per frame,
+  /// until acknowledged by the peer and no frame
+  /// with these can be done again
+  std::map<int, user_inputs> m_local_inputs;
+
+  side m_local_side;
+
+  int m_max_rollback_frames;
+
+  std::vector<message> m_messages;
+
+  /// The number of frames of which the hash has been considered
+  int m_n_hashed_frames{0};
+
+  /// The number of the peer's frames received,
+  /// i.e. all of the peer's frames before it are known
+  int m_n_remote_frames;
+
+  int m_n_rollback_frames{0};
+
+  int m_n_rollbacks{0};
+
+  double m_n_resimulation_secs{0.0};
+
+  int m_n_stalls{0};
+
+  int m_n_steps_per_frame;
+
+  int m_n_ticks{0};
+
+  /// The local user inputs for the next frame that is scheduled
+  user_inputs m_pending_inputs;
+
+  /// The last frame the peer acknowledged
+  /// to have the local user inputs of
+  int m_remote_ack_frame;
+
+  /// The hashes of the peer's game, per frame
+  std::map<int, std::uint64_t> m_remote_hashes;
+
+  /// The peer's user inputs per frame,
+  /// until no frame with these can be done again
+  std::map<int, user_inputs> m_remote_inputs;
+
+  /// The first frame of which the peer's user inputs
+  /// were predicted wrong, if any
+  std::optional<int> m_rollback_frame;
+
+  /// The games at the start of the recent frames,
+  /// the game at the start of a frame is at index
+  /// 'frame % m_snapshots.size()'
+  std::vector<game_controller> m_snapshots;
+
+  net_transport& m_transport;
+
+  /// Calculate the hashes of the frames
+  /// of which the user inputs of both players are known
+  void calc_hashes();
+
+  /// Compare the local and peer's hashes of the same frames
+  void check_hashes();
+
+  /// Do the next frame, with the local user inputs
+  /// and the known or predicted user inputs of the peer
+  void do_frame();
+
+  /// Get the user inputs of both players for a frame,
+  /// in the same order on both computers
+  user_inputs get_frame_inputs(const int frame) const;
+
+  /// Process a message of the peer
+  void process_message(const lockstep_message& m);
+
+  /// Receive all messages of the peer
+  void receive();
+
+  /// Go back to the first frame of which the peer's user inputs
+  /// were predicted wrong and do all frames since again
+  void roll_back();
+
+  /// Schedule the pending local user inputs,
+  /// so that each frame up to the input delay has these
+  void schedule_local_inputs();
+
+  /// Send the local user inputs the peer has not acknowledged yet
+  void send();
+};
+
+/// The result of \link{run_rollback_loopback}
+class rollback_loopback_result
+{
+public:
+  explicit rollback_loopback_result(
+    const int n_frames,
+    const int n_stalls,
+    const int n_rollbacks,
+    const int n_rollback_frames,
+    const double n_resimulation_secs,
+    const double n_secs,
+    const bool is_desync
+  );
+
+  /// Get the number of frames done by both players
+  auto get_n_frames() const noexcept { return m_n_frames; }
+
+  /// Get the number of seconds spent by both players
+  /// on doing frames again
+  auto get_n_resimulation_secs() const noexcept { return m_n_resimulation_secs; }
+
+  /// Get the number of frames done again by both players
+  auto get_n_rollback_frames() const noexcept { return m_n_rollback_frames; }
+
+  /// Get the number of frames done again by one player
+  /// per second of play
+  double get_n_rollback_frames_per_second() const noexcept;
+
+  /// Get the number of rollbacks of both players
+  auto get_n_rollbacks() const noexcept { return m_n_rollbacks; }
+
+  /// Get the number of seconds of play
+  auto get_n_secs() const noexcept { return m_n_secs; }
+
+  /// Get the number of stalls of both players
+  auto get_n_stalls() const noexcept { return m_n_stalls; }
+
+  /// Get the mean number of milliseconds to do a frame again
+  double get_resimulation_ms_per_frame() const noexcept;
+
+  /// Did the games differ?
+  auto is_desync() const noexcept { return m_is_desync; }
+
+private:
+  int m_n_frames;
+  int m_n_stalls;
+  int m_n_rollbacks;
+  int m_n_rollback_frames;
+  double m_n_resimulation_secs;
+  double m_n_secs;
+  bool m_is_desync;
+};
+
+/// Play two games with rollback, in one process,
+/// over a \link{loopback_transport}, with random user inputs.
+/// @param n_frames the number of frames each player does
+/// @param latency the number of ticks a message takes to arrive
+/// @param packet_loss the chance that a message is lost
+///
+/// Both games should be the same at the end
+rollback_loopback_result run_rollback_loopback(
+  const int n_frames,
+  const int latency,
+  const double packet_loss = 0.0,
+  const int input_delay = get_default_rollback_input_delay(),
+  const int n_steps_per_frame = get_default_lockstep_n_steps_per_frame(),
+  const int seed = 42
+);
+
+/// Test this class and its free functions
+void test_rollback_session();
+
+/// Test this class with threads, sockets or wall-clock time,
+/// which is slow
+void test_rollback_session_long();
+
+#endif // ROLLBACK_SESSION_H
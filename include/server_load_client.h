@@ -0,0 +1,145 @@
+#ifndef SERVER_LOAD_CLIENT_H
+#define SERVER_LOAD_CLIENT_H
+
+#include "ccfwd.h"
+#include "net_transport.h"
+#include "side.h"
+#include "user_inputs.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+/// A client of a \link{server_match} that does random user inputs,
+/// to put a \link{match_server} under load.
+///
+/// Sends its user inputs like a real client would,
+/// see \link{server_match}
+class server_load_client
+{
+public:
+  /// @param transport the transport to the server. Must outlive this client
+  /// @param player the side of the player of this client
+  /// @param input_chance the chance of a user input per tick
+  explicit server_load_client(
+    net_transport& transport,
+    const side player,
+    const double input_chance = 0.25,
+    const int seed = 42
+  );
+
+  /// Get the number of user inputs the server acknowledged
+  auto get_n_acknowledged() const noexcept { return m_n_acknowledged; }
+
+  /// Get the number of user inputs done
+  auto get_n_user_inputs() const noexcept { return m_n_user_inputs; }
+
+  auto get_player() const noexcept { return m_player; }
+
+  /// Maybe do a random user input,
+  /// then send the user inputs not acknowledged yet
+  void tick();
+
+private:
+
+  double m_input_chance;
+
+  int m_n_acknowledged{0};
+
+  int m_n_user_inputs{0};
+
+  side m_player;
+
+  std::default_random_engine m_rng_engine;
+
+  net_transport& m_transport;
+
+  /// The user inputs the server has not acknowledged yet,
+  /// the first is frame m_n_acknowledged
+  std::vector<user_inputs> m_unacknowledged;
+
+  /// Receive the acknowledgements of the server
+  void receive();
+};
+
+/// The result of \link{run_server_soak}
+class server_soak_result
+{
+public:
+  explicit server_soak_result(
+    const int n_matches,
+    const int n_threads,
+    const int n_frames,
+    const int n_late_ticks,
+    const int n_user_inputs,
+    const double n_secs,
+    const double n_cpu_secs,
+    const double max_match_cpu_secs
+  );
+
+  /// Get the number of frames done by all matches per second
+  double get_frames_per_second() const noexcept;
+
+  /// Get the mean time to do a frame of one match, in milliseconds
+  double get_match_frame_ms() const noexcept;
+
+  /// Get the largest time spent on one match, in seconds
+  auto get_max_match_cpu_secs() const noexcept { return m_max_match_cpu_secs; }
+
+  /// Get the total time spent on all matches, in seconds
+  auto get_n_cpu_secs() const noexcept { return m_n_cpu_secs; }
+
+  /// Get the number of frames done by all matches
+  auto get_n_frames() const noexcept { return m_n_frames; }
+
+  /// Get the number of ticks that took longer than a frame
+  auto get_n_late_ticks() const noexcept { return m_n_late_ticks; }
+
+  auto get_n_matches() const noexcept { return m_n_matches; }
+
+  /// Get the number of seconds the server ran
+  auto get_n_secs() const noexcept { return m_n_secs; }
+
+  auto get_n_threads() const noexcept { return m_n_threads; }
+
+  /// Get the number of user inputs the server acknowledged
+  auto get_n_user_inputs() const noexcept { return m_n_user_inputs; }
+
+private:
+  int m_n_matches;
+  int m_n_threads;
+  int m_n_frames;
+  int m_n_late_ticks;
+  int m_n_user_inputs;
+  double m_n_secs;
+  double m_n_cpu_secs;
+  double m_max_match_cpu_secs;
+};
+
+/// Host matches on a \link{match_server},
+/// each with two \link{server_load_client}s,
+/// connected over \link{loopback_transport}s.
+/// @param n_matches the number of matches
+/// @param n_frames the number of frames of each match
+/// @param n_threads the number of worker threads,
+///   if zero, one per hardware thread
+/// @param is_real_time tick at the frame rate if true,
+///   else as fast as possible
+/// @param replay_folder the folder to save the replays in,
+///   if empty, the replays are not saved
+server_soak_result run_server_soak(
+  const int n_matches,
+  const int n_frames,
+  const int n_threads = 0,
+  const bool is_real_time = false,
+  const std::string& replay_folder = ""
+);
+
+/// Test this class and its free functions
+void test_server_load_client();
+
+/// Test this class with threads, sockets or wall-clock time,
+/// which is slow
+void test_server_load_client_long();
+
+#endif // SERVER_LOAD_CLIENT_H
@@ -0,0 +1,117 @@
+#ifndef SERVER_MATCH_H
+#define SERVER_MATCH_H
+
+#include "ccfwd.h"
+#include "delta_t.h"
+#include "game_controller.h"
+#include "game_simulation.h"
+#include "game_speed.h"
+#include "input_replay.h"
+#include "lockstep_message.h"
+#include "lockstep_session.h"
+#include "net_transport.h"
+#include "side.h"
+
+#include <map>
+#include <memory>
+#include <string>
+
+/// Get the default maximum number of frames of a \link{server_match},
+/// which is ten minutes at the default frame rate
+constexpr int get_default_server_match_max_n_frames() { return 18000; }
+
+/// One game hosted by a \link{match_server}.
+///
+/// The server has the authoritative game.
+/// Each player's client sends its user inputs
+/// as \link{lockstep_message}s, where a frame is one user inputs
+/// the client has done, numbered from zero.
+/// A client only sends when it has user inputs
+/// that the server has not acknowledged yet.
+/// The server does the user inputs in the next frame after these arrive,
+/// and acknowledges these in the reply.
+///
+/// All frames are recorded in an \link{input_replay}.
+class server_match
+{
+public:
+  /// @param id the ID of the match, unique per server
+  /// @param transport_lhs the transport to the left-hand player's client,
+  ///   can be nullptr if there is no such client
+  /// @param transport_rhs the transport to the right-hand player's client,
+  ///   can be nullptr if there is no such client
+  /// @param c the game at the start
+  /// @param max_n_frames the number of frames after which the match ends
+  /// @param n_steps_per_frame the number of simulation steps per frame
+  explicit server_match(
+    const int id,
+    std::unique_ptr<net_transport> transport_lhs,
+    std::unique_ptr<net_transport> transport_rhs,
+    const game_controller& c = game_controller(),
+    const int max_n_frames = get_default_server_match_max_n_frames(),
+    const int n_steps_per_frame = get_default_lockstep_n_steps_per_frame(),
+    const game_speed speed = get_default_game_speed(),
+    const double steps_per_second = get_default_simulation_frequency()
+  );
+
+  /// Get the number of seconds spent ticking this match,
+  /// measured on the thread that did the ticks
+  auto get_cpu_secs() const noexcept { return m_cpu_secs; }
+
+  /// Get the number of frames done
+  auto get_frame() const noexcept { return m_frame; }
+
+  const auto& get_game_controller() const noexcept { return m_game_controller; }
+
+  auto get_id() const noexcept { return m_id; }
+
+  /// Get the number of user inputs received from both clients
+  auto get_n_user_inputs() const noexcept { return m_n_user_inputs; }
+
+  const auto& get_replay() const noexcept { return m_replay; }
+
+  /// Has the game a winner or has the maximum number of frames been done?
+  bool is_done() const noexcept;
+
+  /// Receive the user inputs of the clients,
+  /// do the next frame with these and acknowledge these
+  void tick();
+
+private:
+
+  double m_cpu_secs{0.0};
+
+  /// The in-game time per simulation step
+  delta_t m_delta_t;
+
+  /// The next frame to do
+  int m_frame{0};
+
+  game_controller m_game_controller;
+
+  int m_id;
+
+  int m_max_n_frames;
+
+  /// The number of frames received per client,
+  /// i.e. all of its frames before it are known
+  std::map<side, int> m_n_received_frames;
+
+  int m_n_steps_per_frame;
+
+  int m_n_user_inputs{0};
+
+  input_replay m_replay;
+
+  /// The transports to the clients, per side
+  std::map<side, std::unique_ptr<net_transport>> m_transports;
+
+  /// Receive all messages of the client of a side,
+  /// adding its new user inputs
+  void receive(const side s, user_inputs& inputs);
+};
+
+/// Test this class and its free functions
+void test_server_match();
+
+#endif // SERVER_MATCH_H
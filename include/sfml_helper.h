@@ -10,11 +10,13 @@
 
 #include <SFML/Graphics.hpp>
 
+#ifndef LOGIC_ONLY
 /// Convert a fraction of health (i.e. a value e [0.0, 1.0] to a color
 sf::Color f_health_to_color(const double f);
 
 /// Convert a fraction of shield (i.e. a value e [0.0, 1.0] to a color
 sf::Color f_shield_to_color(const double f);
+#endif // LOGIC_ONLY
 
 /// Get all the SFML mouse buttons
 std::vector<sf::Mouse::Button> get_all_sfml_buttons() noexcept;
@@ -29,6 +31,7 @@ bool is_shift_pressed() noexcept;
 /// to a filename to a filename, as used by \link{input_prompt_textures}
 std::string key_str_to_resource_name(std::string key_str);
 
+#ifndef LOGIC_ONLY
 /// Make 'rectangle' have the same size as the \link{screen_coordinat}
 void set_rect(sf::RectangleShape& rectangle, const screen_coordinate& screen_size);
 
@@ -38,6 +41,7 @@ void set_rect(sf::RectangleShape& rectangle, const screen_rect& screen_rect);
 /// Make 'text' have the same size and position as the 'screen_rect'
 /// Assumes the text already has a font and has text
 void set_text_position(sf::Text& text, const screen_rect& screen_rect);
+#endif // LOGIC_ONLY
 
 /// Tes these function
 void test_sfml_helper();
@@ -60,6 +64,7 @@ std::string to_str(const sf::Mouse::Button k);
 /// Convert a key to its one-character description
 std::string to_one_char_str(const sf::Keyboard::Key);
 
+#ifndef LOGIC_ONLY
 /// Convert chess_color to sf::Color
 sf::Color to_sfml_color(const chess_color color) noexcept;
 
@@ -68,5 +73,6 @@ sf::Color to_sfml_color(
   const chess_color color,
   const piece_action_type t
 ) noexcept;
+#endif // LOGIC_ONLY
 
 #endif // SFML_HELPER_H
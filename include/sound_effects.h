@@ -6,23 +6,42 @@
 
 #include "ccfwd.h"
 #include "message.h"
+#include "sound_voice_pool.h"
 
 #include <SFML/Audio.hpp>
 
-/// The sound effects
+#include <map>
+
+/// The sound effects.
+///
+/// The sound effects are played by a fixed number of voices,
+/// see \link{sound_voice_pool}.
+/// Cannot be copied nor moved, as its buffers
+/// refer to its own members
 class sound_effects
 {
 public:
   sound_effects();
+  sound_effects(const sound_effects&) = delete;
+  sound_effects& operator=(const sound_effects&) = delete;
+
+  /// The number of sound requests that got no voice, since the start
+  int get_n_dropped_voices() const noexcept { return m_voice_pool.get_n_dropped_voices(); }
 
-  int get_n_sound_effects() const noexcept {
-    return sizeof(*this)
-    / (sizeof(m_attacking_high) + sizeof(m_attacking_high_buffer));
-  }
+  int get_n_sound_effects() const noexcept { return static_cast<int>(m_buffers.size()); }
+
+  /// The number of voices that are playing now
+  int get_n_playing_voices() const noexcept;
 
   /// Play a sound effect
   void play(const message& effect);
 
+  /// Play the sound effects of one frame.
+  ///
+  /// Duplicate sound effects are played once,
+  /// less important sound effects may be dropped
+  void play(const std::vector<message>& effects);
+
   /// Play a Thema bark. Number can be either 1 or 2
   void play_bark(const int number);
 
@@ -36,43 +55,24 @@ public:
   void set_master_volume(const volume& v);
 
 private:
-  sf::Sound m_attacking_high;
-  sf::Sound m_attacking_low;
-  sf::Sound m_attacking_mid;
-  sf::Sound m_bark_1;
-  sf::Sound m_bark_2;
-  sf::Sound m_countdown;
-  sf::Sound m_done_high;
-  sf::Sound m_done_low;
-  sf::Sound m_done_mid;
-  sf::Sound m_faring_into_battle;
-  sf::Sound m_heu_high;
-  sf::Sound m_heu_low;
-  sf::Sound m_heu_mid;
-  sf::Sound m_hide;
-  sf::Sound m_hmm_high;
-  sf::Sound m_hmm_low;
-  sf::Sound m_hmm_mid;
-  sf::Sound m_i_cannot_high;
-  sf::Sound m_i_cannot_low;
-  sf::Sound m_i_cannot_mid;
-  sf::Sound m_i_cant_high;
-  sf::Sound m_i_cant_low;
-  sf::Sound m_i_cant_mid;
-  sf::Sound m_its_time_to_rock;
-  sf::Sound m_jumping_into_battle;
-  sf::Sound m_lets_rule;
-  sf::Sound m_moving_forward;
-  sf::Sound m_no_high;
-  sf::Sound m_no_low;
-  sf::Sound m_no_mid;
-  sf::Sound m_nope_high;
-  sf::Sound m_nope_low;
-  sf::Sound m_nope_mid;
-  sf::Sound m_to_rule_is_to_act;
-  sf::Sound m_yes_high;
-  sf::Sound m_yes_low;
-  sf::Sound m_yes_mid;
+
+  /// The buffers, in the order of the table (see \link{get_table}).
+  /// The index of a buffer is used as the index of its sound
+  std::vector<std::reference_wrapper<const sf::SoundBuffer>> m_buffers;
+
+  /// Per message type and piece type, the index of the sound
+  /// in the table (see \link{get_table}), if any
+  std::map<message_type, std::map<piece_type, int>> m_message_sound_indices;
+
+  /// The volume of all voices, as a percentage
+  float m_master_volume{100.0};
+
+  /// Decides which voice plays which sound.
+  /// Must be initialized before \link{m_voices}
+  sound_voice_pool m_voice_pool;
+
+  /// The voices that play the sound effects
+  std::vector<sf::Sound> m_voices;
 
   sf::SoundBuffer m_attacking_high_buffer;
   sf::SoundBuffer m_attacking_low_buffer;
@@ -112,8 +112,23 @@ private:
   sf::SoundBuffer m_yes_low_buffer;
   sf::SoundBuffer m_yes_mid_buffer;
 
-  /// Get the table that connects the sound and buffer and filename
-  std::vector<std::tuple<std::reference_wrapper<sf::Sound>, std::reference_wrapper<sf::SoundBuffer>, std::string>> get_table() noexcept;
+  /// Get the buffer that is played for a message, if any
+  const sf::SoundBuffer * get_buffer(
+    const message_type t,
+    const piece_type p
+  ) const noexcept;
+
+  /// Get the table that connects the buffer and filename
+  std::vector<std::pair<std::reference_wrapper<sf::SoundBuffer>, std::string>> get_table() noexcept;
+
+  /// Get the index of a buffer in the table
+  int get_sound_index(const sf::SoundBuffer& buffer) const noexcept;
+
+  /// Play the sounds from the table, using the voice pool
+  void play(const std::vector<sound_request>& requests);
+
+  /// Play a user interface sound, with the highest priority
+  void play_ui_sound(const sf::SoundBuffer& buffer);
 };
 
 /// Test this class and its free functions
@@ -0,0 +1,76 @@
+#ifndef SOUND_VOICE_POOL_H
+#define SOUND_VOICE_POOL_H
+
+#include "message_type.h"
+
+#include <utility>
+#include <vector>
+
+/// A request to play a sound effect.
+///
+/// The sound effect is identified by an index,
+/// as used by \link{sound_effects}
+class sound_request
+{
+public:
+  explicit sound_request(const int sound_index, const int priority);
+
+  auto get_priority() const noexcept { return m_priority; }
+  auto get_sound_index() const noexcept { return m_sound_index; }
+
+private:
+  int m_sound_index;
+  int m_priority;
+};
+
+/// Decides which voice plays which sound effect.
+///
+/// There is a fixed number of voices, so that many pieces
+/// finishing at once do not pile up sounds.
+/// Per frame, the requested sound effects are de-duplicated
+/// and assigned by priority.
+/// If there is no free voice, a request steals the voice of
+/// the lowest-priority sound that has a lower priority than itself.
+/// Otherwise, the request is dropped.
+class sound_voice_pool
+{
+public:
+  explicit sound_voice_pool(const int n_voices = 8);
+
+  /// Assign voices to the sound effects requested in one frame
+  /// @param requests the requested sound effects
+  /// @param is_playing per voice, if it still plays a sound effect
+  /// @return pairs of voice index and sound index,
+  ///   for each voice that must start playing a new sound effect
+  std::vector<std::pair<int, int>> assign(
+    std::vector<sound_request> requests,
+    const std::vector<bool>& is_playing
+  );
+
+  /// The number of requests that got no voice, since the start
+  int get_n_dropped_voices() const noexcept { return m_n_dropped_voices; }
+
+  int get_n_voices() const noexcept { return static_cast<int>(m_priorities.size()); }
+
+private:
+
+  /// Per voice, the priority of the last sound effect it played
+  std::vector<int> m_priorities;
+
+  int m_n_dropped_voices{0};
+};
+
+/// Get the priority of the sound effect of a message.
+///
+/// A higher value denotes a more important sound effect
+int get_sound_priority(const message_type t) noexcept;
+
+/// Get the priority of a sound effect that is the user interface's
+/// direct response to a key press, e.g. in a menu.
+/// This is the highest priority
+int get_ui_sound_priority() noexcept;
+
+/// Test this class and its free functions
+void test_sound_voice_pool();
+
+#endif // SOUND_VOICE_POOL_H
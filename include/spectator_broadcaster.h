@@ -0,0 +1,130 @@
+#ifndef SPECTATOR_BROADCASTER_H
+#define SPECTATOR_BROADCASTER_H
+
+#include "ccfwd.h"
+#include "net_transport.h"
+#include "spectator_state.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+/// Get the default number of ticks between two keyframes
+/// sent to all spectators
+constexpr int get_default_spectator_keyframe_interval() { return 90; }
+
+/// Sends a game to many spectators.
+///
+/// Each tick, the game is encoded once,
+/// as a delta from the previous tick,
+/// and the same bytes are sent to all spectators.
+/// A new spectator gets a keyframe first.
+/// Every so many ticks, all spectators get a keyframe,
+/// so that a spectator that lost a message can continue.
+class spectator_broadcaster
+{
+public:
+  /// @param keyframe_interval the number of ticks between two keyframes
+  ///   sent to all spectators
+  explicit spectator_broadcaster(
+    const int keyframe_interval = get_default_spectator_keyframe_interval()
+  );
+
+  /// Add a spectator, that gets a keyframe in the next tick
+  void add_spectator(std::unique_ptr<net_transport> transport);
+
+  /// Get the number of seconds spent on encoding
+  auto get_encode_secs() const noexcept { return m_encode_secs; }
+
+  /// Get the number of bytes sent to all spectators
+  auto get_n_bytes_sent() const noexcept { return m_n_bytes_sent; }
+
+  /// Get the number of spectators
+  int get_n_spectators() const noexcept { return static_cast<int>(m_spectators.size()); }
+
+  /// Get the number of ticks done
+  auto get_n_ticks() const noexcept { return m_tick; }
+
+  /// Send the state of the game to all spectators
+  void tick(const game_controller& c);
+
+private:
+
+  /// The time spent on encoding
+  double m_encode_secs{0.0};
+
+  int m_keyframe_interval;
+
+  std::int64_t m_n_bytes_sent{0};
+
+  /// The state sent in the previous tick, if any
+  std::optional<spectator_state> m_previous_state;
+
+  /// The spectators and if they have a keyframe
+  std::vector<std::pair<std::unique_ptr<net_transport>, bool>> m_spectators;
+
+  /// The next tick
+  int m_tick{0};
+};
+
+/// The result of \link{run_spectator_broadcast}
+class spectator_broadcast_result
+{
+public:
+  explicit spectator_broadcast_result(
+    const int n_spectators,
+    const int n_ticks,
+    const std::int64_t n_bytes_sent,
+    const double n_secs,
+    const double encode_secs,
+    const bool is_in_sync
+  );
+
+  /// Get the number of bytes sent per second per spectator
+  double get_n_bytes_per_second() const noexcept;
+
+  /// Get the mean time to encode one tick, in milliseconds
+  double get_encode_ms_per_tick() const noexcept;
+
+  auto get_n_bytes_sent() const noexcept { return m_n_bytes_sent; }
+
+  /// Get the number of seconds of play
+  auto get_n_secs() const noexcept { return m_n_secs; }
+
+  auto get_n_spectators() const noexcept { return m_n_spectators; }
+
+  auto get_n_ticks() const noexcept { return m_n_ticks; }
+
+  /// Did all spectators see the state of the game at the end?
+  auto is_in_sync() const noexcept { return m_is_in_sync; }
+
+private:
+  int m_n_spectators;
+  int m_n_ticks;
+  std::int64_t m_n_bytes_sent;
+  double m_n_secs;
+  double m_encode_secs;
+  bool m_is_in_sync;
+};
+
+/// Play a game with random user inputs
+/// and broadcast it to spectators over \link{loopback_transport}s.
+/// @param n_spectators the number of spectators
+/// @param n_ticks the number of ticks, each of
+///   \link{get_default_lockstep_n_steps_per_frame} simulation steps
+spectator_broadcast_result run_spectator_broadcast(
+  const int n_spectators,
+  const int n_ticks,
+  const int keyframe_interval = get_default_spectator_keyframe_interval(),
+  const int seed = 42
+);
+
+/// Test this class and its free functions
+void test_spectator_broadcaster();
+
+/// Test this class with threads, sockets or wall-clock time,
+/// which is slow
+void test_spectator_broadcaster_long();
+
+#endif // SPECTATOR_BROADCASTER_H
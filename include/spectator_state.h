@@ -0,0 +1,108 @@
+#ifndef SPECTATOR_STATE_H
+#define SPECTATOR_STATE_H
+
+#include "ccfwd.h"
+#include "chess_color.h"
+#include "piece_action_type.h"
+#include "piece_type.h"
+#include "side.h"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+/// Get the number of bytes per square of a \link{spectator_state}
+constexpr int get_spectator_square_n_bytes() { return 6; }
+
+/// Get the number of squares of a \link{spectator_state}
+constexpr int get_spectator_n_squares() { return 64; }
+
+/// What a spectator sees of a game, in a fixed number of bytes.
+///
+/// Per square, there is the piece on it, if any,
+/// its health and shield, quantised to one byte each,
+/// and its current action and the progress of that action.
+/// Besides the squares, there is the in-game time,
+/// the winner, if any, and the cursors, quantised to one byte per axis.
+///
+/// As all values have a fixed place,
+/// two states are compared value by value,
+/// so that only the changed values need to be sent,
+/// see \link{to_spectator_delta_bytes}.
+class spectator_state
+{
+public:
+  /// The values of a square, in the order of the bytes
+  enum class field
+  {
+    piece,
+    health,
+    shield,
+    action_type,
+    action_target,
+    action_progress
+  };
+
+  /// An empty board
+  spectator_state();
+
+  /// What a spectator sees of a game
+  explicit spectator_state(const game_controller& c);
+
+  /// Get the cursor of a player, quantised to 1/16th of a square per axis
+  const auto& get_cursor(const side s) const noexcept { return m_cursors[static_cast<int>(s)]; }
+
+  /// Get a value of a square, as a byte
+  std::uint8_t get_field(const int square_index, const field f) const noexcept;
+
+  auto get_in_game_time() const noexcept { return m_in_game_time; }
+
+  /// Get the winner, if any
+  const auto& get_winner() const noexcept { return m_winner; }
+
+  /// Set the cursor of a player, quantised to 1/16th of a square per axis
+  void set_cursor(const side s, const std::array<std::uint8_t, 2>& xy) noexcept;
+
+  /// Set a value of a square, as a byte
+  void set_field(const int square_index, const field f, const std::uint8_t value) noexcept;
+
+  void set_in_game_time(const double t) noexcept { m_in_game_time = t; }
+
+  void set_winner(const std::optional<chess_color>& winner) noexcept { m_winner = winner; }
+
+private:
+  std::array<std::array<std::uint8_t, 2>, 2> m_cursors;
+
+  double m_in_game_time{0.0};
+
+  std::array<std::uint8_t, get_spectator_n_squares() * get_spectator_square_n_bytes()> m_squares;
+
+  std::optional<chess_color> m_winner;
+};
+
+/// Get the index of a square in a \link{spectator_state}
+int get_spectator_square_index(const square& s) noexcept;
+
+/// Get the type of the action of the piece on a square, if any
+std::optional<piece_action_type> get_action_type(
+  const spectator_state& s,
+  const int square_index
+) noexcept;
+
+/// Get the health of the piece on a square, as a fraction
+/// of its maximum, to within 1/255th
+double get_f_health(const spectator_state& s, const int square_index) noexcept;
+
+/// Get the color and type of the piece on a square, if any
+std::optional<std::pair<chess_color, piece_type>> get_piece(
+  const spectator_state& s,
+  const int square_index
+) noexcept;
+
+/// Test this class and its free functions
+void test_spectator_state();
+
+bool operator==(const spectator_state& lhs, const spectator_state& rhs) noexcept;
+bool operator!=(const spectator_state& lhs, const spectator_state& rhs) noexcept;
+
+#endif // SPECTATOR_STATE_H
@@ -0,0 +1,72 @@
+#ifndef SPECTATOR_STREAM_H
+#define SPECTATOR_STREAM_H
+
+#include "ccfwd.h"
+#include "spectator_state.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/// Convert a \link{spectator_state} to the bytes
+/// of a keyframe, that has all values.
+/// @param tick the tick of the state
+std::vector<std::uint8_t> to_spectator_keyframe_bytes(
+  const spectator_state& s,
+  const int tick
+);
+
+/// Convert the difference between two \link{spectator_state}s
+/// of consecutive ticks to the bytes of a delta,
+/// that has the changed values only.
+/// @param tick the tick of the new state
+std::vector<std::uint8_t> to_spectator_delta_bytes(
+  const spectator_state& from,
+  const spectator_state& to,
+  const int tick
+);
+
+/// Reads the stream of keyframes and deltas
+/// a spectator receives,
+/// to know what the game looks like.
+///
+/// A delta is only applied to the state of the tick before it.
+/// If a message is lost, the deltas are ignored
+/// until the next keyframe arrives.
+class spectator_decoder
+{
+public:
+  spectator_decoder() = default;
+
+  /// Read a message.
+  /// @return true if the state was updated
+  bool add(const std::vector<std::uint8_t>& bytes);
+
+  /// Get the number of deltas applied
+  auto get_n_deltas() const noexcept { return m_n_deltas; }
+
+  /// Get the number of messages that were ignored,
+  /// as these could not be read or did not follow the previous tick
+  auto get_n_ignored() const noexcept { return m_n_ignored; }
+
+  /// Get the number of keyframes applied
+  auto get_n_keyframes() const noexcept { return m_n_keyframes; }
+
+  /// Get the state, if a keyframe has arrived
+  const auto& get_state() const noexcept { return m_state; }
+
+  /// Get the tick of the state, or -1 if there is no state
+  auto get_tick() const noexcept { return m_tick; }
+
+private:
+  int m_n_deltas{0};
+  int m_n_ignored{0};
+  int m_n_keyframes{0};
+  std::optional<spectator_state> m_state;
+  int m_tick{-1};
+};
+
+/// Test these functions and classes
+void test_spectator_stream();
+
+#endif // SPECTATOR_STREAM_H
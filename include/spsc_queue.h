@@ -0,0 +1,99 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/// A lock-free, bounded queue, to pass values
+/// from one producer thread to one consumer thread.
+///
+/// Neither thread ever waits for the other:
+/// when the queue is full, \link{spsc_queue::try_push} fails,
+/// when the queue is empty, \link{spsc_queue::try_pop} fails.
+template <class T>
+class spsc_queue
+{
+public:
+  /// @param capacity the maximum number of values in the queue,
+  ///   must be a power of two
+  explicit spsc_queue(const int capacity = 1024)
+    : m_values(capacity),
+      m_index_mask{static_cast<std::size_t>(capacity) - 1}
+  {
+    assert(capacity > 0);
+    assert((capacity & (capacity - 1)) == 0);
+  }
+
+  spsc_queue(const spsc_queue&) = delete;
+  spsc_queue& operator=(const spsc_queue&) = delete;
+
+  /// Get the maximum number of values in the queue
+  int get_capacity() const noexcept { return static_cast<int>(m_values.size()); }
+
+  /// Get the number of values in the queue.
+  ///
+  /// As the other thread may push or pop at the same time,
+  /// this is only an estimate
+  int get_size() const noexcept
+  {
+    return static_cast<int>(
+      m_tail.load(std::memory_order_acquire)
+      - m_head.load(std::memory_order_acquire)
+    );
+  }
+
+  /// Is the queue empty?
+  ///
+  /// As the other thread may push or pop at the same time,
+  /// this is only an estimate
+  bool is_empty() const noexcept { return get_size() == 0; }
+
+  /// Remove the oldest value and put it in 'value'.
+  /// Returns false if the queue is empty.
+  ///
+  /// Only to be called by the consumer thread
+  bool try_pop(T& value)
+  {
+    const std::size_t head{m_head.load(std::memory_order_relaxed)};
+    if (head == m_tail.load(std::memory_order_acquire)) return false;
+    value = std::move(m_values[head & m_index_mask]);
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Add a value.
+  /// Returns false if the queue is full.
+  ///
+  /// Only to be called by the producer thread
+  bool try_push(T value)
+  {
+    const std::size_t tail{m_tail.load(std::memory_order_relaxed)};
+    if (tail - m_head.load(std::memory_order_acquire) == m_values.size()) return false;
+    m_values[tail & m_index_mask] = std::move(value);
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  std::vector<T> m_values;
+
+  std::size_t m_index_mask;
+
+  /// The number of values popped, only written by the consumer
+  alignas(64) std::atomic<std::size_t> m_head{0};
+
+  /// The number of values pushed, only written by the producer
+  alignas(64) std::atomic<std::size_t> m_tail{0};
+};
+
+/// Test this class
+void test_spsc_queue();
+
+/// Test this class with threads, sockets or wall-clock time,
+/// which is slow
+void test_spsc_queue_long();
+
+#endif // SPSC_QUEUE_H
@@ -4,6 +4,8 @@
 #include "race.h"
 #include "screen_rect.h"
 
+#include <optional>
+
 /// The layout of a square.
 ///
 /// This layout is only relevant if there is a piece in this square
@@ -69,10 +71,14 @@ public:
   /// The outline of the health bar
   const screen_rect& get_health_bar_outline() const noexcept { return m_health_bar; }
 
-  /// The health bar value, a bar within the outline of the health bar
+  /// The health bar value, a bar within the outline of the health bar.
+  ///
+  /// Throws a std::logic_error if the square is too small to show it
   screen_rect get_health_bar_value(const double f, const race r = race::classic) const;
 
-  /// The shield bar value, a bar within the lower half of the outline of the health bar
+  /// The shield bar value, a bar within the lower half of the outline of the health bar.
+  ///
+  /// Throws a std::logic_error if the square is too small to show it
   screen_rect get_shield_bar_value(const double f) const;
 
   const screen_rect& get_piece() const noexcept { return m_piece; }
@@ -82,8 +88,22 @@ private:
 
 
   screen_rect m_health_bar;
+
+  /// The full health bar value, within the outline.
+  /// Empty if the square is too small to have one
+  std::optional<screen_rect> m_health_bar_inside;
+
+  /// The full health bar value of a rooxx piece,
+  /// the upper half of m_health_bar_inside
+  std::optional<screen_rect> m_health_bar_inside_rooxx;
+
   screen_rect m_is_protected;
   screen_rect m_piece;
+
+  /// The full shield bar value,
+  /// the lower half of m_health_bar_inside
+  std::optional<screen_rect> m_shield_bar_inside;
+
   screen_rect m_square;
 };
 
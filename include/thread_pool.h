@@ -0,0 +1,115 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// A fixed number of worker threads that do tasks,
+/// with work stealing.
+///
+/// Each worker has its own queue of tasks.
+/// A worker takes the most recently added task from its own queue,
+/// and if that is empty, steals the oldest task
+/// from the queue of another worker,
+/// so that no worker is idle while there is work to do,
+/// even if the tasks take very different amounts of time.
+///
+/// Tasks added by a worker are added to its own queue,
+/// tasks added by another thread are spread over the queues.
+class thread_pool
+{
+public:
+  /// @param n_threads the number of worker threads,
+  ///   if zero, one per hardware thread
+  explicit thread_pool(const int n_threads = 0);
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  /// Does all tasks added, then stops the workers
+  ~thread_pool();
+
+  /// Add a task.
+  ///
+  /// Can be called from any thread, including the workers
+  void add_task(const std::function<void()>& task);
+
+  /// Get the number of tasks done
+  auto get_n_tasks_done() const noexcept { return m_n_tasks_done.load(); }
+
+  /// Get the number of tasks taken from the queue of another worker
+  auto get_n_steals() const noexcept { return m_n_steals.load(); }
+
+  /// Get the number of worker threads.
+  ///
+  /// This is the number of queues, as these are all created
+  /// before the first worker starts
+  int get_n_threads() const noexcept { return static_cast<int>(m_queues.size()); }
+
+  /// Wait until all tasks added are done.
+  ///
+  /// Not to be called by a worker
+  void wait();
+
+private:
+
+  /// The queue of tasks of one worker
+  class task_queue
+  {
+  public:
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+  };
+
+  /// The queue a task added by another thread is added to next.
+  /// Unsigned, so it wraps around to zero instead of going negative
+  std::atomic<unsigned int> m_next_queue{0};
+
+  /// The number of tasks added, but not done yet
+  int m_n_pending{0};
+
+  /// The number of tasks in the queues
+  int m_n_queued{0};
+
+  std::atomic<int> m_n_steals{0};
+
+  std::atomic<int> m_n_tasks_done{0};
+
+  bool m_must_stop{false};
+
+  /// Protects m_n_pending, m_n_queued and m_must_stop
+  std::mutex m_mutex;
+
+  /// Notifies that all tasks are done
+  std::condition_variable m_all_done;
+
+  /// Wakes up the workers
+  std::condition_variable m_has_tasks;
+
+  /// One queue per worker
+  std::vector<std::unique_ptr<task_queue>> m_queues;
+
+  std::vector<std::thread> m_workers;
+
+  /// Do tasks until m_must_stop is set and no tasks are left
+  void run(const int worker_index);
+
+  /// Take a task from the worker's own queue,
+  /// else steal one from another worker's queue.
+  /// Returns false if all queues are empty
+  bool try_take_task(const int worker_index, std::function<void()>& task);
+};
+
+/// Test this class and its free functions
+void test_thread_pool();
+
+/// Test this class with threads, sockets or wall-clock time,
+/// which is slow
+void test_thread_pool_long();
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,68 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <string>
+
+/// Measures the time of a scope, when tracing is enabled.
+///
+/// Use it like this:
+///
+/// void game::tick_impl(const delta_t& dt)
+/// {
+///   const trace_scope scope("game::tick_impl");
+///   // ...
+/// }
+///
+/// When tracing is disabled, this costs one atomic load.
+/// When tracing is enabled, each thread stores its events
+/// in its own buffer, of which it overwrites the oldest events when full.
+/// That buffer has a lock, that is only contended
+/// when \link{stop_tracing} reads it.
+/// At the end, \link{stop_tracing} writes all events
+/// as Chrome trace-event JSON, that can be viewed
+/// in 'chrome://tracing' or at 'https://ui.perfetto.dev'.
+class trace_scope
+{
+public:
+  /// @param name the name of the scope.
+  ///   Must be a string literal, as only the pointer is stored
+  explicit trace_scope(const char * const name) noexcept;
+  trace_scope(const trace_scope&) = delete;
+  trace_scope& operator=(const trace_scope&) = delete;
+  ~trace_scope();
+
+private:
+  const char * m_name;
+
+  /// The start time, in microseconds since tracing started,
+  /// or -1 if tracing is disabled
+  std::int64_t m_start_microseconds;
+};
+
+/// Get the number of trace events that were overwritten
+/// by newer ones, because a buffer was full
+int get_n_overwritten_trace_events();
+
+/// Get the number of trace events kept, to be written
+int get_n_trace_events();
+
+/// Is tracing enabled?
+bool is_tracing() noexcept;
+
+/// Start tracing, to write the events to a file
+/// when \link{stop_tracing} is called.
+///
+/// Removes the events of an earlier trace
+void start_tracing(const std::string& filename);
+
+/// Stop tracing and write the trace-event JSON file.
+///
+/// Can be called while other threads are tracing:
+/// an event these add after tracing stopped is not written
+void stop_tracing();
+
+/// Test this class and its free functions
+void test_trace();
+
+#endif // TRACE_H
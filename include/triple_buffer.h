@@ -0,0 +1,86 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <array>
+#include <atomic>
+
+/// A lock-free triple buffer, to pass values
+/// from one writer thread to one reader thread.
+///
+/// The writer writes in its own back buffer and then publishes it.
+/// The reader reads the most recently published value.
+/// Neither thread ever waits for the other:
+/// if the writer publishes faster than the reader reads,
+/// the values in between are skipped.
+template <class T>
+class triple_buffer
+{
+public:
+  explicit triple_buffer(const T& initial_value = T())
+    : m_buffers{initial_value, initial_value, initial_value}
+  {
+
+  }
+
+  /// Get the writer's back buffer, to write the next value in.
+  ///
+  /// Only to be called by the writer thread
+  T& get_back() noexcept { return m_buffers[m_back]; }
+
+  /// Get the most recently published value.
+  ///
+  /// Only to be called by the reader thread
+  const T& get_front() noexcept
+  {
+    if (m_middle.load(std::memory_order_relaxed) & is_new_bit)
+    {
+      // Swap the front buffer with the published middle buffer
+      const int middle{
+        m_middle.exchange(m_front, std::memory_order_acq_rel)
+      };
+      m_front = middle & index_mask;
+    }
+    return m_buffers[m_front];
+  }
+
+  /// Is there a published value that the reader has not read yet?
+  bool has_new() const noexcept
+  {
+    return m_middle.load(std::memory_order_acquire) & is_new_bit;
+  }
+
+  /// Publish the back buffer,
+  /// after which the writer gets a new back buffer.
+  ///
+  /// Only to be called by the writer thread
+  void publish() noexcept
+  {
+    const int middle{
+      m_middle.exchange(m_back | is_new_bit, std::memory_order_acq_rel)
+    };
+    m_back = middle & index_mask;
+  }
+
+private:
+  static constexpr int index_mask{0b011};
+  static constexpr int is_new_bit{0b100};
+
+  std::array<T, 3> m_buffers;
+
+  /// The index of the buffer the writer writes in.
+  /// Only used by the writer thread
+  int m_back{0};
+
+  /// The index of the buffer in between,
+  /// with 'is_new_bit' set if it has not been read yet
+  std::atomic<int> m_middle{1};
+
+  /// The index of the buffer the reader reads from.
+  /// Only used by the reader thread
+  int m_front{2};
+};
+
+/// Test this class
+void test_triple_buffer();
+
+#endif // TRIPLE_BUFFER_H
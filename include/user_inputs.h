@@ -29,7 +29,11 @@ public:
     const std::vector<user_input>& user_inputs = {}
   );
 
-  /// Add a new user input
+  /// Add a new user input.
+  ///
+  /// A mouse move directly after an earlier mouse move
+  /// of the same player replaces that earlier one,
+  /// as only the last cursor position matters
   void add(const user_input& input);
 
   [[nodiscard]] const auto& get_user_inputs() const noexcept { return m_user_inputs; }
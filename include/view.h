@@ -6,8 +6,10 @@
 #include "delta_t.h"
 #include "program_state.h"
 
+#include <SFML/Graphics/RenderTexture.hpp>
 #include <SFML/Window/Event.hpp>
 
+#include <memory>
 #include <optional>
 
 /// The abstract base class of all other views
@@ -22,6 +24,10 @@
 /// menu_view       |The main menu
 /// options_view    |Game settings
 /// played_game_view|View a played game
+///
+/// A view that only changes due to user input
+/// can retain its drawing between frames,
+/// see \link{view::is_retained}.
 class view
 {
 public:
@@ -31,7 +37,10 @@ public:
   /// Clear the next state
   void clear_next_state();
 
-  /// Draw the menu on the main window
+  /// Draw the menu on the main window.
+  ///
+  /// A retained view only draws everything again
+  /// after \link{view::invalidate}
   void draw();
 
   /// The next state to go to, if any
@@ -42,6 +51,21 @@ public:
   /// It can be activated by 'start' and deactivated by 'stop'
   bool is_active() const noexcept { return m_is_active; }
 
+  /// Does this view retain its drawing between frames?
+  ///
+  /// If yes, the view is drawn on a texture,
+  /// that is only drawn again after \link{view::invalidate}
+  bool is_retained() const noexcept { return is_retained_impl(); }
+
+  /// Let the next \link{view::draw} draw everything again,
+  /// e.g. because the view has changed.
+  ///
+  /// Processing a key press, a mouse button press, a resize
+  /// and starting the view does so already.
+  /// A view that changes by other events, e.g. a mouse move
+  /// that selects another item, must call this itself
+  void invalidate() noexcept { m_must_redraw = true; }
+
   /// Process an event
   bool process_event(sf::Event& e);
 
@@ -69,12 +93,24 @@ private:
 
   bool m_is_active{false};
 
+  /// Must a retained view draw everything again?
+  bool m_must_redraw{true};
+
   /// The next state to go to, if any
   std::optional<program_state> m_next_state;
 
+  /// The drawing of a retained view, if any
+  std::unique_ptr<sf::RenderTexture> m_retained_drawing;
+
+  /// Draw the retained drawing, drawing it again if needed
+  void draw_retained();
+
   /// Draw the menu on the main window
   virtual void draw_impl() = 0;
 
+  /// Does this view retain its drawing between frames?
+  virtual bool is_retained_impl() const noexcept { return false; }
+
   /// Process an event
   virtual bool process_event_impl(sf::Event& e) = 0;
 
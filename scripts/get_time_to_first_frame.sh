@@ -0,0 +1,48 @@
+#!/bin/bash
+#
+# Measure the time it takes to load the game,
+# with and without the asset cache,
+# with a cold and a warm page cache.
+#
+# A cold page cache requires 'sudo' to drop the kernel caches.
+#
+# The loading times are appended to 'conquer_chess_error.txt'
+# and shown at the end.
+#
+# Usage:
+#
+#   ./scripts/get_time_to_first_frame.sh
+
+if [[ "$PWD" =~ scripts$ ]]; then
+    echo "FATAL ERROR."
+    echo "Please run the script from the project root. "
+    echo "Present working director: $PWD"
+    echo " "
+    echo "Tip: like this"
+    echo " "
+    echo "  ./scripts/get_time_to_first_frame.sh"
+    echo " "
+    exit 42
+fi
+
+cd build/Desktop-Release
+
+function drop_page_cache {
+  sync
+  echo 3 | sudo tee /proc/sys/vm/drop_caches > /dev/null
+}
+
+echo "1. No asset cache, cold page cache"
+rm -f conquer_chess_assets.cache
+drop_page_cache
+./conquer_chess --no-test --exit_after_loading
+
+echo "2. Asset cache, cold page cache"
+drop_page_cache
+./conquer_chess --no-test --exit_after_loading
+
+echo "3. Asset cache, warm page cache"
+./conquer_chess --no-test --exit_after_loading
+
+echo "Loading times, in the order above:"
+grep -A 2 "Loading time" conquer_chess_error.txt | grep -v -- "--" | tail -n 9
@@ -0,0 +1,88 @@
+/// Conquer Chess headless match server.
+///
+/// Usage:
+///
+///   conquer_chess_server [n_matches] [n_secs] [n_threads] [replay_folder]
+///   conquer_chess_server --soak [n_matches] [n_frames] [n_threads]
+///
+/// The first form hosts matches at the frame rate for a number of seconds,
+/// each played by two local load-generating clients,
+/// saves the replays of the matches in the replay folder, if any,
+/// and writes the load of the server as JSON to stdout.
+///
+/// The second form does the same as fast as possible,
+/// to measure how many matches the server can host,
+/// e.g. 'conquer_chess_server --soak 5000 300 > soak.json'.
+#include "match_server.h"
+#include "metrics.h"
+#include "server_load_client.h"
+
+#include <iostream>
+#include <string>
+
+/// Host matches with load-generating clients
+void run_server(
+  const int n_matches,
+  const int n_frames,
+  const int n_threads,
+  const bool is_real_time,
+  const std::string& replay_folder
+)
+{
+  const server_soak_result r{
+    run_server_soak(n_matches, n_frames, n_threads, is_real_time, replay_folder)
+  };
+  std::cout << "{\n"
+    << "  \"server\": {"
+    << "\"matches\": " << r.get_n_matches() << ", "
+    << "\"threads\": " << r.get_n_threads() << ", "
+    << "\"real_time\": " << (is_real_time ? "true" : "false") << ", "
+    << "\"frames\": " << r.get_n_frames() << ", "
+    << "\"seconds\": " << r.get_n_secs() << ", "
+    << "\"frames_per_second\": " << r.get_frames_per_second() << ", "
+    << "\"late_ticks\": " << r.get_n_late_ticks() << ", "
+    << "\"user_inputs\": " << r.get_n_user_inputs() << ", "
+    << "\"cpu_seconds\": " << r.get_n_cpu_secs() << ", "
+    << "\"match_frame_ms\": " << r.get_match_frame_ms() << ", "
+    << "\"max_match_cpu_seconds\": " << r.get_max_match_cpu_secs()
+    << "}\n}\n"
+  ;
+  save_metrics(get_metrics());
+}
+
+int main(int argc, char* argv[])
+{
+  const std::string usage{
+    std::string("Usage: ") + argv[0] + " [n_matches] [n_secs] [n_threads] [replay_folder]\n"
+    + "       " + argv[0] + " --soak [n_matches] [n_frames] [n_threads]\n"
+  };
+  if (argc > 1 && std::string(argv[1]) == "--soak")
+  {
+    if (argc > 5)
+    {
+      std::cerr << usage;
+      return 1;
+    }
+    run_server(
+      argc >= 3 ? std::stoi(argv[2]) : 1000,
+      argc >= 4 ? std::stoi(argv[3]) : 300,
+      argc == 5 ? std::stoi(argv[4]) : 0,
+      false,
+      ""
+    );
+    return 0;
+  }
+  if (argc > 5)
+  {
+    std::cerr << usage;
+    return 1;
+  }
+  const int n_secs{argc >= 3 ? std::stoi(argv[2]) : 10};
+  run_server(
+    argc >= 2 ? std::stoi(argv[1]) : 1000,
+    static_cast<int>(n_secs * get_default_match_server_frame_rate()),
+    argc >= 4 ? std::stoi(argv[3]) : 0,
+    true,
+    argc == 5 ? argv[4] : ""
+  );
+}
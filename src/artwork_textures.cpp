@@ -2,6 +2,7 @@
 
 #ifndef LOGIC_ONLY
 
+#include "asset_cache.h"
 #include "game_resources.h"
 #include <SFML/Graphics.hpp>
 
@@ -17,7 +18,7 @@ artwork_textures::artwork_textures()
     const auto filename{filename_str.c_str()};
     QFile f(":/resources/textures/artwork/" + filename);
     
-    if (!m_all_races[i].loadFromFile(filename))
+    if (!load_from_file(m_all_races[i], filename))
     {
       auto msg{"Cannot find image file '" + filename + "'"};
       throw std::runtime_error(msg);
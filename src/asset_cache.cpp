@@ -0,0 +1,500 @@
+#include "asset_cache.h"
+
+#include "trace.h"
+
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+/// The first bytes of an asset cache file.
+/// Increase the version number when the file layout changes
+constexpr char asset_cache_magic[8] = {'C', 'C', 'A', 'S', 'S', 'E', 'T', '1'};
+
+/// The header of an asset cache file
+struct asset_cache_file_header
+{
+  char m_magic[8];
+  std::uint64_t m_n_entries;
+};
+
+/// One record in the table of contents of an asset cache file.
+/// The table of contents is followed by the source filenames,
+/// after which the data follows
+struct asset_cache_file_record
+{
+  std::uint64_t m_content_hash;
+  std::uint64_t m_source_size;
+  std::int64_t m_source_time;
+  std::uint32_t m_type;
+  std::uint32_t m_a;
+  std::uint32_t m_b;
+  std::uint32_t m_filename_size;
+  std::uint64_t m_data_offset;
+  std::uint64_t m_data_size;
+};
+
+/// The alignment of the data blocks in an asset cache file
+constexpr std::uint64_t asset_cache_alignment{64};
+
+/// A read-only file that is mapped into memory.
+///
+/// Where memory-mapping is unavailable, the file is read in full
+class memory_mapped_file
+{
+public:
+  explicit memory_mapped_file(const std::string& filename);
+  memory_mapped_file(const memory_mapped_file&) = delete;
+  memory_mapped_file& operator=(const memory_mapped_file&) = delete;
+  ~memory_mapped_file();
+
+  const std::uint8_t * get_data() const noexcept { return m_data; }
+  std::uint64_t get_size() const noexcept { return m_size; }
+
+private:
+  const std::uint8_t * m_data{nullptr};
+  std::uint64_t m_size{0};
+
+  /// The file content, if it could not be memory-mapped
+  std::vector<std::uint8_t> m_buffer;
+};
+
+memory_mapped_file::memory_mapped_file(const std::string& filename)
+{
+#ifndef _WIN32
+  const int fd{::open(filename.c_str(), O_RDONLY)};
+  if (fd < 0) return;
+  struct stat s;
+  if (::fstat(fd, &s) == 0 && s.st_size > 0)
+  {
+    void * const p{::mmap(nullptr, s.st_size, PROT_READ, MAP_PRIVATE, fd, 0)};
+    if (p != MAP_FAILED)
+    {
+      m_data = static_cast<const std::uint8_t*>(p);
+      m_size = s.st_size;
+    }
+  }
+  ::close(fd);
+#else
+  std::ifstream f(filename, std::ios::binary);
+  if (!f) return;
+  m_buffer.assign(
+    std::istreambuf_iterator<char>(f),
+    std::istreambuf_iterator<char>()
+  );
+  m_data = m_buffer.data();
+  m_size = m_buffer.size();
+#endif // _WIN32
+}
+
+memory_mapped_file::~memory_mapped_file()
+{
+#ifndef _WIN32
+  if (m_data)
+  {
+    ::munmap(const_cast<std::uint8_t*>(m_data), m_size);
+  }
+#endif // _WIN32
+}
+
+/// Get the size and last write time of a file.
+/// Returns false if the file does not exist
+bool get_file_size_and_time(
+  const std::string& filename,
+  std::uint64_t& size,
+  std::int64_t& time
+)
+{
+  std::error_code e;
+  size = std::filesystem::file_size(filename, e);
+  if (e) return false;
+  time = std::filesystem::last_write_time(filename, e).time_since_epoch().count();
+  return !e;
+}
+
+asset_cache_entry::asset_cache_entry(
+  const asset_type t,
+  const std::uint32_t a,
+  const std::uint32_t b
+) : m_type{t}, m_a{a}, m_b{b}
+{
+
+}
+
+const std::uint8_t* asset_cache_entry::get_data() const noexcept
+{
+  if (m_mapped_data) return m_mapped_data;
+  return m_owned_data.data();
+}
+
+std::uint64_t asset_cache_entry::get_data_size() const noexcept
+{
+  if (m_mapped_data) return m_mapped_size;
+  return m_owned_data.size();
+}
+
+asset_cache::asset_cache(const std::string& filename)
+  : m_filename{filename}
+{
+  read();
+}
+
+asset_cache::~asset_cache()
+{
+
+}
+
+void asset_cache::add(
+  const std::string& source_filename,
+  const asset_type t,
+  const std::uint32_t a,
+  const std::uint32_t b,
+  std::vector<std::uint8_t> data
+)
+{
+  asset_cache_entry e(t, a, b);
+  get_file_size_and_time(source_filename, e.m_source_size, e.m_source_time);
+  e.m_content_hash = calc_file_hash(source_filename);
+  e.m_owned_data = std::move(data);
+  m_entries[source_filename] = std::move(e);
+  m_is_dirty = true;
+}
+
+std::uint64_t calc_file_hash(const std::string& filename)
+{
+  std::ifstream f(filename, std::ios::binary);
+  std::uint64_t hash{calc_fnv1a_hash(nullptr, 0)};
+  std::vector<char> buffer(1 << 16);
+  while (f)
+  {
+    f.read(buffer.data(), buffer.size());
+    hash = calc_fnv1a_hash(
+      reinterpret_cast<const std::uint8_t*>(buffer.data()),
+      f.gcount(),
+      hash
+    );
+  }
+  return hash;
+}
+
+std::uint64_t calc_fnv1a_hash(
+  const std::uint8_t * const data,
+  const std::uint64_t size,
+  std::uint64_t hash
+) noexcept
+{
+  for (std::uint64_t i{0}; i != size; ++i)
+  {
+    hash ^= data[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+const asset_cache_entry * asset_cache::find(
+  const std::string& source_filename,
+  const asset_type t
+)
+{
+  const auto iter{m_entries.find(source_filename)};
+  if (iter == std::end(m_entries) || iter->second.m_type != t)
+  {
+    ++m_n_misses;
+    return nullptr;
+  }
+  asset_cache_entry& e{iter->second};
+  std::uint64_t size{0};
+  std::int64_t time{0};
+  if (!get_file_size_and_time(source_filename, size, time)
+    || size != e.m_source_size
+  )
+  {
+    ++m_n_misses;
+    return nullptr;
+  }
+  if (time != e.m_source_time)
+  {
+    // The file may only have been touched, e.g. by a fresh checkout
+    if (calc_file_hash(source_filename) != e.m_content_hash)
+    {
+      ++m_n_misses;
+      return nullptr;
+    }
+    e.m_source_time = time;
+    m_is_dirty = true;
+  }
+  ++m_n_hits;
+  return &e;
+}
+
+asset_cache& asset_cache::get()
+{
+  static asset_cache c;
+  return c;
+}
+
+std::string get_default_asset_cache_filename() noexcept
+{
+  return "conquer_chess_assets.cache";
+}
+
+void asset_cache::read()
+{
+  m_entries.clear();
+  m_mapped_file = std::make_unique<memory_mapped_file>(m_filename);
+  const std::uint8_t * const begin{m_mapped_file->get_data()};
+  const std::uint64_t size{m_mapped_file->get_size()};
+  if (!begin || size < sizeof(asset_cache_file_header)) return;
+
+  asset_cache_file_header header;
+  std::memcpy(&header, begin, sizeof(header));
+  if (std::memcmp(header.m_magic, asset_cache_magic, sizeof(asset_cache_magic)) != 0) return;
+
+  const std::uint64_t records_end{
+    sizeof(header) + (header.m_n_entries * sizeof(asset_cache_file_record))
+  };
+  if (header.m_n_entries > size || records_end > size) return;
+
+  std::uint64_t filename_offset{records_end};
+  for (std::uint64_t i{0}; i != header.m_n_entries; ++i)
+  {
+    asset_cache_file_record r;
+    std::memcpy(
+      &r,
+      begin + sizeof(header) + (i * sizeof(asset_cache_file_record)),
+      sizeof(r)
+    );
+    if (filename_offset + r.m_filename_size > size
+      || r.m_data_offset > size
+      || r.m_data_size > size - r.m_data_offset
+    )
+    {
+      // A corrupt cache is the same as no cache
+      m_entries.clear();
+      return;
+    }
+    const std::string source_filename(
+      reinterpret_cast<const char*>(begin + filename_offset),
+      r.m_filename_size
+    );
+    filename_offset += r.m_filename_size;
+
+    asset_cache_entry e(static_cast<asset_type>(r.m_type), r.m_a, r.m_b);
+    e.m_content_hash = r.m_content_hash;
+    e.m_source_size = r.m_source_size;
+    e.m_source_time = r.m_source_time;
+    e.m_mapped_data = begin + r.m_data_offset;
+    e.m_mapped_size = r.m_data_size;
+    m_entries[source_filename] = std::move(e);
+  }
+}
+
+void asset_cache::save()
+{
+  if (!m_is_dirty) return;
+  write();
+
+  // Map the new file, so that no entry owns its data anymore
+  read();
+  m_is_dirty = false;
+}
+
+void asset_cache::write() const
+{
+  const std::string tmp_filename{m_filename + ".tmp"};
+  {
+    std::ofstream f(tmp_filename, std::ios::binary);
+    asset_cache_file_header header;
+    std::memcpy(header.m_magic, asset_cache_magic, sizeof(asset_cache_magic));
+    header.m_n_entries = m_entries.size();
+    f.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::uint64_t data_offset{
+      sizeof(header) + (m_entries.size() * sizeof(asset_cache_file_record))
+    };
+    for (const auto& p: m_entries) data_offset += p.first.size();
+
+    for (const auto& p: m_entries)
+    {
+      const asset_cache_entry& e{p.second};
+      data_offset = (data_offset + asset_cache_alignment - 1)
+        / asset_cache_alignment * asset_cache_alignment
+      ;
+      asset_cache_file_record r;
+      r.m_content_hash = e.m_content_hash;
+      r.m_source_size = e.m_source_size;
+      r.m_source_time = e.m_source_time;
+      r.m_type = static_cast<std::uint32_t>(e.m_type);
+      r.m_a = e.m_a;
+      r.m_b = e.m_b;
+      r.m_filename_size = p.first.size();
+      r.m_data_offset = data_offset;
+      r.m_data_size = e.get_data_size();
+      f.write(reinterpret_cast<const char*>(&r), sizeof(r));
+      data_offset += r.m_data_size;
+    }
+    for (const auto& p: m_entries)
+    {
+      f.write(p.first.data(), p.first.size());
+    }
+    for (const auto& p: m_entries)
+    {
+      const asset_cache_entry& e{p.second};
+      const std::uint64_t pos = f.tellp();
+      const std::uint64_t aligned_pos{
+        (pos + asset_cache_alignment - 1)
+        / asset_cache_alignment * asset_cache_alignment
+      };
+      const std::vector<char> padding(aligned_pos - pos, '\0');
+      f.write(padding.data(), padding.size());
+      f.write(reinterpret_cast<const char*>(e.get_data()), e.get_data_size());
+    }
+  }
+  std::error_code e;
+  std::filesystem::rename(tmp_filename, m_filename, e);
+  if (e)
+  {
+    // Keep the old cache file, the next run will try again
+    std::filesystem::remove(tmp_filename, e);
+  }
+}
+
+#ifndef LOGIC_ONLY
+
+bool load_from_file(sf::Texture& texture, const std::string& filename)
+{
+  const trace_scope scope("load_from_file texture");
+  asset_cache& c{asset_cache::get()};
+  if (const asset_cache_entry * const e{c.find(filename, asset_type::texture)})
+  {
+    assert(e->get_data_size() == 4ull * e->get_a() * e->get_b());
+    if (!texture.create(e->get_a(), e->get_b())) return false;
+    texture.update(e->get_data());
+    return true;
+  }
+  sf::Image image;
+  if (!image.loadFromFile(filename)) return false;
+  if (!texture.loadFromImage(image)) return false;
+  const auto size{image.getSize()};
+  const std::uint8_t * const pixels{image.getPixelsPtr()};
+  c.add(
+    filename,
+    asset_type::texture,
+    size.x,
+    size.y,
+    std::vector<std::uint8_t>(pixels, pixels + (4ull * size.x * size.y))
+  );
+  return true;
+}
+
+bool load_from_file(sf::SoundBuffer& buffer, const std::string& filename)
+{
+  const trace_scope scope("load_from_file sound");
+  asset_cache& c{asset_cache::get()};
+  if (const asset_cache_entry * const e{c.find(filename, asset_type::sound)})
+  {
+    return buffer.loadFromSamples(
+      reinterpret_cast<const sf::Int16*>(e->get_data()),
+      e->get_data_size() / sizeof(sf::Int16),
+      e->get_a(),
+      e->get_b()
+    );
+  }
+  if (!buffer.loadFromFile(filename)) return false;
+  const auto samples{
+    reinterpret_cast<const std::uint8_t*>(buffer.getSamples())
+  };
+  c.add(
+    filename,
+    asset_type::sound,
+    buffer.getChannelCount(),
+    buffer.getSampleRate(),
+    std::vector<std::uint8_t>(
+      samples,
+      samples + (buffer.getSampleCount() * sizeof(sf::Int16))
+    )
+  );
+  return true;
+}
+
+#endif // LOGIC_ONLY
+
+void test_asset_cache()
+{
+#ifndef NDEBUG
+  // calc_fnv1a_hash
+  {
+    // From the FNV-1a test vectors
+    assert(calc_fnv1a_hash(nullptr, 0) == 14695981039346656037ull);
+    const std::uint8_t a{'a'};
+    assert(calc_fnv1a_hash(&a, 1) == 0xaf63dc4c8601ec8cull);
+  }
+  const std::string cache_filename{"tmp_asset_cache.cache"};
+  const std::string source_filename{"tmp_asset_cache_source.txt"};
+  std::filesystem::remove(cache_filename);
+  {
+    std::ofstream f(source_filename);
+    f << "Some content";
+  }
+  // A new cache is empty
+  {
+    asset_cache c(cache_filename);
+    assert(c.get_n_entries() == 0);
+    assert(!c.is_dirty());
+    assert(!c.find(source_filename, asset_type::texture));
+    assert(c.get_n_misses() == 1);
+  }
+  // Adding makes the cache dirty, saving makes it clean
+  {
+    asset_cache c(cache_filename);
+    c.add(source_filename, asset_type::texture, 1, 2, {1, 2, 3, 4, 5, 6, 7, 8});
+    assert(c.is_dirty());
+    c.save();
+    assert(!c.is_dirty());
+    assert(std::filesystem::exists(cache_filename));
+  }
+  // An entry can be found in a saved cache
+  {
+    asset_cache c(cache_filename);
+    assert(c.get_n_entries() == 1);
+    const asset_cache_entry * const e{c.find(source_filename, asset_type::texture)};
+    assert(e);
+    assert(c.get_n_hits() == 1);
+    assert(e->get_a() == 1);
+    assert(e->get_b() == 2);
+    assert(e->get_data_size() == 8);
+    assert(e->get_data()[7] == 8);
+    assert(e->get_content_hash() == calc_file_hash(source_filename));
+    // Wrong type
+    assert(!c.find(source_filename, asset_type::sound));
+  }
+  // A changed source file makes the entry stale
+  {
+    {
+      std::ofstream f(source_filename);
+      f << "Some other content";
+    }
+    asset_cache c(cache_filename);
+    assert(!c.find(source_filename, asset_type::texture));
+  }
+  // A corrupt cache file is the same as no cache file
+  {
+    {
+      std::ofstream f(cache_filename, std::ios::binary);
+      f << "CCASSET1 and nonsense";
+    }
+    asset_cache c(cache_filename);
+    assert(c.get_n_entries() == 0);
+  }
+  std::filesystem::remove(cache_filename);
+  std::filesystem::remove(source_filename);
+#endif // NDEBUG
+}
@@ -0,0 +1,277 @@
+#include "benchmark.h"
+
+#include "action_history.h"
+#include "chess_move.h"
+#include "fen_string.h"
+#include "game.h"
+#include "pgn_game_string.h"
+#include "pgn_move_string.h"
+#include "pieces.h"
+#include "replay.h"
+#include "square.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+/// Written to by the benchmarks,
+/// so that the compiler cannot optimize the work away
+volatile int benchmark_sink{0};
+
+} // ~namespace
+
+benchmark_result::benchmark_result(
+  const std::string& name,
+  const int n_iterations,
+  const std::vector<double>& ns_per_iteration
+) : m_name{name},
+    m_n_iterations{n_iterations},
+    m_ns_per_iteration{ns_per_iteration}
+{
+  assert(m_n_iterations > 0);
+  assert(!m_ns_per_iteration.empty());
+}
+
+double benchmark_result::get_min_ns() const noexcept
+{
+  return *std::min_element(
+    std::begin(m_ns_per_iteration),
+    std::end(m_ns_per_iteration)
+  );
+}
+
+double benchmark_result::get_median_ns() const noexcept
+{
+  std::vector<double> v{m_ns_per_iteration};
+  std::sort(std::begin(v), std::end(v));
+  return v[v.size() / 2];
+}
+
+std::vector<starting_position_type> get_benchmark_starting_positions() noexcept
+{
+  return
+  {
+    starting_position_type::standard,
+    starting_position_type::kasparov_vs_topalov,
+    starting_position_type::pawn_all_out_assault,
+    starting_position_type::bishop_and_knight_end_game,
+    starting_position_type::queen_end_game
+  };
+}
+
+benchmark_result run_benchmark(
+  const std::string& name,
+  const std::function<void()>& f,
+  const double min_run_time_secs,
+  const int n_runs
+)
+{
+  assert(min_run_time_secs >= 0.0);
+  assert(n_runs > 0);
+  using clock = std::chrono::steady_clock;
+  const auto run{
+    [&f](const int n_iterations)
+    {
+      const auto start{clock::now()};
+      for (int i{0}; i != n_iterations; ++i) f();
+      return std::chrono::duration<double>(clock::now() - start).count();
+    }
+  };
+
+  // Calibrate
+  int n_iterations{1};
+  while (run(n_iterations) < min_run_time_secs)
+  {
+    n_iterations *= 2;
+  }
+
+  std::vector<double> ns_per_iteration;
+  ns_per_iteration.reserve(n_runs);
+  for (int i{0}; i != n_runs; ++i)
+  {
+    ns_per_iteration.push_back(run(n_iterations) * 1.0e9 / n_iterations);
+  }
+  return benchmark_result(name, n_iterations, ns_per_iteration);
+}
+
+std::vector<benchmark_result> run_all_benchmarks(
+  const std::string& filter,
+  const double min_run_time_secs,
+  const int n_runs
+)
+{
+  std::vector<benchmark_result> results;
+  const auto add{
+    [&](const std::string& name, const std::function<void()>& f)
+    {
+      if (name.find(filter) == std::string::npos) return;
+      results.push_back(run_benchmark(name, f, min_run_time_secs, n_runs));
+    }
+  };
+
+  for (const auto t: get_benchmark_starting_positions())
+  {
+    const game g{create_game_with_starting_position(t)};
+    const std::string position{to_str(t)};
+
+    add(
+      "collect_all_piece_actions/" + position,
+      [&g]() { benchmark_sink += collect_all_piece_actions(g).size(); }
+    );
+    add(
+      "is_square_attacked/" + position,
+      [&g]()
+      {
+        for (int x{0}; x != 8; ++x)
+        {
+          for (int y{0}; y != 8; ++y)
+          {
+            for (const auto c: get_all_chess_colors())
+            {
+              benchmark_sink += is_square_attacked(g.get_pieces(), square(x, y), c);
+            }
+          }
+        }
+      }
+    );
+    add(
+      "game::tick/" + position,
+      [&g]()
+      {
+        game h{g};
+        h.tick(delta_t(0.1));
+        benchmark_sink += h.get_pieces().size();
+      }
+    );
+    add(
+      "to_fen_string/" + position,
+      [&g]() { benchmark_sink += to_fen_string(g).get().size(); }
+    );
+    add(
+      "is_checkmate/" + position,
+      [&g]()
+      {
+        for (const auto c: get_all_chess_colors())
+        {
+          benchmark_sink += is_checkmate(g.get_pieces(), c);
+        }
+      }
+    );
+  }
+
+  // The same position is asked about for each move
+  const fen_string standard_fen{create_fen_string_of_standard_starting_position()};
+  const std::vector<pgn_move_string> standard_moves{
+    pgn_move_string("e4"),
+    pgn_move_string("d3"),
+    pgn_move_string("Nc3"),
+    pgn_move_string("Nf3")
+  };
+  add(
+    "chess_move/first_moves",
+    [&standard_fen, &standard_moves]()
+    {
+      for (const auto& m: standard_moves)
+      {
+        benchmark_sink += chess_move(m, standard_fen).get_from().value().get_x();
+      }
+    }
+  );
+
+  // The PGN of replay 1 cannot be parsed yet
+  const pgn_game_string pgn{get_scholars_mate_as_pgn_str()};
+  add(
+    "create_action_history_from_pgn/scholars_mate",
+    [&pgn]() { benchmark_sink += create_action_history_from_pgn(pgn).get().size(); }
+  );
+  add(
+    "extract_game_statistics_in_time/scholars_mate",
+    [&pgn]()
+    {
+      const replay r(create_action_history_from_pgn(pgn));
+      benchmark_sink += extract_game_statistics_in_time(r, delta_t(0.2)).get().size();
+    }
+  );
+  return results;
+}
+
+std::string to_json(const std::vector<benchmark_result>& results)
+{
+  std::stringstream s;
+  s << std::fixed << std::setprecision(1)
+    << "{\n"
+    << "  \"compiled_in_debug_mode\": "
+    #ifndef NDEBUG
+    << "true"
+    #else
+    << "false"
+    #endif
+    << ",\n"
+    << "  \"benchmarks\": ["
+  ;
+  bool is_first{true};
+  for (const auto& r: results)
+  {
+    if (!is_first) s << ',';
+    is_first = false;
+    s << "\n    {"
+      << "\"name\": \"" << r.get_name() << "\", "
+      << "\"iterations\": " << r.get_n_iterations() << ", "
+      << "\"runs\": " << r.get_ns_per_iteration().size() << ", "
+      << "\"min_ns\": " << r.get_min_ns() << ", "
+      << "\"median_ns\": " << r.get_median_ns()
+      << "}"
+    ;
+  }
+  s << "\n  ]\n}\n";
+  return s.str();
+}
+
+void test_benchmark()
+{
+#ifndef NDEBUG
+  // benchmark_result
+  {
+    const benchmark_result r("a", 1, { 3.0, 1.0, 2.0 });
+    assert(r.get_name() == "a");
+    assert(r.get_n_iterations() == 1);
+    assert(r.get_min_ns() == 1.0);
+    assert(r.get_median_ns() == 2.0);
+  }
+  // run_benchmark
+  {
+    int n{0};
+    const auto r{run_benchmark("count", [&n]() { ++n; }, 0.0, 3)};
+    assert(r.get_n_iterations() == 1);
+    assert(r.get_ns_per_iteration().size() == 3);
+    assert(n == 4); // 1 for calibration, 3 runs
+  }
+  // to_json
+  {
+    const std::string s{to_json( { benchmark_result("a", 1, { 1.0 }) } )};
+    assert(s.find("\"benchmarks\"") != std::string::npos);
+    assert(s.find("\"name\": \"a\"") != std::string::npos);
+  }
+#endif // NDEBUG
+}
+
+void test_benchmark_long()
+{
+#ifndef NDEBUG
+  // run_all_benchmarks, with a filter
+  {
+    const auto results{run_all_benchmarks("to_fen_string/kasparov", 0.0, 1)};
+    assert(results.size() == 1);
+    assert(results[0].get_name() == "to_fen_string/kasparov_vs_topalov");
+  }
+  // run_all_benchmarks, all benchmarks of a position are present
+  {
+    const auto results{run_all_benchmarks("/standard", 0.0, 1)};
+    assert(results.size() == 5);
+  }
+#endif // NDEBUG
+}
@@ -0,0 +1,75 @@
+#include "board_background.h"
+
+#ifndef LOGIC_ONLY
+
+#include "board_layout.h"
+#include "draw.h"
+#include "draw_board.h"
+#include "game_resources.h"
+#include "game_view_layout.h"
+#include "metrics.h"
+#include "render_window.h"
+#include "trace.h"
+
+#include <SFML/Graphics/Sprite.hpp>
+
+#include <cassert>
+
+bool board_background::compose(const game_view_layout& layout, const race map_race)
+{
+  const trace_scope scope("board_background::compose");
+  static metric_counter& n_composes{
+    get_metrics().get_counter("board_background_composes")
+  };
+  const screen_rect& background{layout.get_background()};
+  const int width{background.get_br().get_x()};
+  const int height{background.get_br().get_y()};
+  assert(width > 0);
+  assert(height > 0);
+
+  m_texture = std::make_unique<sf::RenderTexture>();
+  if (!m_texture->create(width, height))
+  {
+    m_texture.reset();
+    return false;
+  }
+  m_texture->clear(sf::Color::Transparent);
+
+  // Use the regular drawing functions, drawing on the texture
+  render_window& w{get_render_window()};
+  w.set_draw_target(m_texture.get());
+  draw_texture(get_map_texture(map_race), background);
+  draw_squares(layout.get_board());
+  w.set_draw_target(nullptr);
+  m_texture->display();
+
+  m_background_rect = background;
+  m_board_rect = layout.get_board().get_board();
+  m_race = map_race;
+  n_composes.add();
+  return true;
+}
+
+void board_background::draw(const game_view_layout& layout, const race map_race)
+{
+  const trace_scope scope("board_background::draw");
+  if (
+    !m_texture
+    || m_background_rect != layout.get_background()
+    || m_board_rect != layout.get_board().get_board()
+    || m_race != map_race
+  )
+  {
+    if (!compose(layout, map_race))
+    {
+      // Cannot use a texture, so draw the parts one by one
+      draw_texture(get_map_texture(map_race), layout.get_background());
+      draw_squares(layout.get_board());
+      return;
+    }
+  }
+  assert(m_texture);
+  get_render_window().draw(sf::Sprite(m_texture->getTexture()));
+}
+
+#endif // LOGIC_ONLY
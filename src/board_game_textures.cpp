@@ -2,6 +2,8 @@
 
 #ifndef LOGIC_ONLY
 
+#include "asset_cache.h"
+
 #include <cassert>
 
 board_game_textures::board_game_textures()
@@ -23,7 +25,7 @@ board_game_textures::board_game_textures()
   for (const auto& p: v)
   {
     const auto filename{std::string("resources/textures/board_game/") + p.second.c_str()};
-    if (!p.first.get().loadFromFile(filename))
+    if (!load_from_file(p.first.get(), filename))
     {
       auto msg{"Cannot find image file '" + filename + "'"};
       throw std::runtime_error(msg);
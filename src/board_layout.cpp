@@ -40,17 +40,16 @@ board_layout::board_layout(const screen_rect& r)
     }
   }
 
-  m_rects.resize(8);
   for (int y = 0; y != 8; ++y)
   {
-    m_rects[y].resize(8);
     for (int x = 0; x != 8; ++x)
     {
       const screen_rect square_rect{
         screen_coordinate(xs[x], ys[y]),
         screen_coordinate(xs[x + 1], ys[y + 1])
       };
-      m_rects[y][x] = square_rect;
+      m_squares[get_square_index(x, y)] = square_layout(square_rect);
+      m_centers[get_square_index(x, y)] = get_center(square_rect);
     }
   }
 }
@@ -77,9 +76,16 @@ const square_layout& board_layout::get_square(const int x, const int y) const
   assert(x < 8);
   assert(y >= 0);
   assert(y < 8);
-  assert(m_rects.size() == 8);
-  assert(m_rects[y].size() == 8);
-  return m_rects[y][x];
+  return m_squares[get_square_index(x, y)];
+}
+
+const screen_coordinate& board_layout::get_square_center(const int x, const int y) const
+{
+  assert(x >= 0);
+  assert(x < 8);
+  assert(y >= 0);
+  assert(y < 8);
+  return m_centers[get_square_index(x, y)];
 }
 
 
@@ -111,6 +117,26 @@ void test_board_layout()
     assert(get_width(layout.get_board()) == 64);
     assert(get_height(layout.get_board()) == 64);
   }
+  // get_squares and get_square_center
+  {
+    const board_layout layout(
+      screen_rect(
+        screen_coordinate(0, 0),
+        screen_coordinate(64, 64)
+      )
+    );
+    assert(layout.get_squares().size() == 64);
+    for (int x{0}; x != 8; ++x)
+    {
+      for (int y{0}; y != 8; ++y)
+      {
+        const auto& s{layout.get_square(x, y)};
+        assert(&layout.get_squares()[get_square_index(x, y)] == &s);
+        assert(layout.get_square_center(x, y) == get_center(s.get_square()));
+      }
+    }
+    assert(layout.get_square_center(0, 0) == screen_coordinate(4, 4));
+  }
   // All squares have the same width and height, #152
   {
     const screen_coordinate tl(618, 40);
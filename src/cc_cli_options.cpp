@@ -14,6 +14,16 @@ cc_cli_options::cc_cli_options(const std::vector<std::string>& args) :
   if (n_args) m_conquer_chess_exe_path = args[0];
   for (int i{1}; i<n_args; ++i)
   {
+    if (args[i] == "--trace")
+    {
+      if (i + 1 == n_args)
+      {
+        throw std::logic_error("CLI argument '--trace' must be followed by a filename");
+      }
+      m_trace_filename = args[i + 1];
+      ++i;
+      continue;
+    }
     if (!is_valid_cli_arg(args[i]))
     {
       std::stringstream s;
@@ -40,14 +50,23 @@ cc_cli_options::cc_cli_options(const std::vector<std::string>& args) :
   if (do_test) m_do_test = true;
   if (do_not_test) m_do_test = false;
 
+  const bool do_long_test = std::count(std::begin(args), std::end(args), "--long-tests");
+  if (do_long_test) m_do_long_test = true;
+
   const bool do_assert_to_log = std::count(std::begin(args), std::end(args), "--assert_to_log");
   if (do_assert_to_log) m_do_assert_to_log = true;
 
+  const bool do_exit_after_loading = std::count(std::begin(args), std::end(args), "--exit_after_loading");
+  if (do_exit_after_loading) m_do_exit_after_loading = true;
+
   const bool do_play_standard_random_game = std::count(std::begin(args), std::end(args), "--play_standard_random_game");
   if (do_play_standard_random_game) m_do_play_standard_random_game = true;
 
   const bool do_show_debug_info = std::count(std::begin(args), std::end(args), "--show_debug_info");
   if (do_show_debug_info) m_do_show_debug_info = true;
+
+  const bool do_use_vsync = std::count(std::begin(args), std::end(args), "--vsync");
+  if (do_use_vsync) m_do_use_vsync = true;
 }
 
 std::vector<std::string> collect_args(int argc, char **argv)
@@ -61,12 +80,16 @@ std::vector<std::string> get_all_cli_args() noexcept
   return
   {
     "--assert_to_log",
+    "--exit_after_loading",
+    "--long-tests",
     "--no-test",
     "--no-profile",
     "--play_standard_random_game",
     "--profile",
     "--show_debug_info",
-    "--test"
+    "--test",
+    "--trace",
+    "--vsync"
   };
 }
 
@@ -104,6 +127,20 @@ void test_cli_options()
     const cc_cli_options options_2( { "--assert_to_log" } );
     assert(options_2.get_do_assert_to_log());
   }
+  // --exit_after_loading
+  {
+    const cc_cli_options options_1;
+    assert(!options_1.get_do_exit_after_loading());
+    const cc_cli_options options_2( { "--exit_after_loading" } );
+    assert(options_2.get_do_exit_after_loading());
+  }
+  // --long-tests
+  {
+    const cc_cli_options options_1;
+    assert(!options_1.get_do_long_test());
+    const cc_cli_options options_2( { "conquer_chess", "--long-tests" } );
+    assert(options_2.get_do_long_test());
+  }
   // --play_standard_random_game
   {
     const cc_cli_options options_1;
@@ -125,6 +162,35 @@ void test_cli_options()
     const cc_cli_options options_2( { "--no-test" } );
     assert(!options_2.get_do_test());
   }
+  // --trace
+  {
+    const cc_cli_options options_1;
+    assert(options_1.get_trace_filename().empty());
+    const cc_cli_options options_2( { "conquer_chess", "--trace", "trace.json" } );
+    assert(options_2.get_trace_filename() == "trace.json");
+    const cc_cli_options options_3( { "conquer_chess", "--trace", "--test" } );
+    assert(options_3.get_trace_filename() == "--test");
+  }
+  // --trace without a filename
+  {
+    bool has_thrown{false};
+    try
+    {
+      const cc_cli_options options( { "conquer_chess", "--trace" } );
+    }
+    catch (std::logic_error& e)
+    {
+      has_thrown = true;
+    }
+    assert(has_thrown);
+  }
+  // --vsync
+  {
+    const cc_cli_options options_1;
+    assert(!options_1.get_do_use_vsync());
+    const cc_cli_options options_2( { "--vsync" } );
+    assert(options_2.get_do_use_vsync());
+  }
   // get_conquer_chess_exe_path
   {
     const cc_cli_options options_1;
@@ -151,7 +217,11 @@ void test_cli_options()
     assert(is_valid_cli_arg("--test"));
     assert(is_valid_cli_arg("--no-test"));
     assert(is_valid_cli_arg("--assert_to_log"));
+    assert(is_valid_cli_arg("--exit_after_loading"));
+    assert(is_valid_cli_arg("--long-tests"));
     assert(is_valid_cli_arg("--show_debug_info"));
+    assert(is_valid_cli_arg("--vsync"));
+    assert(is_valid_cli_arg("--trace"));
   }
   // operator<<
   {
@@ -170,10 +240,14 @@ std::ostream& operator<<(std::ostream& os, const cc_cli_options& options) noexce
     << "Raw CLI arguments: " << to_comma_seperated_str(options.m_args) << '\n'
     << "Compiled in debug mode: " << bool_to_str(options.m_compiled_in_debug_move) << '\n'
     << "Redirect assert output to log: " << bool_to_str(options.m_do_assert_to_log) << '\n'
+    << "Exit after loading: " << bool_to_str(options.m_do_exit_after_loading) << '\n'
     << "Play a standard random game: " << bool_to_str(options.m_do_play_standard_random_game) << '\n'
     << "Show debug info at startup: " << bool_to_str(options.m_do_show_debug_info) << '\n'
     << "Run a run-time speed profile: " << bool_to_str(options.m_do_profile) << '\n'
-    << "Run all tests: " << bool_to_str(options.m_do_test)
+    << "Run all tests: " << bool_to_str(options.m_do_test) << '\n'
+    << "Run the long tests: " << bool_to_str(options.m_do_long_test) << '\n'
+    << "Use vsync: " << bool_to_str(options.m_do_use_vsync) << '\n'
+    << "Trace to file: " << options.m_trace_filename
   ;
   return os;
 }
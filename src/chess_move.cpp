@@ -1,5 +1,6 @@
 #include "chess_move.h"
 #include "game.h"
+#include "fen_position_cache.h"
 #include "fen_string.h"
 #include <cassert>
 #include <iostream>
@@ -81,20 +82,20 @@ square get_from_for_bishop(const fen_string& s, const pgn_move_string& m)
 {
   assert(get_piece_type(m).has_value());
   assert(get_piece_type(m).value() == piece_type::bishop);
-  const auto g{create_game_from_fen_string(s)};
-  const auto pieces{
-    find_pieces(g, piece_type::bishop, get_color(s))
+  const fen_position position{get_fen_position_cache().get(s)};
+  const auto squares{
+    position.get_squares(piece_type::bishop, position.get_active_color())
   };
-  assert(!pieces.empty());
+  assert(!squares.empty());
   assert(get_square(m).has_value());
   const square target{get_to(m).value()};
 
   std::optional<square> from_square;
-  for (const auto& piece: pieces)
+  for (const auto& sq: squares)
   {
-    if (are_on_same_diagonal(piece.get_current_square(), target))
+    if (are_on_same_diagonal(sq, target))
     {
-      from_square = piece.get_current_square();
+      from_square = sq;
       break;
     }
   }
@@ -106,33 +107,33 @@ square get_from_for_king(const fen_string& s, const pgn_move_string& m)
 {
   assert(get_piece_type(m).has_value());
   assert(get_piece_type(m).value() == piece_type::king);
-  const auto g{create_game_from_fen_string(s)};
-  const auto pieces{
-    find_pieces(g, piece_type::king, get_color(s))
+  const fen_position position{get_fen_position_cache().get(s)};
+  const auto squares{
+    position.get_squares(piece_type::king, position.get_active_color())
   };
-  assert(!pieces.empty());
-  assert(pieces.size() == 1); // There is only 1 king
-  return pieces[0].get_current_square();
+  assert(!squares.empty());
+  assert(squares.size() == 1); // There is only 1 king
+  return squares[0];
 }
 
 square get_from_for_knight(const fen_string& s, const pgn_move_string& m)
 {
   assert(get_piece_type(m).has_value());
   assert(get_piece_type(m).value() == piece_type::knight);
-  const auto g{create_game_from_fen_string(s)};
-  const auto pieces{
-    find_pieces(g, piece_type::knight, get_color(s))
+  const fen_position position{get_fen_position_cache().get(s)};
+  const auto squares{
+    position.get_squares(piece_type::knight, position.get_active_color())
   };
-  assert(!pieces.empty());
+  assert(!squares.empty());
   assert(get_to(m).has_value());
   const square target{get_to(m).value()};
 
   std::optional<square> from_square;
-  for (const auto& piece: pieces)
+  for (const auto& sq: squares)
   {
-    if (are_adjacent_for_knight(piece.get_current_square(), target))
+    if (are_adjacent_for_knight(sq, target))
     {
-      from_square = piece.get_current_square();
+      from_square = sq;
       break;
     }
   }
@@ -144,21 +145,21 @@ square get_from_for_pawn(const fen_string& s, const pgn_move_string& m)
 {
   assert(get_piece_type(m).has_value());
   assert(get_piece_type(m).value() == piece_type::pawn);
-  const auto g{create_game_from_fen_string(s)};
+  const fen_position position{get_fen_position_cache().get(s)};
   assert(!is_capture(m));
   const square one_behind{
-    get_behind(get_to(m).value(), get_color(s))
+    get_behind(get_to(m).value(), position.get_active_color())
   };
-  if (is_piece_at(g, one_behind))
+  if (position.is_piece_at(one_behind))
   {
     // Pawns cannot jump, so if there is a pawn one behind the target square,
     // it must be from there
-    assert(get_piece_at(g, one_behind).get_type() == piece_type::pawn);
+    assert(position.get_piece_at(one_behind).value().second == piece_type::pawn);
     return one_behind;
   }
-  const square two_behind{get_behind(one_behind, get_color(s))};
-  assert(is_piece_at(g, two_behind));
-  assert(get_piece_at(g, two_behind).get_type() == piece_type::pawn);
+  const square two_behind{get_behind(one_behind, position.get_active_color())};
+  assert(position.is_piece_at(two_behind));
+  assert(position.get_piece_at(two_behind).value().second == piece_type::pawn);
   return two_behind;
 }
 
@@ -166,27 +167,24 @@ square get_from_for_queen(const fen_string& s, const pgn_move_string& m)
 {
   assert(get_piece_type(m).has_value());
   assert(get_piece_type(m).value() == piece_type::queen);
-  const auto g{create_game_from_fen_string(s)};
-  assert(!g.get_pieces().empty());
-
-
-  const auto pieces{
-    find_pieces(g, piece_type::queen, get_color(s))
+  const fen_position position{get_fen_position_cache().get(s)};
+  const auto squares{
+    position.get_squares(piece_type::queen, position.get_active_color())
   };
 
-  assert(!pieces.empty());
+  assert(!squares.empty());
   assert(get_to(m).has_value());
   const square target{get_to(m).value()};
 
   std::optional<square> from_square;
-  for (const auto& piece: pieces)
+  for (const auto& sq: squares)
   {
-    if (are_on_same_diagonal(piece.get_current_square(), target)
-      || are_on_same_rank(piece.get_current_square(), target)
-      || are_on_same_file(piece.get_current_square(), target)
+    if (are_on_same_diagonal(sq, target)
+      || are_on_same_rank(sq, target)
+      || are_on_same_file(sq, target)
     )
     {
-      from_square = piece.get_current_square();
+      from_square = sq;
       break;
     }
   }
@@ -200,22 +198,22 @@ square get_from_for_rook(const fen_string& s, const pgn_move_string& m)
 {
   assert(get_piece_type(m).has_value());
   assert(get_piece_type(m).value() == piece_type::rook);
-  const auto g{create_game_from_fen_string(s)};
-  const auto pieces{
-    find_pieces(g, piece_type::rook, get_color(s))
+  const fen_position position{get_fen_position_cache().get(s)};
+  const auto squares{
+    position.get_squares(piece_type::rook, position.get_active_color())
   };
-  assert(!pieces.empty());
+  assert(!squares.empty());
   assert(get_to(m).has_value());
   const square target{get_to(m).value()};
 
   std::optional<square> from_square;
-  for (const auto& piece: pieces)
+  for (const auto& sq: squares)
   {
-    if (are_on_same_rank(piece.get_current_square(), target)
-      || are_on_same_file(piece.get_current_square(), target)
+    if (are_on_same_rank(sq, target)
+      || are_on_same_file(sq, target)
     )
     {
-      from_square = piece.get_current_square();
+      from_square = sq;
       break;
     }
   }
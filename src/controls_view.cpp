@@ -158,6 +158,7 @@ bool controls_view::process_event_impl(sf::Event& event)
     const auto mouse_screen_pos{
       screen_coordinate(event.mouseMove.x, event.mouseMove.y)
     };
+    const auto selected_before{m_selected};
     if (is_in(mouse_screen_pos, m_layout.get_action_1_value())) m_selected = controls_view_item::action_1;
     if (is_in(mouse_screen_pos, m_layout.get_action_2_value())) m_selected = controls_view_item::action_2;
     if (is_in(mouse_screen_pos, m_layout.get_action_3_value())) m_selected = controls_view_item::action_3;
@@ -169,6 +170,7 @@ bool controls_view::process_event_impl(sf::Event& event)
     if (is_in(mouse_screen_pos, m_layout.get_next_value())) m_selected = controls_view_item::next_action;
     if (is_in(mouse_screen_pos, m_layout.get_right_value())) m_selected = controls_view_item::right;
     if (is_in(mouse_screen_pos, m_layout.get_up_value())) m_selected = controls_view_item::up;
+    if (m_selected != selected_before) invalidate();
   }
   else if (event.type == sf::Event::MouseButtonPressed)
   {
@@ -2,24 +2,27 @@
 
 #include "cc_cli_options.h"
 
+#include <cassert>
 #include <chrono>
+#include <filesystem>
 #include <fstream>
-#include <ios>
+#include <sstream>
 
 diagnostics_file::diagnostics_file(
-  const std::string filename
-) : m_filename{filename}
+  diagnostics_log& log
+) : m_log{&log}
 {
 
 }
 
 void diagnostics_file::add_cli_options(const cc_cli_options& options)
 {
-  std::ofstream f(m_filename, std::ios::app); // Append
-  f
+  std::stringstream s;
+  s
     << "---------------------------------------------------------------" << '\n'
     << options << '\n'
   ;
+  add_lines(s.str());
 }
 
 void diagnostics_file::add_footer()
@@ -27,10 +30,11 @@ void diagnostics_file::add_footer()
   const auto now = std::chrono::system_clock::now();
   const std::time_t now_time = std::chrono::system_clock::to_time_t(now);
 
-  std::ofstream f(m_filename, std::ios::app); // Append
-  f
+  std::stringstream s;
+  s
     << "Game ended successfully at " << std::ctime(&now_time) << '\n'
   ;
+  add_lines(s.str());
 }
 
 void diagnostics_file::add_header()
@@ -38,25 +42,81 @@ void diagnostics_file::add_header()
   const auto now = std::chrono::system_clock::now();
   const std::time_t now_time = std::chrono::system_clock::to_time_t(now);
 
-  std::ofstream f(m_filename, std::ios::app); // Append
-  f
-    << " " << '\n'
+  std::stringstream s;
+  s
     << "===============================================================" << '\n'
     << "Conquer Chess log file." << '\n'
     << "Compile date: " << __DATE__ << '\n'
     << "Compile time: " << __TIME__ << '\n'
     << "Current time and date: " << std::ctime(&now_time) << '\n'
   ;
+  add_lines(s.str());
+}
+
+void diagnostics_file::add_lines(const std::string& text)
+{
+  std::stringstream s(text);
+  std::string line;
+  while (std::getline(s, line))
+  {
+    if (line.empty()) continue;
+    m_log->add(log_severity::info, line);
+  }
+}
+
+void diagnostics_file::add_loading_time(
+  const double seconds,
+  const int n_asset_cache_hits,
+  const int n_asset_cache_misses
+)
+{
+  std::stringstream s;
+  s
+    << "Loading time (seconds): " << seconds << '\n'
+    << "Asset cache hits: " << n_asset_cache_hits << '\n'
+    << "Asset cache misses: " << n_asset_cache_misses << '\n'
+  ;
+  add_lines(s.str());
 }
 
 void diagnostics_file::add_screen_size(const int width, const int height)
 {
-  std::ofstream f(m_filename, std::ios::app);
-  f
-    << "Screen size (width x height): " << width << " x " << height << '\n';
+  std::stringstream s;
+  s << "Screen size (width x height): " << width << " x " << height;
+  m_log->add(log_severity::debug, s.str());
 }
 
 std::string get_default_diagnostics_filename()  noexcept
 {
   return "conquer_chess_error.txt";
 }
+
+void test_diagnostics_file()
+{
+#ifndef NDEBUG
+  // All text ends up in the log file, one line per message
+  {
+    const std::string filename{"tmp_diagnostics_file.txt"};
+    std::filesystem::remove(filename); // From an earlier test
+    {
+      diagnostics_log log(filename);
+      diagnostics_file f(log);
+      f.add_header();
+      f.add_cli_options(cc_cli_options());
+      f.add_loading_time(1.0, 2, 3);
+      f.add_screen_size(640, 480);
+      f.add_footer();
+    }
+    std::ifstream is(filename);
+    std::stringstream s;
+    s << is.rdbuf();
+    const std::string text{s.str()};
+    assert(text.find("info: Conquer Chess log file.") != std::string::npos);
+    assert(text.find("Asset cache misses: 3") != std::string::npos);
+    assert(text.find("debug: Screen size (width x height): 640 x 480") != std::string::npos);
+    assert(text.find("Game ended successfully") != std::string::npos);
+    is.close();
+    std::filesystem::remove(filename);
+  }
+#endif // NDEBUG
+}
@@ -0,0 +1,390 @@
+#include "diagnostics_log.h"
+
+#include "diagnostics_file.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+/// Get the name of a severity, without allocating
+const char * get_severity_name(const log_severity s) noexcept
+{
+  switch (s)
+  {
+    case log_severity::debug: return "debug";
+    case log_severity::info: return "info";
+    case log_severity::warning: return "warning";
+    case log_severity::error:
+    default:
+      return "error";
+  }
+}
+
+/// Format a message as one line, without allocating.
+/// Returns the number of characters written
+int format_line(
+  char * const buffer,
+  const int buffer_size,
+  const log_severity s,
+  const double time_secs,
+  const char * const text,
+  const int length
+) noexcept
+{
+  const int n{
+    std::snprintf(
+      buffer,
+      buffer_size,
+      "[%10.3f] %s: %.*s\n",
+      time_secs,
+      get_severity_name(s),
+      length,
+      text
+    )
+  };
+  return std::min(n, buffer_size - 1);
+}
+
+/// The size of a buffer that can hold one formatted line
+constexpr int get_line_buffer_size() { return get_diagnostics_log_max_message_length() + 32; }
+
+/// The log of the process, once created by get_diagnostics_log
+std::atomic<const diagnostics_log*> process_log{nullptr};
+
+} // ~namespace
+
+diagnostics_log::diagnostics_log(
+  const std::string& filename,
+  const int capacity,
+  const int max_messages_per_second
+) : m_filename{filename},
+    m_entries{std::make_unique<entry[]>(capacity)},
+    m_index_mask{static_cast<std::uint64_t>(capacity) - 1},
+    m_max_messages_per_second{max_messages_per_second},
+    m_start{std::chrono::steady_clock::now()}
+{
+  assert(capacity > 0);
+  assert((capacity & (capacity - 1)) == 0);
+  assert(m_max_messages_per_second > 0);
+  m_writer = std::thread(&diagnostics_log::run, this);
+}
+
+diagnostics_log::~diagnostics_log()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_must_stop = true;
+  }
+  m_wake_writer.notify_one();
+  m_writer.join();
+}
+
+void diagnostics_log::add(const log_severity s, const std::string& text) noexcept
+{
+  if (s < m_min_severity.load(std::memory_order_relaxed)) return;
+  if (s != log_severity::error && is_rate_limited())
+  {
+    ++m_n_rate_limited;
+    return;
+  }
+  const std::uint64_t i{m_n_added.fetch_add(1, std::memory_order_relaxed)};
+  entry& e{m_entries[i & m_index_mask]};
+  e.m_sequence.store((2 * i) + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  e.m_severity = s;
+  e.m_time_secs = get_time_secs();
+  e.m_length = static_cast<int>(std::min(text.size(), e.m_text.size()));
+  std::memcpy(e.m_text.data(), text.data(), e.m_length);
+  e.m_sequence.store((2 * i) + 2, std::memory_order_release);
+
+  // Write errors as soon as possible
+  if (s == log_severity::error) m_wake_writer.notify_one();
+}
+
+void diagnostics_log::dump(std::FILE * const f) const noexcept
+{
+  const std::uint64_t n_added{m_n_added.load(std::memory_order_acquire)};
+  const std::uint64_t capacity{m_index_mask + 1};
+  const std::uint64_t first{n_added > capacity ? n_added - capacity : 0};
+  char line[get_line_buffer_size()];
+  const char header[] = "Most recent diagnostics:\n";
+  std::fwrite(header, 1, sizeof(header) - 1, f);
+  for (std::uint64_t i{first}; i != n_added; ++i)
+  {
+    log_severity s{log_severity::debug};
+    double time_secs{0.0};
+    std::array<char, get_diagnostics_log_max_message_length()> text;
+    int length{0};
+    if (read(i, s, time_secs, text, length) != read_result::ok) continue;
+    const int n{format_line(line, sizeof(line), s, time_secs, text.data(), length)};
+    std::fwrite(line, 1, n, f);
+  }
+  std::fflush(f);
+}
+
+void diagnostics_log::flush()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  const std::uint64_t n_added{m_n_added.load()};
+  m_must_flush = true;
+  m_wake_writer.notify_one();
+  m_messages_written.wait(
+    lock,
+    [this, n_added]() { return m_n_done >= n_added; }
+  );
+}
+
+double diagnostics_log::get_time_secs() const noexcept
+{
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - m_start
+  ).count();
+}
+
+bool diagnostics_log::is_rate_limited() noexcept
+{
+  const std::int64_t second{static_cast<std::int64_t>(get_time_secs())};
+  std::int64_t window{m_rate_window.load(std::memory_order_relaxed)};
+  if (second != window
+    && m_rate_window.compare_exchange_strong(window, second)
+  )
+  {
+    m_n_in_rate_window = 0;
+  }
+  return m_n_in_rate_window.fetch_add(1, std::memory_order_relaxed)
+    >= m_max_messages_per_second
+  ;
+}
+
+diagnostics_log::read_result diagnostics_log::read(
+  const std::uint64_t i,
+  log_severity& s,
+  double& time_secs,
+  std::array<char, get_diagnostics_log_max_message_length()>& text,
+  int& length
+) const noexcept
+{
+  const entry& e{m_entries[i & m_index_mask]};
+  const std::uint64_t done{(2 * i) + 2};
+  const std::uint64_t before{e.m_sequence.load(std::memory_order_acquire)};
+  if (before < done) return read_result::not_written_yet;
+  if (before > done) return read_result::overwritten;
+  s = e.m_severity;
+  time_secs = e.m_time_secs;
+  length = e.m_length;
+  std::memcpy(text.data(), e.m_text.data(), length);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const std::uint64_t after{e.m_sequence.load(std::memory_order_relaxed)};
+  if (after != before) return read_result::overwritten;
+  return read_result::ok;
+}
+
+void diagnostics_log::run()
+{
+  const auto write_interval{std::chrono::milliseconds(100)};
+  std::ofstream f(m_filename, std::ios::app);
+  char line[get_line_buffer_size()];
+  int n_rate_limited_written{0};
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (1)
+  {
+    m_wake_writer.wait_for(
+      lock,
+      write_interval,
+      [this]() { return m_must_flush || m_must_stop; }
+    );
+    const bool must_stop{m_must_stop};
+    m_must_flush = false;
+    lock.unlock();
+
+    // Write without holding the lock
+    const std::uint64_t n_added{m_n_added.load(std::memory_order_acquire)};
+    bool has_written{false};
+    while (m_n_read != n_added)
+    {
+      // A message that was added, but is not written yet,
+      // may be overwritten while waiting for it
+      if (n_added - m_n_read > m_index_mask + 1)
+      {
+        ++m_n_dropped;
+        ++m_n_read;
+        continue;
+      }
+      log_severity s{log_severity::debug};
+      double time_secs{0.0};
+      std::array<char, get_diagnostics_log_max_message_length()> text;
+      int length{0};
+      const read_result r{read(m_n_read, s, time_secs, text, length)};
+      if (r == read_result::not_written_yet) break;
+      if (r == read_result::overwritten)
+      {
+        ++m_n_dropped;
+      }
+      else
+      {
+        const int n{format_line(line, sizeof(line), s, time_secs, text.data(), length)};
+        f.write(line, n);
+        has_written = true;
+      }
+      ++m_n_read;
+    }
+    const int n_rate_limited{m_n_rate_limited};
+    if (n_rate_limited != n_rate_limited_written)
+    {
+      f << "Diagnostics: "
+        << (n_rate_limited - n_rate_limited_written)
+        << " messages were dropped, as too many messages were added per second\n"
+      ;
+      n_rate_limited_written = n_rate_limited;
+      has_written = true;
+    }
+    if (has_written) f.flush();
+
+    lock.lock();
+    m_n_done = m_n_read;
+    m_messages_written.notify_all();
+    if (must_stop && m_n_read == m_n_added.load()) return;
+  }
+}
+
+bool dump_diagnostics_log(std::FILE * const f) noexcept
+{
+  const diagnostics_log * const log{process_log.load()};
+  if (!log) return false;
+  log->dump(f);
+  return true;
+}
+
+diagnostics_log& get_diagnostics_log()
+{
+  static diagnostics_log log(get_default_diagnostics_filename());
+  process_log = &log;
+  return log;
+}
+
+void test_diagnostics_log()
+{
+#ifndef NDEBUG
+  const std::string filename{"tmp_diagnostics_log.txt"};
+  const auto read_file{
+    [](const std::string& name)
+    {
+      std::ifstream f(name);
+      std::stringstream s;
+      s << f.rdbuf();
+      return s.str();
+    }
+  };
+  // Messages are written when flushed
+  {
+    std::filesystem::remove(filename); // From an earlier test
+    diagnostics_log log(filename);
+    log.add(log_severity::info, "Hello");
+    log.add(log_severity::error, "World");
+    log.flush();
+    const std::string text{read_file(filename)};
+    assert(text.find("info: Hello") != std::string::npos);
+    assert(text.find("error: World") != std::string::npos);
+    assert(text.find("Hello") < text.find("World"));
+  }
+  // Messages are written when destroyed, appended to the file
+  {
+    {
+      diagnostics_log log(filename);
+      log.add(log_severity::info, "Again");
+    }
+    const std::string text{read_file(filename)};
+    assert(text.find("Hello") != std::string::npos);
+    assert(text.find("Again") != std::string::npos);
+    std::filesystem::remove(filename);
+  }
+  // Messages less severe than the minimum are not added
+  {
+    diagnostics_log log(filename);
+    log.set_min_severity(log_severity::warning);
+    assert(log.get_min_severity() == log_severity::warning);
+    log.add(log_severity::info, "Hidden");
+    log.add(log_severity::warning, "Shown");
+    log.flush();
+    const std::string text{read_file(filename)};
+    assert(text.find("Hidden") == std::string::npos);
+    assert(text.find("Shown") != std::string::npos);
+    std::filesystem::remove(filename);
+  }
+  // Too many messages per second are rate limited, errors are not
+  {
+    diagnostics_log log(filename, 16, 2);
+    for (int i{0}; i != 5; ++i) log.add(log_severity::info, "Spam");
+    log.add(log_severity::error, "Important");
+    log.flush();
+    // Depending on the time, the messages may be in two seconds
+    assert(log.get_n_rate_limited() >= 1);
+    const std::string text{read_file(filename)};
+    assert(text.find("Important") != std::string::npos);
+    assert(text.find("messages were dropped") != std::string::npos);
+    std::filesystem::remove(filename);
+  }
+  // Long messages are truncated
+  {
+    diagnostics_log log(filename);
+    log.add(log_severity::info, std::string(1000, 'x'));
+    log.flush();
+    const std::string text{read_file(filename)};
+    assert(text.find(std::string(get_diagnostics_log_max_message_length(), 'x')) != std::string::npos);
+    assert(text.find(std::string(get_diagnostics_log_max_message_length() + 1, 'x')) == std::string::npos);
+    std::filesystem::remove(filename);
+  }
+  // The ring buffer keeps the most recent messages
+  {
+    diagnostics_log log(filename, 4, 1000);
+    for (int i{0}; i != 10; ++i) log.add(log_severity::info, "Message " + std::to_string(i));
+    const std::string dump_filename{"tmp_diagnostics_log_dump.txt"};
+    std::FILE * const f{std::fopen(dump_filename.c_str(), "w")};
+    log.dump(f);
+    std::fclose(f);
+    const std::string text{read_file(dump_filename)};
+    assert(text.find("Message 5") == std::string::npos);
+    assert(text.find("Message 6") != std::string::npos);
+    assert(text.find("Message 9") != std::string::npos);
+    std::filesystem::remove(dump_filename);
+  }
+  std::filesystem::remove(filename);
+  // Messages can be added from multiple threads
+  {
+    {
+      diagnostics_log log(filename, 1024, 1000);
+      std::thread t(
+        [&log]()
+        {
+          for (int i{0}; i != 100; ++i) log.add(log_severity::debug, "Other thread");
+        }
+      );
+      for (int i{0}; i != 100; ++i) log.add(log_severity::debug, "Main thread");
+      t.join();
+      log.flush();
+      assert(log.get_n_dropped() == 0);
+    }
+    std::ifstream f(filename);
+    std::string line;
+    int n_lines{0};
+    while (std::getline(f, line)) ++n_lines;
+    assert(n_lines == 200);
+    std::filesystem::remove(filename);
+  }
+  // dump_diagnostics_log dumps the log of the process, once created
+  {
+    get_diagnostics_log();
+    const std::string dump_filename{"tmp_diagnostics_log_dump.txt"};
+    std::FILE * const f{std::fopen(dump_filename.c_str(), "w")};
+    assert(dump_diagnostics_log(f));
+    std::fclose(f);
+    assert(read_file(dump_filename).find("Most recent diagnostics") != std::string::npos);
+    std::filesystem::remove(dump_filename);
+  }
+#endif // NDEBUG
+}
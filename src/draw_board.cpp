@@ -11,22 +11,45 @@
 #include "screen_coordinate.h"
 #include "sfml_helper.h"
 #include "render_window.h"
+#include "trace.h"
 
 #include <cassert>
 #include <iterator>
 
+namespace {
+
+/// Get the progress of the current action of the i-th piece,
+/// as interpolated in 'progresses', if these are given
+double get_progress(
+  const std::vector<piece>& pieces,
+  const std::vector<double>& progresses,
+  const std::size_t i
+)
+{
+  assert(i < pieces.size());
+  if (progresses.empty()) return pieces[i].get_current_action_progress().get();
+  assert(progresses.size() == pieces.size());
+  return progresses[i];
+}
+
+} // namespace
+
 void draw_pieces(
   const game_controller& c,
   const board_layout& layout,
-  const bool indicate_protectedness
+  const bool indicate_protectedness,
+  const std::vector<double>& progresses
 )
 {
+  const trace_scope scope("draw_pieces");
   const auto& game{c.get_game()};
 
   const auto selected_piece_ids{collect_selected_piece_ids(c)};
 
-  for (const auto& piece: game.get_pieces())
+  const auto& pieces{game.get_pieces()};
+  for (std::size_t i{0}; i != pieces.size(); ++i)
   {
+    const auto& piece{pieces[i]};
     const int x{piece.get_current_square().get_x()};
     const int y{piece.get_current_square().get_y()};
     const square_layout& square_layout(layout.get_square(x, y));
@@ -37,7 +60,7 @@ void draw_pieces(
       && piece.get_actions()[0].get_action_type() == piece_action_type::move
     )
     {
-      const double f{piece.get_current_action_progress().get()};
+      const double f{get_progress(pieces, progresses, i)};
       int alpha{0};
       if (f < 0.5)
       {
@@ -50,7 +73,7 @@ void draw_pieces(
       fill_color = sf::Color(255, 255, 255, alpha);
     }
 
-    const screen_rect sprite_rect(square_layout.get_piece());
+    const screen_rect& sprite_rect(square_layout.get_piece());
 
     draw_texture(
       get_piece_texture(
@@ -85,6 +108,7 @@ void draw_squares(
   const bool semi_transparent
 )
 {
+  const trace_scope scope("draw_squares");
   for (int x = 0; x != 8; ++x)
   {
     for (int y = 0; y != 8; ++y)
@@ -109,6 +133,7 @@ void draw_unit_health_bars(
   const board_layout& bl
 )
 {
+  const trace_scope scope("draw_unit_health_bars");
   for (const auto& piece: g.get_pieces())
   {
     const auto& square_layout{
@@ -117,7 +142,7 @@ void draw_unit_health_bars(
         piece.get_current_square().get_y()
       )
     };
-    const auto outline_rect{
+    const auto& outline_rect{
       square_layout.get_health_bar_outline()
     };
 
@@ -168,38 +193,35 @@ void draw_unit_health_bars(
 
 void draw_unit_paths(
   const std::vector<piece>& pieces,
-  const board_layout& layout
+  const board_layout& layout,
+  const std::vector<double>& progresses
 )
 {
-  for (const auto& piece: pieces)
+  const trace_scope scope("draw_unit_paths");
+  for (std::size_t i{0}; i != pieces.size(); ++i)
   {
+    const auto& piece{pieces[i]};
     if (is_idle(piece)) continue;
 
-    const auto square_piece{
-      layout.get_square(
-        piece.get_current_square().get_x(),
-        piece.get_current_square().get_y()
-      ).get_square()
-    };
-    const auto piece_pixel{get_center(square_piece)};
+    const int x{piece.get_current_square().get_x()};
+    const int y{piece.get_current_square().get_y()};
+    const auto& square_piece{layout.get_square(x, y).get_square()};
+    const auto& piece_pixel{layout.get_square_center(x, y)};
 
     const auto& actions{piece.get_actions()};
     for (const auto& action: actions)
     {
 
-      const auto square_from{
-        layout.get_square(action.get_from().get_x(), action.get_from().get_y()).get_square()
+      const auto& from_pixel{
+        layout.get_square_center(action.get_from().get_x(), action.get_from().get_y())
       };
-      const auto square_to{
-        layout.get_square(action.get_to().get_x(), action.get_to().get_y()).get_square()
+      const auto& to_pixel{
+        layout.get_square_center(action.get_to().get_x(), action.get_to().get_y())
       };
-      const auto from_pixel{get_center(square_from)};
-      const auto to_pixel{get_center(square_to)};
       const auto center_pixel{(to_pixel + from_pixel) / 2.0};
       const double length{calc_distance(from_pixel, to_pixel)};
       const double angle_degrees{calc_angle_degrees(center_pixel, to_pixel)};
       sf::RectangleShape rect;
-      assert(get_width(square_from) == get_width(square_to));
       const double max_square_height{static_cast<double>(get_width(square_piece))};
       const double height{std::max(2.0, max_square_height * 0.05)};
       rect.setSize(sf::Vector2f(length, height));
@@ -235,13 +257,9 @@ void draw_unit_paths(
       std::begin(actions),
       std::end(actions),
       std::back_inserter(coordinats),
-      [layout](const auto& user_input)
+      [&layout](const auto& user_input)
       {
-        const auto square_to{
-          layout.get_square(user_input.get_to().get_x(), user_input.get_to().get_y()).get_square()
-        };
-        const auto to_pixel{get_center(square_to)};
-        return to_pixel;
+        return layout.get_square_center(user_input.get_to().get_x(), user_input.get_to().get_y());
         /*
         return convert_to_screen_coordinate(
           to_coordinat(user_input.get_to()),
@@ -279,14 +297,12 @@ void draw_unit_paths(
       || first_action.get_action_type() == piece_action_type::castle_queenside
     )
     {
-      const auto square_from{
-        layout.get_square(first_action.get_from().get_x(), first_action.get_from().get_y()).get_square()
+      const auto& from_pixel{
+        layout.get_square_center(first_action.get_from().get_x(), first_action.get_from().get_y())
       };
-      const auto square_to{
-        layout.get_square(first_action.get_to().get_x(), first_action.get_to().get_y()).get_square()
+      const auto& to_pixel{
+        layout.get_square_center(first_action.get_to().get_x(), first_action.get_to().get_y())
       };
-      const auto from_pixel{get_center(square_from)};
-      const auto to_pixel{get_center(square_to)};
       /*
       const auto from_pixel{
         convert_to_screen_coordinate(
@@ -301,7 +317,7 @@ void draw_unit_paths(
         )
       };
       */
-      const auto f{piece.get_current_action_progress().get()};
+      const auto f{get_progress(pieces, progresses, i)};
       assert(f >= 0.0);
       assert(f <= 1.0);
       const auto delta_pixel{to_pixel - from_pixel};
@@ -0,0 +1,116 @@
+#include "fen_position.h"
+
+#include "fen_string.h"
+#include "square.h"
+
+#include <cassert>
+#include <cctype>
+
+namespace {
+
+/// Get the index of a square, as used by \link{fen_position}
+int get_fen_position_index(const square& s) noexcept
+{
+  return (s.get_x() * 8) + s.get_y();
+}
+
+} // ~namespace
+
+fen_position::fen_position()
+  : m_active_color{chess_color::white},
+    m_squares{}
+{
+
+}
+
+fen_position::fen_position(const fen_string& s)
+  : fen_position()
+{
+  const std::string& str{s.get()};
+  int square_index{0}; // a8, b8, c8, etc...
+  for (const char c: str)
+  {
+    if (c == ' ') break;
+    if (c == '/') continue;
+    if (c >= '1' && c <= '8')
+    {
+      square_index += static_cast<int>(c - '0');
+      continue;
+    }
+    assert(square_index < 64);
+    // FEN strings start from above
+    const int rank_index{7 - (square_index / 8)};
+    m_squares[(rank_index * 8) + (square_index % 8)] = c;
+    ++square_index;
+  }
+  m_active_color = get_color(s);
+}
+
+std::optional<std::pair<chess_color, piece_type>> fen_position::get_piece_at(const square& s) const noexcept
+{
+  const char c{m_squares[get_fen_position_index(s)]};
+  if (c == '\0') return {};
+  return std::make_pair(
+    std::isupper(c) ? chess_color::white : chess_color::black,
+    to_piece_type(std::toupper(c))
+  );
+}
+
+std::vector<square> fen_position::get_squares(
+  const piece_type type,
+  const chess_color color
+) const
+{
+  std::vector<square> squares;
+  for (int rank_index{7}; rank_index >= 0; --rank_index)
+  {
+    for (int file_index{0}; file_index != 8; ++file_index)
+    {
+      const square s(rank_index, file_index);
+      const auto p{get_piece_at(s)};
+      if (p && p.value().first == color && p.value().second == type)
+      {
+        squares.push_back(s);
+      }
+    }
+  }
+  return squares;
+}
+
+bool fen_position::is_piece_at(const square& s) const noexcept
+{
+  return m_squares[get_fen_position_index(s)] != '\0';
+}
+
+void test_fen_position()
+{
+#ifndef NDEBUG
+  // An empty board has no pieces
+  {
+    const fen_position p;
+    assert(!p.is_piece_at(square("e1")));
+    assert(p.get_active_color() == chess_color::white);
+  }
+  // The standard starting position
+  {
+    const fen_position p(create_fen_string_of_standard_starting_position(chess_color::black));
+    assert(p.get_active_color() == chess_color::black);
+    assert(p.is_piece_at(square("e1")));
+    assert(!p.is_piece_at(square("e4")));
+    assert(p.get_piece_at(square("e1")).value().first == chess_color::white);
+    assert(p.get_piece_at(square("e1")).value().second == piece_type::king);
+    assert(p.get_piece_at(square("d8")).value().first == chess_color::black);
+    assert(p.get_piece_at(square("d8")).value().second == piece_type::queen);
+  }
+  // The squares are in the order of the FEN string
+  {
+    const fen_position p(create_fen_string_of_standard_starting_position());
+    const auto squares{p.get_squares(piece_type::knight, chess_color::white)};
+    assert(squares.size() == 2);
+    assert(squares[0] == square("b1"));
+    assert(squares[1] == square("g1"));
+    assert(p.get_squares(piece_type::pawn, chess_color::black).size() == 8);
+    assert(p.get_squares(piece_type::pawn, chess_color::black)[0] == square("a7"));
+  }
+#endif // NDEBUG
+}
@@ -0,0 +1,156 @@
+#include "fen_position_cache.h"
+
+#include "fen_string.h"
+#include "metrics.h"
+#include "square.h"
+
+#include <cassert>
+#include <functional>
+#include <thread>
+#include <vector>
+
+fen_position_cache::fen_position_cache(const int max_size)
+  : m_max_size{max_size}
+{
+  assert(m_max_size > 0);
+}
+
+fen_position fen_position_cache::get(const fen_string& s)
+{
+  static metric_counter& n_hits{get_metrics().get_counter("fen_position_cache_hits")};
+  static metric_counter& n_misses{get_metrics().get_counter("fen_position_cache_misses")};
+  const std::size_t hash{std::hash<std::string>()(s.get())};
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto there{m_index.find(hash)};
+    // The FEN string is compared too, as two FEN strings can have the same hash
+    if (there != std::end(m_index) && there->second->m_fen_str == s.get())
+    {
+      m_entries.splice(std::begin(m_entries), m_entries, there->second);
+      ++m_n_hits;
+      n_hits.add();
+      return m_entries.front().m_position;
+    }
+  }
+  ++m_n_misses;
+  n_misses.add();
+
+  // Parse without holding the lock
+  const fen_position position(s);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const auto there{m_index.find(hash)};
+  if (there != std::end(m_index))
+  {
+    // Added by another thread meanwhile, or a different FEN string with the same hash
+    m_entries.erase(there->second);
+    m_index.erase(there);
+  }
+  m_entries.push_front( { hash, s.get(), position } );
+  m_index[hash] = std::begin(m_entries);
+  if (static_cast<int>(m_entries.size()) > m_max_size)
+  {
+    m_index.erase(m_entries.back().m_hash);
+    m_entries.pop_back();
+  }
+  return position;
+}
+
+int fen_position_cache::get_size() const noexcept
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return static_cast<int>(m_entries.size());
+}
+
+fen_position_cache& get_fen_position_cache()
+{
+  static fen_position_cache c;
+  return c;
+}
+
+double get_hit_rate(const fen_position_cache& c) noexcept
+{
+  const std::int64_t n{c.get_n_hits() + c.get_n_misses()};
+  if (n == 0) return 0.0;
+  return static_cast<double>(c.get_n_hits()) / static_cast<double>(n);
+}
+
+void test_fen_position_cache()
+{
+#ifndef NDEBUG
+  // A new cache is empty
+  {
+    const fen_position_cache c;
+    assert(c.get_size() == 0);
+    assert(c.get_max_size() == get_default_fen_position_cache_size());
+    assert(get_hit_rate(c) == 0.0);
+  }
+  // The second request is a hit
+  {
+    fen_position_cache c;
+    const fen_string s{create_fen_string_of_standard_starting_position()};
+    const auto a{c.get(s)};
+    const auto b{c.get(s)};
+    assert(c.get_n_misses() == 1);
+    assert(c.get_n_hits() == 1);
+    assert(get_hit_rate(c) == 0.5);
+    assert(a.get_squares(piece_type::king, chess_color::white) == b.get_squares(piece_type::king, chess_color::white));
+  }
+  // The least recently used position is dropped
+  {
+    fen_position_cache c(2);
+    const fen_string a{get_fen_string_game_over_white_checkmate()};
+    const fen_string b{get_fen_string_game_over_black_checkmate()};
+    const fen_string d{create_fen_string_of_standard_starting_position()};
+    c.get(a);
+    c.get(b);
+    c.get(a); // b is now the least recently used
+    c.get(d);
+    assert(c.get_size() == 2);
+    c.get(a);
+    assert(c.get_n_hits() == 2);
+    c.get(b);
+    assert(c.get_n_hits() == 2);
+    assert(c.get_n_misses() == 4);
+  }
+  // The position is the one of the FEN string
+  {
+    fen_position_cache c;
+    const fen_string s{get_fen_string_game_over_black_checkmate()};
+    c.get(s);
+    const auto p{c.get(s)};
+    assert(p.get_active_color() == chess_color::black);
+    assert(p.get_piece_at(square("e7")).value().second == piece_type::queen);
+  }
+  // Can be used from many threads
+  {
+    fen_position_cache c(4);
+    const std::vector<fen_string> fens{
+      get_fen_string_game_over_white_checkmate(),
+      get_fen_string_game_over_black_checkmate(),
+      get_fen_string_game_over_white_no_king(),
+      get_fen_string_game_over_black_no_king(),
+      create_fen_string_of_standard_starting_position()
+    };
+    std::vector<std::thread> threads;
+    for (int i{0}; i != 4; ++i)
+    {
+      threads.push_back(
+        std::thread(
+          [&c, &fens, i]()
+          {
+            for (int j{0}; j != 100; ++j)
+            {
+              const auto& s{fens[(i + j) % fens.size()]};
+              assert(c.get(s).get_active_color() == get_color(s));
+            }
+          }
+        )
+      );
+    }
+    for (auto& t: threads) t.join();
+    assert(c.get_n_hits() + c.get_n_misses() == 400);
+    assert(c.get_size() <= 4);
+  }
+#endif // NDEBUG
+}
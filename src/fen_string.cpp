@@ -2,7 +2,6 @@
 #include "pieces.h"
 
 #include <cassert>
-#include <regex>
 
 fen_string::fen_string(const std::string& fen_str)
   : m_fen_str{fen_str}
@@ -39,8 +38,12 @@ fen_string create_fen_string_with_starting_position(
 
 chess_color get_color(const fen_string& s)
 {
-  if (std::regex_search(s.get(), std::regex(" w "))) return chess_color::white;
-  assert(std::regex_search(s.get(), std::regex(" b ")));
+  // The active color follows the first space
+  const auto i{s.get().find(' ')};
+  assert(i != std::string::npos);
+  assert(i + 1 < s.get().size());
+  if (s.get()[i + 1] == 'w') return chess_color::white;
+  assert(s.get()[i + 1] == 'b');
   return chess_color::black;
 }
 
@@ -0,0 +1,197 @@
+#include "frame_pacer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+frame_pacer::frame_pacer(const double target_fps)
+  : m_target_fps{target_fps}
+{
+  assert(m_target_fps > 0.0);
+  m_frame_times_ms.reserve(get_frame_pacer_n_frame_times());
+  m_deadline_microseconds = static_cast<sf::Int64>(1000000.0 / m_target_fps);
+}
+
+void frame_pacer::add_frame_time(const double ms)
+{
+  if (get_n_frame_times() < get_frame_pacer_n_frame_times())
+  {
+    m_frame_times_ms.push_back(ms);
+  }
+  else
+  {
+    m_frame_times_ms[m_frame_times_index] = ms;
+  }
+  m_frame_times_index = (m_frame_times_index + 1) % get_frame_pacer_n_frame_times();
+}
+
+double frame_pacer::get_frame_time_percentile_ms(const double p) const
+{
+  assert(p >= 0.0);
+  assert(p <= 100.0);
+  if (m_frame_times_ms.empty()) return 0.0;
+  std::vector<double> v{m_frame_times_ms};
+  const int i{
+    static_cast<int>(std::round(p / 100.0 * static_cast<double>(v.size() - 1)))
+  };
+  std::nth_element(std::begin(v), std::begin(v) + i, std::end(v));
+  return v[i];
+}
+
+std::string get_frame_times_str(const frame_pacer& p)
+{
+  std::stringstream s;
+  s << std::fixed << std::setprecision(1)
+    << p.get_frame_time_percentile_ms(50.0) << "/"
+    << p.get_frame_time_percentile_ms(95.0) << "/"
+    << p.get_frame_time_percentile_ms(99.0) << " ms, "
+    << p.get_n_missed_deadlines() << " missed"
+  ;
+  return s.str();
+}
+
+void frame_pacer::set_target_fps(const double fps)
+{
+  assert(fps > 0.0);
+  m_target_fps = fps;
+}
+
+sf::Int64 frame_pacer::end_work(const sf::Int64 work_end)
+{
+  const sf::Int64 period{static_cast<sf::Int64>(1000000.0 / m_target_fps)};
+  m_last_work_time_ms = static_cast<double>(work_end - m_last_frame_end_microseconds) / 1000.0;
+
+  if (m_use_vsync)
+  {
+    // The display has already waited for the screen.
+    // A frame that took one and a half period or more
+    // has skipped a screen refresh
+    if (2 * (work_end - m_last_frame_end_microseconds) >= 3 * period)
+    {
+      ++m_n_missed_deadlines;
+    }
+    return work_end;
+  }
+  if (work_end > m_deadline_microseconds)
+  {
+    // Too late: do not wait and do not try to catch up
+    ++m_n_missed_deadlines;
+    m_deadline_microseconds = work_end;
+  }
+  return m_deadline_microseconds;
+}
+
+void frame_pacer::end_frame(const sf::Int64 frame_end)
+{
+  const sf::Int64 period{static_cast<sf::Int64>(1000000.0 / m_target_fps)};
+  m_deadline_microseconds += period;
+  if (m_use_vsync) m_deadline_microseconds = frame_end + period;
+
+  add_frame_time(static_cast<double>(frame_end - m_last_frame_end_microseconds) / 1000.0);
+  m_last_frame_end_microseconds = frame_end;
+  m_fps_clock.tick();
+}
+
+void frame_pacer::tick()
+{
+  const sf::Int64 work_end{m_clock.getElapsedTime().asMicroseconds()};
+  const sf::Int64 wait_end{end_work(work_end)};
+
+  // Sleep most of the time, spin the last bit
+  const sf::Int64 spin_start{wait_end - get_frame_pacer_spin_time_microseconds()};
+  if (work_end < spin_start)
+  {
+    sf::sleep(sf::microseconds(spin_start - work_end));
+  }
+  while (m_clock.getElapsedTime().asMicroseconds() < wait_end)
+  {
+    // Spin
+  }
+  end_frame(m_clock.getElapsedTime().asMicroseconds());
+}
+
+void test_frame_pacer()
+{
+#ifndef NDEBUG
+  // A new frame pacer has no frame times
+  {
+    const frame_pacer p;
+    assert(p.get_fps() == 0.0);
+    assert(p.get_n_frame_times() == 0);
+    assert(p.get_n_missed_deadlines() == 0);
+    assert(p.get_frame_time_percentile_ms(50.0) == 0.0);
+    assert(!p.get_use_vsync());
+  }
+  // set_target_fps
+  {
+    frame_pacer p;
+    p.set_target_fps(42.0);
+    assert(p.get_target_fps() == 42.0);
+  }
+  // Frames that end early wait until their deadline
+  {
+    frame_pacer p(100.0);
+    // Work took 3 ms of the 10 ms period
+    assert(p.end_work(3000) == 10000);
+    assert(p.get_last_work_time_ms() == 3.0);
+    p.end_frame(10000);
+    assert(p.end_work(14000) == 20000);
+    p.end_frame(20000);
+    assert(p.get_n_frame_times() == 2);
+    assert(p.get_frame_time_percentile_ms(50.0) == 10.0);
+    assert(p.get_n_missed_deadlines() == 0);
+  }
+  // A frame that takes too long misses its deadline,
+  // after which the deadlines do not try to catch up
+  {
+    frame_pacer p(100.0);
+    p.end_frame(p.end_work(1000));
+    // The second deadline is at 20 ms, work ends at 35 ms
+    assert(p.end_work(35000) == 35000);
+    assert(p.get_n_missed_deadlines() == 1);
+    assert(p.get_last_work_time_ms() == 25.0);
+    p.end_frame(35000);
+    assert(p.end_work(36000) == 45000);
+    p.end_frame(45000);
+    assert(p.get_n_missed_deadlines() == 1);
+    assert(p.get_frame_time_percentile_ms(0.0) == 10.0);
+    assert(p.get_frame_time_percentile_ms(50.0) == 10.0);
+    assert(p.get_frame_time_percentile_ms(100.0) == 25.0);
+  }
+  // With vsync, the pacer does not wait,
+  // and a frame of one and a half period or more is missed
+  {
+    frame_pacer p(100.0);
+    p.set_use_vsync(true);
+    assert(p.end_work(10000) == 10000);
+    p.end_frame(10000);
+    assert(p.end_work(24000) == 24000);
+    assert(p.get_n_missed_deadlines() == 0);
+    p.end_frame(24000);
+    assert(p.end_work(39000) == 39000);
+    assert(p.get_n_missed_deadlines() == 1);
+  }
+  // The number of frame times is limited
+  {
+    frame_pacer p(1000.0);
+    for (int i{0}; i != get_frame_pacer_n_frame_times() + 1; ++i)
+    {
+      p.end_frame(p.end_work(i * 1000));
+    }
+    assert(p.get_n_frame_times() == get_frame_pacer_n_frame_times());
+  }
+  // tick waits until the deadline
+  {
+    frame_pacer p(1000.0);
+    p.tick();
+    assert(p.get_n_frame_times() == 1);
+  }
+  // get_frame_times_str
+  {
+    const frame_pacer p;
+    assert(!get_frame_times_str(p).empty());
+  }
+#endif // NDEBUG
+}
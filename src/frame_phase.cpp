@@ -0,0 +1,53 @@
+#include "frame_phase.h"
+
+#include <cassert>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+#include "../magic_enum/include/magic_enum/magic_enum.hpp" // https://github.com/Neargye/magic_enum
+
+std::vector<frame_phase> get_all_frame_phases() noexcept
+{
+  const auto a{magic_enum::enum_values<frame_phase>()};
+  std::vector<frame_phase> v;
+  v.reserve(a.size());
+  std::copy(std::begin(a), std::end(a), std::back_inserter(v));
+  assert(a.size() == v.size());
+  return v;
+}
+
+void test_frame_phase()
+{
+#ifndef NDEBUG
+  // get_all_frame_phases
+  {
+    assert(get_all_frame_phases().size() == 4);
+    assert(get_all_frame_phases().front() == frame_phase::events);
+  }
+  // to_str
+  {
+    assert(to_str(frame_phase::events) == "events");
+    assert(to_str(frame_phase::tick) == "tick");
+    assert(to_str(frame_phase::draw) == "draw");
+    assert(to_str(frame_phase::display) == "display");
+  }
+  // operator<<
+  {
+    std::stringstream s;
+    s << frame_phase::draw;
+    assert(!s.str().empty());
+  }
+#endif // NDEBUG
+}
+
+std::string to_str(const frame_phase p) noexcept
+{
+  return std::string(magic_enum::enum_name(p));
+}
+
+std::ostream& operator<<(std::ostream& os, const frame_phase p) noexcept
+{
+  os << to_str(p);
+  return os;
+}
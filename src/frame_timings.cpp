@@ -0,0 +1,237 @@
+#include "frame_timings.h"
+
+#include "helper.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+#ifndef LOGIC_ONLY
+#include "game_resources.h"
+#include "render_window.h"
+#include "screen_rect.h"
+
+// From https://github.com/jerr-it/SFGraphing
+#include "../SFGraphing/include/SFGraphing/SFPlot.h"
+#endif // LOGIC_ONLY
+
+frame_timing::frame_timing()
+  : m_ms{0.0, 0.0, 0.0, 0.0}
+{
+  assert(m_ms.size() == get_all_frame_phases().size());
+}
+
+double frame_timing::get_ms(const frame_phase p) const noexcept
+{
+  return m_ms[static_cast<int>(p)];
+}
+
+void frame_timing::set_ms(const frame_phase p, const double ms) noexcept
+{
+  assert(ms >= 0.0);
+  m_ms[static_cast<int>(p)] = ms;
+}
+
+double get_total_ms(const frame_timing& t) noexcept
+{
+  double sum{0.0};
+  for (const auto p: get_all_frame_phases()) sum += t.get_ms(p);
+  return sum;
+}
+
+frame_timings::frame_timings(const int max_n_frames)
+  : m_max_n_frames{max_n_frames}
+{
+  assert(m_max_n_frames > 0);
+  m_timings.reserve(m_max_n_frames);
+}
+
+void frame_timings::add(const frame_timing& t)
+{
+  if (get_n_frames() < m_max_n_frames)
+  {
+    m_timings.push_back(t);
+  }
+  else
+  {
+    m_timings[m_index] = t;
+  }
+  m_index = (m_index + 1) % m_max_n_frames;
+}
+
+std::vector<frame_timing> frame_timings::get() const
+{
+  if (get_n_frames() < m_max_n_frames) return m_timings;
+  std::vector<frame_timing> v;
+  v.reserve(m_timings.size());
+  std::copy(std::begin(m_timings) + m_index, std::end(m_timings), std::back_inserter(v));
+  std::copy(std::begin(m_timings), std::begin(m_timings) + m_index, std::back_inserter(v));
+  return v;
+}
+
+std::string get_default_frame_timings_filename() noexcept
+{
+  return "conquer_chess_frame_timings.csv";
+}
+
+double get_mean_ms(const frame_timings& t, const frame_phase p)
+{
+  const auto v{t.get()};
+  if (v.empty()) return 0.0;
+  const double sum{
+    std::accumulate(
+      std::begin(v),
+      std::end(v),
+      0.0,
+      [p](const double s, const frame_timing& f) { return s + f.get_ms(p); }
+    )
+  };
+  return sum / static_cast<double>(v.size());
+}
+
+void save_to_csv(const frame_timings& t, const std::string& filename)
+{
+  std::ofstream f(filename);
+  f << to_csv_str(t);
+}
+
+std::string to_csv_str(const frame_timings& t)
+{
+  std::vector<std::string> headers;
+  for (const auto p: get_all_frame_phases()) headers.push_back(to_str(p));
+  headers.push_back("total");
+
+  std::stringstream s;
+  s << to_comma_seperated_str(headers) << '\n';
+  for (const auto& f: t.get())
+  {
+    std::vector<double> row;
+    for (const auto p: get_all_frame_phases()) row.push_back(f.get_ms(p));
+    row.push_back(get_total_ms(f));
+    s << to_comma_seperated_str(row) << '\n';
+  }
+  return s.str();
+}
+
+#ifndef LOGIC_ONLY
+
+void draw_frame_timings(const frame_timings& t, const screen_rect& r)
+{
+  const auto timings{t.get()};
+  if (timings.size() < 2) return;
+
+  std::vector<float> xs(timings.size());
+  std::iota(std::begin(xs), std::end(xs), 0.0f);
+
+  const std::vector<sf::Color> colors{
+    sf::Color(255, 255, 0),
+    sf::Color(255, 0, 0),
+    sf::Color(0, 255, 0),
+    sf::Color(0, 128, 255)
+  };
+  assert(colors.size() == get_all_frame_phases().size());
+
+  std::vector<csrc::PlotDataSet> data_sets;
+  float max_ms{1000.0f / 30.0f};
+  for (const auto p: get_all_frame_phases())
+  {
+    std::vector<float> ys;
+    ys.reserve(timings.size());
+    for (const auto& f: timings)
+    {
+      ys.push_back(static_cast<float>(f.get_ms(p)));
+    }
+    max_ms = std::max(max_ms, *std::max_element(std::begin(ys), std::end(ys)));
+    data_sets.push_back(
+      csrc::PlotDataSet(
+        xs,
+        ys,
+        colors[static_cast<int>(p)],
+        to_str(p),
+        csrc::PlottingType::LINE
+      )
+    );
+  }
+
+  //Position, dimension, margin, font
+  csrc::SFPlot plot(
+    sf::Vector2f(r.get_tl().get_x(), r.get_tl().get_y()),
+    sf::Vector2f(get_width(r), get_height(r)),
+    24,
+    get_arial_font(),
+    "Frame",
+    "Time (ms)"
+  );
+  for (const auto& d: data_sets) plot.AddDataSet(d);
+
+  //x-minimum, x-maximum, y-minimum, y-maximum, x-step-size, y-step-size, Color of axes
+  const double xmax{static_cast<double>(xs.back())};
+  const double ymax{std::ceil(max_ms / 10.0) * 10.0};
+  plot.SetupAxes(0.0, xmax, 0.0, ymax, 50.0, 10.0, sf::Color::White);
+  plot.GenerateVertices();
+  get_render_window().draw(plot);
+}
+
+#endif // LOGIC_ONLY
+
+void test_frame_timings()
+{
+#ifndef NDEBUG
+  // frame_timing
+  {
+    frame_timing t;
+    assert(get_total_ms(t) == 0.0);
+    t.set_ms(frame_phase::tick, 1.0);
+    t.set_ms(frame_phase::draw, 2.0);
+    assert(t.get_ms(frame_phase::tick) == 1.0);
+    assert(t.get_ms(frame_phase::draw) == 2.0);
+    assert(get_total_ms(t) == 3.0);
+  }
+  // A new frame_timings is empty
+  {
+    const frame_timings t;
+    assert(t.get_n_frames() == 0);
+    assert(t.get().empty());
+    assert(get_mean_ms(t, frame_phase::draw) == 0.0);
+  }
+  // The ring buffer keeps the newest, from oldest to newest
+  {
+    frame_timings t(3);
+    for (int i{1}; i <= 5; ++i)
+    {
+      frame_timing f;
+      f.set_ms(frame_phase::events, i);
+      t.add(f);
+    }
+    assert(t.get_n_frames() == 3);
+    const auto v{t.get()};
+    assert(v[0].get_ms(frame_phase::events) == 3.0);
+    assert(v[1].get_ms(frame_phase::events) == 4.0);
+    assert(v[2].get_ms(frame_phase::events) == 5.0);
+    assert(get_mean_ms(t, frame_phase::events) == 4.0);
+  }
+  // to_csv_str has a header and one row per frame
+  {
+    frame_timings t;
+    t.add(frame_timing());
+    t.add(frame_timing());
+    const std::string s{to_csv_str(t)};
+    assert(s.find("events,tick,draw,display,total") == 0);
+    assert(std::count(std::begin(s), std::end(s), '\n') == 3);
+  }
+  // save_to_csv
+  {
+    const std::string filename{"tmp_frame_timings.csv"};
+    std::filesystem::remove(filename); // From an earlier test
+    frame_timings t;
+    t.add(frame_timing());
+    save_to_csv(t, filename);
+    assert(std::filesystem::exists(filename));
+    std::filesystem::remove(filename);
+  }
+#endif // NDEBUG
+}
@@ -1,13 +1,17 @@
 #include "game.h"
 
 //#include "game_options.h"
+#include "king_safety.h"
 #include "piece_actions.h"
 #include "square.h"
 #include "pieces.h"
 #include "chess_color.h"
+#include "metrics.h"
+#include "trace.h"
 #include <cassert>
 #include <cmath>
 #include <algorithm>
+#include <array>
 #include <iterator>
 #include <iostream>
 //#include <random>
@@ -298,73 +302,28 @@ action_history collect_action_history(const game& g)
 
 std::vector<piece_action> collect_all_piece_actions(const game& g)
 {
-  // 1. Collect all the simple actions,
-  //    such as movement and attacks
+  // What threatens each king, i.e. the attacked squares,
+  // the checks and the pins, computed once for all actions
+  const std::array<king_safety, 2> safeties{
+    king_safety(g.get_pieces(), chess_color::black),
+    king_safety(g.get_pieces(), chess_color::white)
+  };
+  // Collect the actions of each piece, such as movement and attacks,
+  // that do not leave the own king in check
   std::vector<piece_action> actions;
   for (const auto& p: g.get_pieces())
   {
-    const auto piece_actions{
-      collect_all_piece_actions(g, p)
-    };
-    std::copy(
-      std::begin(piece_actions),
-      std::end(piece_actions),
-      std::back_inserter(actions)
-    );
+    const king_safety& safety{safeties[static_cast<int>(p.get_color())]};
+    for (const auto& action: collect_all_piece_actions(g, p))
+    {
+      if (safety.is_legal(action)) actions.push_back(action);
+    }
   }
-  // 2. collect all attacked squares
-  std::vector<std::pair<square, chess_color>> attacked_squares{
-    collect_attacked_squares(actions)
-  };
 
-  // 3. Prevent king moving into or through (by castling) check
-  const auto new_end{
-    std::remove_if(
-      std::begin(actions),
-      std::end(actions),
-      [attacked_squares](const piece_action& action)
-      {
-        if (action.get_action_type() == piece_action_type::move)
-        {
-          if (action.get_piece_type() == piece_type::king)
-          {
-            // King cannot move into check
-            const chess_color enemy_color{get_other_color(action.get_color())};
-            return is_square_attacked_by(attacked_squares, action.get_to(), enemy_color);
-          }
-        }
-        else if (action.get_action_type() == piece_action_type::castle_kingside)
-        {
-          const square king_square{action.get_from()};
-          const chess_color enemy_color{get_other_color(action.get_color())};
-          const square f_pawn_square{square(king_square.get_x(), 5)};
-          const square g_pawn_square{square(king_square.get_x(), 6)};
-          return is_square_attacked_by(attacked_squares, f_pawn_square, enemy_color)
-            || is_square_attacked_by(attacked_squares, g_pawn_square, enemy_color)
-          ;
-        }
-        else if (action.get_action_type() == piece_action_type::castle_queenside)
-        {
-          const square king_square{action.get_from()};
-          const chess_color enemy_color{get_other_color(action.get_color())};
-          const square b_pawn_square{square(king_square.get_x(), 1)};
-          const square c_pawn_square{square(king_square.get_x(), 2)};
-          const square d_pawn_square{square(king_square.get_x(), 3)};
-          return is_square_attacked_by(attacked_squares, b_pawn_square, enemy_color)
-            || is_square_attacked_by(attacked_squares, c_pawn_square, enemy_color)
-            || is_square_attacked_by(attacked_squares, d_pawn_square, enemy_color)
-          ;
-        }
-        return false;
-      }
-    )
+  static metric_counter& n_actions{
+    get_metrics().get_counter("piece_actions_generated")
   };
-  actions.erase(new_end, std::end(actions));
-
-  // Prevent opening up a pin
-
-  // If king is attacked, only moves that break check are possible
-
+  n_actions.add(actions.size());
   return actions;
 }
 
@@ -373,17 +332,14 @@ std::vector<piece_action> collect_all_piece_actions(
   const chess_color player_color)
 {
   std::vector<piece_action> actions;
+  const king_safety safety(g.get_pieces(), player_color);
   for (const auto& p: g.get_pieces())
   {
     if (p.get_color() != player_color) continue;
-    const auto piece_actions{
-      collect_all_piece_actions(g, p)
-    };
-    std::copy(
-      std::begin(piece_actions),
-      std::end(piece_actions),
-      std::back_inserter(actions)
-    );
+    for (const auto& action: collect_all_piece_actions(g, p))
+    {
+      if (safety.is_legal(action)) actions.push_back(action);
+    }
   }
   return actions;
 }
@@ -1247,6 +1203,7 @@ void game::tick(const delta_t& dt)
 
 void game::tick_impl(const delta_t& dt)
 {
+  const trace_scope scope("game::tick_impl");
   assert(dt <= delta_t(0.25));
 
   check_game_and_pieces_agree_on_the_time();
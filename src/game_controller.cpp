@@ -8,8 +8,12 @@
 #include "piece.h"
 #include "pieces.h"
 #include "message_type.h"
+#include "metrics.h"
+#include "trace.h"
 
+#include <algorithm>
 #include <cassert>
+#include <random>
 #include <sstream>
 
 #ifdef PHYSICAL_CONTROLLERS_H
@@ -47,6 +51,7 @@ void add_user_inputs(game_controller& c, const user_inputs& inputs)
 
 void game_controller::apply_user_inputs_to_game()
 {
+  const trace_scope scope("game_controller::apply_user_inputs_to_game");
   check_selected_pieces_exist();
 
   game& g{m_game};
@@ -58,12 +63,25 @@ void game_controller::apply_user_inputs_to_game()
     user_inputs[user_input.get_player()].push_back(user_input);
   }
 
+  // The user inputs that do nothing,
+  // e.g. selecting an action that is not there,
+  // are skipped with a 'continue'
+  static metric_counter& n_applied_inputs{
+    get_metrics().get_counter("user_inputs_applied")
+  };
+  static metric_counter& n_dropped_inputs{
+    get_metrics().get_counter("user_inputs_dropped")
+  };
+  int n_applied{0};
+
   for (const side s: get_all_sides())
   {
     for (const auto& user_input: user_inputs.at(s))
     {
-      // Need to update every input
-      const auto actions = get_piece_actions(*this, s);
+      // Need to update every input, which is cheap
+      // if the cursor stays on the same square
+      const auto& actions{get_piece_actions(s)};
+      const auto game_version_before{m_game_version};
       switch(user_input.get_user_input_type())
       {
         case user_input_type::press_down:
@@ -141,15 +159,27 @@ void game_controller::apply_user_inputs_to_game()
         }
         break;
       }
-      g.tick(delta_t(0.0));
+      // Only an action changes the game,
+      // after which the game responds at once, without time passing.
+      // Moving a cursor does not change the game,
+      // so the remembered piece actions stay valid
+      if (m_game_version != game_version_before)
+      {
+        g.tick(delta_t(0.0));
+        ++m_game_version;
+      }
+      ++n_applied;
     }
   }
+  n_applied_inputs.add(n_applied);
+  n_dropped_inputs.add(m_user_inputs.get_user_inputs().size() - n_applied);
   m_user_inputs = std::vector<user_input>();
   check_selected_pieces_exist();
 }
 
 void game_controller::apply_action_type_to_game(game& g, const piece_action_type t, const side s)
 {
+  ++m_game_version;
   switch (t)
   {
     case piece_action_type::attack: apply_action_type_attack_to_game(g, s); break;
@@ -495,6 +525,65 @@ void game_controller::apply_action_type_unselect_to_game(game& g, const side pla
   this->set_selected_piece_id(player_side, {} );
 }
 
+std::uint64_t calc_hash(const game_controller& c) noexcept
+{
+  // FNV-1a, https://en.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function
+  std::uint64_t hash{14695981039346656037ULL};
+  const auto add_bytes{
+    [&hash](const void * const data, const std::size_t n_bytes)
+    {
+      const auto bytes{static_cast<const unsigned char*>(data)};
+      for (std::size_t i{0}; i != n_bytes; ++i)
+      {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+      }
+    }
+  };
+  const auto add_int{[&add_bytes](const int i) { add_bytes(&i, sizeof(i)); }};
+  const auto add_double{[&add_bytes](const double d) { add_bytes(&d, sizeof(d)); }};
+
+  const game& g{c.get_game()};
+  add_double(g.get_in_game_time().get());
+  add_int(g.get_winner().has_value() ? static_cast<int>(g.get_winner().value()) : -1);
+  // The piece IDs differ between processes, so these are not used
+  for (const auto& p: g.get_pieces())
+  {
+    add_int(static_cast<int>(p.get_type()));
+    add_int(static_cast<int>(p.get_color()));
+    add_int(p.get_current_square().get_x());
+    add_int(p.get_current_square().get_y());
+    add_double(p.get_health());
+    add_int(p.get_kill_count());
+    add_double(p.get_current_action_progress().get());
+    for (const auto& a: p.get_actions())
+    {
+      add_int(static_cast<int>(a.get_action_type()));
+      add_int(a.get_from().get_x());
+      add_int(a.get_from().get_y());
+      add_int(a.get_to().get_x());
+      add_int(a.get_to().get_y());
+    }
+  }
+  for (const side s: get_all_sides())
+  {
+    add_double(c.get_cursor_pos(s).get_x());
+    add_double(c.get_cursor_pos(s).get_y());
+    // The index of the selected piece, if any
+    const auto& id{c.get_selected_piece_id(s)};
+    const auto& pieces{g.get_pieces()};
+    const auto there{
+      std::find_if(
+        std::begin(pieces),
+        std::end(pieces),
+        [&id](const auto& p) { return id.has_value() && p.get_id() == id.value(); }
+      )
+    };
+    add_int(there == std::end(pieces) ? -1 : static_cast<int>(std::distance(std::begin(pieces), there)));
+  }
+  return hash;
+}
+
 bool can_attack(
   const game_controller& c,
   const side player_side
@@ -795,7 +884,7 @@ const in_game_time& get_in_game_time(
   return c.get_game().get_in_game_time();
 }
 
-std::vector<piece_action_type> get_piece_actions(
+std::vector<piece_action_type> collect_piece_actions(
   const game_controller& c,
   const side player_side
 ) noexcept
@@ -849,6 +938,62 @@ std::vector<piece_action_type> get_piece_actions(
   return actions;
 }
 
+const std::vector<piece_action_type>& game_controller::get_piece_actions(
+  const side player_side
+) const noexcept
+{
+  static metric_counter& n_hits{
+    get_metrics().get_counter("piece_actions_memo_hits")
+  };
+  static metric_counter& n_misses{
+    get_metrics().get_counter("piece_actions_memo_misses")
+  };
+  const square cursor_square{get_cursor_square(*this, player_side)};
+  const auto& selected_piece_id{get_selected_piece_id(player_side)};
+  // The pieces are at the centers of their squares,
+  // so whether a piece can be selected only depends on
+  // the cursor's square and if it is near that square's center.
+  // This needs no look at the pieces
+  const bool is_cursor_near_center{
+    calc_distance(get_cursor_pos(player_side), to_coordinat(cursor_square))
+    < get_default_click_distance()
+  };
+  const auto memo{m_piece_actions_memos.find(player_side)};
+  if (
+    memo != std::end(m_piece_actions_memos)
+    && memo->second.m_game_version == m_game_version
+    && memo->second.m_cursor_square == cursor_square
+    && memo->second.m_selected_piece_id == selected_piece_id
+    && memo->second.m_is_cursor_near_center == is_cursor_near_center
+  )
+  {
+    n_hits.add();
+    return memo->second.m_actions;
+  }
+  n_misses.add();
+  piece_actions_memo& m{
+    m_piece_actions_memos.insert_or_assign(
+      player_side,
+      piece_actions_memo{
+        cursor_square,
+        selected_piece_id,
+        m_game_version,
+        is_cursor_near_center,
+        collect_piece_actions(*this, player_side)
+      }
+    ).first->second
+  };
+  return m.m_actions;
+}
+
+std::vector<piece_action_type> get_piece_actions(
+  const game_controller& c,
+  const side player_side
+) noexcept
+{
+  return c.get_piece_actions(player_side);
+}
+
 piece& get_piece_at(game_controller& c, const std::string& square_str)
 {
   return get_piece_at(c.get_game(), square_str);
@@ -1130,6 +1275,25 @@ void test_game_controller() //!OCLINT tests may be many
     add_user_input(c, create_press_action_1(side::lhs));
     assert(!is_empty(get_user_inputs(c)));
   }
+  // calc_hash, same state gives the same hash
+  {
+    const game_controller a;
+    const game_controller b;
+    assert(calc_hash(a) == calc_hash(b));
+  }
+  // calc_hash, another cursor position gives another hash
+  {
+    const game_controller a;
+    game_controller b;
+    move_cursor_to(b, "e4", side::lhs);
+    assert(calc_hash(a) != calc_hash(b));
+  }
+  // calc_hash, another piece position gives another hash
+  {
+    const game_controller a;
+    const game_controller b{game(get_pieces_kings_only())};
+    assert(calc_hash(a) != calc_hash(b));
+  }
   // collect_selected_piece_ids, no selected pieces
   {
     const game_controller c;
@@ -1560,6 +1724,95 @@ void test_game_controller() //!OCLINT tests may be many
     assert(actions.size() == 1);
     assert(actions[0] == piece_action_type::select);
   }
+  // get_piece_actions is remembered while the cursor stays on its square
+  {
+    game_controller c;
+    do_select(c, "d2", side::lhs);
+    move_cursor_to(c, "d3", side::lhs);
+    const metric_counter& n_hits{get_metrics().get_counter("piece_actions_memo_hits")};
+    const metric_counter& n_misses{get_metrics().get_counter("piece_actions_memo_misses")};
+    const auto actions{c.get_piece_actions(side::lhs)};
+    const auto n_hits_before{n_hits.get()};
+    const auto n_misses_before{n_misses.get()};
+    c.set_cursor_pos(get_cursor_pos(c, side::lhs) + game_coordinate(0.1, 0.1), side::lhs);
+    assert(c.get_piece_actions(side::lhs) == actions);
+    assert(n_hits.get() == n_hits_before + 1);
+    assert(n_misses.get() == n_misses_before);
+    // Another square
+    move_cursor_to(c, "d4", side::lhs);
+    assert(c.get_piece_actions(side::lhs) == collect_piece_actions(c, side::lhs));
+    assert(n_misses.get() == n_misses_before + 1);
+    // A tick
+    c.tick(delta_t(0.1));
+    assert(c.get_piece_actions(side::lhs) == collect_piece_actions(c, side::lhs));
+    assert(n_misses.get() == n_misses_before + 2);
+    // Another selected piece
+    do_select(c, "e2", side::lhs);
+    move_cursor_to(c, "d4", side::lhs);
+    assert(c.get_piece_actions(side::lhs) == collect_piece_actions(c, side::lhs));
+    assert(n_misses.get() > n_misses_before + 2);
+  }
+  // get_piece_actions is remembered for a burst of mouse moves within one square
+  {
+    game_controller c;
+    do_select(c, "d2", side::lhs);
+    move_cursor_to(c, "d3", side::lhs);
+    const metric_counter& n_hits{get_metrics().get_counter("piece_actions_memo_hits")};
+    const metric_counter& n_misses{get_metrics().get_counter("piece_actions_memo_misses")};
+    const auto actions{c.get_piece_actions(side::lhs)};
+    const auto n_hits_before{n_hits.get()};
+    const auto n_misses_before{n_misses.get()};
+    const game_coordinate center{to_coordinat(square("d3"))};
+    const int n_moves{10};
+    for (int i{0}; i != n_moves; ++i)
+    {
+      const double d{0.01 * i};
+      add_user_input(c, create_mouse_move_action(center + game_coordinate(d, -d), side::lhs));
+      c.apply_user_inputs_to_game();
+    }
+    assert(get_cursor_square(c, side::lhs) == square("d3"));
+    assert(c.get_piece_actions(side::lhs) == actions);
+    assert(n_hits.get() >= n_hits_before + n_moves);
+    assert(n_misses.get() == n_misses_before);
+  }
+  // An action applied by a user input forgets the remembered piece actions
+  {
+    game_controller c;
+    move_cursor_to(c, "e2", side::lhs);
+    const metric_counter& n_misses{get_metrics().get_counter("piece_actions_memo_misses")};
+    assert(c.get_piece_actions(side::lhs) == std::vector<piece_action_type>( { piece_action_type::select } ));
+    const auto n_misses_before{n_misses.get()};
+    add_user_input(c, create_press_action_1(side::lhs));
+    c.apply_user_inputs_to_game();
+    assert(count_selected_units(c, chess_color::white) == 1);
+    assert(c.get_piece_actions(side::lhs) == collect_piece_actions(c, side::lhs));
+    assert(c.get_piece_actions(side::lhs) != std::vector<piece_action_type>( { piece_action_type::select } ));
+    assert(n_misses.get() > n_misses_before);
+  }
+  // get_piece_actions is the same as collect_piece_actions in a random game
+  {
+    game_controller c;
+    std::default_random_engine rng_engine(42);
+    std::uniform_real_distribution<double> coordinat_distribution(0.0, 8.0);
+    for (int i{0}; i != 1000; ++i)
+    {
+      const user_input input{create_useful_random_user_input(rng_engine)};
+      add_user_input(c, input);
+      add_user_input(
+        c,
+        create_mouse_move_action(
+          game_coordinate(coordinat_distribution(rng_engine), coordinat_distribution(rng_engine)),
+          input.get_player()
+        )
+      );
+      c.apply_user_inputs_to_game();
+      if (i % 4 == 0) c.tick(delta_t(0.1));
+      for (const side s: get_all_sides())
+      {
+        assert(c.get_piece_actions(s) == collect_piece_actions(c, s));
+      }
+    }
+  }
   // 53: Piece selected, cursor at valid target square -> move, lhs
   {
     game_controller c;
@@ -2632,6 +2885,7 @@ void game_controller::tick(const delta_t& dt)
 {
   check_selected_pieces_exist();
   m_game.tick(dt);
+  ++m_game_version;
 
   update_selectedness_due_to_captures();
   check_selected_pieces_exist();
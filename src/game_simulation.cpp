@@ -0,0 +1,427 @@
+#include "game_simulation.h"
+
+#include "diagnostics_log.h"
+#include "game_coordinate.h"
+#include "metrics.h"
+#include "piece.h"
+#include "square.h"
+#include "trace.h"
+#include "user_input.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iterator>
+#include <utility>
+
+game_snapshot::game_snapshot(
+  const game_controller& c,
+  const int n_steps
+) : m_game_controller{c},
+    m_n_steps{n_steps}
+{
+  assert(m_n_steps >= 0);
+}
+
+game_simulation::game_simulation(
+  const game_controller& c,
+  const game_speed speed,
+  const double steps_per_second
+) : m_game_controller{c},
+    m_snapshots(game_snapshot(c, 0)),
+    m_speed{speed},
+    m_steps_per_second{steps_per_second}
+{
+  assert(m_steps_per_second > 0.0);
+}
+
+game_simulation::~game_simulation()
+{
+  stop();
+}
+
+void game_simulation::add_user_inputs(const user_inputs& inputs)
+{
+  static metric_counter& n_queue_full{
+    get_metrics().get_counter("user_inputs_queue_full")
+  };
+  if (is_empty(inputs)) return;
+  flush_user_inputs();
+  if (!has_waiting_user_inputs()
+    && m_user_inputs.try_push(
+      timed_user_inputs{inputs, std::chrono::steady_clock::now()}
+    )
+  )
+  {
+    return;
+  }
+  // Keep the order: these inputs wait after the earlier ones
+  if (!has_waiting_user_inputs())
+  {
+    n_queue_full.add();
+    get_diagnostics_log().add(
+      log_severity::warning,
+      "The user inputs queue is full, the user inputs wait"
+    );
+    m_waiting_user_inputs.m_time = std::chrono::steady_clock::now();
+  }
+  add(m_waiting_user_inputs.m_user_inputs, inputs);
+}
+
+std::vector<message> game_simulation::collect_messages()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::vector<message> messages;
+  std::swap(messages, m_messages);
+  return messages;
+}
+
+void game_simulation::flush_user_inputs()
+{
+  if (!has_waiting_user_inputs()) return;
+  if (m_user_inputs.try_push(m_waiting_user_inputs))
+  {
+    m_waiting_user_inputs = timed_user_inputs();
+  }
+}
+
+delta_t game_simulation::get_delta_t() const noexcept
+{
+  return delta_t(get_speed_multiplier(m_speed) / m_steps_per_second);
+}
+
+bool game_simulation::has_waiting_user_inputs() const noexcept
+{
+  return !is_empty(m_waiting_user_inputs.m_user_inputs);
+}
+
+void game_simulation::run()
+{
+  using clock = std::chrono::steady_clock;
+  const auto step_time{
+    std::chrono::duration_cast<clock::duration>(
+      std::chrono::duration<double>(get_step_time_secs())
+    )
+  };
+  // If the simulation falls this many steps behind,
+  // give up catching up, instead of trying to catch up forever
+  const int max_n_steps_behind{10};
+
+  auto next_step{clock::now()};
+  while (!m_must_stop)
+  {
+    step();
+    next_step += step_time;
+    const auto now{clock::now()};
+    if (now - next_step > max_n_steps_behind * step_time)
+    {
+      next_step = now;
+    }
+    std::this_thread::sleep_until(next_step);
+  }
+}
+
+void game_simulation::start()
+{
+  assert(!is_running());
+  m_must_stop = false;
+  m_thread = std::thread(&game_simulation::run, this);
+}
+
+void game_simulation::step()
+{
+  const trace_scope scope("game_simulation::step");
+  static metric_histogram& step_times_ms{
+    get_metrics().get_histogram("simulation_step_ms")
+  };
+  static metric_histogram& input_to_action_ms{
+    get_metrics().get_histogram("input_to_action_ms")
+  };
+  const auto start{std::chrono::steady_clock::now()};
+  const bool has_winner{std::as_const(m_game_controller).get_game().get_winner().has_value()};
+  const bool measure_input_latency{m_measure_input_latency};
+  timed_user_inputs inputs;
+  while (m_user_inputs.try_pop(inputs))
+  {
+    ::add_user_inputs(m_game_controller, inputs.m_user_inputs);
+    if (measure_input_latency && !has_winner)
+    {
+      const auto n_actions_before{count_piece_actions_added_by_this_thread()};
+      m_game_controller.apply_user_inputs_to_game();
+      if (count_piece_actions_added_by_this_thread() != n_actions_before)
+      {
+        input_to_action_ms.add(
+          std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - inputs.m_time
+          ).count()
+        );
+      }
+    }
+  }
+  if (!has_winner)
+  {
+    m_game_controller.apply_user_inputs_to_game();
+    m_game_controller.tick(get_delta_t());
+  }
+  ++m_n_steps;
+
+  // Hand over the pieces' messages
+  std::vector<message> messages{::collect_messages(std::as_const(m_game_controller).get_game())};
+  clear_piece_messages(m_game_controller.get_game());
+  if (!messages.empty())
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::copy(
+      std::begin(messages),
+      std::end(messages),
+      std::back_inserter(m_messages)
+    );
+  }
+
+  m_snapshots.get_back() = game_snapshot(m_game_controller, m_n_steps);
+  m_snapshots.publish();
+
+  step_times_ms.add(
+    std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start
+    ).count()
+  );
+}
+
+void game_simulation::stop()
+{
+  if (!is_running()) return;
+  m_must_stop = true;
+  m_thread.join();
+}
+
+void interpolate(
+  const game_snapshot& from,
+  const game_snapshot& to,
+  const double f,
+  std::vector<double>& progresses
+)
+{
+  assert(f >= 0.0);
+  assert(f <= 1.0);
+  const auto& from_pieces{from.get_game_controller().get_game().get_pieces()};
+  const auto& to_pieces{to.get_game_controller().get_game().get_pieces()};
+  progresses.resize(to_pieces.size());
+  for (std::size_t i{0}; i != to_pieces.size(); ++i)
+  {
+    const piece& p{to_pieces[i]};
+    const double to_progress{p.get_current_action_progress().get()};
+    progresses[i] = to_progress;
+    if (p.get_actions().empty()) continue;
+    const auto there{
+      std::find_if(
+        std::begin(from_pieces),
+        std::end(from_pieces),
+        [&p](const auto& q) { return q.get_id() == p.get_id(); }
+      )
+    };
+    // Only interpolate if it is the same action
+    if (there == std::end(from_pieces)) continue;
+    if (there->get_actions().empty()) continue;
+    if (!(there->get_actions()[0] == p.get_actions()[0])) continue;
+    const double from_progress{there->get_current_action_progress().get()};
+    progresses[i] = from_progress + (f * (to_progress - from_progress));
+  }
+}
+
+void test_game_simulation()
+{
+#ifndef NDEBUG
+  // A new simulation has done no steps
+  {
+    game_simulation s;
+    assert(s.get_snapshot().get_n_steps() == 0);
+    assert(!s.is_running());
+  }
+  // A step is published
+  {
+    game_simulation s;
+    s.step();
+    assert(s.get_snapshot().get_n_steps() == 1);
+  }
+  // Every step has the same delta_t
+  {
+    game_simulation s(game_controller(), game_speed::normal, 100.0);
+    for (int i{0}; i != 100; ++i) s.step();
+    const double t{
+      s.get_snapshot().get_game_controller().get_game().get_in_game_time().get()
+    };
+    assert(std::abs(t - (100.0 * s.get_delta_t().get())) < 0.0001);
+  }
+  // The same user inputs in the same steps give the same game
+  {
+    game_simulation a;
+    game_simulation b;
+    for (auto s: { &a, &b })
+    {
+      user_inputs inputs;
+      inputs.add(create_mouse_move_action(to_coordinat(square("e2")), side::lhs));
+      inputs.add(create_press_lmb_action(side::lhs));
+      inputs.add(create_mouse_move_action(to_coordinat(square("e4")), side::lhs));
+      inputs.add(create_press_lmb_action(side::lhs));
+      s->add_user_inputs(inputs);
+      for (int i{0}; i != 200; ++i) s->step();
+    }
+    assert(
+      a.get_snapshot().get_game_controller().get_game().get_pieces()
+      == b.get_snapshot().get_game_controller().get_game().get_pieces()
+    );
+    assert(!a.collect_messages().empty());
+    assert(a.collect_messages().empty());
+  }
+  // The time from a user input to a piece starting an action is measured
+  {
+    const metric_histogram& input_to_action_ms{
+      get_metrics().get_histogram("input_to_action_ms")
+    };
+    const auto n_before{input_to_action_ms.get_count()};
+    game_simulation s;
+    assert(!s.get_measure_input_latency());
+    s.set_measure_input_latency(true);
+    assert(s.get_measure_input_latency());
+    user_inputs select;
+    select.add(create_mouse_move_action(to_coordinat(square("e2")), side::lhs));
+    select.add(create_press_lmb_action(side::lhs));
+    s.add_user_inputs(select);
+    user_inputs move;
+    move.add(create_mouse_move_action(to_coordinat(square("e4")), side::lhs));
+    move.add(create_press_lmb_action(side::lhs));
+    s.add_user_inputs(move);
+    s.step();
+    assert(input_to_action_ms.get_count() > n_before);
+  }
+  // When the queue is full, user inputs wait and only mouse moves are combined
+  {
+    game_simulation s;
+    user_inputs move;
+    move.add(create_mouse_move_action(to_coordinat(square("e2")), side::lhs));
+    for (int i{0}; i != 1024; ++i) s.add_user_inputs(move);
+    assert(!s.has_waiting_user_inputs());
+    user_inputs press;
+    press.add(create_press_lmb_action(side::lhs));
+    user_inputs move_to_e3;
+    move_to_e3.add(create_mouse_move_action(to_coordinat(square("e3")), side::lhs));
+    user_inputs move_to_e4;
+    move_to_e4.add(create_mouse_move_action(to_coordinat(square("e4")), side::lhs));
+    s.add_user_inputs(press);
+    s.add_user_inputs(move_to_e3);
+    s.add_user_inputs(move_to_e4);
+    s.add_user_inputs(press);
+    assert(s.has_waiting_user_inputs());
+    // The queue is emptied by a step, after which the waiting inputs fit
+    s.step();
+    s.flush_user_inputs();
+    assert(!s.has_waiting_user_inputs());
+    // Both clicks arrive, at the last cursor position: e2 is moved to e4
+    s.step();
+    const auto& pieces{s.get_snapshot().get_game_controller().get_game().get_pieces()};
+    assert(
+      std::any_of(
+        std::begin(pieces),
+        std::end(pieces),
+        [](const auto& p)
+        {
+          return !p.get_actions().empty()
+            && p.get_actions()[0].get_to() == square("e4");
+        }
+      )
+    );
+  }
+  // Start and stop
+  {
+    game_simulation s;
+    s.start();
+    assert(s.is_running());
+    while (s.get_snapshot().get_n_steps() == 0) {}
+    s.stop();
+    assert(!s.is_running());
+  }
+  // interpolate
+  {
+    game_controller c;
+    const piece_id id{get_piece_at(c.get_game(), "e2").get_id()};
+    do_select(c, "e2", side::lhs);
+    move_cursor_to(c, "e4", side::lhs);
+    add_user_input(c, create_press_action_1(side::lhs));
+    c.apply_user_inputs_to_game();
+    c.tick(delta_t(0.1));
+    const game_snapshot from(c, 1);
+    c.tick(delta_t(0.1));
+    const game_snapshot to(c, 2);
+    const auto& pieces{to.get_game_controller().get_game().get_pieces()};
+    const std::size_t i{
+      static_cast<std::size_t>(
+        std::distance(
+          std::begin(pieces),
+          std::find_if(
+            std::begin(pieces),
+            std::end(pieces),
+            [id](const auto& p) { return p.get_id() == id; }
+          )
+        )
+      )
+    };
+    const double p_from{
+      get_piece_with_id(from.get_game_controller().get_game(), id).get_current_action_progress().get()
+    };
+    const double p_to{pieces[i].get_current_action_progress().get()};
+    assert(p_from < p_to);
+    std::vector<double> progresses;
+    // At 0.0, the progress is the one in 'from'
+    interpolate(from, to, 0.0, progresses);
+    assert(progresses.size() == pieces.size());
+    assert(progresses[i] == p_from);
+    // At 0.5, the progress is halfway
+    interpolate(from, to, 0.5, progresses);
+    assert(std::abs(progresses[i] - ((p_from + p_to) / 2.0)) < 0.0001);
+    // At 1.0, the progress is the one in 'to'
+    interpolate(from, to, 1.0, progresses);
+    assert(progresses[i] == p_to);
+    // The memory is reused
+    const double * const data{progresses.data()};
+    interpolate(from, to, 0.5, progresses);
+    assert(progresses.data() == data);
+  }
+  // interpolate, with a piece that is only in one of the two snapshots
+  {
+    game_controller c;
+    const piece_id id{get_piece_at(c.get_game(), "e2").get_id()};
+    do_select(c, "e2", side::lhs);
+    move_cursor_to(c, "e4", side::lhs);
+    add_user_input(c, create_press_action_1(side::lhs));
+    c.apply_user_inputs_to_game();
+    c.tick(delta_t(0.1));
+    const game_snapshot to(c, 2);
+    // 'from' has all pieces except the moving one and one that is gone in 'to'
+    std::vector<piece> from_pieces;
+    for (const auto& p: c.get_game().get_pieces())
+    {
+      if (p.get_id() != id) from_pieces.push_back(p);
+    }
+    const game_snapshot from(game_controller(game(from_pieces)), 1);
+    auto to_pieces{c.get_game().get_pieces()};
+    to_pieces.erase(std::begin(to_pieces));
+    const game_snapshot to_with_one_less(game_controller(game(to_pieces)), 2);
+
+    // A piece that is absent in 'from' has its progress in 'to'
+    std::vector<double> progresses;
+    interpolate(from, to, 0.5, progresses);
+    const double p_to{get_piece_with_id(c.get_game(), id).get_current_action_progress().get()};
+    assert(p_to > 0.0);
+    const auto& pieces{to.get_game_controller().get_game().get_pieces()};
+    for (std::size_t i{0}; i != pieces.size(); ++i)
+    {
+      if (pieces[i].get_id() == id) assert(progresses[i] == p_to);
+    }
+    // A piece that is absent in 'to' is not shown
+    interpolate(to, to_with_one_less, 0.5, progresses);
+    assert(progresses.size() == to_pieces.size());
+  }
+#endif // NDEBUG
+}
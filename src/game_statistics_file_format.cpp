@@ -0,0 +1,50 @@
+#include "game_statistics_file_format.h"
+
+#include <cassert>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+#include "../magic_enum/include/magic_enum/magic_enum.hpp" // https://github.com/Neargye/magic_enum
+
+std::vector<game_statistics_file_format> get_all_game_statistics_file_formats() noexcept
+{
+  const auto a{magic_enum::enum_values<game_statistics_file_format>()};
+  std::vector<game_statistics_file_format> v;
+  v.reserve(a.size());
+  std::copy(std::begin(a), std::end(a), std::back_inserter(v));
+  assert(a.size() == v.size());
+  return v;
+}
+
+void test_game_statistics_file_format()
+{
+#ifndef NDEBUG
+  // get_all_game_statistics_file_formats
+  {
+    assert(get_all_game_statistics_file_formats().size() == 2);
+  }
+  // to_str
+  {
+    assert(to_str(game_statistics_file_format::csv) == "csv");
+    assert(to_str(game_statistics_file_format::binary) == "binary");
+  }
+  // operator<<
+  {
+    std::stringstream s;
+    s << game_statistics_file_format::binary;
+    assert(!s.str().empty());
+  }
+#endif // NDEBUG
+}
+
+std::string to_str(const game_statistics_file_format f) noexcept
+{
+  return std::string(magic_enum::enum_name(f));
+}
+
+std::ostream& operator<<(std::ostream& os, const game_statistics_file_format f) noexcept
+{
+  os << to_str(f);
+  return os;
+}
@@ -6,21 +6,132 @@
 #include "helper.h"
 
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <fstream>
 #include <filesystem>
+#include <stdexcept>
 
-game_statistics_output_file::game_statistics_output_file(const std::string& filename)
-  : m_filename{filename}
+namespace {
+
+/// The first characters of a binary statistics file
+const std::string binary_magic{"CCGS"};
+
+void write_binary(std::ostream& os, const std::uint32_t i)
+{
+  os.write(reinterpret_cast<const char*>(&i), sizeof(i));
+}
+
+void write_binary(std::ostream& os, const float f)
+{
+  os.write(reinterpret_cast<const char*>(&f), sizeof(f));
+}
+
+std::uint32_t read_binary_uint32(std::istream& is)
+{
+  std::uint32_t i{0};
+  is.read(reinterpret_cast<char*>(&i), sizeof(i));
+  return i;
+}
+
+float read_binary_float(std::istream& is)
+{
+  float f{0.0};
+  is.read(reinterpret_cast<char*>(&f), sizeof(f));
+  return f;
+}
+
+} // ~namespace
+
+game_statistics_output_file::game_statistics_output_file(
+  const std::string& filename,
+  const game_statistics_file_format format,
+  const double flush_interval_secs
+) : m_filename{filename},
+    m_format{format},
+    m_flush_interval_secs{flush_interval_secs}
 {
-  std::ofstream f(filename);
-  f << get_column_headers_as_str() << '\n';
+  assert(m_flush_interval_secs > 0.0);
+  {
+    std::ofstream f(m_filename, std::ios::binary);
+    write_game_statistics_header(f, m_format);
+  }
+  m_writer = std::thread(&game_statistics_output_file::run, this);
+}
+
+game_statistics_output_file::~game_statistics_output_file()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_must_stop = true;
+  }
+  m_wake_writer.notify_one();
+  m_writer.join();
 }
 
 void game_statistics_output_file::add_to_file(const game_controller& c)
 {
   const game_statistics s(c);
-  std::ofstream f(m_filename, std::ios::app);
-  f << to_comma_seperated_str(flatten_to_row(s)) << '\n';
+  if (m_rows.try_push(flatten_to_row(s)))
+  {
+    ++m_n_rows_added;
+  }
+  else
+  {
+    ++m_n_dropped_rows;
+  }
+}
+
+void game_statistics_output_file::flush()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  const int n_rows_added{m_n_rows_added};
+  m_must_flush = true;
+  m_wake_writer.notify_one();
+  m_rows_written.wait(
+    lock,
+    [this, n_rows_added]() { return m_n_rows_written >= n_rows_added; }
+  );
+}
+
+void game_statistics_output_file::run()
+{
+  std::ofstream f(m_filename, std::ios::app | std::ios::binary);
+  const auto flush_interval{
+    std::chrono::duration<double>(m_flush_interval_secs)
+  };
+  std::vector<std::vector<double>> rows;
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (1)
+  {
+    m_wake_writer.wait_for(
+      lock,
+      flush_interval,
+      [this]() { return m_must_flush || m_must_stop; }
+    );
+    const bool must_stop{m_must_stop};
+    m_must_flush = false;
+    lock.unlock();
+
+    // Write without holding the lock
+    std::vector<double> row;
+    while (m_rows.try_pop(row))
+    {
+      rows.push_back(std::move(row));
+    }
+    if (!rows.empty())
+    {
+      write_game_statistics_rows(f, rows, m_format);
+      f.flush();
+    }
+
+    lock.lock();
+    m_n_rows_written += static_cast<int>(rows.size());
+    rows.clear();
+    m_rows_written.notify_all();
+    if (must_stop) return;
+  }
 }
 
 std::string get_column_headers_as_str()
@@ -28,6 +139,44 @@ std::string get_column_headers_as_str()
   return to_comma_seperated_str(get_column_headers());
 }
 
+std::string get_default_game_statistics_filename() noexcept
+{
+  return "conquer_chess_game_statistics.csv";
+}
+
+std::vector<std::vector<double>> read_binary_game_statistics_file(const std::string& filename)
+{
+  std::ifstream f(filename, std::ios::binary);
+  std::string magic(binary_magic.size(), ' ');
+  f.read(magic.data(), magic.size());
+  if (magic != binary_magic)
+  {
+    throw std::runtime_error("Not a binary game statistics file: " + filename);
+  }
+  const std::uint32_t n_columns{read_binary_uint32(f)};
+  for (std::uint32_t i{0}; i != n_columns; ++i)
+  {
+    const std::uint32_t length{read_binary_uint32(f)};
+    f.ignore(length);
+  }
+  std::vector<std::vector<double>> rows;
+  while (1)
+  {
+    const std::uint32_t n_rows{read_binary_uint32(f)};
+    if (!f) break;
+    const std::size_t first_row{rows.size()};
+    rows.resize(first_row + n_rows, std::vector<double>(n_columns));
+    for (std::uint32_t col{0}; col != n_columns; ++col)
+    {
+      for (std::uint32_t row{0}; row != n_rows; ++row)
+      {
+        rows[first_row + row][col] = read_binary_float(f);
+      }
+    }
+  }
+  return rows;
+}
+
 void test_game_statistics_output_file()
 {
 #ifndef NDEBUG
@@ -42,6 +191,74 @@ void test_game_statistics_output_file()
     const game_controller c;
     f.add_to_file(c);
   }
+  // CSV, rows are written when flushed
+  {
+    const std::string filename("tmp.csv");
+    game_statistics_output_file f(filename);
+    const game_controller c;
+    f.add_to_file(c);
+    f.add_to_file(c);
+    f.flush();
+    std::ifstream is(filename);
+    std::string line;
+    int n_lines{0};
+    while (std::getline(is, line)) ++n_lines;
+    assert(n_lines == 3); // The header and two rows
+    assert(f.get_n_dropped_rows() == 0);
+  }
+  // CSV, rows are written when destroyed
+  {
+    const std::string filename("tmp.csv");
+    {
+      game_statistics_output_file f(filename);
+      const game_controller c;
+      f.add_to_file(c);
+    }
+    std::ifstream is(filename);
+    std::string line;
+    int n_lines{0};
+    while (std::getline(is, line)) ++n_lines;
+    assert(n_lines == 2); // The header and one row
+  }
+  // Binary, rows can be read back
+  {
+    const std::string filename("tmp.bin");
+    const game_controller c;
+    {
+      game_statistics_output_file f(filename, game_statistics_file_format::binary);
+      assert(f.get_format() == game_statistics_file_format::binary);
+      f.add_to_file(c);
+      f.flush(); // Creates a second block
+      f.add_to_file(c);
+    }
+    const auto rows{read_binary_game_statistics_file(filename)};
+    assert(rows.size() == 2);
+    const auto expected{flatten_to_row(game_statistics(c))};
+    assert(rows[0].size() == expected.size());
+    for (std::size_t i{0}; i != expected.size(); ++i)
+    {
+      assert(std::abs(rows[1][i] - expected[i]) < 0.001);
+    }
+    std::filesystem::remove(filename);
+  }
+  // Binary, reading a CSV file throws
+  {
+    const std::string filename("tmp.csv");
+    {
+      game_statistics_output_file f(filename);
+    }
+    bool has_thrown{false};
+    try
+    {
+      read_binary_game_statistics_file(filename);
+    }
+    catch (const std::runtime_error&)
+    {
+      has_thrown = true;
+    }
+    assert(has_thrown);
+    std::filesystem::remove(filename);
+  }
   // column_headers_to_str
   {
     assert(!get_column_headers_as_str().empty());
@@ -60,3 +277,52 @@ void test_game_statistics_output_file()
   }
 #endif
 }
+
+void write_game_statistics_header(
+  std::ostream& os,
+  const game_statistics_file_format format
+)
+{
+  if (format == game_statistics_file_format::csv)
+  {
+    os << get_column_headers_as_str() << '\n';
+    return;
+  }
+  assert(format == game_statistics_file_format::binary);
+  os << binary_magic;
+  const auto headers{get_column_headers()};
+  write_binary(os, static_cast<std::uint32_t>(headers.size()));
+  for (const auto& header: headers)
+  {
+    write_binary(os, static_cast<std::uint32_t>(header.size()));
+    os << header;
+  }
+}
+
+void write_game_statistics_rows(
+  std::ostream& os,
+  const std::vector<std::vector<double>>& rows,
+  const game_statistics_file_format format
+)
+{
+  if (format == game_statistics_file_format::csv)
+  {
+    for (const auto& row: rows)
+    {
+      os << to_comma_seperated_str(row) << '\n';
+    }
+    return;
+  }
+  assert(format == game_statistics_file_format::binary);
+  if (rows.empty()) return;
+  const std::size_t n_columns{rows[0].size()};
+  write_binary(os, static_cast<std::uint32_t>(rows.size()));
+  for (std::size_t col{0}; col != n_columns; ++col)
+  {
+    for (const auto& row: rows)
+    {
+      assert(row.size() == n_columns);
+      write_binary(os, static_cast<float>(row[col]));
+    }
+  }
+}
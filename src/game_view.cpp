@@ -21,6 +21,7 @@
 #include "screen_rect.h"
 #include "screen_rect.h"
 #include "sfml_helper.h"
+#include "trace.h"
 
 #include <SFML/Graphics.hpp>
 #include <SFML/Graphics/Text.hpp>
@@ -30,11 +31,11 @@
 #include <iterator>
 #include <string>
 #include <sstream>
+#include <utility>
 
 game_view::game_view(
-) : m_game_controller{},
-    m_log{get_default_message_display_time_secs()},
-    m_statistics_output_file("tmp.txt")
+) : m_log{get_default_message_display_time_secs()},
+    m_statistics_output_file(get_default_game_statistics_filename())
 {
   m_controls_bar.set_draw_up_down(false);
   m_controls_bar.set_draw_select(false);
@@ -42,32 +43,31 @@ game_view::game_view(
 }
 
 
-void game_view::tick_impl(delta_t dt)
+void game_view::tick_impl(delta_t)
 {
   assert(is_active());
 
-  //const game& g{m_game_controller.get_game()};
+  const in_game_time last_time{get_in_game_time(get_game_controller())};
+
+  // Pass the user inputs that waited because the queue was full
+  m_simulation->flush_user_inputs();
+
+  // Show the newest state of the simulation
+  update_game_controller();
 
   const int n_logs_per_time_unit{8};
-  if (static_cast<int>(get_in_game_time(m_game_controller).get() * n_logs_per_time_unit)
-    < static_cast<int>((get_in_game_time(m_game_controller) + dt).get() * n_logs_per_time_unit))
+  if (static_cast<int>(last_time.get() * n_logs_per_time_unit)
+    < static_cast<int>(get_in_game_time(get_game_controller()).get() * n_logs_per_time_unit))
   {
-    m_statistics_output_file.add_to_file(m_game_controller);
-    m_statistics_in_time.add(m_game_controller);
+    m_statistics_output_file.add_to_file(get_game_controller());
+    m_statistics_in_time.add(get_game_controller());
   }
 
   // Disard old messages
   m_log.tick();
 
-  if (!get_winner(m_game_controller).has_value())
-  {
-
-    // Do a tick, so that one delta_t equals one second under normal game speed
-    m_game_controller.tick(dt);
-
-    // Read the pieces' messages and play their sounds
-    process_piece_messages();
-  }
+  // Read the pieces' messages and play their sounds
+  process_piece_messages();
 
   // Show the new state
   draw_impl();
@@ -113,17 +113,14 @@ const std::vector<piece>& get_pieces(const game_view& v) noexcept
 replay game_view::get_replay() const
 {
   return replay(
-    create_action_history_from_game(m_game_controller.get_game()),
-    m_game_controller
+    create_action_history_from_game(get_game()),
+    get_game_controller()
   );
 }
 
-void game_view::play_pieces_sound_effects()
+void game_view::play_pieces_sound_effects(const std::vector<message>& messages)
 {
-  for (const auto& sound_effect: collect_messages(m_game_controller.get_game()))
-  {
-    game_resources::get().get_sound_effects().play(sound_effect);
-  }
+  game_resources::get().get_sound_effects().play(messages);
 }
 
 const game_coordinate& get_cursor_pos(const game_view& view, const side player) noexcept
@@ -183,10 +180,15 @@ bool game_view::process_event_impl(sf::Event& event)
   }
 
   // Become unresponsive when there is a winner
-  if (!m_game_controller.get_game().get_winner().has_value())
+  if (!get_game().get_winner().has_value())
   {
-    ::process_event(m_game_controller, m_pc, event, m_layout);
-    m_game_controller.apply_user_inputs_to_game();
+    // The simulation applies the user inputs in its next step
+    for (const auto s: get_all_sides())
+    {
+      m_simulation->add_user_inputs(
+        m_pc.get_controller(s).process_input(event, s, m_layout)
+      );
+    }
   }
   return false;
 }
@@ -222,23 +224,26 @@ void process_event(
 
 void game_view::process_piece_messages()
 {
-  for (const auto& piece_message: collect_messages(m_game_controller.get_game()))
+  const std::vector<message> messages{m_simulation->collect_messages()};
+  for (const auto& piece_message: messages)
   {
     m_log.add_message(piece_message);
   }
 
   // Play the new sounds to be played
-  play_pieces_sound_effects();
-
-  clear_piece_messages(m_game_controller.get_game());
+  play_pieces_sound_effects(messages);
 }
 
 void game_view::draw_impl()
 {
-  // Show the layout of the screen: board and sidebars
-  draw_background(*this);
+  const trace_scope scope("game_view::draw_impl");
+  // Show the map and the squares of the board
+  m_board_background.draw(
+    m_layout,
+    get_game_controller().get_lobby_options().get_race(chess_color::white)
+  );
 
-  // Show the board: squares, unit paths, pieces, health bars
+  // Show the board: unit paths, pieces, health bars
   draw_board(*this, m_game_options.get_show_occupied());
 
   // In-game statistics widget
@@ -263,11 +268,11 @@ void game_view::draw_impl()
   }
 
   // Draw winner
-  if (m_game_controller.get_game().get_winner().has_value())
+  if (get_game().get_winner().has_value())
   {
 
     draw_text(
-      "Winner: " + to_human_str(m_game_controller.get_game().get_winner().value()),
+      "Winner: " + to_human_str(get_game().get_winner().value()),
       m_layout.get_background(),
       200
     );
@@ -281,7 +286,7 @@ void draw_board(
   const bool show_occupied
 )
 {
-  draw_squares(view);
+  const trace_scope scope("draw_board");
   if (show_occupied)
   {
     show_occupied_squares(view);
@@ -304,6 +309,7 @@ void draw_controls(
   const side player_side
 )
 {
+  const trace_scope scope("draw_controls");
   // Stub for keyboard only
   const auto& c{ view.get_physical_controllers().get_controller(player_side)};
 
@@ -366,6 +372,7 @@ void draw_controls(
 
 void draw_game_statistics_widget(game_view& view)
 {
+  const trace_scope scope("draw_game_statistics_widget");
   draw_game_statistics_widget(
     view.get_layout().get_game_info(),
     view.get_game_controller()
@@ -374,6 +381,7 @@ void draw_game_statistics_widget(game_view& view)
 
 void draw_navigation_controls(game_view& view)
 {
+  const trace_scope scope("draw_navigation_controls");
   for (const auto s: get_all_sides())
   {
     draw_navigation_controls(
@@ -424,7 +432,7 @@ void game_view::show_mouse_cursor()
   cursor.setOrigin(16.0, 16.0);
   const screen_coordinate cursor_pos{
     convert_to_screen_coordinate(
-      get_cursor_pos(m_game_controller, side::rhs),
+      get_cursor_pos(get_game_controller(), side::rhs),
       layout
     )
   };
@@ -437,6 +445,7 @@ void game_view::show_mouse_cursor()
 
 void draw_log(game_view& view, const side player)
 {
+  const trace_scope scope("draw_log");
   const auto& layout = view.get_layout();
   sf::Text text;
   text.setFont(game_resources::get().get_fonts().get_arial_font());
@@ -451,15 +460,6 @@ void draw_log(game_view& view, const side player)
   get_render_window().draw(text);
 }
 
-void draw_background(game_view& view)
-{
-  const auto& layout{view.get_layout()};
-  draw_texture(
-    get_map_texture(view.get_game_controller().get_lobby_options().get_race(chess_color::white)),
-    screen_rect(layout.get_background())
-  );
-}
-
 
 void show_occupied_squares(game_view& view)
 {
@@ -488,17 +488,20 @@ void show_occupied_squares(game_view& view)
 
 void draw_pieces(game_view& view)
 {
+  const trace_scope scope("draw_pieces");
   const bool indicate_protectedness{true};
   draw_pieces(
     view.get_game_controller(),
     view.get_layout().get_board(),
-    indicate_protectedness
+    indicate_protectedness,
+    view.get_piece_progresses()
   );
 
 }
 
 void draw_possible_moves(game_view& view)
 {
+  const trace_scope scope("draw_possible_moves");
   const auto& g{view.get_game()};
   const auto& c{view.get_game_controller()};
   const auto& layout{view.get_layout()};
@@ -526,16 +529,12 @@ void draw_possible_moves(game_view& view)
 }
 
 
-void draw_squares(game_view& view)
-{
-  draw_squares(view.get_layout().get_board().get_board());
-}
-
 void draw_cursor(
   game_view& view,
   const side player
 )
 {
+  const trace_scope scope("draw_cursor");
   const auto& c{view.get_game_controller()};
   const auto& layout{view.get_layout()};
   const int x{
@@ -583,6 +582,7 @@ void draw_cursor(
 
 void draw_unit_health_bars(game_view& view)
 {
+  const trace_scope scope("draw_unit_health_bars");
   draw_unit_health_bars(
     view.get_game(),
     view.get_layout().get_board()
@@ -592,14 +592,17 @@ void draw_unit_health_bars(game_view& view)
 
 void draw_unit_paths(game_view& view)
 {
+  const trace_scope scope("draw_unit_paths");
   draw_unit_paths(
     view.get_game().get_pieces(),
-    view.get_layout().get_board()
+    view.get_layout().get_board(),
+    view.get_piece_progresses()
   );
 }
 
 void draw_unit_info(game_view& view, const side player_side)
 {
+  const trace_scope scope("draw_unit_info");
   const auto& layout{view.get_layout()};
   const auto& r{layout.get_unit_info(player_side)};
   const auto& c{view.get_game_controller()};
@@ -651,7 +654,7 @@ void game_view::start_impl()
   game_resources::get().get_sound_effects().set_master_volume(
     get_sound_effects_volume(m_game_options)
   );
-  m_game_controller = game_controller(
+  const game_controller c(
     create_game_with_starting_position(
       m_game_options.get_starting_position(),
       m_lobby_options.get_race(side::lhs),
@@ -659,6 +662,16 @@ void game_view::start_impl()
     ),
     m_lobby_options
   );
+  m_simulation = std::make_unique<game_simulation>(
+    c,
+    m_game_options.get_game_speed()
+  );
+  // Show the input latency in the debug info
+  m_simulation->set_measure_input_latency(m_game_options.get_show_debug_info());
+  m_previous_snapshot = m_simulation->get_snapshot();
+  m_latest_snapshot = m_simulation->get_snapshot();
+  m_snapshot_clock.restart();
+  m_simulation->start();
   assert(!is_active());
   set_is_active(true);
 
@@ -667,12 +680,40 @@ void game_view::start_impl()
 void game_view::stop_impl()
 {
   assert(is_active());
+  m_simulation->stop();
   m_clock.restart();
   game_resources::get().get_songs().get_wonderful_time().stop();
   clear_next_state();
   set_is_active(false);
 }
 
+void game_view::update_game_controller()
+{
+  const game_snapshot& snapshot{m_simulation->get_snapshot()};
+  if (snapshot.get_n_steps() != m_latest_snapshot.get_n_steps())
+  {
+    // Swap first, so that the copy reuses the memory of the oldest snapshot
+    std::swap(m_previous_snapshot, m_latest_snapshot);
+    m_latest_snapshot = snapshot;
+    m_snapshot_clock.restart();
+  }
+  // Show the previous snapshot going to the latest one,
+  // in the time the simulation took to get from the one to the other
+  const int n_steps{
+    m_latest_snapshot.get_n_steps() - m_previous_snapshot.get_n_steps()
+  };
+  const double f{
+    n_steps == 0
+    ? 1.0
+    : std::min(
+        1.0,
+        m_snapshot_clock.getElapsedTime().asSeconds()
+          / (n_steps * m_simulation->get_step_time_secs())
+      )
+  };
+  interpolate(m_previous_snapshot, m_latest_snapshot, f, m_piece_progresses);
+}
+
 void test_game_view() //!OCLINT tests may be many
 {
   #ifndef NDEBUG // no tests in release
@@ -2,6 +2,7 @@
 
 #ifndef LOGIC_ONLY
 
+#include "asset_cache.h"
 #include "helper.h"
 #include "sfml_helper.h"
 
@@ -25,7 +26,7 @@ input_prompt_textures::input_prompt_textures()
       std::string("resources/textures/input_prompts/")
       + texture_name + ".png"
     };
-    if (!m_textures[texture_name].loadFromFile(filename))
+    if (!load_from_file(m_textures[texture_name], filename))
     {
       auto msg{"Cannot find image file '" + filename + "'"};
       throw std::runtime_error(msg);
@@ -0,0 +1,277 @@
+#include "input_replay.h"
+
+#include "lockstep_session.h"
+#include "net_bytes.h"
+#include "user_input.h"
+#include "user_input_type.h"
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+/// The first bytes of every input replay, 'CCIR'
+constexpr std::uint32_t get_input_replay_magic() { return 0x52494343; }
+
+/// The version of the binary format
+constexpr std::uint8_t get_input_replay_version() { return 1; }
+
+} // ~namespace
+
+input_replay::input_replay(
+  const delta_t& dt,
+  const int n_steps_per_frame
+) : m_delta_t{dt},
+    m_n_steps_per_frame{n_steps_per_frame}
+{
+  assert(m_n_steps_per_frame > 0);
+}
+
+void input_replay::add_frame(const user_inputs& inputs)
+{
+  if (!is_empty(inputs))
+  {
+    m_frames.push_back(std::make_pair(m_n_frames, inputs));
+  }
+  ++m_n_frames;
+}
+
+input_replay load_input_replay(const std::string& filename)
+{
+  std::ifstream f(filename, std::ios::binary);
+  if (!f.is_open())
+  {
+    std::stringstream msg;
+    msg << "Cannot open input replay file '" << filename << "'";
+    throw std::runtime_error(msg.str());
+  }
+  const std::vector<std::uint8_t> bytes(
+    (std::istreambuf_iterator<char>(f)),
+    std::istreambuf_iterator<char>()
+  );
+  const auto r{to_input_replay(bytes)};
+  if (!r)
+  {
+    std::stringstream msg;
+    msg << "File '" << filename << "' is not an input replay";
+    throw std::runtime_error(msg.str());
+  }
+  return r.value();
+}
+
+game_controller play_input_replay(
+  const input_replay& r,
+  const game_controller& c
+)
+{
+  game_controller result{c};
+  auto next_frame{std::begin(r.get_frames())};
+  for (int frame{0}; frame != r.get_n_frames(); ++frame)
+  {
+    user_inputs inputs;
+    if (next_frame != std::end(r.get_frames()) && next_frame->first == frame)
+    {
+      inputs = next_frame->second;
+      ++next_frame;
+    }
+    do_lockstep_frame(result, inputs, r.get_n_steps_per_frame(), r.get_delta_t());
+  }
+  return result;
+}
+
+void save_input_replay(
+  const input_replay& r,
+  const std::string& filename
+)
+{
+  const auto bytes{to_bytes(r)};
+  std::ofstream f(filename, std::ios::binary);
+  f.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+  if (!f)
+  {
+    std::stringstream msg;
+    msg << "Cannot write input replay file '" << filename << "'";
+    throw std::runtime_error(msg.str());
+  }
+}
+
+void test_input_replay()
+{
+#ifndef NDEBUG
+  // A new replay has no frames
+  {
+    const input_replay r;
+    assert(r.get_n_frames() == 0);
+    assert(r.get_frames().empty());
+    assert(r.get_n_steps_per_frame() == 1);
+  }
+  // Only the frames with user inputs are stored
+  {
+    input_replay r;
+    r.add_frame(user_inputs());
+    r.add_frame(user_inputs( { create_press_up_action(side::lhs) } ));
+    r.add_frame(user_inputs());
+    assert(r.get_n_frames() == 3);
+    assert(r.get_frames().size() == 1);
+    assert(r.get_frames()[0].first == 1);
+  }
+  // A replay is read as written
+  {
+    input_replay r(delta_t(0.25), 4);
+    r.add_frame(user_inputs());
+    r.add_frame(
+      user_inputs(
+        {
+          create_press_action_1(side::rhs),
+          create_mouse_move_action(game_coordinate(1.25, 6.5), side::lhs)
+        }
+      )
+    );
+    const auto s{to_input_replay(to_bytes(r))};
+    assert(s.has_value());
+    assert(s.value() == r);
+    assert(s.value().get_frames()[0].second.get_user_inputs()[1].get_player() == side::lhs);
+  }
+  // Something else is not an input replay
+  {
+    assert(!to_input_replay( {} ));
+    assert(!to_input_replay( { 1, 2, 3, 4, 5, 6, 7, 8 } ));
+    auto bytes{to_bytes(input_replay())};
+    bytes.pop_back();
+    assert(!to_input_replay(bytes));
+  }
+  // A replay is saved and loaded
+  {
+    const std::string filename{"test_input_replay.ccir"};
+    input_replay r;
+    r.add_frame(user_inputs( { create_press_down_action(side::lhs) } ));
+    save_input_replay(r, filename);
+    assert(load_input_replay(filename) == r);
+    std::remove(filename.c_str());
+  }
+  // Loading a file that does not exist throws
+  {
+    bool has_thrown{false};
+    try
+    {
+      load_input_replay("absent.ccir");
+    }
+    catch (const std::runtime_error&)
+    {
+      has_thrown = true;
+    }
+    assert(has_thrown);
+  }
+  // Playing a replay gives the same game
+  {
+    const delta_t dt(0.1);
+    game_controller c;
+    input_replay r(dt, 1);
+    for (int frame{0}; frame != 10; ++frame)
+    {
+      const user_inputs inputs{
+        frame == 2
+        ? user_inputs( { create_press_right_action(side::lhs) } )
+        : user_inputs()
+      };
+      r.add_frame(inputs);
+      do_lockstep_frame(c, inputs, 1, dt);
+    }
+    const game_controller d{play_input_replay(r)};
+    assert(calc_hash(c) == calc_hash(d));
+    assert(calc_hash(c) != calc_hash(game_controller()));
+  }
+#endif // NDEBUG
+}
+
+std::vector<std::uint8_t> to_bytes(const input_replay& r)
+{
+  byte_writer w;
+  w.add_uint32(get_input_replay_magic());
+  w.add_uint8(get_input_replay_version());
+  w.add_double(r.get_delta_t().get());
+  w.add_int32(r.get_n_steps_per_frame());
+  w.add_int32(r.get_n_frames());
+  w.add_int32(static_cast<std::int32_t>(r.get_frames().size()));
+  for (const auto& [frame, inputs]: r.get_frames())
+  {
+    w.add_int32(frame);
+    assert(inputs.get_user_inputs().size() <= 255);
+    w.add_uint8(static_cast<std::uint8_t>(inputs.get_user_inputs().size()));
+    for (const auto& input: inputs.get_user_inputs())
+    {
+      w.add_uint8(static_cast<std::uint8_t>(input.get_user_input_type()));
+      w.add_uint8(static_cast<std::uint8_t>(input.get_player()));
+      if (does_input_type_need_coordinat(input.get_user_input_type()))
+      {
+        w.add_double(input.get_coordinat().value().get_x());
+        w.add_double(input.get_coordinat().value().get_y());
+      }
+    }
+  }
+  return w.get_bytes();
+}
+
+std::optional<input_replay> to_input_replay(const std::vector<std::uint8_t>& bytes)
+{
+  byte_reader r(bytes);
+  if (r.read_uint32() != get_input_replay_magic()) return {};
+  if (r.read_uint8() != get_input_replay_version()) return {};
+  const double dt{r.read_double()};
+  const int n_steps_per_frame{r.read_int32()};
+  const int n_frames{r.read_int32()};
+  const int n_frames_with_inputs{r.read_int32()};
+  if (!r.is_valid() || n_steps_per_frame <= 0) return {};
+  if (n_frames < 0 || n_frames_with_inputs < 0) return {};
+
+  const int n_user_input_types{
+    static_cast<int>(get_all_user_input_types().size())
+  };
+  input_replay replay(delta_t(dt), n_steps_per_frame);
+  for (int i{0}; i != n_frames_with_inputs; ++i)
+  {
+    const int frame{r.read_int32()};
+    if (frame < replay.get_n_frames() || frame >= n_frames) return {};
+    while (replay.get_n_frames() != frame) replay.add_frame(user_inputs());
+
+    user_inputs inputs;
+    const int n_inputs{r.read_uint8()};
+    for (int j{0}; j != n_inputs; ++j)
+    {
+      const int type_index{r.read_uint8()};
+      const int side_index{r.read_uint8()};
+      if (type_index >= n_user_input_types || side_index > 1) return {};
+      const user_input_type type{static_cast<user_input_type>(type_index)};
+      const side player{static_cast<side>(side_index)};
+      if (does_input_type_need_coordinat(type))
+      {
+        const double x{r.read_double()};
+        const double y{r.read_double()};
+        inputs.add(user_input(type, player, game_coordinate(x, y)));
+      }
+      else
+      {
+        inputs.add(user_input(type, player));
+      }
+    }
+    if (!r.is_valid() || is_empty(inputs)) return {};
+    replay.add_frame(inputs);
+  }
+  if (!r.is_valid() || !r.is_done()) return {};
+  while (replay.get_n_frames() != n_frames) replay.add_frame(user_inputs());
+  return replay;
+}
+
+bool operator==(const input_replay& lhs, const input_replay& rhs) noexcept
+{
+  return lhs.get_delta_t() == rhs.get_delta_t()
+    && lhs.get_n_steps_per_frame() == rhs.get_n_steps_per_frame()
+    && lhs.get_n_frames() == rhs.get_n_frames()
+    && lhs.get_frames() == rhs.get_frames()
+  ;
+}
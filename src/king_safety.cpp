@@ -0,0 +1,358 @@
+#include "king_safety.h"
+
+#include "game.h"
+#include "piece.h"
+#include "piece_action.h"
+#include "pieces.h"
+#include "square.h"
+
+#include <cassert>
+
+namespace {
+
+/// The jumps of a knight, as (rank, file) steps
+constexpr std::array<std::pair<int, int>, 8> get_knight_jumps()
+{
+  return { { {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2} } };
+}
+
+/// The steps of a king, as (rank, file) steps
+constexpr std::array<std::pair<int, int>, 8> get_king_steps()
+{
+  return { { {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1} } };
+}
+
+constexpr bool is_on_board(const int x, const int y) noexcept
+{
+  return x >= 0 && x < 8 && y >= 0 && y < 8;
+}
+
+constexpr int get_index(const int x, const int y) noexcept
+{
+  return (x * 8) + y;
+}
+
+int get_index(const square& s) noexcept
+{
+  return get_index(s.get_x(), s.get_y());
+}
+
+constexpr std::uint64_t get_bit(const int index) noexcept
+{
+  return std::uint64_t{1} << index;
+}
+
+/// Can a piece of this type move along a line in this direction?
+bool is_slider(const piece_type t, const std::pair<int, int>& direction) noexcept
+{
+  const bool is_diagonal{direction.first != 0 && direction.second != 0};
+  if (t == piece_type::queen) return true;
+  return is_diagonal ? t == piece_type::bishop : t == piece_type::rook;
+}
+
+/// The rank step of the pawns of a color
+constexpr int get_pawn_step(const chess_color c) noexcept
+{
+  return c == chess_color::white ? 1 : -1;
+}
+
+} // ~namespace
+
+king_safety::king_safety(
+  const std::vector<piece>& pieces,
+  const chess_color color
+) : m_attacked{0},
+    m_board{},
+    m_check_mask{0},
+    m_color{color},
+    m_n_checkers{0}
+{
+  m_pin_masks.fill(~std::uint64_t{0});
+  for (const auto& p: pieces)
+  {
+    const int i{get_index(p.get_current_square())};
+    if (m_board[i]) continue;
+    m_board[i] = std::make_pair(p.get_color(), p.get_type());
+    if (!m_king_index && p.get_color() == color && p.get_type() == piece_type::king)
+    {
+      m_king_index = i;
+    }
+  }
+  if (!m_king_index)
+  {
+    m_check_mask = ~std::uint64_t{0};
+    return;
+  }
+  const int king_index{m_king_index.value()};
+  const int kx{king_index / 8};
+  const int ky{king_index % 8};
+  const chess_color enemy_color{get_other_color(color)};
+
+  // The attacks of the enemy, including the checks
+  const auto add_attack{
+    [this, king_index](const int x, const int y, const int from_index)
+    {
+      if (!is_on_board(x, y)) return;
+      const int i{get_index(x, y)};
+      m_attacked |= get_bit(i);
+      if (i == king_index)
+      {
+        ++m_n_checkers;
+        m_check_mask |= get_bit(from_index);
+      }
+    }
+  };
+  for (int i{0}; i != 64; ++i)
+  {
+    if (!m_board[i] || m_board[i].value().first != enemy_color) continue;
+    const piece_type t{m_board[i].value().second};
+    const int x{i / 8};
+    const int y{i % 8};
+    switch (t)
+    {
+      case piece_type::pawn:
+        add_attack(x + get_pawn_step(enemy_color), y - 1, i);
+        add_attack(x + get_pawn_step(enemy_color), y + 1, i);
+        break;
+      case piece_type::knight:
+        for (const auto& [dx, dy]: get_knight_jumps()) add_attack(x + dx, y + dy, i);
+        break;
+      case piece_type::king:
+        // A king cannot give check
+        for (const auto& [dx, dy]: get_king_steps())
+        {
+          if (is_on_board(x + dx, y + dy)) m_attacked |= get_bit(get_index(x + dx, y + dy));
+        }
+        break;
+      case piece_type::bishop:
+      case piece_type::queen:
+      case piece_type::rook:
+        for (const auto& direction: get_king_steps())
+        {
+          if (!is_slider(t, direction)) continue;
+          std::uint64_t line{0};
+          for (int tx{x + direction.first}, ty{y + direction.second};
+            is_on_board(tx, ty);
+            tx += direction.first, ty += direction.second
+          )
+          {
+            const int j{get_index(tx, ty)};
+            m_attacked |= get_bit(j);
+            if (j == king_index)
+            {
+              // The king can block or capture nothing on this line,
+              // the other pieces can
+              ++m_n_checkers;
+              m_check_mask |= line | get_bit(i);
+              // The king cannot step back along the line of the check
+              continue;
+            }
+            if (m_board[j]) break;
+            line |= get_bit(j);
+          }
+        }
+        break;
+    }
+  }
+  if (m_n_checkers == 0) m_check_mask = ~std::uint64_t{0};
+
+  // The pieces pinned to the king
+  for (const auto& direction: get_king_steps())
+  {
+    std::optional<int> pinned_index;
+    std::uint64_t line{0};
+    for (int tx{kx + direction.first}, ty{ky + direction.second};
+      is_on_board(tx, ty);
+      tx += direction.first, ty += direction.second
+    )
+    {
+      const int j{get_index(tx, ty)};
+      line |= get_bit(j);
+      if (!m_board[j]) continue;
+      const auto& [c, t]{m_board[j].value()};
+      if (!pinned_index)
+      {
+        if (c != color) break;
+        pinned_index = j;
+        continue;
+      }
+      if (c == enemy_color && is_slider(t, direction))
+      {
+        m_pin_masks[pinned_index.value()] = line;
+      }
+      break;
+    }
+  }
+}
+
+bool king_safety::is_king_attacked(
+  const std::array<std::optional<std::pair<chess_color, piece_type>>, 64>& board
+) const noexcept
+{
+  assert(m_king_index);
+  const int kx{m_king_index.value() / 8};
+  const int ky{m_king_index.value() % 8};
+  const chess_color enemy_color{get_other_color(m_color)};
+  const auto is_enemy_at{
+    [&board, enemy_color](const int x, const int y, const piece_type t)
+    {
+      if (!is_on_board(x, y)) return false;
+      const auto& p{board[get_index(x, y)]};
+      return p && p.value().first == enemy_color && p.value().second == t;
+    }
+  };
+  // An enemy pawn attacks towards the king
+  const int pawn_x{kx - get_pawn_step(enemy_color)};
+  if (is_enemy_at(pawn_x, ky - 1, piece_type::pawn)) return true;
+  if (is_enemy_at(pawn_x, ky + 1, piece_type::pawn)) return true;
+  for (const auto& [dx, dy]: get_knight_jumps())
+  {
+    if (is_enemy_at(kx + dx, ky + dy, piece_type::knight)) return true;
+  }
+  for (const auto& direction: get_king_steps())
+  {
+    for (int tx{kx + direction.first}, ty{ky + direction.second};
+      is_on_board(tx, ty);
+      tx += direction.first, ty += direction.second
+    )
+    {
+      const auto& p{board[get_index(tx, ty)]};
+      if (!p) continue;
+      if (p.value().first == enemy_color && is_slider(p.value().second, direction)) return true;
+      break;
+    }
+  }
+  return false;
+}
+
+bool king_safety::is_legal(const piece_action& action) const noexcept
+{
+  assert(action.get_color() == m_color);
+  if (!m_king_index) return true;
+  const int king_index{m_king_index.value()};
+  const int from_index{get_index(action.get_from())};
+  const int to_index{get_index(action.get_to())};
+  switch (action.get_action_type())
+  {
+    case piece_action_type::select:
+    case piece_action_type::unselect:
+      return true;
+    case piece_action_type::castle_kingside:
+    case piece_action_type::castle_queenside:
+    {
+      // Not out of, through or into check
+      const int step{action.get_action_type() == piece_action_type::castle_kingside ? 1 : -1};
+      return !is_in_check()
+        && !(m_attacked & get_bit(king_index + step))
+        && !(m_attacked & get_bit(king_index + step + step))
+      ;
+    }
+    case piece_action_type::promote_to_bishop:
+    case piece_action_type::promote_to_knight:
+    case piece_action_type::promote_to_queen:
+    case piece_action_type::promote_to_rook:
+      // A promotion does not move the pawn, so it cannot end a check
+      return !is_in_check();
+    case piece_action_type::attack_en_passant:
+    {
+      // Rare enough to simply put the pieces where they end up
+      auto board{m_board};
+      board[to_index] = board[from_index];
+      board[from_index].reset();
+      board[get_index(action.get_from().get_x(), action.get_to().get_y())].reset();
+      return !is_king_attacked(board);
+    }
+    case piece_action_type::attack:
+    case piece_action_type::move:
+      break;
+  }
+  if (from_index == king_index)
+  {
+    return !(m_attacked & get_bit(to_index));
+  }
+  if (m_n_checkers > 1) return false;
+  return (m_check_mask & get_bit(to_index))
+    && (m_pin_masks[from_index] & get_bit(to_index))
+  ;
+}
+
+bool king_safety::is_pinned(const square& s) const noexcept
+{
+  return m_pin_masks[get_index(s)] != ~std::uint64_t{0};
+}
+
+void test_king_safety()
+{
+#ifndef NDEBUG
+  // Without a king, all actions are legal
+  {
+    const auto pieces{create_pieces_from_fen_string(fen_string("4k3/8/8/8/8/8/8/R7 w - - 0 1"))};
+    const king_safety s(pieces, chess_color::white);
+    assert(!s.is_in_check());
+    assert(s.is_legal(piece_action(chess_color::white, piece_type::rook, piece_action_type::move, "a1", "a8")));
+  }
+  // The starting position is safe
+  {
+    const king_safety s(get_standard_starting_pieces(), chess_color::white);
+    assert(!s.is_in_check());
+    assert(s.get_attacked() & get_bit(get_index(square("e6"))));
+    assert(!(s.get_attacked() & get_bit(get_index(square("e4")))));
+    assert(!s.is_pinned(square("e2")));
+  }
+  // A king cannot move to a square attacked by a pawn
+  {
+    const auto pieces{create_pieces_from_fen_string(fen_string("4k3/8/8/8/8/3p4/8/4K3 w - - 0 1"))};
+    const king_safety s(pieces, chess_color::white);
+    assert(!s.is_legal(piece_action(chess_color::white, piece_type::king, piece_action_type::move, "e1", "e2")));
+    assert(s.is_legal(piece_action(chess_color::white, piece_type::king, piece_action_type::move, "e1", "d2")));
+  }
+  // A pinned knight cannot move
+  {
+    const auto pieces{create_pieces_from_fen_string(fen_string("4r2k/8/8/8/8/8/4N3/4K3 w - - 0 1"))};
+    const king_safety s(pieces, chess_color::white);
+    assert(s.is_pinned(square("e2")));
+    assert(!s.is_legal(piece_action(chess_color::white, piece_type::knight, piece_action_type::move, "e2", "c3")));
+  }
+  // A pinned rook can move along the pin and capture the pinner
+  {
+    const auto pieces{create_pieces_from_fen_string(fen_string("4r2k/8/8/8/8/8/4R3/4K3 w - - 0 1"))};
+    const king_safety s(pieces, chess_color::white);
+    assert(s.is_legal(piece_action(chess_color::white, piece_type::rook, piece_action_type::move, "e2", "e5")));
+    assert(s.is_legal(piece_action(chess_color::white, piece_type::rook, piece_action_type::attack, "e2", "e8")));
+    assert(!s.is_legal(piece_action(chess_color::white, piece_type::rook, piece_action_type::move, "e2", "d2")));
+  }
+  // In check, only capturing or blocking the checker, or moving the king
+  {
+    const auto pieces{create_pieces_from_fen_string(fen_string("4r2k/8/8/8/8/8/R7/4K3 w - - 0 1"))};
+    const king_safety s(pieces, chess_color::white);
+    assert(s.is_in_check());
+    assert(s.get_n_checkers() == 1);
+    assert(s.is_legal(piece_action(chess_color::white, piece_type::rook, piece_action_type::move, "a2", "e2")));
+    assert(!s.is_legal(piece_action(chess_color::white, piece_type::rook, piece_action_type::move, "a2", "a3")));
+    assert(s.is_legal(piece_action(chess_color::white, piece_type::king, piece_action_type::move, "e1", "d1")));
+    // The king cannot step back along the line of the check
+    assert(!s.is_legal(piece_action(chess_color::white, piece_type::king, piece_action_type::move, "e1", "e2")));
+  }
+  // In double check, only the king can move
+  {
+    const auto pieces{create_pieces_from_fen_string(fen_string("4r2k/8/8/8/8/3n4/R7/4K3 w - - 0 1"))};
+    const king_safety s(pieces, chess_color::white);
+    assert(s.get_n_checkers() == 2);
+    assert(!s.is_legal(piece_action(chess_color::white, piece_type::rook, piece_action_type::move, "a2", "e2")));
+    assert(s.is_legal(piece_action(chess_color::white, piece_type::king, piece_action_type::move, "e1", "d1")));
+  }
+  // No castling out of check
+  {
+    const auto pieces{create_pieces_from_fen_string(fen_string("4r2k/8/8/8/8/8/8/4K2R w K - 0 1"))};
+    const king_safety s(pieces, chess_color::white);
+    assert(!s.is_legal(piece_action(chess_color::white, piece_type::king, piece_action_type::castle_kingside, "e1", "g1")));
+  }
+  // An en-passant capture that opens the rank to the king
+  {
+    const auto pieces{create_pieces_from_fen_string(fen_string("7k/8/8/K2Pp2r/8/8/8/8 w - - 0 1"))};
+    const king_safety s(pieces, chess_color::white);
+    assert(!s.is_legal(piece_action(chess_color::white, piece_type::pawn, piece_action_type::attack_en_passant, "d5", "e6")));
+    assert(s.is_legal(piece_action(chess_color::white, piece_type::pawn, piece_action_type::move, "d5", "d6")));
+  }
+#endif // NDEBUG
+}
@@ -2,6 +2,8 @@
 
 #ifndef LOGIC_ONLY
 
+#include "asset_cache.h"
+
 //#include <functional>
 #include <cassert>
 #include <sstream>
@@ -11,7 +13,7 @@ loading_screen_textures::loading_screen_textures()
   for (int i=1 ; i!=5; ++i)
   {
     const std::string filename{get_filename(i)};
-    if (!m_all_races[i].loadFromFile(filename))
+    if (!load_from_file(m_all_races[i], filename))
     {
       auto msg{"Cannot find image file '" + filename + "'"};
       throw std::runtime_error(msg);
@@ -29,7 +31,7 @@ loading_screen_textures::loading_screen_textures()
     const auto filename{p.second.c_str()};
     QFile f(":/resources/textures/artwork/" + filename);
 
-    if (!p.first.get().loadFromFile(filename))
+    if (!load_from_file(p.first.get(), filename))
     {
       auto msg{"Cannot find image file '" + filename + "'"};
       throw std::runtime_error(msg);
@@ -4,6 +4,8 @@
 
 
 
+#include "asset_cache.h"
+
 #include <cassert>
 #include <sstream>
 
@@ -16,7 +18,7 @@ lobby_menu_textures::lobby_menu_textures()
       std::string("resources/textures/lobby_menu/")
       + filename_str.c_str()
     };
-    if (!m_heads[r].loadFromFile(filename))
+    if (!load_from_file(m_heads[r], filename))
     {
       auto msg{"Cannot find image file '" + filename + "'"};
       throw std::runtime_error(msg);
@@ -30,7 +32,7 @@ lobby_menu_textures::lobby_menu_textures()
       std::string("resources/textures/lobby_menu/")
       + filename_str.c_str()
     };
-    if (!m_color[r].loadFromFile(filename))
+    if (!load_from_file(m_color[r], filename))
     {
       auto msg{"Cannot find image file '" + filename + "'"};
       throw std::runtime_error(msg);
@@ -43,7 +45,7 @@ lobby_menu_textures::lobby_menu_textures()
     const auto filename{std::string("resources/textures/lobby_menu/")
       + filename_str.c_str()
     };
-    if (!m_ready[b].loadFromFile(filename))
+    if (!load_from_file(m_ready[b], filename))
     {
       auto msg{"Cannot find image file '" + filename + "'"};
       throw std::runtime_error(msg);
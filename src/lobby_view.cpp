@@ -33,6 +33,9 @@ void lobby_view::tick_impl(const delta_t)
   assert(is_active());
   if (m_clock)
   {
+    // Show the countdown
+    invalidate();
+
     if (m_clock.value().getElapsedTime().asSeconds() > m_countdown_secs)
     {
       // Store to the lobby options, as these settings are accepted
@@ -0,0 +1,172 @@
+#include "lockstep_message.h"
+
+#include "net_bytes.h"
+#include "user_input_type.h"
+
+#include <cassert>
+
+namespace {
+
+/// The first bytes of every lockstep message, 'CCLS'
+constexpr std::uint32_t get_lockstep_message_magic() { return 0x534c4343; }
+
+} // ~namespace
+
+lockstep_message::lockstep_message(
+  const int first_frame,
+  const std::vector<user_inputs>& inputs,
+  const int ack_frame,
+  const int hash_frame,
+  const std::uint64_t hash
+) : m_first_frame{first_frame},
+    m_inputs{inputs},
+    m_ack_frame{ack_frame},
+    m_hash_frame{hash_frame},
+    m_hash{hash}
+{
+  assert(m_first_frame >= 0);
+  assert(static_cast<int>(m_inputs.size()) <= get_lockstep_message_max_n_frames());
+  assert(m_ack_frame >= -1);
+  assert(m_hash_frame >= -1);
+}
+
+void test_lockstep_message()
+{
+#ifndef NDEBUG
+  // A message is read as written
+  {
+    const lockstep_message m(
+      12,
+      {
+        user_inputs(),
+        user_inputs(
+          {
+            create_press_action_1(side::rhs),
+            create_mouse_move_action(game_coordinate(1.25, 6.5), side::rhs)
+          }
+        )
+      },
+      11,
+      10,
+      0x0123456789abcdefULL
+    );
+    const auto bytes{to_bytes(m)};
+    const auto n{to_lockstep_message(bytes, side::rhs)};
+    assert(n.has_value());
+    assert(n.value() == m);
+    assert(n.value().get_inputs().size() == 2);
+    assert(n.value().get_inputs()[1].get_user_inputs()[1].get_coordinat().value().get_y() == 6.5);
+  }
+  // The side of the user inputs is the sender's
+  {
+    const lockstep_message m(0, { user_inputs( { create_press_up_action(side::lhs) } ) } );
+    const auto n{to_lockstep_message(to_bytes(m), side::rhs)};
+    assert(n.value().get_inputs()[0].get_user_inputs()[0].get_player() == side::rhs);
+  }
+  // A message without a hash has no bytes for it
+  {
+    const auto with_hash{to_bytes(lockstep_message(0, {}, -1, 0, 42))};
+    const auto without_hash{to_bytes(lockstep_message(0, {}, -1, -1))};
+    assert(with_hash.size() == without_hash.size() + 8);
+    assert(to_lockstep_message(without_hash, side::lhs).value().get_hash_frame() == -1);
+  }
+  // A frame without user inputs takes one byte
+  {
+    const auto empty{to_bytes(lockstep_message(0, {}))};
+    const auto one_frame{to_bytes(lockstep_message(0, { user_inputs() } ))};
+    assert(one_frame.size() == empty.size() + 1);
+  }
+  // Something else is not a lockstep message
+  {
+    assert(!to_lockstep_message( {}, side::lhs));
+    assert(!to_lockstep_message( { 1, 2, 3, 4, 5, 6, 7, 8 }, side::lhs));
+  }
+  // A message that is too short is not a lockstep message
+  {
+    auto bytes{to_bytes(lockstep_message(0, { user_inputs() } ))};
+    bytes.pop_back();
+    assert(!to_lockstep_message(bytes, side::lhs));
+  }
+#endif // NDEBUG
+}
+
+std::vector<std::uint8_t> to_bytes(const lockstep_message& m)
+{
+  byte_writer w;
+  w.add_uint32(get_lockstep_message_magic());
+  w.add_int32(m.get_first_frame());
+  w.add_int32(m.get_ack_frame());
+  w.add_int32(m.get_hash_frame());
+  if (m.get_hash_frame() >= 0) w.add_uint64(m.get_hash());
+  w.add_uint8(static_cast<std::uint8_t>(m.get_inputs().size()));
+  for (const auto& inputs: m.get_inputs())
+  {
+    assert(inputs.get_user_inputs().size() <= 255);
+    w.add_uint8(static_cast<std::uint8_t>(inputs.get_user_inputs().size()));
+    for (const auto& input: inputs.get_user_inputs())
+    {
+      w.add_uint8(static_cast<std::uint8_t>(input.get_user_input_type()));
+      if (does_input_type_need_coordinat(input.get_user_input_type()))
+      {
+        w.add_double(input.get_coordinat().value().get_x());
+        w.add_double(input.get_coordinat().value().get_y());
+      }
+    }
+  }
+  return w.get_bytes();
+}
+
+std::optional<lockstep_message> to_lockstep_message(
+  const std::vector<std::uint8_t>& bytes,
+  const side sender
+)
+{
+  byte_reader r(bytes);
+  if (r.read_uint32() != get_lockstep_message_magic()) return {};
+  const int first_frame{r.read_int32()};
+  const int ack_frame{r.read_int32()};
+  const int hash_frame{r.read_int32()};
+  const std::uint64_t hash{hash_frame >= 0 ? r.read_uint64() : 0};
+  const int n_frames{r.read_uint8()};
+  if (first_frame < 0 || ack_frame < -1 || hash_frame < -1) return {};
+
+  const int n_user_input_types{
+    static_cast<int>(get_all_user_input_types().size())
+  };
+  std::vector<user_inputs> inputs;
+  inputs.reserve(n_frames);
+  for (int i{0}; i != n_frames; ++i)
+  {
+    user_inputs frame_inputs;
+    const int n_inputs{r.read_uint8()};
+    for (int j{0}; j != n_inputs; ++j)
+    {
+      const int type_index{r.read_uint8()};
+      if (type_index >= n_user_input_types) return {};
+      const user_input_type type{static_cast<user_input_type>(type_index)};
+      if (does_input_type_need_coordinat(type))
+      {
+        const double x{r.read_double()};
+        const double y{r.read_double()};
+        frame_inputs.add(user_input(type, sender, game_coordinate(x, y)));
+      }
+      else
+      {
+        frame_inputs.add(user_input(type, sender));
+      }
+    }
+    inputs.push_back(frame_inputs);
+  }
+  if (!r.is_valid() || !r.is_done()) return {};
+  return lockstep_message(first_frame, inputs, ack_frame, hash_frame, hash);
+}
+
+bool operator==(const lockstep_message& lhs, const lockstep_message& rhs) noexcept
+{
+  return lhs.get_first_frame() == rhs.get_first_frame()
+    && lhs.get_inputs() == rhs.get_inputs()
+    && lhs.get_ack_frame() == rhs.get_ack_frame()
+    && lhs.get_hash_frame() == rhs.get_hash_frame()
+    && lhs.get_hash() == rhs.get_hash()
+  ;
+}
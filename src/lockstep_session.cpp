@@ -0,0 +1,450 @@
+#include "lockstep_session.h"
+
+#include "metrics.h"
+#include "pieces.h"
+#include "trace.h"
+#include "user_input.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iterator>
+#include <random>
+#include <utility>
+
+lockstep_session::lockstep_session(
+  const game_controller& c,
+  const side local_side,
+  net_transport& transport,
+  const int input_delay,
+  const int hash_interval,
+  const int n_steps_per_frame,
+  const game_speed speed,
+  const double steps_per_second
+) : m_game_controller{c},
+    m_delta_t{get_speed_multiplier(speed) / steps_per_second},
+    m_hash_interval{hash_interval},
+    m_input_delay{input_delay},
+    m_last_scheduled_frame{input_delay - 1},
+    m_local_side{local_side},
+    m_n_remote_frames{input_delay},
+    m_n_steps_per_frame{n_steps_per_frame},
+    m_remote_ack_frame{input_delay - 1},
+    m_transport{transport}
+{
+  assert(m_input_delay >= 0);
+  assert(m_hash_interval > 0);
+  assert(m_n_steps_per_frame > 0);
+
+  // The frames before the first input delay have no user inputs,
+  // as no user could have done anything yet
+  for (int frame{0}; frame != m_input_delay; ++frame)
+  {
+    m_local_inputs[frame] = user_inputs();
+    m_remote_inputs[frame] = user_inputs();
+  }
+}
+
+void lockstep_session::add_local_inputs(const user_inputs& inputs)
+{
+  for (const auto& input: inputs.get_user_inputs())
+  {
+    if (input.get_player() != m_local_side) continue;
+    m_pending_inputs.add(input);
+  }
+}
+
+void lockstep_session::check_hashes()
+{
+  for (const auto& [frame, hash]: m_remote_hashes)
+  {
+    const auto there{m_local_hashes.find(frame)};
+    if (there == std::end(m_local_hashes)) continue;
+    if (there->second != hash && !m_desync_frame)
+    {
+      m_desync_frame = frame;
+    }
+  }
+  // Only the hashes not compared yet need to be kept
+  if (m_remote_hashes.empty() || m_local_hashes.empty()) return;
+  const int last_frame{
+    std::min(
+      m_remote_hashes.rbegin()->first,
+      m_local_hashes.rbegin()->first
+    )
+  };
+  m_remote_hashes.erase(std::begin(m_remote_hashes), m_remote_hashes.upper_bound(last_frame));
+  m_local_hashes.erase(std::begin(m_local_hashes), m_local_hashes.upper_bound(last_frame));
+}
+
+std::vector<message> lockstep_session::collect_messages()
+{
+  std::vector<message> messages;
+  std::swap(messages, m_messages);
+  return messages;
+}
+
+void lockstep_session::do_frame()
+{
+  const trace_scope scope("lockstep_session::do_frame");
+  assert(m_local_inputs.count(m_frame));
+  assert(m_remote_inputs.count(m_frame));
+
+  // The same order on both computers
+  user_inputs inputs;
+  for (const side s: get_all_sides())
+  {
+    add(inputs, s == m_local_side ? m_local_inputs[m_frame] : m_remote_inputs[m_frame]);
+  }
+  do_lockstep_frame(m_game_controller, inputs, m_n_steps_per_frame, m_delta_t);
+  const std::vector<message> messages{::collect_messages(std::as_const(m_game_controller).get_game())};
+  std::copy(std::begin(messages), std::end(messages), std::back_inserter(m_messages));
+  clear_piece_messages(m_game_controller.get_game());
+
+  m_remote_inputs.erase(m_frame);
+  if (m_frame <= m_remote_ack_frame) m_local_inputs.erase(m_frame);
+
+  if ((m_frame + 1) % m_hash_interval == 0)
+  {
+    m_last_hash_frame = m_frame;
+    m_last_hash = calc_hash(m_game_controller);
+    m_local_hashes[m_frame] = m_last_hash;
+    check_hashes();
+  }
+  ++m_frame;
+}
+
+void do_lockstep_frame(
+  game_controller& c,
+  const user_inputs& inputs,
+  const int n_steps,
+  const delta_t& dt
+)
+{
+  add_user_inputs(c, inputs);
+  for (int i{0}; i != n_steps; ++i)
+  {
+    // Read via the const overload, so the game is not marked as changed
+    if (std::as_const(c).get_game().get_winner().has_value()) break;
+    c.apply_user_inputs_to_game();
+    c.tick(dt);
+  }
+}
+
+int lockstep_session::get_recommended_input_delay() const noexcept
+{
+  if (m_mean_round_trip_frames < 0.0) return m_input_delay;
+  // The user inputs need half a round trip to arrive,
+  // plus one frame, as the peer may just have done its tick
+  return static_cast<int>(std::ceil(m_mean_round_trip_frames / 2.0)) + 1;
+}
+
+void lockstep_session::process_message(const lockstep_message& m)
+{
+  // The peer's user inputs
+  const int n_frames{static_cast<int>(m.get_inputs().size())};
+  for (int i{0}; i != n_frames; ++i)
+  {
+    const int frame{m.get_first_frame() + i};
+    if (frame < m_n_remote_frames) continue; // Already received
+    m_remote_inputs.emplace(frame, m.get_inputs()[i]);
+  }
+  while (m_remote_inputs.count(m_n_remote_frames))
+  {
+    ++m_n_remote_frames;
+  }
+
+  // The peer has received the local user inputs up to this frame
+  if (m.get_ack_frame() > m_remote_ack_frame)
+  {
+    const auto there{m_send_ticks.find(m.get_ack_frame())};
+    if (there != std::end(m_send_ticks))
+    {
+      const double round_trip_frames{
+        static_cast<double>(m_n_ticks - there->second)
+      };
+      m_mean_round_trip_frames = m_mean_round_trip_frames < 0.0
+        ? round_trip_frames
+        : (0.9 * m_mean_round_trip_frames) + (0.1 * round_trip_frames)
+      ;
+    }
+    m_remote_ack_frame = m.get_ack_frame();
+    m_send_ticks.erase(std::begin(m_send_ticks), m_send_ticks.upper_bound(m_remote_ack_frame));
+    m_local_inputs.erase(
+      std::begin(m_local_inputs),
+      m_local_inputs.lower_bound(std::min(m_frame, m_remote_ack_frame + 1))
+    );
+  }
+
+  // The hash of the peer's game
+  if (m.get_hash_frame() >= 0)
+  {
+    m_remote_hashes[m.get_hash_frame()] = m.get_hash();
+    check_hashes();
+  }
+}
+
+void lockstep_session::receive()
+{
+  std::vector<std::uint8_t> bytes;
+  while (m_transport.receive(bytes))
+  {
+    const auto m{to_lockstep_message(bytes, get_other_side(m_local_side))};
+    if (!m) continue;
+    process_message(m.value());
+  }
+}
+
+void lockstep_session::schedule_local_inputs()
+{
+  while (m_last_scheduled_frame < m_frame + m_input_delay)
+  {
+    ++m_last_scheduled_frame;
+    m_local_inputs[m_last_scheduled_frame] = m_pending_inputs;
+    m_pending_inputs = user_inputs();
+    m_send_ticks[m_last_scheduled_frame] = m_n_ticks;
+  }
+}
+
+void lockstep_session::send()
+{
+  const int first_frame{m_remote_ack_frame + 1};
+  const int n_frames{
+    std::min(
+      m_last_scheduled_frame - first_frame + 1,
+      get_lockstep_message_max_n_frames()
+    )
+  };
+  std::vector<user_inputs> inputs;
+  for (int i{0}; i < n_frames; ++i)
+  {
+    inputs.push_back(m_local_inputs.at(first_frame + i));
+  }
+  const bool is_hash_sent{
+    m_last_hash_frame >= 0
+    && m_frame - m_last_hash_frame <= get_lockstep_n_hash_resend_frames()
+  };
+  const lockstep_message m(
+    first_frame,
+    inputs,
+    m_n_remote_frames - 1,
+    is_hash_sent ? m_last_hash_frame : -1,
+    m_last_hash
+  );
+  const auto bytes{to_bytes(m)};
+  m_transport.send(bytes);
+
+  static metric_counter& n_bytes_sent{
+    get_metrics().get_counter("lockstep_bytes_sent")
+  };
+  n_bytes_sent.add(bytes.size());
+}
+
+void lockstep_session::set_input_delay(const int input_delay)
+{
+  assert(input_delay >= 0);
+  m_input_delay = input_delay;
+}
+
+bool lockstep_session::tick()
+{
+  const trace_scope scope("lockstep_session::tick");
+  ++m_n_ticks;
+  receive();
+  schedule_local_inputs();
+  send();
+  if (!m_remote_inputs.count(m_frame))
+  {
+    ++m_n_stalls;
+    static metric_counter& n_stalls{
+      get_metrics().get_counter("lockstep_stalls")
+    };
+    n_stalls.add();
+    return false;
+  }
+  do_frame();
+  return true;
+}
+
+lockstep_loopback_result::lockstep_loopback_result(
+  const int n_frames,
+  const int n_stalls,
+  const std::int64_t n_bytes_sent,
+  const double n_secs,
+  const bool is_desync
+) : m_n_frames{n_frames},
+    m_n_stalls{n_stalls},
+    m_n_bytes_sent{n_bytes_sent},
+    m_n_secs{n_secs},
+    m_is_desync{is_desync}
+{
+  assert(m_n_frames >= 0);
+  assert(m_n_stalls >= 0);
+  assert(m_n_bytes_sent >= 0);
+  assert(m_n_secs >= 0.0);
+}
+
+double lockstep_loopback_result::get_n_bytes_per_minute() const noexcept
+{
+  if (m_n_secs == 0.0) return 0.0;
+  // Both players send
+  return static_cast<double>(m_n_bytes_sent) / 2.0 / (m_n_secs / 60.0);
+}
+
+lockstep_loopback_result run_lockstep_loopback(
+  const int n_frames,
+  const int input_delay,
+  const int n_steps_per_frame,
+  const int seed
+)
+{
+  const auto [transport_lhs, transport_rhs]{create_loopback_transports()};
+  const game_controller c;
+  lockstep_session lhs(c, side::lhs, *transport_lhs, input_delay, get_default_lockstep_hash_interval(), n_steps_per_frame);
+  lockstep_session rhs(c, side::rhs, *transport_rhs, input_delay, get_default_lockstep_hash_interval(), n_steps_per_frame);
+
+  std::default_random_engine rng_engine(seed);
+  std::uniform_int_distribution<int> n_inputs_distribution(0, 3);
+  while (lhs.get_frame() < n_frames || rhs.get_frame() < n_frames)
+  {
+    for (auto s: { &lhs, &rhs })
+    {
+      if (s->get_frame() >= n_frames) continue;
+      // A player does a user input in one out of four frames
+      if (n_inputs_distribution(rng_engine) == 0)
+      {
+        const user_input i{create_useful_random_user_input(rng_engine)};
+        s->add_local_inputs(
+          user_inputs( { user_input(i.get_user_input_type(), s->get_local_side(), i.get_coordinat()) } )
+        );
+      }
+      s->tick();
+      s->collect_messages();
+    }
+  }
+  const double n_secs{
+    n_frames * n_steps_per_frame / get_default_simulation_frequency()
+  };
+  return lockstep_loopback_result(
+    lhs.get_frame() + rhs.get_frame(),
+    lhs.get_n_stalls() + rhs.get_n_stalls(),
+    transport_lhs->get_n_bytes_sent() + transport_rhs->get_n_bytes_sent(),
+    n_secs,
+    // Both games did the same number of frames,
+    // so these must be the same
+    lhs.get_desync_frame().has_value()
+      || rhs.get_desync_frame().has_value()
+      || calc_hash(lhs.get_game_controller()) != calc_hash(rhs.get_game_controller())
+  );
+}
+
+void test_lockstep_session()
+{
+#ifndef NDEBUG
+  // A new session has done no frames
+  {
+    const auto [a, b]{create_loopback_transports()};
+    const lockstep_session s(game_controller(), side::lhs, *a);
+    assert(s.get_frame() == 0);
+    assert(s.get_n_stalls() == 0);
+    assert(!s.get_desync_frame());
+    assert(s.get_input_delay() == get_default_lockstep_input_delay());
+    assert(s.get_mean_round_trip_frames() < 0.0);
+  }
+  // A session without a peer stalls after the input delay
+  {
+    const auto [a, b]{create_loopback_transports()};
+    lockstep_session s(game_controller(), side::lhs, *a, 2, 30, 1);
+    assert(s.tick());
+    assert(s.tick());
+    assert(!s.tick());
+    assert(s.get_frame() == 2);
+    assert(s.get_n_stalls() == 1);
+  }
+  // A local user input is done after the input delay, in both games
+  {
+    const auto [a, b]{create_loopback_transports()};
+    lockstep_session lhs(game_controller(), side::lhs, *a, 2, 30, 1);
+    lockstep_session rhs(game_controller(), side::rhs, *b, 2, 30, 1);
+    lhs.add_local_inputs(user_inputs( { create_press_up_action(side::lhs) } ));
+    const auto cursor_before{get_cursor_pos(lhs.get_game_controller(), side::lhs)};
+    for (int i{0}; i != 2; ++i)
+    {
+      lhs.tick();
+      rhs.tick();
+    }
+    assert(lhs.get_frame() == 2);
+    assert(get_cursor_pos(lhs.get_game_controller(), side::lhs) == cursor_before);
+    for (int i{0}; i != 2; ++i)
+    {
+      lhs.tick();
+      rhs.tick();
+    }
+    assert(lhs.get_frame() == 4);
+    assert(rhs.get_frame() == 4);
+    assert(get_cursor_pos(lhs.get_game_controller(), side::lhs) != cursor_before);
+    assert(calc_hash(lhs.get_game_controller()) == calc_hash(rhs.get_game_controller()));
+    assert(lhs.get_mean_round_trip_frames() >= 0.0);
+  }
+  // The user inputs of the other side are ignored
+  {
+    const auto [a, b]{create_loopback_transports()};
+    lockstep_session s(game_controller(), side::lhs, *a, 0, 30, 1);
+    const auto cursor_before{get_cursor_pos(s.get_game_controller(), side::rhs)};
+    s.add_local_inputs(user_inputs( { create_press_up_action(side::rhs) } ));
+    // Peer's user inputs for frame 0, that are none
+    b->send(to_bytes(lockstep_message(0, { user_inputs() } )));
+    assert(s.tick());
+    assert(get_cursor_pos(s.get_game_controller(), side::rhs) == cursor_before);
+  }
+  // Different games are detected as a desync
+  {
+    const auto [a, b]{create_loopback_transports()};
+    lockstep_session lhs(game_controller(), side::lhs, *a, 1, 2, 1);
+    lockstep_session rhs(game_controller(game(get_pieces_kings_only())), side::rhs, *b, 1, 2, 1);
+    for (int i{0}; i != 4; ++i)
+    {
+      lhs.tick();
+      rhs.tick();
+    }
+    assert(lhs.get_desync_frame().has_value());
+    assert(lhs.get_desync_frame().value() == 1);
+    assert(rhs.get_desync_frame().has_value());
+  }
+  // The recommended input delay follows the round trip time
+  {
+    const auto [a, b]{create_loopback_transports()};
+    lockstep_session lhs(game_controller(), side::lhs, *a, 5, 30, 1);
+    lockstep_session rhs(game_controller(), side::rhs, *b, 5, 30, 1);
+    for (int i{0}; i != 4; ++i)
+    {
+      lhs.tick();
+      rhs.tick();
+    }
+    assert(lhs.get_recommended_input_delay() < lhs.get_input_delay());
+    lhs.set_input_delay(lhs.get_recommended_input_delay());
+    rhs.set_input_delay(rhs.get_recommended_input_delay());
+    for (int i{0}; i != 10; ++i)
+    {
+      lhs.tick();
+      rhs.tick();
+    }
+    assert(lhs.get_frame() == 14);
+    assert(calc_hash(lhs.get_game_controller()) == calc_hash(rhs.get_game_controller()));
+  }
+#endif // NDEBUG
+}
+
+void test_lockstep_session_long()
+{
+#ifndef NDEBUG
+  // Two games with random user inputs stay the same
+  {
+    const auto result{run_lockstep_loopback(30, 2, 1)};
+    assert(result.get_n_frames() == 60);
+    assert(!result.is_desync());
+    assert(result.get_n_bytes_sent() > 0);
+    assert(result.get_n_bytes_per_minute() > 0.0);
+  }
+#endif // NDEBUG
+}
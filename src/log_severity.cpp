@@ -0,0 +1,58 @@
+#include "log_severity.h"
+
+#include <cassert>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+#include "../magic_enum/include/magic_enum/magic_enum.hpp" // https://github.com/Neargye/magic_enum
+
+std::vector<log_severity> get_all_log_severities() noexcept
+{
+  const auto a{magic_enum::enum_values<log_severity>()};
+  std::vector<log_severity> v;
+  v.reserve(a.size());
+  std::copy(std::begin(a), std::end(a), std::back_inserter(v));
+  assert(a.size() == v.size());
+  return v;
+}
+
+void test_log_severity()
+{
+#ifndef NDEBUG
+  // get_all_log_severities
+  {
+    assert(get_all_log_severities().size() == 4);
+    assert(get_all_log_severities().front() == log_severity::debug);
+    assert(get_all_log_severities().back() == log_severity::error);
+  }
+  // Severities can be compared
+  {
+    assert(log_severity::debug < log_severity::error);
+  }
+  // to_str
+  {
+    assert(to_str(log_severity::debug) == "debug");
+    assert(to_str(log_severity::info) == "info");
+    assert(to_str(log_severity::warning) == "warning");
+    assert(to_str(log_severity::error) == "error");
+  }
+  // operator<<
+  {
+    std::stringstream s;
+    s << log_severity::warning;
+    assert(!s.str().empty());
+  }
+#endif // NDEBUG
+}
+
+std::string to_str(const log_severity s) noexcept
+{
+  return std::string(magic_enum::enum_name(s));
+}
+
+std::ostream& operator<<(std::ostream& os, const log_severity s) noexcept
+{
+  os << to_str(s);
+  return os;
+}
@@ -21,6 +21,8 @@
 #include "about.h"
 #include "about_view_layout.h"
 #include "action_history.h"
+#include "asset_cache.h"
+#include "benchmark.h"
 #include "board_layout.h"
 #include "board_to_text_options.h"
 #include "castling_type.h"
@@ -29,7 +31,11 @@
 #include "controls_view_item.h"
 #include "controls_view_layout.h"
 #include "diagnostics_file.h"
+#include "diagnostics_log.h"
 #include "fps_clock.h"
+#include "frame_pacer.h"
+#include "frame_phase.h"
+#include "frame_timings.h"
 #include "game.h"
 #include "game_controller.h"
 #include "game_statistics_widget_layout.h"
@@ -38,23 +44,37 @@
 #include "game_options.h"
 #include "game_statistics.h"
 #include "game_rect.h"
+#include "game_simulation.h"
 #include "game_view_layout.h"
 #include "game_statistics_in_time.h"
+#include "game_statistics_file_format.h"
 #include "game_statistics_output_file.h"
 #include "helper.h"
+#include "fen_position.h"
+#include "fen_position_cache.h"
 #include "fen_string.h"
 #include "in_game_time.h"
+#include "input_replay.h"
 #include "game_statistics_view_layout.h"
 #include "in_game_controls_layout.h"
 #include "key_bindings.h"
+#include "king_safety.h"
 #include "laws.h"
+#include "log_severity.h"
 #include "lobby_options.h"
+#include "lockstep_message.h"
+#include "lockstep_session.h"
 #include "lobby_view_item.h"
 #include "lobby_view_layout.h"
 #include "menu_view_item.h"
 #include "menu_view_layout.h"
+#include "match_server.h"
+#include "metrics.h"
 #include "navigation_controls_layout.h"
+#include "net_bytes.h"
+#include "net_transport.h"
 #include "options_view_layout.h"
+#include "perft.h"
 #include "pgn_move_string.h"
 #include "pgn_game_string.h"
 #include "physical_controller.h"
@@ -68,11 +88,21 @@
 #include "race.h"
 #include "read_only.h"
 #include "replay.h"
+#include "rollback_session.h"
 #include "screen_coordinate.h"
 #include "sfml_helper.h"
-#include "sleep_scheduler.h"
+#include "server_load_client.h"
+#include "server_match.h"
+#include "sound_voice_pool.h"
+#include "spectator_broadcaster.h"
+#include "spectator_state.h"
+#include "spectator_stream.h"
+#include "spsc_queue.h"
 #include "test_game.h"
 #include "test_rules.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include "triple_buffer.h"
 #include "when_to_make_a_move_law.h"
 #ifndef LOGIC_ONLY
 #include "loading_view.h"
@@ -86,7 +116,7 @@
 #include <cstdio>
 #include <filesystem>
 
-/// All tests are called from here, only in debug mode
+/// All fast tests are called from here, only in debug mode
 void test()
 {
 #ifndef NDEBUG
@@ -99,6 +129,8 @@ void test()
   test_about_view_layout();
   test_action_history();
   test_action_number();
+  test_asset_cache();
+  test_benchmark();
   test_board_layout();
   test_board_to_text_options();
   test_castling_type();
@@ -110,17 +142,26 @@ void test()
   test_controls_view_layout();
   test_cli_options();
   test_delta_t();
+  test_diagnostics_file();
+  test_diagnostics_log();
+  test_fen_position();
+  test_fen_position_cache();
   test_fen_string();
   test_fps_clock();
+  test_frame_pacer();
+  test_frame_phase();
+  test_frame_timings();
   test_game();
   test_game_controller();
   test_game_coordinate();
   test_game_info_layout();
   test_game_options();
   test_game_rect();
+  test_game_simulation();
   test_game_speed();
   test_game_statistic_type();
   test_game_statistics();
+  test_game_statistics_file_format();
   test_game_statistics_in_time();
   test_game_statistics_output_file();
   test_game_statistics_view_layout();
@@ -129,20 +170,30 @@ void test()
   test_id();
   test_in_game_controls_layout();
   test_in_game_time();
+  test_input_replay();
   test_key_bindings();
+  test_king_safety();
   test_laws();
   test_lobby_options();
   test_lobby_view_item();
   test_lobby_view_layout();
+  test_lockstep_message();
+  test_lockstep_session();
   test_log();
+  test_log_severity();
+  test_match_server();
   test_menu_view_item();
   test_menu_view_layout();
   test_message();
   test_message_type();
+  test_metrics();
   test_mouse_bindings();
   test_navigation_controls_layout();
+  test_net_bytes();
+  test_net_transport();
   test_options_view_item();
   test_options_view_layout();
+  test_perft();
   test_pgn_game_string();
   test_pgn_move_string();
   test_physical_controller_type();
@@ -159,15 +210,24 @@ void test()
   test_race();
   test_read_only();
   test_replay();
+  test_rollback_session();
   test_rules();
   test_screen_coordinate();
   test_screen_rect();
+  test_server_load_client();
+  test_server_match();
   test_sfml_helper();
   test_side();
-  test_sleep_scheduler();
-  test_sleep_scheduler();
+  test_sound_voice_pool();
+  test_spectator_broadcaster();
+  test_spectator_state();
+  test_spectator_stream();
+  test_spsc_queue();
   test_square();
   test_starting_position_type();
+  test_thread_pool();
+  test_trace();
+  test_triple_buffer();
   test_user_input();
   test_user_inputs();
   test_volume();
@@ -181,13 +241,33 @@ void test()
 #endif // NDEBUG
 }
 
+/// All slow tests, that use threads, sockets or wall-clock time,
+/// are called from here, only in debug mode and with '--long-tests'
+void test_long()
+{
+#ifndef NDEBUG
+  test_benchmark_long();
+  test_lockstep_session_long();
+  test_match_server_long();
+  test_net_transport_long();
+  test_perft_long();
+  test_rollback_session_long();
+  test_server_load_client_long();
+  test_spectator_broadcaster_long();
+  test_spsc_queue_long();
+  test_thread_pool_long();
+#endif // NDEBUG
+}
+
 /// Handle the abort signal, as triggered by a failing assert.
-/// Note that, for now, this is mostly cosmetic:
-/// in main, the stderr is redirected
-/// to a file.
+/// The most recent diagnostics are written to stderr,
+/// which, in main, is redirected to the diagnostics file.
 /// @note From \url{https://www.geeksforgeeks.org/cpp/how-to-handle-sigabrt-signal-in-cpp/}
 void handle_abort_signal(int /* signal */)
 {
+    // Only dumps the log that already exists,
+    // as creating it here is not safe
+    dump_diagnostics_log(stderr);
     std::cout
       << "ERROR!\n"
       << "\n"
@@ -263,6 +343,9 @@ int main(int argc, char **argv) //!OCLINT tests may be long
 
   if (options.get_do_assert_to_log())
   {
+    // Create the log before the signal handler can dump it
+    get_diagnostics_log();
+
     // Set up the signal handler for SIGABRT
     // From https://www.geeksforgeeks.org/cpp/how-to-handle-sigabrt-signal-in-cpp/
     signal(SIGABRT, handle_abort_signal);
@@ -283,11 +366,27 @@ int main(int argc, char **argv) //!OCLINT tests may be long
     std::clog << "Start playing a standard random game\n";
     play_standard_random_game();
   }
+  if (options.get_do_profile() || options.get_do_play_standard_random_game())
+  {
+    std::clog << "Save metrics to '" << get_default_metrics_filename() << "'\n";
+    save_metrics(get_metrics());
+  }
   if (options.get_do_test())
   {
     std::clog << "Start tests\n";
     test();
   }
+  if (options.get_do_long_test())
+  {
+    std::clog << "Start long tests\n";
+    test_long();
+  }
+
+  if (!options.get_trace_filename().empty())
+  {
+    std::clog << "Start tracing to '" << options.get_trace_filename() << "'\n";
+    start_tracing(options.get_trace_filename());
+  }
 
   #ifndef LOGIC_ONLY
   std::clog << "Starting game\n";
@@ -295,6 +394,9 @@ int main(int argc, char **argv) //!OCLINT tests may be long
   v.exec();
   #endif // LOGIC_ONLY
 
+  // Write the trace, if any
+  stop_tracing();
+
   // Game ended successfully
   file.add_footer();
 
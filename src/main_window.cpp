@@ -3,8 +3,10 @@
 #ifndef LOGIC_ONLY
 
 #include "about_view.h"
+#include "asset_cache.h"
 #include "controls_view.h"
 #include "diagnostics_file.h"
+#include "diagnostics_log.h"
 #include "draw.h"
 #include "game_options.h"
 #include "game_resources.h"
@@ -12,14 +14,18 @@
 #include "loading_view.h"
 #include "lobby_options.h"
 #include "lobby_view.h"
+#include "log_severity.h"
 #include "menu_view.h"
 #include "options_view.h"
 #include "render_window.h"
 #include "replay_view.h"
 #include "screen_rect.h"
+#include "trace.h"
 
 #include <cassert>
 #include <cmath>
+#include <iomanip>
+#include <sstream>
 
 main_window::main_window(const cc_cli_options& options)
   : m_cli_options{options}
@@ -71,20 +77,36 @@ main_window::main_window(const cc_cli_options& options)
   m_game_options.set_show_debug_info(
     m_cli_options.get_do_show_debug_info()
   );
+
+  // Let the display or the frame pacer wait
+  get_render_window().setVerticalSyncEnabled(m_cli_options.get_do_use_vsync());
+  m_frame_pacer.set_use_vsync(m_cli_options.get_do_use_vsync());
 }
 
 void main_window::exec()
 {
   m_views[program_state::loading]->start();
+  m_frame_phase_clock.restart();
 
   while (get_render_window().isOpen())
   {
+    const trace_scope scope("main_window::exec frame");
+
     // Process user input and play game until instructed to exit
     const bool must_quit{process_events()};
     if (must_quit) return;
+    end_frame_phase(frame_phase::events);
 
     // Go to the next state
     tick();
+    end_frame_phase(frame_phase::tick);
+
+    if (m_cli_options.get_do_exit_after_loading()
+      && m_program_state != program_state::loading
+    )
+    {
+      break;
+    }
 
     // Show the new state
     show();
@@ -92,8 +114,17 @@ void main_window::exec()
   get_render_window().close();
 }
 
+void main_window::end_frame_phase(const frame_phase p)
+{
+  m_frame_timing.set_ms(
+    p,
+    m_frame_phase_clock.restart().asMicroseconds() / 1000.0
+  );
+}
+
 bool main_window::process_events()
 {
+  const trace_scope scope("main_window::process_events");
   sf::Event event;
   while (get_render_window().pollEvent(event))
   {
@@ -111,6 +142,14 @@ bool main_window::process_event(sf::Event& event)
     process_resize_event(event);
     return false; // Do not close the program
   }
+  if (event.type == sf::Event::LostFocus
+    || event.type == sf::Event::GainedFocus
+  )
+  {
+    m_has_focus = event.type == sf::Event::GainedFocus;
+    update_target_fps();
+    return false; // Do not close the program
+  }
   if (event.type == sf::Event::KeyPressed)
   {
     sf::Keyboard::Key key_pressed = event.key.code;
@@ -121,6 +160,13 @@ bool main_window::process_event(sf::Event& event)
       );
       return false; // Done. Do not close the program
     }
+    if (key_pressed == sf::Keyboard::Key::F5
+      && m_game_options.get_show_debug_info()
+    )
+    {
+      save_to_csv(m_frame_timings, get_default_frame_timings_filename());
+      return false; // Done. Do not close the program
+    }
   }
 
   // Specific
@@ -216,6 +262,15 @@ void main_window::set_new_state(const program_state s)
     }
   }
 
+  if (m_program_state == program_state::loading)
+  {
+    diagnostics_file().add_loading_time(
+      m_loading_clock.getElapsedTime().asSeconds(),
+      asset_cache::get().get_n_hits(),
+      asset_cache::get().get_n_misses()
+    );
+  }
+
   // Start the new state
   m_program_state = s;
 
@@ -224,10 +279,12 @@ void main_window::set_new_state(const program_state s)
   m_views[m_program_state]->start();
   assert(m_views[m_program_state]->is_active());
   assert(!m_views[m_program_state]->get_next_state().has_value());
+  update_target_fps();
 }
 
 void main_window::show()
 {
+  const trace_scope scope("main_window::show");
   // Start drawing the new frame, by clearing the screen
   get_render_window().clear();
 
@@ -236,32 +293,72 @@ void main_window::show()
   if (m_game_options.get_show_debug_info()) {
     show_debug_info();
   }
+  end_frame_phase(frame_phase::draw);
 
   // Display all shapes
   get_render_window().display();
 
-  m_sleep_scheduler.tick();
+  m_frame_pacer.tick();
+  end_frame_phase(frame_phase::display);
+
+  m_frame_timings.add(m_frame_timing);
+
+  update_metrics();
 }
 
 void main_window::show_debug_info()
 {
   const auto debug_rect = screen_rect(
     screen_coordinate(4, 4),
-    screen_coordinate(400, 30)
+    screen_coordinate(900, 30)
   );
   const int fps{
-    static_cast<int>(std::round(m_sleep_scheduler.get_fps()))
+    static_cast<int>(std::round(m_frame_pacer.get_fps()))
   };
+  const sound_effects& effects{game_resources::get().get_sound_effects()};
   draw_rectangle(debug_rect, sf::Color(128, 128, 128, 128));
   draw_text(
     std::to_string(fps) + std::string(" FPS, ")
+    + get_frame_times_str(m_frame_pacer) + ", "
     + to_str(m_program_state) + ", "
     + to_str(m_lobby_options.get_race(side::lhs))
     + std::string(" vs ")
-    + to_str(m_lobby_options.get_race(side::rhs)),
+    + to_str(m_lobby_options.get_race(side::rhs)) + ", "
+    + std::to_string(effects.get_n_playing_voices()) + " voices, "
+    + std::to_string(effects.get_n_dropped_voices()) + " dropped",
     debug_rect,
     16
   );
+
+  // The mean time per frame phase, in the recent frames
+  const auto phases_rect = screen_rect(
+    screen_coordinate(4, 34),
+    screen_coordinate(900, 60)
+  );
+  std::stringstream s;
+  s << std::fixed << std::setprecision(1);
+  for (const auto p: get_all_frame_phases())
+  {
+    s << p << ": " << get_mean_ms(m_frame_timings, p) << " ms, ";
+  }
+  s << "F5: save to " << get_default_frame_timings_filename();
+  draw_rectangle(phases_rect, sf::Color(128, 128, 128, 128));
+  draw_text(s.str(), phases_rect, 16);
+
+  const auto graph_rect = screen_rect(
+    screen_coordinate(4, 64),
+    screen_coordinate(604, 304)
+  );
+  draw_rectangle(graph_rect, sf::Color(0, 0, 0, 192));
+  draw_frame_timings(m_frame_timings, graph_rect);
+
+  // The change of the metrics in the last second
+  const auto metrics_rect = screen_rect(
+    screen_coordinate(4, 308),
+    screen_coordinate(1604, 334)
+  );
+  draw_rectangle(metrics_rect, sf::Color(128, 128, 128, 128));
+  draw_text(m_metrics_str, metrics_rect, 16);
 }
 
 void test_main_window()
@@ -276,11 +373,51 @@ void test_main_window()
   #endif // NDEBUG
 }
 
+void main_window::update_metrics()
+{
+  static metric_gauge& cpu_percent{
+    get_metrics().get_gauge("process_cpu_percent")
+  };
+  if (m_metrics_clock.getElapsedTime().asSeconds() < 1.0) return;
+  const double real_secs{m_metrics_clock.restart().asSeconds()};
+
+  // The CPU time of all threads, relative to the real time
+  const double cpu_secs{get_process_cpu_secs()};
+  cpu_percent.set(100.0 * (cpu_secs - m_metrics_cpu_secs) / real_secs);
+  m_metrics_cpu_secs = cpu_secs;
+
+  const metrics_snapshot now{get_metrics().get_snapshot()};
+  m_metrics_str = get_metrics_rates_str(m_metrics_snapshot, now);
+  m_metrics_snapshot = now;
+
+  if (now.m_time_secs - m_metrics_log_snapshot.m_time_secs >= get_metrics_log_interval_secs())
+  {
+    get_diagnostics_log().add(
+      log_severity::debug,
+      "Metrics: " + get_metrics_rates_str(m_metrics_log_snapshot, now)
+    );
+    m_metrics_log_snapshot = now;
+  }
+}
+
+void main_window::update_target_fps()
+{
+  const bool is_idle{
+    !m_has_focus && m_views[m_program_state]->is_retained()
+  };
+  m_frame_pacer.set_target_fps(
+    is_idle ? get_unfocused_target_fps() : get_focused_target_fps()
+  );
+  // Let the pacer wait, as the display would wait one screen refresh only
+  m_frame_pacer.set_use_vsync(!is_idle && m_cli_options.get_do_use_vsync());
+}
+
 void main_window::tick()
 {
+  const trace_scope scope("main_window::tick");
   const double dt_raw{
     get_speed_multiplier(m_game_options.get_game_speed())
-      / m_sleep_scheduler.get_fps()
+      / m_frame_pacer.get_fps()
   };
   // For the first frames, dt_raw may be too big
   const delta_t dt{std::min(dt_raw, 1.0)};
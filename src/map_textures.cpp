@@ -2,6 +2,8 @@
 
 #ifndef LOGIC_ONLY
 
+#include "asset_cache.h"
+
 #include <cassert>
 #include <sstream>
 
@@ -10,7 +12,7 @@ map_textures::map_textures()
   for (const auto r: get_all_races())
   {
     const std::string filename{get_filename(r)};
-    if (!m_textures[r].loadFromFile(filename))
+    if (!load_from_file(m_textures[r], filename))
     {
       auto msg{"Cannot find image file '" + filename + "'"};
       throw std::runtime_error(msg);
@@ -0,0 +1,246 @@
+#include "match_server.h"
+
+#include "diagnostics_log.h"
+#include "game_simulation.h"
+#include "metrics.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+match_server::match_server(
+  const int n_threads,
+  const std::string& replay_folder,
+  const int n_steps_per_frame
+) : m_n_steps_per_frame{n_steps_per_frame},
+    m_replay_folder{replay_folder},
+    m_thread_pool(n_threads)
+{
+  assert(m_n_steps_per_frame > 0);
+}
+
+int match_server::add_match(
+  std::unique_ptr<net_transport> transport_lhs,
+  std::unique_ptr<net_transport> transport_rhs,
+  const game_controller& c,
+  const int max_n_frames
+)
+{
+  const int id{m_next_id++};
+  m_matches.push_back(
+    std::make_unique<server_match>(
+      id,
+      std::move(transport_lhs),
+      std::move(transport_rhs),
+      c,
+      max_n_frames,
+      m_n_steps_per_frame
+    )
+  );
+  m_cpu_secs[id] = 0.0;
+  return id;
+}
+
+double match_server::get_frame_rate() const noexcept
+{
+  return get_default_simulation_frequency() / m_n_steps_per_frame;
+}
+
+double match_server::get_max_match_cpu_secs() const noexcept
+{
+  double max_secs{m_max_done_cpu_secs};
+  for (const auto& [id, secs]: m_cpu_secs)
+  {
+    max_secs = std::max(max_secs, secs);
+  }
+  return max_secs;
+}
+
+double match_server::get_total_cpu_secs() const noexcept
+{
+  double total_secs{m_total_done_cpu_secs};
+  for (const auto& [id, secs]: m_cpu_secs) total_secs += secs;
+  return total_secs;
+}
+
+std::string get_match_replay_filename(const int match_id)
+{
+  std::stringstream s;
+  s << "match_" << match_id << ".ccir";
+  return s.str();
+}
+
+void match_server::run(const int n_ticks)
+{
+  using clock = std::chrono::steady_clock;
+  const auto frame_time{
+    std::chrono::duration_cast<clock::duration>(
+      std::chrono::duration<double>(1.0 / get_frame_rate())
+    )
+  };
+  auto next_tick{clock::now()};
+  for (int i{0}; i != n_ticks; ++i)
+  {
+    tick();
+    next_tick += frame_time;
+    const auto now{clock::now()};
+    if (now > next_tick)
+    {
+      // Do not try to catch up, as the matches would speed up
+      ++m_n_late_ticks;
+      next_tick = now;
+    }
+    std::this_thread::sleep_until(next_tick);
+  }
+}
+
+void match_server::save_replay(const server_match& m) const
+{
+  if (m_replay_folder.empty()) return;
+  const std::string filename{
+    (std::filesystem::path(m_replay_folder) / get_match_replay_filename(m.get_id())).string()
+  };
+  try
+  {
+    save_input_replay(m.get_replay(), filename);
+  }
+  catch (const std::runtime_error& e)
+  {
+    // One replay that cannot be saved must not stop the other matches
+    get_diagnostics_log().add(log_severity::error, e.what());
+  }
+}
+
+void match_server::tick()
+{
+  const trace_scope scope("match_server::tick");
+  static metric_histogram& tick_ms{
+    get_metrics().get_histogram("server_tick_ms")
+  };
+  static metric_counter& n_match_frames{
+    get_metrics().get_counter("server_match_frames")
+  };
+  static metric_gauge& n_matches{
+    get_metrics().get_gauge("server_matches")
+  };
+  const auto start{std::chrono::steady_clock::now()};
+
+  for (const auto& m: m_matches)
+  {
+    server_match* const p{m.get()};
+    m_thread_pool.add_task(
+      [this, p]
+      {
+        p->tick();
+        if (p->is_done()) save_replay(*p);
+      }
+    );
+  }
+  m_thread_pool.wait();
+
+  for (const auto& m: m_matches)
+  {
+    m_cpu_secs[m->get_id()] = m->get_cpu_secs();
+  }
+  m_n_frames += static_cast<int>(m_matches.size());
+  n_match_frames.add(m_matches.size());
+
+  // Only keep the totals of the matches that are done,
+  // so that a long-running server does not grow
+  for (const auto& m: m_matches)
+  {
+    if (!m->is_done()) continue;
+    const auto cpu_secs{m_cpu_secs.find(m->get_id())};
+    m_max_done_cpu_secs = std::max(m_max_done_cpu_secs, cpu_secs->second);
+    m_total_done_cpu_secs += cpu_secs->second;
+    m_cpu_secs.erase(cpu_secs);
+  }
+  const auto new_end{
+    std::remove_if(
+      std::begin(m_matches),
+      std::end(m_matches),
+      [](const auto& m) { return m->is_done(); }
+    )
+  };
+  m_n_matches_done += static_cast<int>(std::distance(new_end, std::end(m_matches)));
+  m_matches.erase(new_end, std::end(m_matches));
+  ++m_n_ticks;
+
+  n_matches.set(m_matches.size());
+  tick_ms.add(
+    std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start
+    ).count()
+  );
+}
+
+void test_match_server()
+{
+#ifndef NDEBUG
+  // A new server has no matches
+  {
+    const match_server s(2);
+    assert(s.get_matches().empty());
+    assert(s.get_n_ticks() == 0);
+    assert(s.get_thread_pool().get_n_threads() == 2);
+    assert(s.get_frame_rate() > 0.0);
+  }
+  // All matches are ticked
+  {
+    match_server s(2, "", 1);
+    const int a{s.add_match(nullptr, nullptr)};
+    const int b{s.add_match(nullptr, nullptr)};
+    assert(a != b);
+    s.tick();
+    assert(s.get_n_frames() == 2);
+    for (const auto& m: s.get_matches()) assert(m->get_frame() == 1);
+    assert(s.get_cpu_secs().at(a) > 0.0);
+    assert(s.get_cpu_secs().at(b) > 0.0);
+    assert(s.get_total_cpu_secs() >= s.get_max_match_cpu_secs());
+  }
+  // A match that is done is removed and its replay saved
+  {
+    const std::filesystem::path folder{
+      std::filesystem::temp_directory_path() / "test_match_server"
+    };
+    std::filesystem::create_directories(folder);
+    match_server s(2, folder.string(), 1);
+    const int id{s.add_match(nullptr, nullptr, game_controller(), 2)};
+    s.add_match(nullptr, nullptr, game_controller(), 3);
+    s.tick();
+    s.tick();
+    assert(s.get_n_ticks() == 2);
+    assert(s.get_n_matches_done() == 1);
+    assert(s.get_matches().size() == 1);
+    const std::string filename{(folder / get_match_replay_filename(id)).string()};
+    assert(std::filesystem::exists(filename));
+    assert(load_input_replay(filename).get_n_frames() == 2);
+    std::filesystem::remove_all(folder);
+    // Only its CPU time is forgotten, the totals remain
+    assert(!s.get_cpu_secs().count(id));
+    assert(s.get_cpu_secs().size() == 1);
+    assert(s.get_total_cpu_secs() > s.get_cpu_secs().begin()->second);
+  }
+#endif // NDEBUG
+}
+
+void test_match_server_long()
+{
+#ifndef NDEBUG
+  // Running ticks at the frame rate
+  {
+    match_server s(2, "", 1);
+    s.add_match(nullptr, nullptr);
+    const auto start{std::chrono::steady_clock::now()};
+    s.run(3);
+    const std::chrono::duration<double> duration{std::chrono::steady_clock::now() - start};
+    assert(s.get_n_ticks() == 3);
+    assert(duration.count() >= 2.0 / s.get_frame_rate());
+  }
+#endif // NDEBUG
+}
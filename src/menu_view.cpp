@@ -296,6 +296,7 @@ void menu_view::set_selected(const menu_view_item i)
   if (m_selected != i)
   {
     game_resources::get().get_sound_effects().play_hide();
+    invalidate();
   }
   m_selected = i;
 }
@@ -0,0 +1,482 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+#ifndef _WIN32
+#include <time.h>
+#else
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif // _WIN32
+
+namespace {
+
+/// Get the time on a steady clock, in seconds
+double get_steady_time_secs() noexcept
+{
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now().time_since_epoch()
+  ).count();
+}
+
+/// Get the index of the shard of a \link{metric_counter}
+/// that the current thread increments.
+///
+/// Threads get their shard in turn
+int get_thread_shard_index() noexcept
+{
+  static std::atomic<int> next_index{0};
+  thread_local const int index{
+    next_index.fetch_add(1, std::memory_order_relaxed)
+      % get_metric_counter_n_shards()
+  };
+  return index;
+}
+
+} // ~namespace
+
+void metric_counter::add(const std::int64_t n) noexcept
+{
+  m_shards[get_thread_shard_index()].m_value.fetch_add(
+    n, std::memory_order_relaxed
+  );
+}
+
+std::int64_t metric_counter::get() const noexcept
+{
+  std::int64_t sum{0};
+  for (const auto& s: m_shards)
+  {
+    sum += s.m_value.load(std::memory_order_relaxed);
+  }
+  return sum;
+}
+
+metric_histogram::metric_histogram(const std::vector<double>& upper_bounds)
+  : m_upper_bounds{upper_bounds},
+    m_bucket_counts{
+      std::make_unique<std::atomic<std::int64_t>[]>(upper_bounds.size() + 1)
+    }
+{
+  assert(std::is_sorted(std::begin(m_upper_bounds), std::end(m_upper_bounds)));
+  for (std::size_t i{0}; i != m_upper_bounds.size() + 1; ++i)
+  {
+    m_bucket_counts[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void metric_histogram::add(const double value) noexcept
+{
+  const auto there{
+    std::lower_bound(
+      std::begin(m_upper_bounds),
+      std::end(m_upper_bounds),
+      value
+    )
+  };
+  const auto index{std::distance(std::begin(m_upper_bounds), there)};
+  m_bucket_counts[index].fetch_add(1, std::memory_order_relaxed);
+  m_count.fetch_add(1, std::memory_order_relaxed);
+
+  // std::atomic<double> has no fetch_add before C++20
+  double sum{m_sum.load(std::memory_order_relaxed)};
+  while (
+    !m_sum.compare_exchange_weak(
+      sum, sum + value, std::memory_order_relaxed
+    )
+  )
+  {
+    // sum is updated by compare_exchange_weak
+  }
+}
+
+std::vector<std::int64_t> metric_histogram::get_bucket_counts() const
+{
+  std::vector<std::int64_t> counts(m_upper_bounds.size() + 1);
+  for (std::size_t i{0}; i != counts.size(); ++i)
+  {
+    counts[i] = m_bucket_counts[i].load(std::memory_order_relaxed);
+  }
+  return counts;
+}
+
+metrics_registry::metrics_registry()
+  : m_start_secs{get_steady_time_secs()}
+{
+
+}
+
+metric_counter& metrics_registry::get_counter(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto& p{m_counters[name]};
+  if (!p) p = std::make_unique<metric_counter>();
+  return *p;
+}
+
+metric_gauge& metrics_registry::get_gauge(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto& p{m_gauges[name]};
+  if (!p) p = std::make_unique<metric_gauge>();
+  return *p;
+}
+
+metric_histogram& metrics_registry::get_histogram(
+  const std::string& name,
+  const std::vector<double>& upper_bounds
+)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto& p{m_histograms[name]};
+  if (!p)
+  {
+    p = std::make_unique<metric_histogram>(
+      upper_bounds.empty()
+      ? get_default_metric_histogram_upper_bounds_ms()
+      : upper_bounds
+    );
+  }
+  return *p;
+}
+
+metrics_snapshot metrics_registry::get_snapshot() const
+{
+  metrics_snapshot s;
+  s.m_time_secs = get_steady_time_secs() - m_start_secs;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto& [name, c]: m_counters)
+  {
+    s.m_counters[name] = c->get();
+  }
+  for (const auto& [name, g]: m_gauges)
+  {
+    s.m_gauges[name] = g->get();
+  }
+  for (const auto& [name, h]: m_histograms)
+  {
+    metric_histogram_snapshot hs;
+    hs.m_upper_bounds = h->get_upper_bounds();
+    hs.m_bucket_counts = h->get_bucket_counts();
+    hs.m_count = h->get_count();
+    hs.m_sum = h->get_sum();
+    s.m_histograms[name] = hs;
+  }
+  return s;
+}
+
+std::string get_default_metrics_filename() noexcept
+{
+  return "conquer_chess_metrics.json";
+}
+
+std::vector<double> get_default_metric_histogram_upper_bounds_ms()
+{
+  return
+  {
+    0.01, 0.02, 0.05,
+    0.1, 0.2, 0.5,
+    1.0, 2.0, 5.0,
+    10.0, 20.0, 50.0,
+    100.0, 200.0, 500.0,
+    1000.0
+  };
+}
+
+double get_mean(const metric_histogram_snapshot& h) noexcept
+{
+  if (h.m_count == 0) return 0.0;
+  return h.m_sum / static_cast<double>(h.m_count);
+}
+
+metrics_registry& get_metrics()
+{
+  static metrics_registry r;
+  return r;
+}
+
+std::string get_metrics_rates_str(
+  const metrics_snapshot& before,
+  const metrics_snapshot& after
+)
+{
+  std::string s;
+  for (const auto& t: get_metrics_rates_strs(before, after))
+  {
+    if (!s.empty()) s += ", ";
+    s += t;
+  }
+  return s;
+}
+
+std::vector<std::string> get_metrics_rates_strs(
+  const metrics_snapshot& before,
+  const metrics_snapshot& after
+)
+{
+  const double dt{after.m_time_secs - before.m_time_secs};
+  std::vector<std::string> texts;
+  for (const auto& [name, value]: after.m_counters)
+  {
+    const auto there{before.m_counters.find(name)};
+    const std::int64_t value_before{
+      there == std::end(before.m_counters) ? 0 : there->second
+    };
+    std::stringstream s;
+    s << std::fixed << std::setprecision(0) << name << ": ";
+    if (dt > 0.0) s << static_cast<double>(value - value_before) / dt;
+    else s << '?';
+    s << "/s";
+    texts.push_back(s.str());
+  }
+  for (const auto& [name, value]: after.m_gauges)
+  {
+    std::stringstream s;
+    s << std::fixed << std::setprecision(0) << name << ": " << value;
+    texts.push_back(s.str());
+  }
+  for (const auto& [name, h]: after.m_histograms)
+  {
+    std::stringstream s;
+    s << std::fixed << std::setprecision(2) << name << ": " << get_mean(h) << " (mean)";
+    texts.push_back(s.str());
+  }
+  return texts;
+}
+
+double get_process_cpu_secs() noexcept
+{
+#ifndef _WIN32
+  timespec t;
+  if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t) != 0) return 0.0;
+  return static_cast<double>(t.tv_sec) + (static_cast<double>(t.tv_nsec) / 1.0e9);
+#else
+  FILETIME creation_time;
+  FILETIME exit_time;
+  FILETIME kernel_time;
+  FILETIME user_time;
+  if (!GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time))
+  {
+    return 0.0;
+  }
+  // A FILETIME counts in units of 100 nanoseconds
+  const auto to_secs{
+    [](const FILETIME& f)
+    {
+      return static_cast<double>(
+        (static_cast<std::uint64_t>(f.dwHighDateTime) << 32) | f.dwLowDateTime
+      ) / 1.0e7;
+    }
+  };
+  return to_secs(kernel_time) + to_secs(user_time);
+#endif // _WIN32
+}
+
+void save_metrics(
+  const metrics_registry& r,
+  const std::string& filename
+)
+{
+  std::ofstream f(filename);
+  f << to_json(r.get_snapshot());
+}
+
+void test_metrics()
+{
+#ifndef NDEBUG
+  // A new counter is zero
+  {
+    const metric_counter c;
+    assert(c.get() == 0);
+  }
+  // A counter sums its increments
+  {
+    metric_counter c;
+    c.add();
+    c.add(2);
+    assert(c.get() == 3);
+  }
+  // A counter sums the increments of all threads
+  {
+    metric_counter c;
+    const int n_threads{4};
+    const int n_increments{1000};
+    std::vector<std::thread> threads;
+    for (int i{0}; i != n_threads; ++i)
+    {
+      threads.emplace_back(
+        [&c]()
+        {
+          for (int j{0}; j != n_increments; ++j) c.add();
+        }
+      );
+    }
+    for (auto& t: threads) t.join();
+    assert(c.get() == n_threads * n_increments);
+  }
+  // A gauge has its most recent value
+  {
+    metric_gauge g;
+    assert(g.get() == 0.0);
+    g.set(1.5);
+    g.set(2.5);
+    assert(g.get() == 2.5);
+  }
+  // A histogram puts its values in the right buckets
+  {
+    metric_histogram h({1.0, 10.0});
+    h.add(0.5);
+    h.add(1.0);
+    h.add(5.0);
+    h.add(100.0);
+    assert(h.get_count() == 4);
+    assert(h.get_sum() == 106.5);
+    const std::vector<std::int64_t> expected{2, 1, 1};
+    assert(h.get_bucket_counts() == expected);
+  }
+  // A registry gives the same metric for the same name
+  {
+    metrics_registry r;
+    assert(&r.get_counter("a") == &r.get_counter("a"));
+    assert(&r.get_counter("a") != &r.get_counter("b"));
+    assert(&r.get_gauge("a") == &r.get_gauge("a"));
+    assert(&r.get_histogram("a") == &r.get_histogram("a"));
+  }
+  // A histogram without upper bounds uses the default ones
+  {
+    metrics_registry r;
+    assert(
+      r.get_histogram("a").get_upper_bounds()
+      == get_default_metric_histogram_upper_bounds_ms()
+    );
+  }
+  // A snapshot has the values of all metrics
+  {
+    metrics_registry r;
+    r.get_counter("c").add(3);
+    r.get_gauge("g").set(1.5);
+    r.get_histogram("h", {1.0}).add(2.0);
+    const metrics_snapshot s{r.get_snapshot()};
+    assert(s.m_counters.at("c") == 3);
+    assert(s.m_gauges.at("g") == 1.5);
+    assert(s.m_histograms.at("h").m_count == 1);
+    assert(s.m_histograms.at("h").m_bucket_counts.back() == 1);
+    assert(get_mean(s.m_histograms.at("h")) == 2.0);
+    assert(s.m_time_secs >= 0.0);
+  }
+  // get_mean of an empty histogram
+  {
+    const metric_histogram_snapshot h;
+    assert(get_mean(h) == 0.0);
+  }
+  // get_metrics_rates_str
+  {
+    metrics_snapshot before;
+    before.m_time_secs = 1.0;
+    before.m_counters["draw_calls"] = 100;
+    metrics_snapshot after;
+    after.m_time_secs = 3.0;
+    after.m_counters["draw_calls"] = 300;
+    after.m_gauges["n_pieces"] = 32.0;
+    const std::string s{get_metrics_rates_str(before, after)};
+    assert(s.find("draw_calls: 100/s") != std::string::npos);
+    assert(s.find("n_pieces: 32") != std::string::npos);
+    assert(get_metrics_rates_strs(before, after).size() == 2);
+  }
+  // to_json
+  {
+    metrics_registry r;
+    r.get_counter("c").add(3);
+    r.get_gauge("g").set(1.5);
+    r.get_histogram("h", {1.0}).add(0.5);
+    const std::string s{to_json(r.get_snapshot())};
+    assert(s.find("\"counters\"") != std::string::npos);
+    assert(s.find("\"c\": 3") != std::string::npos);
+    assert(s.find("\"g\": 1.5") != std::string::npos);
+    assert(s.find("\"bucket_counts\": [1, 0]") != std::string::npos);
+  }
+  // save_metrics
+  {
+    const std::string filename{"tmp_metrics.json"};
+    metrics_registry r;
+    r.get_counter("c").add();
+    save_metrics(r, filename);
+    assert(std::filesystem::exists(filename));
+    std::filesystem::remove(filename);
+  }
+  // The metrics of the process
+  {
+    assert(&get_metrics() == &get_metrics());
+  }
+  // get_process_cpu_secs increases with work
+  {
+    const double before{get_process_cpu_secs()};
+    assert(before > 0.0);
+    volatile double x{0.0};
+    while (get_process_cpu_secs() == before) x = x + 1.0;
+    assert(get_process_cpu_secs() > before);
+  }
+#endif // NDEBUG
+}
+
+std::string to_json(const metrics_snapshot& s)
+{
+  std::stringstream j;
+  j << "{\n"
+    << "  \"time_secs\": " << s.m_time_secs << ",\n"
+    << "  \"counters\": {"
+  ;
+  bool is_first{true};
+  for (const auto& [name, value]: s.m_counters)
+  {
+    if (!is_first) j << ',';
+    is_first = false;
+    j << "\n    \"" << name << "\": " << value;
+  }
+  j << "\n  },\n"
+    << "  \"gauges\": {"
+  ;
+  is_first = true;
+  for (const auto& [name, value]: s.m_gauges)
+  {
+    if (!is_first) j << ',';
+    is_first = false;
+    j << "\n    \"" << name << "\": " << value;
+  }
+  j << "\n  },\n"
+    << "  \"histograms\": {"
+  ;
+  is_first = true;
+  for (const auto& [name, h]: s.m_histograms)
+  {
+    if (!is_first) j << ',';
+    is_first = false;
+    j << "\n    \"" << name << "\": {"
+      << "\"count\": " << h.m_count << ", "
+      << "\"sum\": " << h.m_sum << ", "
+      << "\"upper_bounds\": ["
+    ;
+    for (std::size_t i{0}; i != h.m_upper_bounds.size(); ++i)
+    {
+      if (i != 0) j << ", ";
+      j << h.m_upper_bounds[i];
+    }
+    j << "], \"bucket_counts\": [";
+    for (std::size_t i{0}; i != h.m_bucket_counts.size(); ++i)
+    {
+      if (i != 0) j << ", ";
+      j << h.m_bucket_counts[i];
+    }
+    j << "]}";
+  }
+  j << "\n  }\n}\n";
+  return j.str();
+}
@@ -2,6 +2,8 @@
 
 #ifndef LOGIC_ONLY
 
+#include "asset_cache.h"
+
 #include <cassert>
 
 misc_textures::misc_textures()
@@ -15,7 +17,7 @@ misc_textures::misc_textures()
     const auto filename{
       std::string("resources/textures/misc/") + p.second.c_str()
     };
-    if (!p.first.get().loadFromFile(filename))
+    if (!load_from_file(p.first.get(), filename))
     {
       auto msg{"Cannot find image file '" + filename + "'"};
       throw std::runtime_error(msg);
@@ -0,0 +1,135 @@
+#include "net_bytes.h"
+
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+void add(std::vector<std::uint8_t>& bytes, const std::uint64_t value, const int n_bytes)
+{
+  for (int i{0}; i != n_bytes; ++i)
+  {
+    bytes.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+  }
+}
+
+} // ~namespace
+
+void byte_writer::add_double(const double d)
+{
+  static_assert(sizeof(double) == sizeof(std::uint64_t));
+  std::uint64_t i{0};
+  std::memcpy(&i, &d, sizeof(d));
+  add_uint64(i);
+}
+
+void byte_writer::add_int32(const std::int32_t i)
+{
+  add_uint32(static_cast<std::uint32_t>(i));
+}
+
+void byte_writer::add_uint8(const std::uint8_t i)
+{
+  m_bytes.push_back(i);
+}
+
+void byte_writer::add_uint32(const std::uint32_t i)
+{
+  add(m_bytes, i, 4);
+}
+
+void byte_writer::add_uint64(const std::uint64_t i)
+{
+  add(m_bytes, i, 8);
+}
+
+byte_reader::byte_reader(const std::vector<std::uint8_t>& bytes)
+  : m_bytes{bytes}
+{
+
+}
+
+std::uint64_t byte_reader::read(const int n_bytes) noexcept
+{
+  if (m_index + n_bytes > m_bytes.size())
+  {
+    m_index = m_bytes.size();
+    m_is_valid = false;
+    return 0;
+  }
+  std::uint64_t value{0};
+  for (int i{0}; i != n_bytes; ++i)
+  {
+    value |= static_cast<std::uint64_t>(m_bytes[m_index]) << (8 * i);
+    ++m_index;
+  }
+  return value;
+}
+
+double byte_reader::read_double() noexcept
+{
+  const std::uint64_t i{read_uint64()};
+  double d{0.0};
+  std::memcpy(&d, &i, sizeof(d));
+  return d;
+}
+
+std::int32_t byte_reader::read_int32() noexcept
+{
+  return static_cast<std::int32_t>(read_uint32());
+}
+
+std::uint8_t byte_reader::read_uint8() noexcept
+{
+  return static_cast<std::uint8_t>(read(1));
+}
+
+std::uint32_t byte_reader::read_uint32() noexcept
+{
+  return static_cast<std::uint32_t>(read(4));
+}
+
+std::uint64_t byte_reader::read_uint64() noexcept
+{
+  return read(8);
+}
+
+void test_net_bytes()
+{
+#ifndef NDEBUG
+  // Values are read as written
+  {
+    byte_writer w;
+    w.add_uint8(42);
+    w.add_int32(-123456);
+    w.add_uint32(std::numeric_limits<std::uint32_t>::max());
+    w.add_uint64(0x0102030405060708ULL);
+    w.add_double(-1.25);
+    assert(w.get_bytes().size() == 1 + 4 + 4 + 8 + 8);
+    byte_reader r(w.get_bytes());
+    assert(r.read_uint8() == 42);
+    assert(r.read_int32() == -123456);
+    assert(r.read_uint32() == std::numeric_limits<std::uint32_t>::max());
+    assert(r.read_uint64() == 0x0102030405060708ULL);
+    assert(r.read_double() == -1.25);
+    assert(r.is_done());
+    assert(r.is_valid());
+  }
+  // Values are little-endian
+  {
+    byte_writer w;
+    w.add_uint32(0x01020304);
+    const std::vector<std::uint8_t> expected{4, 3, 2, 1};
+    assert(w.get_bytes() == expected);
+  }
+  // Reading past the end makes the reader invalid
+  {
+    const std::vector<std::uint8_t> bytes{1, 2};
+    byte_reader r(bytes);
+    assert(r.read_uint32() == 0);
+    assert(!r.is_valid());
+    assert(r.is_done());
+  }
+#endif // NDEBUG
+}
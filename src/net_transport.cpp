@@ -0,0 +1,223 @@
+#include "net_transport.h"
+
+#include <cassert>
+#include <chrono>
+#include <deque>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+class loopback_channel
+{
+public:
+  /// A packet and the tick at which it arrives
+  using packet_in_flight = std::pair<int, std::vector<std::uint8_t>>;
+
+  /// The packets sent by the first transport, to the second
+  std::deque<packet_in_flight> m_to_second;
+
+  /// The packets sent by the second transport, to the first
+  std::deque<packet_in_flight> m_to_first;
+};
+
+net_transport::net_transport()
+{
+
+}
+
+net_transport::~net_transport()
+{
+
+}
+
+bool net_transport::receive(std::vector<std::uint8_t>& packet)
+{
+  if (!receive_impl(packet)) return false;
+  ++m_n_packets_received;
+  m_n_bytes_received += packet.size();
+  return true;
+}
+
+void net_transport::send(const std::vector<std::uint8_t>& packet)
+{
+  ++m_n_packets_sent;
+  m_n_bytes_sent += packet.size();
+  send_impl(packet);
+}
+
+loopback_transport::loopback_transport(
+  const std::shared_ptr<loopback_channel>& channel,
+  const bool is_first
+) : m_channel{channel},
+    m_is_first{is_first}
+{
+  assert(m_channel);
+}
+
+bool loopback_transport::receive_impl(std::vector<std::uint8_t>& packet)
+{
+  auto& packets{m_is_first ? m_channel->m_to_first : m_channel->m_to_second};
+  if (packets.empty()) return false;
+  if (packets.front().first > m_n_ticks) return false;
+  packet = packets.front().second;
+  packets.pop_front();
+  return true;
+}
+
+void loopback_transport::send_impl(const std::vector<std::uint8_t>& packet)
+{
+  if (m_packet_loss > 0.0)
+  {
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    if (distribution(m_rng_engine) < m_packet_loss) return;
+  }
+  auto& packets{m_is_first ? m_channel->m_to_second : m_channel->m_to_first};
+  packets.push_back(std::make_pair(m_n_ticks + m_latency, packet));
+}
+
+void loopback_transport::set_latency(const int n_ticks)
+{
+  assert(n_ticks >= 0);
+  m_latency = n_ticks;
+}
+
+void loopback_transport::set_packet_loss(const double p)
+{
+  assert(p >= 0.0);
+  assert(p <= 1.0);
+  m_packet_loss = p;
+}
+
+std::pair<
+  std::unique_ptr<loopback_transport>,
+  std::unique_ptr<loopback_transport>
+> create_loopback_transports()
+{
+  const auto channel{std::make_shared<loopback_channel>()};
+  return std::make_pair(
+    std::make_unique<loopback_transport>(channel, true),
+    std::make_unique<loopback_transport>(channel, false)
+  );
+}
+
+udp_transport::udp_transport(
+  const unsigned short local_port,
+  const sf::IpAddress& remote_address,
+  const unsigned short remote_port
+) : m_remote_address{remote_address},
+    m_remote_port{remote_port}
+{
+  if (m_socket.bind(local_port) != sf::Socket::Done)
+  {
+    std::stringstream msg;
+    msg << "Cannot bind UDP socket to port " << local_port;
+    throw std::runtime_error(msg.str());
+  }
+  m_socket.setBlocking(false);
+}
+
+bool udp_transport::receive_impl(std::vector<std::uint8_t>& packet)
+{
+  std::vector<std::uint8_t> buffer(sf::UdpSocket::MaxDatagramSize);
+  std::size_t n_bytes{0};
+  sf::IpAddress sender{m_remote_address};
+  unsigned short sender_port{0};
+  while (
+    m_socket.receive(buffer.data(), buffer.size(), n_bytes, sender, sender_port)
+      == sf::Socket::Done
+  )
+  {
+    if (sender != m_remote_address || sender_port != m_remote_port) continue;
+    packet.assign(std::begin(buffer), std::begin(buffer) + n_bytes);
+    return true;
+  }
+  return false;
+}
+
+void udp_transport::send_impl(const std::vector<std::uint8_t>& packet)
+{
+  // A packet that cannot be sent is lost, as any UDP packet may be
+  m_socket.send(packet.data(), packet.size(), m_remote_address, m_remote_port);
+}
+
+void test_net_transport()
+{
+#ifndef NDEBUG
+  // A new transport has sent and received nothing
+  {
+    const auto [a, b]{create_loopback_transports()};
+    assert(a->get_n_bytes_sent() == 0);
+    assert(a->get_n_packets_received() == 0);
+    std::vector<std::uint8_t> packet;
+    assert(!b->receive(packet));
+  }
+  // loopback_transport delivers packets in order, to the other transport only
+  {
+    const auto [a, b]{create_loopback_transports()};
+    a->send( { 1, 2, 3 } );
+    a->send( { 4 } );
+    std::vector<std::uint8_t> packet;
+    assert(!a->receive(packet));
+    assert(b->receive(packet));
+    assert(packet == std::vector<std::uint8_t>( { 1, 2, 3 } ));
+    assert(b->receive(packet));
+    assert(packet == std::vector<std::uint8_t>( { 4 } ));
+    assert(!b->receive(packet));
+    assert(a->get_n_bytes_sent() == 4);
+    assert(a->get_n_packets_sent() == 2);
+    assert(b->get_n_bytes_received() == 4);
+    assert(b->get_n_packets_received() == 2);
+  }
+  // loopback_transport delivers packets after the latency
+  {
+    const auto [a, b]{create_loopback_transports()};
+    a->set_latency(2);
+    assert(a->get_latency() == 2);
+    a->send( { 1 } );
+    std::vector<std::uint8_t> packet;
+    b->tick();
+    assert(!b->receive(packet));
+    b->tick();
+    assert(b->receive(packet));
+  }
+  // loopback_transport loses packets
+  {
+    const auto [a, b]{create_loopback_transports()};
+    a->set_packet_loss(0.5);
+    assert(a->get_packet_loss() == 0.5);
+    for (int i{0}; i != 100; ++i) a->send( { 1 } );
+    std::vector<std::uint8_t> packet;
+    int n_received{0};
+    while (b->receive(packet)) ++n_received;
+    assert(n_received > 25);
+    assert(n_received < 75);
+    assert(a->get_n_packets_sent() == 100);
+  }
+#endif // NDEBUG
+}
+
+void test_net_transport_long()
+{
+#ifndef NDEBUG
+  // udp_transport sends to another udp_transport on this computer,
+  // on ports picked by the operating system
+  {
+    udp_transport a(0, sf::IpAddress::LocalHost, 0);
+    assert(a.get_local_port() != 0);
+    udp_transport b(0, sf::IpAddress::LocalHost, a.get_local_port());
+    assert(b.get_local_port() != 0);
+    assert(b.get_local_port() != a.get_local_port());
+    a.set_remote_port(b.get_local_port());
+    assert(a.get_remote_port() == b.get_local_port());
+    a.send( { 1, 2, 3 } );
+    std::vector<std::uint8_t> packet;
+    // Wait at most a second for the packet to arrive
+    for (int i{0}; i != 100 && !b.receive(packet); ++i)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    assert(packet == std::vector<std::uint8_t>( { 1, 2, 3 } ));
+    assert(b.get_n_packets_received() == 1);
+  }
+#endif // NDEBUG
+}
@@ -2,6 +2,8 @@
 
 #ifndef LOGIC_ONLY
 
+#include "asset_cache.h"
+
 #include <cassert>
 #include <sstream>
 
@@ -14,7 +16,7 @@ options_menu_textures::options_menu_textures()
       std::string("resources/textures/options_menu/")
       + filename_str.c_str()
     };
-    if (!m_textures[r].loadFromFile(filename))
+    if (!load_from_file(m_textures[r], filename))
     {
       auto msg{"Cannot find image file '" + filename + "'"};
       throw std::runtime_error(msg);
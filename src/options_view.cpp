@@ -270,6 +270,7 @@ void options_view::set_selected(const options_view_item i)
   if (m_selected != i)
   {
     game_resources::get().get_sound_effects().play_hide();
+    invalidate();
   }
   m_selected = i;
 }
@@ -0,0 +1,326 @@
+#include "perft.h"
+
+#include "castling_type.h"
+#include "game.h"
+#include "piece_action.h"
+#include "square.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wshadow"
+#pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
+#include "../chess-library/include/chess.hpp"
+#pragma GCC diagnostic pop
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+namespace {
+
+/// Sort and remove the duplicates
+std::vector<std::string> to_sorted_unique(std::vector<std::string> v)
+{
+  std::sort(std::begin(v), std::end(v));
+  v.erase(std::unique(std::begin(v), std::end(v)), std::end(v));
+  return v;
+}
+
+std::int64_t perft_reference(chess::Board& board, const int depth)
+{
+  chess::Movelist moves;
+  chess::movegen::legalmoves(moves, board);
+  if (depth == 1) return moves.size();
+  std::int64_t n_nodes{0};
+  for (const auto& move: moves)
+  {
+    // As in the rules engine, capturing a king ends the game.
+    // chess-library cannot generate moves without a king
+    if (board.at<chess::PieceType>(move.to()) == chess::PieceType::KING) continue;
+    board.makeMove(move);
+    n_nodes += perft_reference(board, depth - 1);
+    board.unmakeMove(move);
+  }
+  return n_nodes;
+}
+
+/// Can the player still castle, as needed in a FEN string?
+bool has_castling_right(
+  const game& g,
+  const chess_color c,
+  const castling_type t
+)
+{
+  const square king_square{get_initial_king_square(c)};
+  const square rook_square{get_initial_rook_square(c, t)};
+  if (!is_piece_at(g, king_square) || !is_piece_at(g, rook_square)) return false;
+  const piece& king{get_piece_at(g, king_square)};
+  const piece& rook{get_piece_at(g, rook_square)};
+  return king.get_type() == piece_type::king
+    && king.get_color() == c
+    && !has_moved(king)
+    && rook.get_type() == piece_type::rook
+    && rook.get_color() == c
+    && !has_moved(rook)
+  ;
+}
+
+} // ~namespace
+
+perft_result::perft_result(
+  const int depth,
+  const std::int64_t n_nodes,
+  const double n_seconds
+) : m_depth{depth},
+    m_n_nodes{n_nodes},
+    m_n_seconds{n_seconds}
+{
+  assert(m_depth >= 0);
+  assert(m_n_nodes >= 0);
+  assert(m_n_seconds >= 0.0);
+}
+
+double perft_result::get_nodes_per_second() const noexcept
+{
+  if (m_n_seconds == 0.0) return 0.0;
+  return static_cast<double>(m_n_nodes) / m_n_seconds;
+}
+
+std::vector<std::string> collect_perft_moves(
+  const game& g,
+  const chess_color player_color
+)
+{
+  std::vector<std::string> moves;
+  for (const auto& a: collect_all_piece_actions(g))
+  {
+    if (a.get_color() != player_color) continue;
+    if (a.get_from() == a.get_to()) continue; // A promotion
+    moves.push_back(to_str(a.get_from()) + to_str(a.get_to()));
+  }
+  return to_sorted_unique(moves);
+}
+
+std::vector<std::string> collect_reference_perft_moves(const fen_string& s)
+{
+  const chess::Board board(s.get());
+  chess::Movelist moves;
+  chess::movegen::legalmoves(moves, board);
+  std::vector<std::string> v;
+  v.reserve(moves.size());
+  for (const auto& move: moves)
+  {
+    // Remove the promotion piece, e.g. 'e7e8q' becomes 'e7e8'
+    v.push_back(chess::uci::moveToUci(move).substr(0, 4));
+  }
+  return to_sorted_unique(v);
+}
+
+void do_perft_action(game& g, const piece_action& action)
+{
+  get_piece_at(g, action.get_from()).add_action(action);
+  const auto t{action.get_action_type()};
+  if (t == piece_action_type::castle_kingside
+    || t == piece_action_type::castle_queenside
+  )
+  {
+    const chess_color color{action.get_color()};
+    const square rook_square{
+      get_initial_rook_square(
+        color,
+        t == piece_action_type::castle_kingside
+          ? castling_type::king_side
+          : castling_type::queen_side
+      )
+    };
+    get_piece_at(g, rook_square).add_action(
+      piece_action(
+        color,
+        piece_type::rook,
+        t,
+        rook_square,
+        get_rook_target_square(color, t)
+      )
+    );
+  }
+  tick_until_idle(g);
+  clear_piece_messages(g);
+}
+
+perft_result measure_perft(
+  const game& g,
+  const int depth,
+  const chess_color player_color
+)
+{
+  using clock = std::chrono::steady_clock;
+  const auto start{clock::now()};
+  const std::int64_t n_nodes{perft(g, depth, player_color)};
+  const double n_seconds{
+    std::chrono::duration<double>(clock::now() - start).count()
+  };
+  return perft_result(depth, n_nodes, n_seconds);
+}
+
+std::int64_t perft(
+  const game& g,
+  const int depth,
+  const chess_color player_color
+)
+{
+  assert(depth >= 0);
+  if (depth == 0) return 1;
+  if (g.get_winner().has_value()) return 0;
+  std::vector<piece_action> actions{collect_all_piece_actions(g)};
+  actions.erase(
+    std::remove_if(
+      std::begin(actions),
+      std::end(actions),
+      [player_color](const auto& a) { return a.get_color() != player_color; }
+    ),
+    std::end(actions)
+  );
+  if (depth == 1) return static_cast<std::int64_t>(actions.size());
+  std::int64_t n_nodes{0};
+  for (const auto& a: actions)
+  {
+    game h{g};
+    do_perft_action(h, a);
+    n_nodes += perft(h, depth - 1, get_other_color(player_color));
+  }
+  return n_nodes;
+}
+
+std::int64_t perft_reference(const fen_string& s, const int depth)
+{
+  assert(depth >= 0);
+  if (depth == 0) return 1;
+  chess::Board board(s.get());
+  return perft_reference(board, depth);
+}
+
+fen_string to_perft_fen_string(
+  const game& g,
+  const chess_color active_color
+)
+{
+  std::string castling_availability;
+  if (has_castling_right(g, chess_color::white, castling_type::king_side)) castling_availability += 'K';
+  if (has_castling_right(g, chess_color::white, castling_type::queen_side)) castling_availability += 'Q';
+  if (has_castling_right(g, chess_color::black, castling_type::king_side)) castling_availability += 'k';
+  if (has_castling_right(g, chess_color::black, castling_type::queen_side)) castling_availability += 'q';
+  if (castling_availability.empty()) castling_availability = "-";
+  return to_fen_str(g.get_pieces(), active_color, castling_availability);
+}
+
+void test_perft()
+{
+#ifndef NDEBUG
+  // perft_result
+  {
+    const perft_result r(2, 400, 0.5);
+    assert(r.get_depth() == 2);
+    assert(r.get_n_nodes() == 400);
+    assert(r.get_n_seconds() == 0.5);
+    assert(r.get_nodes_per_second() == 800.0);
+  }
+  // perft_reference, the known values of the standard starting position
+  {
+    const fen_string s{create_fen_string_of_standard_starting_position()};
+    assert(perft_reference(s, 0) == 1);
+    assert(perft_reference(s, 1) == 20);
+    assert(perft_reference(s, 2) == 400);
+    assert(perft_reference(s, 3) == 8902);
+  }
+  // perft, depth 0 is the position itself
+  {
+    const game g;
+    assert(perft(g, 0) == 1);
+  }
+  // perft, agrees with chess-library on the standard starting position
+  {
+    const game g;
+    const fen_string s{create_fen_string_of_standard_starting_position()};
+    assert(perft(g, 1) == perft_reference(s, 1));
+    assert(perft(g, 1, chess_color::black) == 20);
+  }
+  // do_perft_action, castling moves the rook too
+  {
+    game g{create_game_with_starting_position(starting_position_type::ready_to_castle)};
+    const piece_action a(
+      chess_color::white,
+      piece_type::king,
+      piece_action_type::castle_kingside,
+      square("e1"),
+      square("g1")
+    );
+    do_perft_action(g, a);
+    assert(get_piece_at(g, square("g1")).get_type() == piece_type::king);
+    assert(get_piece_at(g, square("f1")).get_type() == piece_type::rook);
+  }
+  // to_perft_fen_string, only castling rights if king and rook have not moved
+  {
+    const game standard;
+    assert(to_perft_fen_string(standard, chess_color::white).get().find(" w KQkq ") != std::string::npos);
+    const game kings_only{create_game_with_starting_position(starting_position_type::kings_only)};
+    assert(to_perft_fen_string(kings_only, chess_color::black).get().find(" b - ") != std::string::npos);
+  }
+#endif // NDEBUG
+}
+
+void test_perft_long()
+{
+#ifndef NDEBUG
+  // perft, agrees with chess-library at depth 2.
+  // Kings only, as each action takes long in a debug build
+  {
+    const game g{create_game_with_starting_position(starting_position_type::kings_only)};
+    const fen_string s{to_perft_fen_string(g, chess_color::white)};
+    assert(perft(g, 2) == perft_reference(s, 2));
+  }
+  // collect_perft_moves, agrees with chess-library on the test positions
+  {
+    for (const auto t: get_all_starting_position_types())
+    {
+      const game g{create_game_with_starting_position(t)};
+      for (const auto c: get_all_chess_colors())
+      {
+        const auto moves{collect_perft_moves(g, c)};
+        const auto expected{
+          collect_reference_perft_moves(to_perft_fen_string(g, c))
+        };
+        if (moves != expected)
+        {
+          std::clog << t << ", " << c << ": "
+            << "rules engine: " << moves.size() << " moves, "
+            << "chess-library: " << expected.size() << " moves\n"
+          ;
+        }
+        assert(moves == expected);
+      }
+    }
+  }
+  // measure_perft
+  {
+    const game g;
+    const perft_result r{measure_perft(g, 1)};
+    assert(r.get_n_nodes() == 20);
+    std::stringstream s;
+    s << r;
+    assert(!s.str().empty());
+  }
+#endif // NDEBUG
+}
+
+std::ostream& operator<<(std::ostream& os, const perft_result& r) noexcept
+{
+  os
+    << "depth " << r.get_depth()
+    << ", nodes " << r.get_n_nodes()
+    << ", time " << r.get_n_seconds() << " s"
+    << ", nodes/second " << r.get_nodes_per_second()
+  ;
+  return os;
+}
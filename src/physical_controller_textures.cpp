@@ -3,6 +3,8 @@
 #ifndef LOGIC_ONLY
 
 
+#include "asset_cache.h"
+
 #include <cassert>
 #include <filesystem>
 #include <sstream>
@@ -14,7 +16,7 @@ physical_controller_textures::physical_controller_textures()
   {
     const std::string filename{get_filename(r)};
     assert(std::filesystem::exists(filename));
-    if (!m_symbols[r].loadFromFile(filename))
+    if (!load_from_file(m_symbols[r], filename))
     {
       auto msg{"Cannot find image file '" + filename + "'"};
       throw std::runtime_error(msg);
@@ -27,7 +29,7 @@ physical_controller_textures::physical_controller_textures()
   {
     const std::string filename{get_fancy_filename(r)};
     assert(std::filesystem::exists(filename));
-    if (!m_fancy_textures[r].loadFromFile(filename))
+    if (!load_from_file(m_fancy_textures[r], filename))
     {
       auto msg{"Cannot find image file '" + filename + "'"};
       throw std::runtime_error(msg);
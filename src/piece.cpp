@@ -4,6 +4,7 @@
 #include "game_options.h"
 #include "game_coordinate.h"
 #include "helper.h"
+#include "metrics.h"
 #include "piece_type.h"
 #include "square.h"
 
@@ -32,6 +33,14 @@
 #error This is managed by 'lobby_options'.
 #endif
 
+namespace {
+
+/// The number of actions added to pieces by this thread,
+/// see \link{count_piece_actions_added_by_this_thread}
+thread_local std::int64_t n_piece_actions_added_by_this_thread{0};
+
+} // namespace
+
 piece::piece(
   const chess_color color,
   const piece_type type,
@@ -137,13 +146,22 @@ void piece::add_action(const piece_action& action)
     );
     assert(can_promote(get_color(), get_type(), m_current_square));
     m_actions.push_back(action);
+    ++n_piece_actions_added_by_this_thread;
     return;
   }
   m_actions.push_back(action);
+  ++n_piece_actions_added_by_this_thread;
 }
 
 void piece::add_message(const message_type& message)
 {
+  if (message == message_type::cannot)
+  {
+    static metric_counter& n_cannot_messages{
+      get_metrics().get_counter("cannot_messages")
+    };
+    n_cannot_messages.add();
+  }
   m_messages.push_back(message);
 }
 
@@ -280,6 +298,11 @@ int count_piece_actions(const piece& p)
   return static_cast<int>(p.get_actions().size());
 }
 
+std::int64_t count_piece_actions_added_by_this_thread() noexcept
+{
+  return n_piece_actions_added_by_this_thread;
+}
+
 std::string describe_actions(const piece& p)
 {
   const auto& actions = p.get_actions();
@@ -445,6 +468,16 @@ void test_piece()
   ////////////////////////////////////////////////////////////////////////////
   // piece::add_action
   {
+    // An added action is counted
+    {
+      auto piece{get_test_white_knight()};
+      const auto n_before{count_piece_actions_added_by_this_thread()};
+      piece.add_action(piece_action(chess_color::white, piece_type::knight, piece_action_type::move, square("c3"), square("d5")));
+      assert(count_piece_actions_added_by_this_thread() == n_before + 1);
+      // An impossible action is not
+      piece.add_action(piece_action(chess_color::white, piece_type::knight, piece_action_type::move, square("c3"), square("h8")));
+      assert(count_piece_actions_added_by_this_thread() == n_before + 1);
+    }
     // start_move for a correct move results in a sound
     {
       auto piece{get_test_white_knight()};
@@ -1415,6 +1448,10 @@ void tick_move(
       );
       p.set_current_action_progress(delta_t(1.0) - p.get_current_action_progress()); // Keep progress
       p.add_message(message_type::cannot);
+      static metric_counter& n_bounce_backs{
+        get_metrics().get_counter("move_bounce_backs")
+      };
+      n_bounce_backs.add();
       return;
     }
   }
@@ -3,6 +3,8 @@
 #ifndef LOGIC_ONLY
 
 
+#include "asset_cache.h"
+
 #include <cassert>
 #include <filesystem>
 #include <sstream>
@@ -13,7 +15,7 @@ piece_action_textures::piece_action_textures()
   {
     const std::string filename{get_filename(r)};
     assert(std::filesystem::exists(filename));
-    if (!m_textures[r].loadFromFile(filename))
+    if (!load_from_file(m_textures[r], filename))
     {
       auto msg{"Cannot find image file '" + filename + "'"};
       throw std::runtime_error(msg);
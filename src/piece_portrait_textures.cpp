@@ -3,6 +3,8 @@
 #ifndef LOGIC_ONLY
 
 
+#include "asset_cache.h"
+
 #include <cassert>
 #include <sstream>
 
@@ -19,7 +21,7 @@ piece_portrait_textures::piece_portrait_textures()
           std::string("resources/textures/portraits/")
            + filename_str.c_str()
         };
-        if (!m_textures[r][c][p].loadFromFile(filename))
+        if (!load_from_file(m_textures[r][c][p], filename))
         {
           auto msg{"Cannot find image file '" + filename + "'"};
           throw std::runtime_error(msg);
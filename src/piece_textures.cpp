@@ -3,6 +3,8 @@
 #ifndef LOGIC_ONLY
 
 
+#include "asset_cache.h"
+
 #include <cassert>
 #include <filesystem>
 #include <sstream>
@@ -17,7 +19,7 @@ piece_textures::piece_textures()
       {
         const std::string filename{get_filename(r, c, p)};
         assert(std::filesystem::exists(filename));
-        if (!m_textures[r][c][p].loadFromFile(filename))
+        if (!load_from_file(m_textures[r][c][p], filename))
         {
           auto msg{"Cannot find image file '" + filename + "'"};
           throw std::runtime_error(msg);
@@ -14,8 +14,10 @@
 #include <numeric>
 #include <sstream>
 #include <iterator>
+#include <limits>
 #include <optional>
-#include <regex>
+#include <random>
+#include <stdexcept>
 
 #ifdef GAME_CONTROLLER_H
 #error 'pieces' must know nothing about 'game_controller'
@@ -200,48 +202,28 @@ int count_piece_actions(
 
 std::vector<piece> create_pieces_from_fen_string(const fen_string& fen_str)
 {
-  const std::string s{fen_str.get()};
+  const std::string& s{fen_str.get()};
   assert(!s.empty());
 
   std::vector<piece> pieces;
+  pieces.reserve(32);
 
-  int square_index{0}; // a8, a7, a6, etc...
-  int str_index{0};
-  while(1)
+  int square_index{0}; // a8, b8, c8, etc...
+  for (const char c: s)
   {
-    const char c{s[str_index]};
+    if (c == ' ') break; // Done!
+    if (c == '/') continue; // Move to the next rank
     if (c >= '1' && c <= '8')
     {
-      const int n_skips = static_cast<int>(c - '1');
-      assert(n_skips >= 0 && n_skips <= 8);
-      square_index += n_skips;
-      ++str_index;
-      ++square_index;
-    }
-    else if (c == '/')
-    {
-      // Move to the next
-      ++str_index;
-    }
-    else if (c == ' ')
-    {
-      // Done!
-      break;
-    }
-    else
-    {
-      const piece_type type{to_piece_type(std::toupper(c))};
-      const chess_color color{std::isupper(c) ? chess_color::white : chess_color::black };
-      const char file_char = 'a' + (square_index % 8);
-      const std::string file_str{file_char};
-      const int rank{8 - (square_index / 8)}; // FEN strings start from above
-      assert(rank >= 1 && rank <= 8);
-      const square sq(file_str + std::to_string(rank));
-      const piece p(color, type, sq);
-      pieces.push_back(p);
-      ++str_index;
-      ++square_index;
+      square_index += static_cast<int>(c - '0');
+      continue;
     }
+    const piece_type type{to_piece_type(std::toupper(c))};
+    const chess_color color{std::isupper(c) ? chess_color::white : chess_color::black };
+    const int rank_index{7 - (square_index / 8)}; // FEN strings start from above
+    assert(rank_index >= 0 && rank_index < 8);
+    pieces.push_back(piece(color, type, square(rank_index, square_index % 8)));
+    ++square_index;
   }
   assert(!pieces.empty());
   assert(pieces.size() <= 32);
@@ -1042,15 +1024,89 @@ bool has_king(
   return has_king;
 }
 
+namespace {
+
+/// Convert a piece type to the piece type of chess-library
+chess::PieceType to_chess_piece_type(const piece_type t) noexcept
+{
+  switch (t)
+  {
+    case piece_type::bishop: return chess::PieceType::BISHOP;
+    case piece_type::king: return chess::PieceType::KING;
+    case piece_type::knight: return chess::PieceType::KNIGHT;
+    case piece_type::pawn: return chess::PieceType::PAWN;
+    case piece_type::queen: return chess::PieceType::QUEEN;
+    case piece_type::rook:
+    default:
+      assert(t == piece_type::rook);
+      return chess::PieceType::ROOK;
+  }
+}
+
+/// Convert a color to the color of chess-library
+chess::Color to_chess_color(const chess_color c) noexcept
+{
+  return c == chess_color::white ? chess::Color::WHITE : chess::Color::BLACK;
+}
+
+/// A chess-library board that has its pieces put
+/// directly on its bitboards,
+/// instead of being parsed from a FEN string.
+///
+/// There are no castling rights and no en-passant square,
+/// just like in the FEN string \link{to_fen_str} creates.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
+class pieces_board : public chess::Board
+{
+public:
+  // chess-library needs the kings to read a FEN string
+  pieces_board() : chess::Board("4k3/8/8/8/8/8/8/4K3 w - - 0 1") {}
+
+  /// Remove all pieces and put the new pieces on the board
+  void set_pieces(
+    const std::vector<piece>& pieces,
+    const chess_color player_to_move
+  )
+  {
+    for (int i{0}; i != 64; ++i)
+    {
+      if (board_[i] != chess::Piece::NONE) removePiece(board_[i], chess::Square(i));
+    }
+    for (const auto& p: pieces)
+    {
+      const square& s{p.get_current_square()};
+      // get_x is the rank, get_y is the file
+      const chess::Square sq((s.get_x() * 8) + s.get_y());
+      if (board_[sq.index()] != chess::Piece::NONE) continue;
+      placePiece(
+        chess::Piece(to_chess_piece_type(p.get_type()), to_chess_color(p.get_color())),
+        sq
+      );
+    }
+    stm_ = to_chess_color(player_to_move);
+  }
+};
+#pragma GCC diagnostic pop
+
+} // ~namespace
+
 bool is_checkmate(
   const std::vector<piece>& pieces,
   const chess_color player_in_checkmate
 )
 {
-  const std::string fen_string{to_fen_str(pieces, player_in_checkmate)};
-  const chess::Board board(fen_string);
-  const auto p = board.isGameOver();
-  return p.first == chess::GameResultReason::CHECKMATE;
+  // Without both kings, chess-library cannot find the checks
+  if (!has_king(pieces, chess_color::white)) return false;
+  if (!has_king(pieces, chess_color::black)) return false;
+
+  // One board per thread, so its memory is reused
+  thread_local pieces_board board;
+  board.set_pieces(pieces, player_in_checkmate);
+  if (!board.inCheck()) return false;
+  chess::Movelist moves;
+  chess::movegen::legalmoves(moves, board);
+  return moves.empty();
 }
 
 bool is_draw(const std::vector<piece>& pieces)
@@ -1444,6 +1500,41 @@ void test_pieces()
     assert(!is_checkmate(pieces, chess_color::black));
     assert(!is_checkmate(pieces, chess_color::white));
   }
+  // is_checkmate, in checkmate
+  {
+    const auto white_mated{create_pieces_from_fen_string(get_fen_string_game_over_white_checkmate())};
+    assert(is_checkmate(white_mated, chess_color::white));
+    assert(!is_checkmate(white_mated, chess_color::black));
+    const auto black_mated{create_pieces_from_fen_string(get_fen_string_game_over_black_checkmate())};
+    assert(is_checkmate(black_mated, chess_color::black));
+    assert(!is_checkmate(black_mated, chess_color::white));
+  }
+  // is_checkmate, without a king
+  {
+    const auto pieces{create_pieces_from_fen_string(get_fen_string_game_over_white_no_king())};
+    assert(!is_checkmate(pieces, chess_color::white));
+    assert(!is_checkmate(pieces, chess_color::black));
+  }
+  // is_checkmate, same as chess-library reading the FEN string
+  {
+    for (const auto& pieces:
+      {
+        get_standard_starting_pieces(),
+        get_pieces_before_scholars_mate(),
+        get_pieces_kasparov_vs_topalov(),
+        get_pieces_queen_endgame(),
+        create_pieces_from_fen_string(fen_string("r1bqkb1r/pppp1Qpp/2n2n2/4p3/2B1P3/8/PPPP1PPP/RNB1K1NR b KQkq - 0 4"))
+      }
+    )
+    {
+      for (const auto c: get_all_chess_colors())
+      {
+        const chess::Board board(to_fen_str(pieces, c));
+        const bool expected{board.isGameOver().first == chess::GameResultReason::CHECKMATE};
+        assert(is_checkmate(pieces, c) == expected);
+      }
+    }
+  }
   // is_king_under_attack
   {
     auto pieces{get_pieces_queen_endgame()};
@@ -1691,6 +1782,86 @@ void test_pieces()
     const auto s{to_fen_str(pieces)};
     assert(s == "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
   }
+  // to_fen_chars
+  {
+    const auto pieces{get_standard_starting_pieces()};
+    std::array<char, get_max_fen_str_size()> buffer;
+    const int n{to_fen_chars(pieces, buffer, chess_color::black, "-", "e3", 12, 34)};
+    assert(std::string(buffer.data(), n) == to_fen_str(pieces, chess_color::black, "-", "e3", 12, 34));
+    assert(std::string(buffer.data(), n) == "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR b - e3 12 34");
+  }
+  // to_fen_chars, the longest FEN string fits
+  {
+    std::vector<piece> pieces;
+    for (int x{0}; x != 8; ++x)
+    {
+      for (int y{0}; y != 8; ++y)
+      {
+        pieces.push_back(piece((x + y) % 2 ? chess_color::white : chess_color::black, piece_type::queen, square(x, y)));
+      }
+    }
+    std::array<char, get_max_fen_str_size()> buffer;
+    const int n{
+      to_fen_chars(
+        pieces,
+        buffer,
+        chess_color::white,
+        "KQkq",
+        "e3",
+        std::numeric_limits<int>::max(),
+        std::numeric_limits<int>::max()
+      )
+    };
+    assert(n == get_max_fen_str_size());
+    assert(std::string(buffer.data(), n).substr(0, 9) == "QqQqQqQq/");
+    assert(std::string(buffer.data(), n).substr(n - 21) == "2147483647 2147483647");
+  }
+  // to_fen_chars, rejects what does not fit
+  {
+    const std::vector<piece> pieces{get_standard_starting_pieces()};
+    std::array<char, get_max_fen_str_size()> buffer;
+    bool has_thrown{false};
+    try { to_fen_chars(pieces, buffer, chess_color::white, "KQkqKQkq"); }
+    catch (const std::logic_error&) { has_thrown = true; }
+    assert(has_thrown);
+    has_thrown = false;
+    try { to_fen_chars(pieces, buffer, chess_color::white, "KQkq", "-", -1); }
+    catch (const std::logic_error&) { has_thrown = true; }
+    assert(has_thrown);
+  }
+  // to_fen_str and create_pieces_from_fen_string, same as chess-library
+  {
+    std::mt19937 rng_engine(42);
+    std::uniform_int_distribution<int> n_pieces_distribution(0, 30);
+    std::uniform_int_distribution<int> square_distribution(0, 63);
+    const auto piece_types{get_all_piece_types()};
+    std::uniform_int_distribution<int> type_distribution(0, static_cast<int>(piece_types.size()) - 1);
+    for (int i{0}; i != 1000; ++i)
+    {
+      // Both kings are needed for chess-library
+      std::vector<piece> pieces{
+        piece(chess_color::white, piece_type::king, square(square_distribution(rng_engine) % 8, 0)),
+        piece(chess_color::black, piece_type::king, square(square_distribution(rng_engine) % 8, 7))
+      };
+      const int n_pieces{n_pieces_distribution(rng_engine)};
+      for (int j{0}; j != n_pieces; ++j)
+      {
+        const int index{square_distribution(rng_engine)};
+        const piece_type t{piece_types[type_distribution(rng_engine)]};
+        if (t == piece_type::king) continue;
+        const square sq(index / 8, index % 8);
+        if (is_piece_at(pieces, sq)) continue;
+        pieces.push_back(piece(index % 2 ? chess_color::white : chess_color::black, t, sq));
+      }
+      const chess_color c{i % 2 ? chess_color::white : chess_color::black};
+      const std::string fen{to_fen_str(pieces, c, "-", "-", i % 50, 1 + i)};
+      assert(chess::Board(fen).getFen() == fen);
+      assert(get_color(fen_string(fen)) == c);
+      const auto decoded{create_pieces_from_fen_string(fen_string(fen))};
+      assert(decoded.size() == pieces.size());
+      assert(to_fen_str(decoded, c, "-", "-", i % 50, 1 + i) == fen);
+    }
+  }
 
   // to_pgn
   {
@@ -1737,58 +1908,122 @@ std::vector<std::string> to_board_strs(
   return board;
 }
 
-std::string to_fen_str(
+int to_fen_chars(
   const std::vector<piece>& pieces,
+  std::array<char, get_max_fen_str_size()>& buffer,
   const chess_color active_color,
-  const std::string castling_availability,
-  const std::string en_passant_target_square,
+  const std::string& castling_availability,
+  const std::string& en_passant_target_square,
   const int halfmove_clock,
   const int fullmove_number
 )
 {
-  std::string s;
-  s.reserve(100);
+  // Reject what does not fit, instead of truncating the FEN string
+  if (castling_availability.empty() || castling_availability.size() > 4)
+  {
+    throw std::logic_error("Castling availability must have 1 to 4 characters");
+  }
+  if (en_passant_target_square.empty() || en_passant_target_square.size() > 2)
+  {
+    throw std::logic_error("En passant target square must have 1 or 2 characters");
+  }
+  if (halfmove_clock < 0 || fullmove_number < 0)
+  {
+    throw std::logic_error("FEN counters cannot be negative");
+  }
 
-  // FEN starts from rank 8 and moves backwards
-  const auto ranks = get_all_ranks_in_reversed_order();
-  for (const int rank: ranks)
+  // The first piece at each square, index is (rank * 8) + file
+  std::array<const piece*, 64> board{};
+  for (const auto& p: pieces)
   {
-    for (const char file: get_all_files())
+    const square& sq{p.get_current_square()};
+    const int index{(sq.get_x() * 8) + sq.get_y()};
+    if (!board[index]) board[index] = &p;
+  }
+
+  int n{0};
+  const auto add{
+    [&buffer, &n](const char c)
     {
-      const square sq(file + std::to_string(rank));
-      if (is_piece_at(pieces, sq))
+      assert(n < get_max_fen_str_size());
+      buffer[n++] = c;
+    }
+  };
+  const auto add_str{
+    [&add](const std::string& s) { for (const char c: s) add(c); }
+  };
+  const auto add_int{
+    [&add](const int i)
+    {
+      assert(i >= 0);
+      char digits[10];
+      int n_digits{0};
+      int rest{i};
+      do
       {
-        s += to_fen_char(get_piece_at(pieces, sq));
+        digits[n_digits++] = static_cast<char>('0' + (rest % 10));
+        rest /= 10;
       }
-      else
+      while (rest > 0);
+      while (n_digits > 0) add(digits[--n_digits]);
+    }
+  };
+
+  // FEN starts from rank 8 and moves backwards
+  for (int rank{7}; rank >= 0; --rank)
+  {
+    int n_empty{0};
+    for (int file{0}; file != 8; ++file)
+    {
+      const piece * const p{board[(rank * 8) + file]};
+      if (!p)
       {
-        s += ".";
+        ++n_empty;
+        continue;
       }
-
+      if (n_empty > 0) add(static_cast<char>('0' + n_empty));
+      n_empty = 0;
+      add(to_fen_char(*p));
     }
-    s += "/";
+    if (n_empty > 0) add(static_cast<char>('0' + n_empty));
+    if (rank > 0) add('/');
   }
-  assert(s.back() == '/');
-  s.pop_back();
 
-  // Replace dots by numbers
-  s = std::regex_replace(s, std::regex("\\.{8}"), "8" );
-  s = std::regex_replace(s, std::regex("\\.{7}"), "7" );
-  s = std::regex_replace(s, std::regex("\\.{6}"), "6" );
-  s = std::regex_replace(s, std::regex("\\.{5}"), "5" );
-  s = std::regex_replace(s, std::regex("\\.{4}"), "4" );
-  s = std::regex_replace(s, std::regex("\\.{3}"), "3" );
-  s = std::regex_replace(s, std::regex("\\.{2}"), "2" );
-  s = std::regex_replace(s, std::regex("\\.{1}"), "1" );
-  assert(std::count(s.begin(), s.end(), '.') == 0);
-
-  s += std::string(" ") + to_fen_char(active_color) + " "
-    + castling_availability + " "
-    + en_passant_target_square + " "
-    + std::to_string(halfmove_clock) + " "
-    + std::to_string(fullmove_number)
-  ;
-  return s;
+  add(' ');
+  add(to_fen_char(active_color));
+  add(' ');
+  add_str(castling_availability);
+  add(' ');
+  add_str(en_passant_target_square);
+  add(' ');
+  add_int(halfmove_clock);
+  add(' ');
+  add_int(fullmove_number);
+  return n;
+}
+
+std::string to_fen_str(
+  const std::vector<piece>& pieces,
+  const chess_color active_color,
+  const std::string castling_availability,
+  const std::string en_passant_target_square,
+  const int halfmove_clock,
+  const int fullmove_number
+)
+{
+  std::array<char, get_max_fen_str_size()> buffer;
+  const int n{
+    to_fen_chars(
+      pieces,
+      buffer,
+      active_color,
+      castling_availability,
+      en_passant_target_square,
+      halfmove_clock,
+      fullmove_number
+    )
+  };
+  return std::string(buffer.data(), n);
 }
 
 
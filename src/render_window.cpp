@@ -2,14 +2,57 @@
 
 #ifndef LOGIC_ONLY
 
+#include "metrics.h"
 #include "screen_rect.h"
 
-sf::RenderWindow& get_render_window() noexcept {
+void render_window::count_draw(const void * const texture) noexcept
+{
+  static metric_counter& n_draw_calls{get_metrics().get_counter("draw_calls")};
+  static metric_counter& n_texture_binds{get_metrics().get_counter("texture_binds")};
+  n_draw_calls.add();
+  if (texture != m_last_texture)
+  {
+    n_texture_binds.add();
+    m_last_texture = texture;
+  }
+}
+
+sf::RenderTarget& render_window::get_draw_target() noexcept
+{
+  if (m_draw_target) return *m_draw_target;
+  return *this;
+}
+
+void render_window::draw(const sf::Drawable& drawable, const sf::RenderStates& states)
+{
+  count_draw(nullptr);
+  get_draw_target().draw(drawable, states);
+}
+
+void render_window::draw(const sf::Shape& shape, const sf::RenderStates& states)
+{
+  count_draw(shape.getTexture());
+  get_draw_target().draw(shape, states);
+}
+
+void render_window::draw(const sf::Sprite& sprite, const sf::RenderStates& states)
+{
+  count_draw(sprite.getTexture());
+  get_draw_target().draw(sprite, states);
+}
+
+void render_window::draw(const sf::Text& text, const sf::RenderStates& states)
+{
+  count_draw(text.getFont());
+  get_draw_target().draw(text, states);
+}
+
+render_window& get_render_window() noexcept {
 
   // const auto modes = sf::VideoMode::getFullscreenModes();
 
 
-  static sf::RenderWindow window{
+  static render_window window{
     sf::VideoMode(
       get_width(get_default_screen_rect()),
       get_height(get_default_screen_rect())
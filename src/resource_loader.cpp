@@ -2,7 +2,9 @@
 
 #ifndef LOGIC_ONLY
 
+#include "asset_cache.h"
 #include "game_resources.h"
+#include "trace.h"
 #include <cassert>
 
 resource_loader::resource_loader()
@@ -40,6 +42,7 @@ bool resource_loader::is_done() const noexcept
 
 void resource_loader::process_next()
 {
+  const trace_scope scope("resource_loader::process_next");
   if (is_done()) return;
   game_resources& resources{game_resources::get()};
 
@@ -152,6 +155,9 @@ void resource_loader::process_next()
       m_descriptor = "Loaded "
         + std::to_string(resources.get_n_textures())
         + " textures";
+
+      // All textures and sounds are decoded now
+      asset_cache::get().save();
       m_is_done = true;
       break;
   }
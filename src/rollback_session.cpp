@@ -0,0 +1,505 @@
+#include "rollback_session.h"
+
+#include "metrics.h"
+#include "pieces.h"
+#include "trace.h"
+#include "user_input.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iterator>
+#include <random>
+
+rollback_session::rollback_session(
+  const game_controller& c,
+  const side local_side,
+  net_transport& transport,
+  const int input_delay,
+  const int max_rollback_frames,
+  const int hash_interval,
+  const int n_steps_per_frame,
+  const game_speed speed,
+  const double steps_per_second
+) : m_game_controller{c},
+    m_delta_t{get_speed_multiplier(speed) / steps_per_second},
+    m_hash_interval{hash_interval},
+    m_input_delay{input_delay},
+    m_last_scheduled_frame{input_delay - 1},
+    m_local_side{local_side},
+    m_max_rollback_frames{max_rollback_frames},
+    m_n_remote_frames{input_delay},
+    m_n_steps_per_frame{n_steps_per_frame},
+    m_remote_ack_frame{input_delay - 1},
+    m_snapshots(max_rollback_frames + 1, c),
+    m_transport{transport}
+{
+  assert(m_input_delay >= 0);
+  assert(m_max_rollback_frames > 0);
+  assert(m_hash_interval > 0);
+  assert(m_n_steps_per_frame > 0);
+
+  // The frames before the first input delay have no user inputs,
+  // as no user could have done anything yet
+  for (int frame{0}; frame != m_input_delay; ++frame)
+  {
+    m_local_inputs[frame] = user_inputs();
+    m_remote_inputs[frame] = user_inputs();
+  }
+}
+
+void rollback_session::add_local_inputs(const user_inputs& inputs)
+{
+  for (const auto& input: inputs.get_user_inputs())
+  {
+    if (input.get_player() != m_local_side) continue;
+    m_pending_inputs.add(input);
+  }
+}
+
+void rollback_session::calc_hashes()
+{
+  const int n_snapshots{static_cast<int>(m_snapshots.size())};
+  const int n_certain_frames{std::min(m_frame, m_n_remote_frames)};
+  for (; m_n_hashed_frames < n_certain_frames; ++m_n_hashed_frames)
+  {
+    const int frame{m_n_hashed_frames};
+    if ((frame + 1) % m_hash_interval != 0) continue;
+
+    // The game after the frame is the game at the start of the next one
+    assert(frame + 1 > m_frame - n_snapshots);
+    const game_controller& c{
+      frame + 1 == m_frame
+      ? m_game_controller
+      : m_snapshots[(frame + 1) % n_snapshots]
+    };
+    m_last_hash_frame = frame;
+    m_last_hash = calc_hash(c);
+    m_last_hash_tick = m_n_ticks;
+    m_local_hashes[frame] = m_last_hash;
+  }
+  check_hashes();
+}
+
+void rollback_session::check_hashes()
+{
+  for (const auto& [frame, hash]: m_remote_hashes)
+  {
+    const auto there{m_local_hashes.find(frame)};
+    if (there == std::end(m_local_hashes)) continue;
+    if (there->second != hash && !m_desync_frame)
+    {
+      m_desync_frame = frame;
+    }
+  }
+  // Only the hashes not compared yet need to be kept
+  if (m_remote_hashes.empty() || m_local_hashes.empty()) return;
+  const int last_frame{
+    std::min(
+      m_remote_hashes.rbegin()->first,
+      m_local_hashes.rbegin()->first
+    )
+  };
+  m_remote_hashes.erase(std::begin(m_remote_hashes), m_remote_hashes.upper_bound(last_frame));
+  m_local_hashes.erase(std::begin(m_local_hashes), m_local_hashes.upper_bound(last_frame));
+}
+
+std::vector<message> rollback_session::collect_messages()
+{
+  std::vector<message> messages;
+  std::swap(messages, m_messages);
+  return messages;
+}
+
+void rollback_session::do_frame()
+{
+  const trace_scope scope("rollback_session::do_frame");
+  m_snapshots[m_frame % m_snapshots.size()] = m_game_controller;
+  do_lockstep_frame(m_game_controller, get_frame_inputs(m_frame), m_n_steps_per_frame, m_delta_t);
+  const std::vector<message> messages{::collect_messages(m_game_controller.get_game())};
+  std::copy(std::begin(messages), std::end(messages), std::back_inserter(m_messages));
+  clear_piece_messages(m_game_controller.get_game());
+  ++m_frame;
+}
+
+user_inputs rollback_session::get_frame_inputs(const int frame) const
+{
+  user_inputs inputs;
+  for (const side s: get_all_sides())
+  {
+    if (s == m_local_side)
+    {
+      add(inputs, m_local_inputs.at(frame));
+      continue;
+    }
+    // The peer's user inputs that have not arrived yet
+    // are predicted to be none
+    const auto there{m_remote_inputs.find(frame)};
+    if (there != std::end(m_remote_inputs)) add(inputs, there->second);
+  }
+  return inputs;
+}
+
+void rollback_session::process_message(const lockstep_message& m)
+{
+  // The peer's user inputs
+  const int n_frames{static_cast<int>(m.get_inputs().size())};
+  for (int i{0}; i != n_frames; ++i)
+  {
+    const int frame{m.get_first_frame() + i};
+    if (frame < m_n_remote_frames) continue; // Already received
+    const bool is_new{m_remote_inputs.emplace(frame, m.get_inputs()[i]).second};
+
+    // A frame already done was predicted to have no user inputs
+    if (is_new && frame < m_frame && !is_empty(m.get_inputs()[i]))
+    {
+      m_rollback_frame = std::min(m_rollback_frame.value_or(frame), frame);
+    }
+  }
+  while (m_remote_inputs.count(m_n_remote_frames))
+  {
+    ++m_n_remote_frames;
+  }
+
+  // The peer has received the local user inputs up to this frame
+  m_remote_ack_frame = std::max(m_remote_ack_frame, m.get_ack_frame());
+
+  // The hash of the peer's game
+  if (m.get_hash_frame() >= 0)
+  {
+    m_remote_hashes[m.get_hash_frame()] = m.get_hash();
+  }
+}
+
+void rollback_session::receive()
+{
+  std::vector<std::uint8_t> bytes;
+  while (m_transport.receive(bytes))
+  {
+    const auto m{to_lockstep_message(bytes, get_other_side(m_local_side))};
+    if (!m) continue;
+    process_message(m.value());
+  }
+}
+
+void rollback_session::roll_back()
+{
+  if (!m_rollback_frame) return;
+  const trace_scope scope("rollback_session::roll_back");
+  const int first_frame{m_rollback_frame.value()};
+  m_rollback_frame.reset();
+  const int n_snapshots{static_cast<int>(m_snapshots.size())};
+  assert(first_frame < m_frame);
+  assert(first_frame > m_frame - n_snapshots);
+
+  const auto start{std::chrono::steady_clock::now()};
+  m_game_controller = m_snapshots[first_frame % n_snapshots];
+  for (int frame{first_frame}; frame != m_frame; ++frame)
+  {
+    m_snapshots[frame % n_snapshots] = m_game_controller;
+    do_lockstep_frame(m_game_controller, get_frame_inputs(frame), m_n_steps_per_frame, m_delta_t);
+    // The sounds of these frames have already been played
+    clear_piece_messages(m_game_controller.get_game());
+  }
+  const std::chrono::duration<double> duration{
+    std::chrono::steady_clock::now() - start
+  };
+
+  const int n_frames{m_frame - first_frame};
+  ++m_n_rollbacks;
+  m_n_rollback_frames += n_frames;
+  m_n_resimulation_secs += duration.count();
+
+  static metric_counter& n_rollback_frames{
+    get_metrics().get_counter("rollback_frames")
+  };
+  n_rollback_frames.add(n_frames);
+  static metric_histogram& resimulation_ms{
+    get_metrics().get_histogram("rollback_resimulation_ms")
+  };
+  resimulation_ms.add(duration.count() * 1000.0);
+}
+
+void rollback_session::schedule_local_inputs()
+{
+  while (m_last_scheduled_frame < m_frame + m_input_delay)
+  {
+    ++m_last_scheduled_frame;
+    m_local_inputs[m_last_scheduled_frame] = m_pending_inputs;
+    m_pending_inputs = user_inputs();
+  }
+}
+
+void rollback_session::send()
+{
+  const int first_frame{m_remote_ack_frame + 1};
+  const int n_frames{
+    std::min(
+      m_last_scheduled_frame - first_frame + 1,
+      get_lockstep_message_max_n_frames()
+    )
+  };
+  std::vector<user_inputs> inputs;
+  for (int i{0}; i < n_frames; ++i)
+  {
+    inputs.push_back(m_local_inputs.at(first_frame + i));
+  }
+  const bool is_hash_sent{
+    m_last_hash_frame >= 0
+    && m_n_ticks - m_last_hash_tick <= get_lockstep_n_hash_resend_frames()
+  };
+  const lockstep_message m(
+    first_frame,
+    inputs,
+    m_n_remote_frames - 1,
+    is_hash_sent ? m_last_hash_frame : -1,
+    m_last_hash
+  );
+  m_transport.send(to_bytes(m));
+}
+
+void rollback_session::synchronize()
+{
+  ++m_n_ticks;
+  receive();
+  roll_back();
+  calc_hashes();
+
+  // The user inputs of the frames that are certain
+  // are not needed anymore, except the local ones
+  // the peer may not have received yet
+  const int n_certain_frames{std::min(m_frame, m_n_remote_frames)};
+  m_remote_inputs.erase(
+    std::begin(m_remote_inputs),
+    m_remote_inputs.lower_bound(n_certain_frames)
+  );
+  m_local_inputs.erase(
+    std::begin(m_local_inputs),
+    m_local_inputs.lower_bound(std::min(n_certain_frames, m_remote_ack_frame + 1))
+  );
+
+  schedule_local_inputs();
+  send();
+}
+
+bool rollback_session::tick()
+{
+  const trace_scope scope("rollback_session::tick");
+  synchronize();
+  if (m_frame - m_n_remote_frames >= m_max_rollback_frames)
+  {
+    ++m_n_stalls;
+    static metric_counter& n_stalls{
+      get_metrics().get_counter("rollback_stalls")
+    };
+    n_stalls.add();
+    return false;
+  }
+  do_frame();
+  return true;
+}
+
+rollback_loopback_result::rollback_loopback_result(
+  const int n_frames,
+  const int n_stalls,
+  const int n_rollbacks,
+  const int n_rollback_frames,
+  const double n_resimulation_secs,
+  const double n_secs,
+  const bool is_desync
+) : m_n_frames{n_frames},
+    m_n_stalls{n_stalls},
+    m_n_rollbacks{n_rollbacks},
+    m_n_rollback_frames{n_rollback_frames},
+    m_n_resimulation_secs{n_resimulation_secs},
+    m_n_secs{n_secs},
+    m_is_desync{is_desync}
+{
+  assert(m_n_frames >= 0);
+  assert(m_n_stalls >= 0);
+  assert(m_n_rollbacks >= 0);
+  assert(m_n_rollback_frames >= 0);
+  assert(m_n_resimulation_secs >= 0.0);
+  assert(m_n_secs >= 0.0);
+}
+
+double rollback_loopback_result::get_n_rollback_frames_per_second() const noexcept
+{
+  if (m_n_secs == 0.0) return 0.0;
+  // Both players roll back
+  return static_cast<double>(m_n_rollback_frames) / 2.0 / m_n_secs;
+}
+
+double rollback_loopback_result::get_resimulation_ms_per_frame() const noexcept
+{
+  if (m_n_rollback_frames == 0) return 0.0;
+  return m_n_resimulation_secs * 1000.0 / static_cast<double>(m_n_rollback_frames);
+}
+
+rollback_loopback_result run_rollback_loopback(
+  const int n_frames,
+  const int latency,
+  const double packet_loss,
+  const int input_delay,
+  const int n_steps_per_frame,
+  const int seed
+)
+{
+  const auto [transport_lhs, transport_rhs]{create_loopback_transports()};
+  for (auto t: { transport_lhs.get(), transport_rhs.get() })
+  {
+    t->set_latency(latency);
+    t->set_packet_loss(packet_loss);
+  }
+  const game_controller c;
+  rollback_session lhs(c, side::lhs, *transport_lhs, input_delay, get_default_rollback_max_frames(), get_default_lockstep_hash_interval(), n_steps_per_frame);
+  rollback_session rhs(c, side::rhs, *transport_rhs, input_delay, get_default_rollback_max_frames(), get_default_lockstep_hash_interval(), n_steps_per_frame);
+
+  std::default_random_engine rng_engine(seed);
+  std::uniform_int_distribution<int> n_inputs_distribution(0, 3);
+  while (lhs.get_frame() < n_frames || rhs.get_frame() < n_frames)
+  {
+    for (auto s: { &lhs, &rhs })
+    {
+      if (s->get_frame() >= n_frames) continue;
+      // A player does a user input in one out of four frames
+      if (n_inputs_distribution(rng_engine) == 0)
+      {
+        const user_input i{create_useful_random_user_input(rng_engine)};
+        s->add_local_inputs(
+          user_inputs( { user_input(i.get_user_input_type(), s->get_local_side(), i.get_coordinat()) } )
+        );
+      }
+      s->tick();
+      s->collect_messages();
+    }
+    transport_lhs->tick();
+    transport_rhs->tick();
+  }
+  // Wait for the last user inputs of the peers to arrive
+  for (int i{0}; i != 1000 && !(lhs.is_confirmed() && rhs.is_confirmed()); ++i)
+  {
+    lhs.synchronize();
+    rhs.synchronize();
+    transport_lhs->tick();
+    transport_rhs->tick();
+  }
+  const double n_secs{
+    n_frames * n_steps_per_frame / get_default_simulation_frequency()
+  };
+  return rollback_loopback_result(
+    lhs.get_frame() + rhs.get_frame(),
+    lhs.get_n_stalls() + rhs.get_n_stalls(),
+    lhs.get_n_rollbacks() + rhs.get_n_rollbacks(),
+    lhs.get_n_rollback_frames() + rhs.get_n_rollback_frames(),
+    lhs.get_n_resimulation_secs() + rhs.get_n_resimulation_secs(),
+    n_secs,
+    // Both games did the same frames with the same user inputs,
+    // so these must be the same
+    !lhs.is_confirmed()
+      || !rhs.is_confirmed()
+      || lhs.get_desync_frame().has_value()
+      || rhs.get_desync_frame().has_value()
+      || calc_hash(lhs.get_game_controller()) != calc_hash(rhs.get_game_controller())
+  );
+}
+
+void test_rollback_session()
+{
+#ifndef NDEBUG
+  // A new session has done no frames
+  {
+    const auto [a, b]{create_loopback_transports()};
+    const rollback_session s(game_controller(), side::lhs, *a);
+    assert(s.get_frame() == 0);
+    assert(s.get_n_rollbacks() == 0);
+    assert(s.get_n_stalls() == 0);
+    assert(!s.get_desync_frame());
+    assert(s.get_input_delay() == get_default_rollback_input_delay());
+    assert(s.get_max_rollback_frames() == get_default_rollback_max_frames());
+    assert(s.is_confirmed());
+  }
+  // A local user input is done at once, without waiting for the peer
+  {
+    const auto [a, b]{create_loopback_transports()};
+    rollback_session s(game_controller(), side::lhs, *a, 0, 8, 30, 1);
+    const auto cursor_before{get_cursor_pos(s.get_game_controller(), side::lhs)};
+    s.add_local_inputs(user_inputs( { create_press_up_action(side::lhs) } ));
+    assert(s.tick());
+    assert(s.get_frame() == 1);
+    assert(get_cursor_pos(s.get_game_controller(), side::lhs) != cursor_before);
+    assert(!s.is_confirmed());
+  }
+  // A session without a peer stalls after the maximum rollback
+  {
+    const auto [a, b]{create_loopback_transports()};
+    rollback_session s(game_controller(), side::lhs, *a, 0, 2, 30, 1);
+    assert(s.tick());
+    assert(s.tick());
+    assert(!s.tick());
+    assert(s.get_frame() == 2);
+    assert(s.get_n_stalls() == 1);
+  }
+  // A late user input of the peer is done by going back in time
+  {
+    const auto [a, b]{create_loopback_transports()};
+    a->set_latency(2);
+    b->set_latency(2);
+    rollback_session lhs(game_controller(), side::lhs, *a, 0, 8, 30, 1);
+    rollback_session rhs(game_controller(), side::rhs, *b, 0, 8, 30, 1);
+    const auto cursor_before{get_cursor_pos(lhs.get_game_controller(), side::rhs)};
+    rhs.add_local_inputs(user_inputs( { create_press_up_action(side::rhs) } ));
+    for (int i{0}; i != 4; ++i)
+    {
+      lhs.tick();
+      rhs.tick();
+      a->tick();
+      b->tick();
+    }
+    assert(lhs.get_frame() == 4);
+    assert(lhs.get_n_rollbacks() == 1);
+    assert(lhs.get_n_rollback_frames() > 0);
+    assert(rhs.get_n_rollbacks() == 0);
+    assert(get_cursor_pos(lhs.get_game_controller(), side::rhs) != cursor_before);
+    for (int i{0}; i != 4; ++i)
+    {
+      lhs.synchronize();
+      rhs.synchronize();
+      a->tick();
+      b->tick();
+    }
+    assert(lhs.is_confirmed());
+    assert(rhs.is_confirmed());
+    assert(calc_hash(lhs.get_game_controller()) == calc_hash(rhs.get_game_controller()));
+  }
+  // Different games are detected as a desync
+  {
+    const auto [a, b]{create_loopback_transports()};
+    rollback_session lhs(game_controller(), side::lhs, *a, 0, 8, 2, 1);
+    rollback_session rhs(game_controller(game(get_pieces_kings_only())), side::rhs, *b, 0, 8, 2, 1);
+    for (int i{0}; i != 4; ++i)
+    {
+      lhs.tick();
+      rhs.tick();
+    }
+    assert(lhs.get_desync_frame().has_value());
+    assert(rhs.get_desync_frame().has_value());
+  }
+#endif // NDEBUG
+}
+
+void test_rollback_session_long()
+{
+#ifndef NDEBUG
+  // Two games with random user inputs stay the same,
+  // even if messages are late and lost
+  {
+    const auto result{run_rollback_loopback(30, 3, 0.2, 0, 1)};
+    assert(result.get_n_frames() == 60);
+    assert(!result.is_desync());
+    assert(result.get_n_rollbacks() > 0);
+    assert(result.get_n_rollback_frames_per_second() > 0.0);
+    assert(result.get_resimulation_ms_per_frame() > 0.0);
+  }
+#endif // NDEBUG
+}
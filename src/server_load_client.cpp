@@ -0,0 +1,230 @@
+#include "server_load_client.h"
+
+#include "lockstep_message.h"
+#include "match_server.h"
+#include "user_input.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iterator>
+#include <memory>
+
+server_load_client::server_load_client(
+  net_transport& transport,
+  const side player,
+  const double input_chance,
+  const int seed
+) : m_input_chance{input_chance},
+    m_player{player},
+    m_rng_engine(seed),
+    m_transport{transport}
+{
+  assert(m_input_chance >= 0.0);
+  assert(m_input_chance <= 1.0);
+}
+
+void server_load_client::receive()
+{
+  std::vector<std::uint8_t> bytes;
+  while (m_transport.receive(bytes))
+  {
+    const auto m{to_lockstep_message(bytes, get_other_side(m_player))};
+    if (!m) continue;
+    const int n_acknowledged{m.value().get_ack_frame() + 1};
+    if (n_acknowledged <= m_n_acknowledged) continue;
+    const int n_new{
+      std::min(
+        n_acknowledged - m_n_acknowledged,
+        static_cast<int>(m_unacknowledged.size())
+      )
+    };
+    m_unacknowledged.erase(
+      std::begin(m_unacknowledged),
+      std::begin(m_unacknowledged) + n_new
+    );
+    m_n_acknowledged += n_new;
+  }
+}
+
+void server_load_client::tick()
+{
+  receive();
+  std::uniform_real_distribution<double> distribution(0.0, 1.0);
+  if (distribution(m_rng_engine) < m_input_chance)
+  {
+    const user_input i{create_useful_random_user_input(m_rng_engine)};
+    m_unacknowledged.push_back(
+      user_inputs( { user_input(i.get_user_input_type(), m_player, i.get_coordinat()) } )
+    );
+    ++m_n_user_inputs;
+  }
+  if (m_unacknowledged.empty()) return;
+  const int n_frames{
+    std::min(
+      static_cast<int>(m_unacknowledged.size()),
+      get_lockstep_message_max_n_frames()
+    )
+  };
+  m_transport.send(
+    to_bytes(
+      lockstep_message(
+        m_n_acknowledged,
+        std::vector<user_inputs>(
+          std::begin(m_unacknowledged),
+          std::begin(m_unacknowledged) + n_frames
+        )
+      )
+    )
+  );
+}
+
+server_soak_result::server_soak_result(
+  const int n_matches,
+  const int n_threads,
+  const int n_frames,
+  const int n_late_ticks,
+  const int n_user_inputs,
+  const double n_secs,
+  const double n_cpu_secs,
+  const double max_match_cpu_secs
+) : m_n_matches{n_matches},
+    m_n_threads{n_threads},
+    m_n_frames{n_frames},
+    m_n_late_ticks{n_late_ticks},
+    m_n_user_inputs{n_user_inputs},
+    m_n_secs{n_secs},
+    m_n_cpu_secs{n_cpu_secs},
+    m_max_match_cpu_secs{max_match_cpu_secs}
+{
+  assert(m_n_matches >= 0);
+  assert(m_n_threads > 0);
+  assert(m_n_frames >= 0);
+  assert(m_n_late_ticks >= 0);
+  assert(m_n_user_inputs >= 0);
+  assert(m_n_secs >= 0.0);
+  assert(m_n_cpu_secs >= 0.0);
+  assert(m_max_match_cpu_secs >= 0.0);
+}
+
+double server_soak_result::get_frames_per_second() const noexcept
+{
+  if (m_n_secs == 0.0) return 0.0;
+  return static_cast<double>(m_n_frames) / m_n_secs;
+}
+
+double server_soak_result::get_match_frame_ms() const noexcept
+{
+  if (m_n_frames == 0) return 0.0;
+  return m_n_cpu_secs * 1000.0 / static_cast<double>(m_n_frames);
+}
+
+server_soak_result run_server_soak(
+  const int n_matches,
+  const int n_frames,
+  const int n_threads,
+  const bool is_real_time,
+  const std::string& replay_folder
+)
+{
+  match_server server(n_threads, replay_folder);
+
+  // The client ends of the transports
+  std::vector<std::unique_ptr<loopback_transport>> transports;
+  std::vector<server_load_client> clients;
+  transports.reserve(2 * n_matches);
+  clients.reserve(2 * n_matches);
+  for (int i{0}; i != n_matches; ++i)
+  {
+    auto [client_lhs, server_lhs]{create_loopback_transports()};
+    auto [client_rhs, server_rhs]{create_loopback_transports()};
+    server.add_match(std::move(server_lhs), std::move(server_rhs), game_controller(), n_frames);
+    clients.emplace_back(*client_lhs, side::lhs, 0.25, 2 * i);
+    clients.emplace_back(*client_rhs, side::rhs, 0.25, (2 * i) + 1);
+    transports.push_back(std::move(client_lhs));
+    transports.push_back(std::move(client_rhs));
+  }
+
+  const auto start{std::chrono::steady_clock::now()};
+  for (int i{0}; i != n_frames && !server.get_matches().empty(); ++i)
+  {
+    for (auto& c: clients) c.tick();
+    if (is_real_time)
+    {
+      server.run(1);
+    }
+    else
+    {
+      server.tick();
+    }
+  }
+  const std::chrono::duration<double> duration{
+    std::chrono::steady_clock::now() - start
+  };
+
+  int n_user_inputs{0};
+  for (const auto& c: clients) n_user_inputs += c.get_n_acknowledged();
+  return server_soak_result(
+    n_matches,
+    server.get_thread_pool().get_n_threads(),
+    server.get_n_frames(),
+    server.get_n_late_ticks(),
+    n_user_inputs,
+    duration.count(),
+    server.get_total_cpu_secs(),
+    server.get_max_match_cpu_secs()
+  );
+}
+
+void test_server_load_client()
+{
+#ifndef NDEBUG
+  // A new client has done nothing
+  {
+    const auto [a, b]{create_loopback_transports()};
+    const server_load_client c(*a, side::lhs);
+    assert(c.get_n_user_inputs() == 0);
+    assert(c.get_n_acknowledged() == 0);
+    assert(c.get_player() == side::lhs);
+  }
+  // A client without user inputs sends nothing
+  {
+    const auto [a, b]{create_loopback_transports()};
+    server_load_client c(*a, side::lhs, 0.0);
+    c.tick();
+    assert(a->get_n_packets_sent() == 0);
+  }
+  // A client sends its user inputs until these are acknowledged
+  {
+    const auto [a, b]{create_loopback_transports()};
+    server_load_client c(*a, side::lhs, 1.0);
+    c.tick();
+    c.tick();
+    assert(c.get_n_user_inputs() == 2);
+    assert(a->get_n_packets_sent() == 2);
+    b->send(to_bytes(lockstep_message(0, {}, 1)));
+    c.tick();
+    assert(c.get_n_acknowledged() == 2);
+    // Only the newest user input is sent
+    std::vector<std::uint8_t> bytes;
+    while (b->receive(bytes)) {}
+    assert(to_lockstep_message(bytes, side::lhs).value().get_first_frame() == 2);
+    assert(to_lockstep_message(bytes, side::lhs).value().get_inputs().size() == 1);
+  }
+#endif // NDEBUG
+}
+
+void test_server_load_client_long()
+{
+#ifndef NDEBUG
+  // All user inputs of the clients arrive at the server
+  {
+    const auto result{run_server_soak(2, 4, 2)};
+    assert(result.get_n_matches() == 2);
+    assert(result.get_n_frames() == 8);
+    assert(result.get_n_user_inputs() > 0);
+    assert(result.get_match_frame_ms() > 0.0);
+    assert(result.get_frames_per_second() > 0.0);
+  }
+#endif // NDEBUG
+}
@@ -0,0 +1,141 @@
+#include "server_match.h"
+
+#include "pieces.h"
+#include "trace.h"
+#include "user_input.h"
+
+#include <cassert>
+#include <chrono>
+
+server_match::server_match(
+  const int id,
+  std::unique_ptr<net_transport> transport_lhs,
+  std::unique_ptr<net_transport> transport_rhs,
+  const game_controller& c,
+  const int max_n_frames,
+  const int n_steps_per_frame,
+  const game_speed speed,
+  const double steps_per_second
+) : m_delta_t{get_speed_multiplier(speed) / steps_per_second},
+    m_game_controller{c},
+    m_id{id},
+    m_max_n_frames{max_n_frames},
+    m_n_steps_per_frame{n_steps_per_frame},
+    m_replay(m_delta_t, n_steps_per_frame)
+{
+  assert(m_max_n_frames > 0);
+  assert(m_n_steps_per_frame > 0);
+  m_transports[side::lhs] = std::move(transport_lhs);
+  m_transports[side::rhs] = std::move(transport_rhs);
+  for (const side s: get_all_sides()) m_n_received_frames[s] = 0;
+}
+
+bool server_match::is_done() const noexcept
+{
+  return m_frame >= m_max_n_frames
+    || m_game_controller.get_game().get_winner().has_value()
+  ;
+}
+
+void server_match::receive(const side s, user_inputs& inputs)
+{
+  net_transport* const transport{m_transports[s].get()};
+  if (!transport) return;
+  std::vector<std::uint8_t> bytes;
+  while (transport->receive(bytes))
+  {
+    const auto m{to_lockstep_message(bytes, s)};
+    if (!m) continue;
+    const int n_frames{static_cast<int>(m.value().get_inputs().size())};
+    for (int i{0}; i != n_frames; ++i)
+    {
+      // Only the next frame of the client is new,
+      // as the client sends its frames in order
+      const int frame{m.value().get_first_frame() + i};
+      if (frame != m_n_received_frames[s]) continue;
+      const auto& frame_inputs{m.value().get_inputs()[i]};
+      add(inputs, frame_inputs);
+      m_n_user_inputs += count_user_inputs(frame_inputs);
+      ++m_n_received_frames[s];
+    }
+  }
+}
+
+void server_match::tick()
+{
+  const trace_scope scope("server_match::tick");
+  assert(!is_done());
+  const auto start{std::chrono::steady_clock::now()};
+
+  // The same order every frame, so that the replay gives the same game
+  user_inputs inputs;
+  for (const side s: get_all_sides()) receive(s, inputs);
+
+  m_replay.add_frame(inputs);
+  do_lockstep_frame(m_game_controller, inputs, m_n_steps_per_frame, m_delta_t);
+  // There is no one to hear the sounds
+  clear_piece_messages(m_game_controller.get_game());
+  ++m_frame;
+
+  for (const side s: get_all_sides())
+  {
+    net_transport* const transport{m_transports[s].get()};
+    if (!transport) continue;
+    transport->send(to_bytes(lockstep_message(0, {}, m_n_received_frames[s] - 1)));
+  }
+
+  const std::chrono::duration<double> duration{
+    std::chrono::steady_clock::now() - start
+  };
+  m_cpu_secs += duration.count();
+}
+
+void test_server_match()
+{
+#ifndef NDEBUG
+  // A new match has done no frames
+  {
+    const server_match m(1, nullptr, nullptr);
+    assert(m.get_id() == 1);
+    assert(m.get_frame() == 0);
+    assert(m.get_cpu_secs() == 0.0);
+    assert(!m.is_done());
+  }
+  // A match is done after the maximum number of frames
+  {
+    server_match m(1, nullptr, nullptr, game_controller(), 2, 1);
+    m.tick();
+    assert(!m.is_done());
+    m.tick();
+    assert(m.is_done());
+    assert(m.get_replay().get_n_frames() == 2);
+    assert(m.get_cpu_secs() > 0.0);
+  }
+  // The user inputs of a client are done and acknowledged
+  {
+    auto [client, server]{create_loopback_transports()};
+    server_match m(1, std::move(server), nullptr, game_controller(), 100, 1);
+    const auto cursor_before{get_cursor_pos(m.get_game_controller(), side::lhs)};
+    // The client sends its first user inputs, then sends these again,
+    // as these have not been acknowledged yet.
+    // The side is the one of the client's transport
+    const auto bytes{
+      to_bytes(lockstep_message(0, { user_inputs( { create_press_up_action(side::rhs) } ) } ))
+    };
+    client->send(bytes);
+    client->send(bytes);
+    m.tick();
+    assert(m.get_n_user_inputs() == 1);
+    assert(get_cursor_pos(m.get_game_controller(), side::lhs) != cursor_before);
+    std::vector<std::uint8_t> reply;
+    assert(client->receive(reply));
+    assert(to_lockstep_message(reply, side::lhs).value().get_ack_frame() == 0);
+    // The replay has the user inputs
+    assert(m.get_replay().get_frames().size() == 1);
+    assert(
+      calc_hash(play_input_replay(m.get_replay()))
+      == calc_hash(m.get_game_controller())
+    );
+  }
+#endif // NDEBUG
+}
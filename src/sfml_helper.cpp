@@ -23,6 +23,7 @@ std::string button_str_to_resource_name(std::string button_str)
   return std::string("mouse_") + button_str;
 }
 
+#ifndef LOGIC_ONLY
 sf::Color f_health_to_color(const double f)
 {
   assert(f >= 0.0);
@@ -42,6 +43,7 @@ sf::Color f_shield_to_color(const double f)
   if (f < 0.75) return sf::Color(0, 0, 254);
   return sf::Color(0, 0, 255);
 }
+#endif // LOGIC_ONLY
 
 std::vector<sf::Mouse::Button> get_all_sfml_buttons() noexcept
 {
@@ -122,6 +124,7 @@ std::string key_str_to_resource_name(std::string key_str)
   return std::string("keyboard_") + key_str;
 }
 
+#ifndef LOGIC_ONLY
 void set_rect(sf::RectangleShape& rectangle, const screen_coordinate& screen_size)
 {
   set_rect(
@@ -173,11 +176,13 @@ void set_text_position(sf::Text& text, const screen_rect& screen_rect)
   );
 
 }
+#endif // LOGIC_ONLY
 
 void test_sfml_helper()
 {
 #ifndef NDEBUG
 
+  #ifndef LOGIC_ONLY
   // f_health_to_color
   {
     const sf::Color lowest{f_health_to_color(1.0 * 0.125)};
@@ -204,6 +209,7 @@ void test_sfml_helper()
     assert(low != high);
     assert(mid != high);
   }
+  #endif // LOGIC_ONLY
 
   // get_all_sfml_buttons
   {
@@ -240,6 +246,7 @@ void test_sfml_helper()
     assert(key_str_to_resource_name("RSystem") == "keyboard_win");
   }
 
+  #ifndef LOGIC_ONLY
   // set_rect, on screen_rect
   {
     sf::RectangleShape r;
@@ -266,6 +273,7 @@ void test_sfml_helper()
     set_text_position(t, screen_size);
     assert(!t.getString().isEmpty()); // Does not test set_text_poistion at all
   }
+  #endif // LOGIC_ONLY
 
   // to_resource_name, for keys
   {
@@ -446,6 +454,7 @@ void test_sfml_helper()
     assert(to_str(sf::Keyboard::Key::Z) == "Z");
   }
 
+  #ifndef LOGIC_ONLY
   // to_sfml_color
   {
     const sf::Color b{to_sfml_color(chess_color::black)};
@@ -475,6 +484,7 @@ void test_sfml_helper()
       }
     }
   }
+  #endif // LOGIC_ONLY
 
   // 62: to_one_char_str
   {
@@ -564,6 +574,7 @@ std::string to_one_char_str(const sf::Keyboard::Key k)
   }
 }
 
+#ifndef LOGIC_ONLY
 sf::Color to_sfml_color(const chess_color color) noexcept
 {
   if (color == chess_color::white) return sf::Color::White;
@@ -615,6 +626,7 @@ sf::Color to_sfml_color(
   );
   return sf::Color(128 - 0, 128 - 64, 128 - 64);
 }
+#endif // LOGIC_ONLY
 
 std::string to_inverted_resource_name(const sf::Keyboard::Key k)
 {
@@ -1,243 +1,300 @@
 #include "sound_effects.h"
 
+#include "asset_cache.h"
 #include "volume.h"
 
+#include <algorithm>
 #include <cassert>
 #include <functional>
+#include <iterator>
 
 #ifndef LOGIC_ONLY
 
 sound_effects::sound_effects()
+  : m_voices(m_voice_pool.get_n_voices())
 {
-  const std::vector<std::tuple<std::reference_wrapper<sf::Sound>, std::reference_wrapper<sf::SoundBuffer>, std::string>> v = get_table();
-
-  for (const auto& p: v)
+  for (const auto& p: get_table())
   {
     const auto filename{
       std::string("resources/sound_effects/")
-      + std::get<2>(p).c_str()
+      + p.second.c_str()
     };
-    if (!std::get<1>(p).get().loadFromFile(filename))
+    if (!load_from_file(p.first.get(), filename))
     {
       auto msg{"Cannot find sound file '" + filename + "'"};
       throw std::runtime_error(msg);
     }
-    // Connect sound with its buffer
-    std::get<0>(p).get().setBuffer(std::get<1>(p).get());
-
+    m_buffers.push_back(std::cref(p.first.get()));
   }
-}
 
-std::vector<std::tuple<std::reference_wrapper<sf::Sound>, std::reference_wrapper<sf::SoundBuffer>, std::string>> sound_effects::get_table() noexcept
-{
-  const std::vector<std::tuple<std::reference_wrapper<sf::Sound>, std::reference_wrapper<sf::SoundBuffer>, std::string>> v = {
-    std::make_tuple(std::ref(m_attacking_high), std::ref(m_attacking_high_buffer), "attacking_high.ogg"),
-    std::make_tuple(std::ref(m_attacking_low), std::ref(m_attacking_low_buffer), "attacking_low.ogg"),
-    std::make_tuple(std::ref(m_attacking_mid), std::ref(m_attacking_mid_buffer), "attacking_mid.ogg"),
-    std::make_tuple(std::ref(m_bark_1), std::ref(m_bark_1_buffer), "bark_1.ogg"),
-    std::make_tuple(std::ref(m_bark_2), std::ref(m_bark_2_buffer), "bark_2.ogg"),
-    std::make_tuple(std::ref(m_countdown), std::ref(m_countdown_buffer), "countdown.ogg"),
-    std::make_tuple(std::ref(m_done_high), std::ref(m_done_high_buffer), "done_high.ogg"),
-    std::make_tuple(std::ref(m_done_low), std::ref(m_done_low_buffer), "done_low.ogg"),
-    std::make_tuple(std::ref(m_done_mid), std::ref(m_done_mid_buffer), "done_mid.ogg"),
-    std::make_tuple(std::ref(m_faring_into_battle), std::ref(m_faring_into_battle_buffer), "faring_into_battle.ogg"),
-    std::make_tuple(std::ref(m_heu_high), std::ref(m_heu_high_buffer), "heu_high.ogg"),
-    std::make_tuple(std::ref(m_heu_low), std::ref(m_heu_low_buffer), "heu_low.ogg"),
-    std::make_tuple(std::ref(m_heu_mid), std::ref(m_heu_mid_buffer), "heu_mid.ogg"),
-    std::make_tuple(std::ref(m_hide), std::ref(m_hide_buffer), "hide.ogg"),
-    std::make_tuple(std::ref(m_hmm_high), std::ref(m_hmm_high_buffer), "hmm_high.ogg"),
-    std::make_tuple(std::ref(m_hmm_low), std::ref(m_hmm_low_buffer), "hmm_low.ogg"),
-    std::make_tuple(std::ref(m_hmm_mid), std::ref(m_hmm_mid_buffer), "hmm_mid.ogg"),
-    std::make_tuple(std::ref(m_i_cannot_high), std::ref(m_i_cannot_high_buffer), "i_cannot_high.ogg"),
-    std::make_tuple(std::ref(m_i_cannot_low), std::ref(m_i_cannot_low_buffer), "i_cannot_low.ogg"),
-    std::make_tuple(std::ref(m_i_cannot_mid), std::ref(m_i_cannot_mid_buffer), "i_cannot_mid.ogg"),
-    std::make_tuple(std::ref(m_i_cant_high), std::ref(m_i_cant_high_buffer), "i_cant_high.ogg"),
-    std::make_tuple(std::ref(m_i_cant_low), std::ref(m_i_cant_low_buffer), "i_cant_low.ogg"),
-    std::make_tuple(std::ref(m_i_cant_mid), std::ref(m_i_cant_mid_buffer), "i_cant_mid.ogg"),
-    std::make_tuple(std::ref(m_its_time_to_rock), std::ref(m_its_time_to_rock_buffer), "its_time_to_rock.ogg"),
-    std::make_tuple(std::ref(m_jumping_into_battle), std::ref(m_jumping_into_battle_buffer), "jumping_into_battle.ogg"),
-    std::make_tuple(std::ref(m_lets_rule), std::ref(m_lets_rule_buffer), "lets_rule.ogg"),
-    std::make_tuple(std::ref(m_moving_forward), std::ref(m_moving_forward_buffer), "moving_forward.ogg"),
-    std::make_tuple(std::ref(m_no_high), std::ref(m_no_high_buffer), "no_high.ogg"),
-    std::make_tuple(std::ref(m_no_low), std::ref(m_no_low_buffer), "no_low.ogg"),
-    std::make_tuple(std::ref(m_no_mid), std::ref(m_no_mid_buffer), "no_mid.ogg"),
-    std::make_tuple(std::ref(m_nope_high), std::ref(m_nope_high_buffer), "nope_high.ogg"),
-    std::make_tuple(std::ref(m_nope_low), std::ref(m_nope_low_buffer), "nope_low.ogg"),
-    std::make_tuple(std::ref(m_nope_mid), std::ref(m_nope_mid_buffer), "nope_mid.ogg"),
-    std::make_tuple(std::ref(m_to_rule_is_to_act), std::ref(m_to_rule_is_to_act_buffer), "to_rule_is_to_act.ogg"),
-    std::make_tuple(std::ref(m_yes_high), std::ref(m_yes_high_buffer), "yes_high.ogg"),
-    std::make_tuple(std::ref(m_yes_low), std::ref(m_yes_low_buffer), "yes_low.ogg"),
-    std::make_tuple(std::ref(m_yes_mid), std::ref(m_yes_mid_buffer), "yes_mid.ogg"),
-  };
-  return v;
+  // Look up the sound of each message once
+  for (const auto t: get_all_message_types())
+  {
+    for (const auto p: get_all_piece_types())
+    {
+      const sf::SoundBuffer * const buffer{get_buffer(t, p)};
+      if (buffer)
+      {
+        m_message_sound_indices[t][p] = get_sound_index(*buffer);
+      }
+    }
+  }
 }
 
-void sound_effects::play(const message& effect)
+const sf::SoundBuffer * sound_effects::get_buffer(
+  const message_type t,
+  const piece_type piece_type
+) const noexcept
 {
-  const auto piece_type{effect.get_piece_type()};
-  switch (effect.get_message_type())
+  switch (t)
   {
     case message_type::cannot:
     {
       switch (piece_type)
       {
-        case piece_type::bishop: m_i_cant_high.play(); break;
-        case piece_type::king: m_i_cannot_mid.play(); break;
-        case piece_type::knight: m_i_cant_mid.play(); break;
-        case piece_type::pawn: m_nope_mid.play(); break;
-        case piece_type::queen: m_i_cannot_high.play(); break;
+        case piece_type::bishop: return &m_i_cant_high_buffer;
+        case piece_type::king: return &m_i_cannot_mid_buffer;
+        case piece_type::knight: return &m_i_cant_mid_buffer;
+        case piece_type::pawn: return &m_nope_mid_buffer;
+        case piece_type::queen: return &m_i_cannot_high_buffer;
         default:
         case piece_type::rook:
           assert(piece_type == piece_type::rook);
-          m_nope_low.play();
-          break;
+          return &m_nope_low_buffer;
       }
-      break;
     }
     case message_type::done:
     {
       switch (piece_type)
       {
-        case piece_type::bishop: m_done_high.play(); break;
-        case piece_type::king: m_done_mid.play(); break;
-        case piece_type::knight: m_done_mid.play(); break;
-        case piece_type::pawn: m_done_mid.play(); break;
-        case piece_type::queen: m_done_high.play(); break;
+        case piece_type::bishop: return &m_done_high_buffer;
+        case piece_type::king: return &m_done_mid_buffer;
+        case piece_type::knight: return &m_done_mid_buffer;
+        case piece_type::pawn: return &m_done_mid_buffer;
+        case piece_type::queen: return &m_done_high_buffer;
         default:
         case piece_type::rook:
           assert(piece_type == piece_type::rook);
-          m_done_low.play();
-          break;
+          return &m_done_low_buffer;
       }
-      break;
     }
     case message_type::unselect:
-      m_hide.play();
-      break;
+      return &m_hide_buffer;
     case message_type::select:
     {
       switch (piece_type)
       {
-        case piece_type::bishop: m_hmm_high.play(); break;
-        case piece_type::king: m_yes_mid.play(); break;
-        case piece_type::knight: m_hmm_mid.play(); break;
-        case piece_type::pawn: m_heu_mid.play(); break;
-        case piece_type::queen: m_yes_high.play(); break;
+        case piece_type::bishop: return &m_hmm_high_buffer;
+        case piece_type::king: return &m_yes_mid_buffer;
+        case piece_type::knight: return &m_hmm_mid_buffer;
+        case piece_type::pawn: return &m_heu_mid_buffer;
+        case piece_type::queen: return &m_yes_high_buffer;
         default:
         case piece_type::rook:
           assert(piece_type == piece_type::rook);
-          m_heu_low.play();
-          break;
+          return &m_heu_low_buffer;
       }
-      break;
     }
     case message_type::start_move:
     {
       switch (piece_type)
       {
-        case piece_type::bishop: m_faring_into_battle.play(); break;
-        case piece_type::king: m_lets_rule.play(); break;
-        case piece_type::knight: m_jumping_into_battle.play(); break;
-        case piece_type::pawn: m_moving_forward.play(); break;
-        case piece_type::queen: m_to_rule_is_to_act.play(); break;
+        case piece_type::bishop: return &m_faring_into_battle_buffer;
+        case piece_type::king: return &m_lets_rule_buffer;
+        case piece_type::knight: return &m_jumping_into_battle_buffer;
+        case piece_type::pawn: return &m_moving_forward_buffer;
+        case piece_type::queen: return &m_to_rule_is_to_act_buffer;
         default:
         case piece_type::rook:
           assert(piece_type == piece_type::rook);
-          m_its_time_to_rock.play();
-          break;
+          return &m_its_time_to_rock_buffer;
       }
-      break;
     }
     case message_type::start_castling_kingside:
-    {
-      switch (piece_type)
-      {
-        case piece_type::bishop: break;
-        case piece_type::king: m_lets_rule.play(); break;
-        case piece_type::knight: break;
-        case piece_type::pawn: break;
-        case piece_type::queen: break;
-        case piece_type::rook:
-          assert(piece_type == piece_type::rook);
-          m_its_time_to_rock.play();
-          break;
-      }
-    }
-    break;
     case message_type::start_castling_queenside:
     {
       switch (piece_type)
       {
-        case piece_type::bishop: break;
-        case piece_type::king: m_lets_rule.play(); break;
-        case piece_type::knight: break;
-        case piece_type::pawn: break;
-        case piece_type::queen: break;
-        case piece_type::rook:
-          assert(piece_type == piece_type::rook);
-          m_its_time_to_rock.play();
-          break;
+        case piece_type::king: return &m_lets_rule_buffer;
+        case piece_type::rook: return &m_its_time_to_rock_buffer;
+        default: return nullptr;
       }
     }
-    break;
-    //default:
     case message_type::start_attack:
     {
-      assert(effect.get_message_type() == message_type::start_attack);
       switch (piece_type)
       {
-        case piece_type::bishop: m_attacking_high.play(); break;
-        case piece_type::king: m_attacking_mid.play(); break;
-        case piece_type::knight: m_attacking_mid.play(); break;
-        case piece_type::pawn: m_attacking_low.play(); break;
-        case piece_type::queen: m_attacking_high.play(); break;
+        case piece_type::bishop: return &m_attacking_high_buffer;
+        case piece_type::king: return &m_attacking_mid_buffer;
+        case piece_type::knight: return &m_attacking_mid_buffer;
+        case piece_type::pawn: return &m_attacking_low_buffer;
+        case piece_type::queen: return &m_attacking_high_buffer;
         default:
         case piece_type::rook:
           assert(piece_type == piece_type::rook);
-          m_attacking_low.play();
-          break;
+          return &m_attacking_low_buffer;
       }
-      break;
     }
+    default:
     case message_type::start_en_passant_attack:
     {
-      assert(piece_type == piece_type::pawn);
-      m_attacking_low.play();
-      break;
+      assert(t == message_type::start_en_passant_attack);
+      return &m_attacking_low_buffer;
     }
   }
 }
 
+int sound_effects::get_n_playing_voices() const noexcept
+{
+  return std::count_if(
+    std::begin(m_voices),
+    std::end(m_voices),
+    [](const sf::Sound& s) { return s.getStatus() == sf::Sound::Playing; }
+  );
+}
+
+int sound_effects::get_sound_index(const sf::SoundBuffer& buffer) const noexcept
+{
+  const auto iter{
+    std::find_if(
+      std::begin(m_buffers),
+      std::end(m_buffers),
+      [&buffer](const auto& b) { return &b.get() == &buffer; }
+    )
+  };
+  assert(iter != std::end(m_buffers));
+  return std::distance(std::begin(m_buffers), iter);
+}
+
+std::vector<std::pair<std::reference_wrapper<sf::SoundBuffer>, std::string>> sound_effects::get_table() noexcept
+{
+  const std::vector<std::pair<std::reference_wrapper<sf::SoundBuffer>, std::string>> v = {
+    std::make_pair(std::ref(m_attacking_high_buffer), "attacking_high.ogg"),
+    std::make_pair(std::ref(m_attacking_low_buffer), "attacking_low.ogg"),
+    std::make_pair(std::ref(m_attacking_mid_buffer), "attacking_mid.ogg"),
+    std::make_pair(std::ref(m_bark_1_buffer), "bark_1.ogg"),
+    std::make_pair(std::ref(m_bark_2_buffer), "bark_2.ogg"),
+    std::make_pair(std::ref(m_countdown_buffer), "countdown.ogg"),
+    std::make_pair(std::ref(m_done_high_buffer), "done_high.ogg"),
+    std::make_pair(std::ref(m_done_low_buffer), "done_low.ogg"),
+    std::make_pair(std::ref(m_done_mid_buffer), "done_mid.ogg"),
+    std::make_pair(std::ref(m_faring_into_battle_buffer), "faring_into_battle.ogg"),
+    std::make_pair(std::ref(m_heu_high_buffer), "heu_high.ogg"),
+    std::make_pair(std::ref(m_heu_low_buffer), "heu_low.ogg"),
+    std::make_pair(std::ref(m_heu_mid_buffer), "heu_mid.ogg"),
+    std::make_pair(std::ref(m_hide_buffer), "hide.ogg"),
+    std::make_pair(std::ref(m_hmm_high_buffer), "hmm_high.ogg"),
+    std::make_pair(std::ref(m_hmm_low_buffer), "hmm_low.ogg"),
+    std::make_pair(std::ref(m_hmm_mid_buffer), "hmm_mid.ogg"),
+    std::make_pair(std::ref(m_i_cannot_high_buffer), "i_cannot_high.ogg"),
+    std::make_pair(std::ref(m_i_cannot_low_buffer), "i_cannot_low.ogg"),
+    std::make_pair(std::ref(m_i_cannot_mid_buffer), "i_cannot_mid.ogg"),
+    std::make_pair(std::ref(m_i_cant_high_buffer), "i_cant_high.ogg"),
+    std::make_pair(std::ref(m_i_cant_low_buffer), "i_cant_low.ogg"),
+    std::make_pair(std::ref(m_i_cant_mid_buffer), "i_cant_mid.ogg"),
+    std::make_pair(std::ref(m_its_time_to_rock_buffer), "its_time_to_rock.ogg"),
+    std::make_pair(std::ref(m_jumping_into_battle_buffer), "jumping_into_battle.ogg"),
+    std::make_pair(std::ref(m_lets_rule_buffer), "lets_rule.ogg"),
+    std::make_pair(std::ref(m_moving_forward_buffer), "moving_forward.ogg"),
+    std::make_pair(std::ref(m_no_high_buffer), "no_high.ogg"),
+    std::make_pair(std::ref(m_no_low_buffer), "no_low.ogg"),
+    std::make_pair(std::ref(m_no_mid_buffer), "no_mid.ogg"),
+    std::make_pair(std::ref(m_nope_high_buffer), "nope_high.ogg"),
+    std::make_pair(std::ref(m_nope_low_buffer), "nope_low.ogg"),
+    std::make_pair(std::ref(m_nope_mid_buffer), "nope_mid.ogg"),
+    std::make_pair(std::ref(m_to_rule_is_to_act_buffer), "to_rule_is_to_act.ogg"),
+    std::make_pair(std::ref(m_yes_high_buffer), "yes_high.ogg"),
+    std::make_pair(std::ref(m_yes_low_buffer), "yes_low.ogg"),
+    std::make_pair(std::ref(m_yes_mid_buffer), "yes_mid.ogg"),
+  };
+  return v;
+}
+
+void sound_effects::play(const message& effect)
+{
+  play(std::vector<message>( { effect } ));
+}
+
+void sound_effects::play(const std::vector<message>& effects)
+{
+  std::vector<sound_request> requests;
+  requests.reserve(effects.size());
+  for (const auto& effect: effects)
+  {
+    const auto& sound_indices{m_message_sound_indices[effect.get_message_type()]};
+    const auto iter{sound_indices.find(effect.get_piece_type())};
+    if (iter == std::end(sound_indices)) continue;
+    requests.push_back(
+      sound_request(
+        iter->second,
+        get_sound_priority(effect.get_message_type())
+      )
+    );
+  }
+  play(requests);
+}
+
+void sound_effects::play(const std::vector<sound_request>& requests)
+{
+  if (requests.empty()) return;
+  std::vector<bool> is_playing;
+  is_playing.reserve(m_voices.size());
+  for (const auto& voice: m_voices)
+  {
+    is_playing.push_back(voice.getStatus() == sf::Sound::Playing);
+  }
+  for (const auto& p: m_voice_pool.assign(requests, is_playing))
+  {
+    sf::Sound& voice{m_voices[p.first]};
+    voice.stop();
+    voice.setBuffer(m_buffers[p.second].get());
+    voice.setVolume(m_master_volume);
+    voice.play();
+  }
+}
+
 void sound_effects::play_bark(const int number)
 {
   assert(number == 1 || number == 2);
   if (number == 1)
   {
-    m_bark_1.play();
+    play_ui_sound(m_bark_1_buffer);
   }
   else
   {
     assert(number == 2);
-    m_bark_2.play();
+    play_ui_sound(m_bark_2_buffer);
   }
 
 }
 
 void sound_effects::play_countdown() noexcept
 {
-  m_countdown.play();
+  play_ui_sound(m_countdown_buffer);
 }
 
 void sound_effects::play_hide() noexcept
 {
-  m_hide.play();
+  play_ui_sound(m_hide_buffer);
+}
+
+void sound_effects::play_ui_sound(const sf::SoundBuffer& buffer)
+{
+  play(
+    std::vector<sound_request>(
+      {
+        sound_request(get_sound_index(buffer), get_ui_sound_priority())
+      }
+    )
+  );
 }
 
 void sound_effects::set_master_volume(const volume& v)
 {
-  for (auto& row: get_table())
+  m_master_volume = v.get_percentage();
+  for (auto& voice: m_voices)
   {
-    std::get<0>(row).get().setVolume(v.get_percentage());
+    voice.setVolume(m_master_volume);
   }
 }
 
@@ -0,0 +1,181 @@
+#include "sound_voice_pool.h"
+
+#include <algorithm>
+#include <cassert>
+
+sound_request::sound_request(const int sound_index, const int priority)
+  : m_sound_index{sound_index},
+    m_priority{priority}
+{
+  assert(m_sound_index >= 0);
+}
+
+sound_voice_pool::sound_voice_pool(const int n_voices)
+  : m_priorities(n_voices, 0)
+{
+  assert(n_voices > 0);
+}
+
+std::vector<std::pair<int, int>> sound_voice_pool::assign(
+  std::vector<sound_request> requests,
+  const std::vector<bool>& is_playing
+)
+{
+  assert(is_playing.size() == m_priorities.size());
+
+  // Most important first, then remove the duplicates:
+  // the same sound effect twice in a frame only sounds louder
+  std::stable_sort(
+    std::begin(requests),
+    std::end(requests),
+    [](const sound_request& lhs, const sound_request& rhs)
+    {
+      return lhs.get_priority() > rhs.get_priority();
+    }
+  );
+  std::vector<int> sound_indices;
+  std::vector<std::pair<int, int>> assignments;
+  std::vector<bool> is_busy{is_playing};
+  for (const auto& r: requests)
+  {
+    if (std::count(std::begin(sound_indices), std::end(sound_indices), r.get_sound_index()))
+    {
+      continue;
+    }
+    sound_indices.push_back(r.get_sound_index());
+
+    // A free voice
+    auto voice{std::find(std::begin(is_busy), std::end(is_busy), false)};
+    int voice_index{static_cast<int>(std::distance(std::begin(is_busy), voice))};
+    if (voice == std::end(is_busy))
+    {
+      // The busy voice with the lowest priority,
+      // that is not assigned in this frame
+      voice_index = -1;
+      for (int i{0}; i != get_n_voices(); ++i)
+      {
+        const bool is_assigned_now{
+          std::count_if(
+            std::begin(assignments),
+            std::end(assignments),
+            [i](const auto& p) { return p.first == i; }
+          ) != 0
+        };
+        if (is_assigned_now) continue;
+        if (m_priorities[i] >= r.get_priority()) continue;
+        if (voice_index == -1 || m_priorities[i] < m_priorities[voice_index])
+        {
+          voice_index = i;
+        }
+      }
+    }
+    if (voice_index == -1)
+    {
+      ++m_n_dropped_voices;
+      continue;
+    }
+    is_busy[voice_index] = true;
+    m_priorities[voice_index] = r.get_priority();
+    assignments.push_back(std::make_pair(voice_index, r.get_sound_index()));
+  }
+  return assignments;
+}
+
+int get_sound_priority(const message_type t) noexcept
+{
+  switch (t)
+  {
+    case message_type::start_attack:
+    case message_type::start_en_passant_attack:
+      return 4;
+    case message_type::start_castling_kingside:
+    case message_type::start_castling_queenside:
+    case message_type::start_move:
+      return 3;
+    case message_type::cannot:
+      return 2;
+    case message_type::select:
+    case message_type::unselect:
+      return 1;
+    default:
+    case message_type::done:
+      assert(t == message_type::done);
+      return 0;
+  }
+}
+
+int get_ui_sound_priority() noexcept
+{
+  return 5;
+}
+
+void test_sound_voice_pool()
+{
+#ifndef NDEBUG
+  // get_sound_priority
+  {
+    assert(get_sound_priority(message_type::start_attack) > get_sound_priority(message_type::done));
+    for (const auto t: get_all_message_types())
+    {
+      assert(get_sound_priority(t) < get_ui_sound_priority());
+    }
+  }
+  // All free voices, one request
+  {
+    sound_voice_pool p(2);
+    const auto a{p.assign( { sound_request(3, 1) }, { false, false })};
+    assert(a.size() == 1);
+    assert(a[0].first == 0);
+    assert(a[0].second == 3);
+    assert(p.get_n_dropped_voices() == 0);
+  }
+  // Duplicate requests in a frame are played once
+  {
+    sound_voice_pool p(2);
+    const auto a{p.assign( { sound_request(3, 1), sound_request(3, 1) }, { false, false })};
+    assert(a.size() == 1);
+    assert(p.get_n_dropped_voices() == 0);
+  }
+  // More requests than voices: the most important ones are played
+  {
+    sound_voice_pool p(2);
+    const auto a{
+      p.assign(
+        { sound_request(1, 0), sound_request(2, 2), sound_request(3, 1) },
+        { false, false }
+      )
+    };
+    assert(a.size() == 2);
+    assert(a[0].second == 2);
+    assert(a[1].second == 3);
+    assert(p.get_n_dropped_voices() == 1);
+  }
+  // A more important request steals a voice
+  {
+    sound_voice_pool p(1);
+    p.assign( { sound_request(1, 0) }, { false });
+    const auto a{p.assign( { sound_request(2, 1) }, { true })};
+    assert(a.size() == 1);
+    assert(a[0].first == 0);
+    assert(a[0].second == 2);
+    assert(p.get_n_dropped_voices() == 0);
+  }
+  // A less or equally important request does not steal a voice
+  {
+    sound_voice_pool p(1);
+    p.assign( { sound_request(1, 1) }, { false });
+    const auto a{p.assign( { sound_request(2, 1) }, { true })};
+    assert(a.empty());
+    assert(p.get_n_dropped_voices() == 1);
+  }
+  // A voice is stolen at most once per frame
+  {
+    sound_voice_pool p(1);
+    p.assign( { sound_request(1, 0) }, { false });
+    const auto a{p.assign( { sound_request(2, 2), sound_request(3, 1) }, { true })};
+    assert(a.size() == 1);
+    assert(a[0].second == 2);
+    assert(p.get_n_dropped_voices() == 1);
+  }
+#endif // NDEBUG
+}
@@ -0,0 +1,226 @@
+#include "spectator_broadcaster.h"
+
+#include "game_controller.h"
+#include "game_simulation.h"
+#include "lockstep_session.h"
+#include "metrics.h"
+#include "spectator_stream.h"
+#include "trace.h"
+#include "user_input.h"
+
+#include <cassert>
+#include <chrono>
+#include <random>
+
+spectator_broadcaster::spectator_broadcaster(
+  const int keyframe_interval
+) : m_keyframe_interval{keyframe_interval}
+{
+  assert(m_keyframe_interval > 0);
+}
+
+void spectator_broadcaster::add_spectator(std::unique_ptr<net_transport> transport)
+{
+  assert(transport);
+  m_spectators.push_back(std::make_pair(std::move(transport), false));
+}
+
+void spectator_broadcaster::tick(const game_controller& c)
+{
+  const trace_scope scope("spectator_broadcaster::tick");
+  static metric_histogram& encode_ms{
+    get_metrics().get_histogram("spectator_encode_ms")
+  };
+  static metric_counter& n_bytes_sent{
+    get_metrics().get_counter("spectator_bytes_sent")
+  };
+  const auto start{std::chrono::steady_clock::now()};
+  const spectator_state s(c);
+  const bool is_keyframe_tick{
+    !m_previous_state || m_tick % m_keyframe_interval == 0
+  };
+  // Encoded once, for all spectators
+  std::vector<std::uint8_t> delta;
+  if (!is_keyframe_tick)
+  {
+    delta = to_spectator_delta_bytes(m_previous_state.value(), s, m_tick);
+  }
+  // Only encoded if a spectator needs it
+  std::vector<std::uint8_t> keyframe;
+  const auto get_keyframe{
+    [&]() -> const std::vector<std::uint8_t>&
+    {
+      if (keyframe.empty()) keyframe = to_spectator_keyframe_bytes(s, m_tick);
+      return keyframe;
+    }
+  };
+  if (is_keyframe_tick) get_keyframe();
+  const std::chrono::duration<double, std::milli> duration{
+    std::chrono::steady_clock::now() - start
+  };
+
+  std::int64_t n_bytes{0};
+  for (auto& [transport, has_keyframe]: m_spectators)
+  {
+    const auto& bytes{is_keyframe_tick || !has_keyframe ? get_keyframe() : delta};
+    transport->send(bytes);
+    n_bytes += bytes.size();
+    has_keyframe = true;
+  }
+  m_n_bytes_sent += n_bytes;
+  n_bytes_sent.add(n_bytes);
+  m_encode_secs += duration.count() / 1000.0;
+  encode_ms.add(duration.count());
+
+  m_previous_state = s;
+  ++m_tick;
+}
+
+spectator_broadcast_result::spectator_broadcast_result(
+  const int n_spectators,
+  const int n_ticks,
+  const std::int64_t n_bytes_sent,
+  const double n_secs,
+  const double encode_secs,
+  const bool is_in_sync
+) : m_n_spectators{n_spectators},
+    m_n_ticks{n_ticks},
+    m_n_bytes_sent{n_bytes_sent},
+    m_n_secs{n_secs},
+    m_encode_secs{encode_secs},
+    m_is_in_sync{is_in_sync}
+{
+  assert(m_n_spectators >= 0);
+  assert(m_n_ticks >= 0);
+  assert(m_n_bytes_sent >= 0);
+  assert(m_n_secs >= 0.0);
+  assert(m_encode_secs >= 0.0);
+}
+
+double spectator_broadcast_result::get_encode_ms_per_tick() const noexcept
+{
+  if (m_n_ticks == 0) return 0.0;
+  return m_encode_secs * 1000.0 / static_cast<double>(m_n_ticks);
+}
+
+double spectator_broadcast_result::get_n_bytes_per_second() const noexcept
+{
+  if (m_n_secs == 0.0 || m_n_spectators == 0) return 0.0;
+  return static_cast<double>(m_n_bytes_sent) / m_n_spectators / m_n_secs;
+}
+
+spectator_broadcast_result run_spectator_broadcast(
+  const int n_spectators,
+  const int n_ticks,
+  const int keyframe_interval,
+  const int seed
+)
+{
+  spectator_broadcaster b(keyframe_interval);
+  std::vector<std::unique_ptr<loopback_transport>> transports;
+  for (int i{0}; i != n_spectators; ++i)
+  {
+    auto [to_spectator, from_broadcaster]{create_loopback_transports()};
+    b.add_spectator(std::move(to_spectator));
+    transports.push_back(std::move(from_broadcaster));
+  }
+  std::vector<spectator_decoder> spectators(n_spectators);
+
+  const int n_steps_per_tick{get_default_lockstep_n_steps_per_frame()};
+  const delta_t dt(get_speed_multiplier(get_default_game_speed()) / get_default_simulation_frequency());
+  game_controller c;
+  std::default_random_engine rng_engine(seed);
+  std::uniform_int_distribution<int> n_inputs_distribution(0, 3);
+  std::vector<std::uint8_t> bytes;
+  for (int tick{0}; tick != n_ticks; ++tick)
+  {
+    user_inputs inputs;
+    for (const side s: get_all_sides())
+    {
+      // A player does a user input in one out of four ticks
+      if (n_inputs_distribution(rng_engine) != 0) continue;
+      const user_input i{create_useful_random_user_input(rng_engine)};
+      inputs.add(user_input(i.get_user_input_type(), s, i.get_coordinat()));
+    }
+    do_lockstep_frame(c, inputs, n_steps_per_tick, dt);
+    clear_piece_messages(c.get_game());
+    b.tick(c);
+    for (int i{0}; i != n_spectators; ++i)
+    {
+      while (transports[i]->receive(bytes)) spectators[i].add(bytes);
+    }
+  }
+  bool is_in_sync{true};
+  for (const auto& s: spectators)
+  {
+    if (!s.get_state() || s.get_state().value() != spectator_state(c)) is_in_sync = false;
+  }
+  return spectator_broadcast_result(
+    n_spectators,
+    n_ticks,
+    b.get_n_bytes_sent(),
+    n_ticks * n_steps_per_tick / get_default_simulation_frequency(),
+    b.get_encode_secs(),
+    is_in_sync
+  );
+}
+
+void test_spectator_broadcaster()
+{
+#ifndef NDEBUG
+  // A new broadcaster has no spectators
+  {
+    const spectator_broadcaster b;
+    assert(b.get_n_spectators() == 0);
+    assert(b.get_n_ticks() == 0);
+  }
+  // A spectator gets a keyframe, then deltas
+  {
+    spectator_broadcaster b(100);
+    auto [to_spectator, from_broadcaster]{create_loopback_transports()};
+    b.add_spectator(std::move(to_spectator));
+    game_controller c;
+    spectator_decoder d;
+    std::vector<std::uint8_t> bytes;
+    for (int i{0}; i != 3; ++i)
+    {
+      c.tick(delta_t(0.1));
+      b.tick(c);
+      while (from_broadcaster->receive(bytes)) d.add(bytes);
+    }
+    assert(d.get_n_keyframes() == 1);
+    assert(d.get_n_deltas() == 2);
+    assert(d.get_state().value() == spectator_state(c));
+    assert(b.get_encode_secs() > 0.0);
+  }
+  // A spectator that joins later gets a keyframe
+  {
+    spectator_broadcaster b(100);
+    game_controller c;
+    b.tick(c);
+    auto [to_spectator, from_broadcaster]{create_loopback_transports()};
+    b.add_spectator(std::move(to_spectator));
+    c.tick(delta_t(0.1));
+    b.tick(c);
+    spectator_decoder d;
+    std::vector<std::uint8_t> bytes;
+    assert(from_broadcaster->receive(bytes));
+    assert(d.add(bytes));
+    assert(d.get_n_keyframes() == 1);
+    assert(d.get_tick() == 1);
+  }
+#endif // NDEBUG
+}
+
+void test_spectator_broadcaster_long()
+{
+#ifndef NDEBUG
+  // All spectators see the game
+  {
+    const auto result{run_spectator_broadcast(3, 10, 4)};
+    assert(result.is_in_sync());
+    assert(result.get_n_bytes_per_second() > 0.0);
+    assert(result.get_encode_ms_per_tick() > 0.0);
+  }
+#endif // NDEBUG
+}
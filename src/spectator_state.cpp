@@ -0,0 +1,201 @@
+#include "spectator_state.h"
+
+#include "game.h"
+#include "game_controller.h"
+#include "piece.h"
+#include "piece_action.h"
+#include "pieces.h"
+#include "square.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+/// Quantise a fraction, from 0.0 to 1.0, to a byte
+std::uint8_t to_byte(const double f) noexcept
+{
+  return static_cast<std::uint8_t>(
+    std::lround(std::clamp(f, 0.0, 1.0) * 255.0)
+  );
+}
+
+/// Quantise a coordinat to 1/16th of a square
+std::uint8_t to_cursor_byte(const double x) noexcept
+{
+  return static_cast<std::uint8_t>(
+    std::lround(std::clamp(x * 16.0, 0.0, 255.0))
+  );
+}
+
+} // ~namespace
+
+spectator_state::spectator_state()
+  : m_cursors{},
+    m_squares{}
+{
+
+}
+
+spectator_state::spectator_state(const game_controller& c)
+  : spectator_state()
+{
+  const game& g{c.get_game()};
+  m_in_game_time = g.get_in_game_time().get();
+  m_winner = g.get_winner();
+  for (const side s: get_all_sides())
+  {
+    const auto& pos{c.get_cursor_pos(s)};
+    set_cursor(s, { to_cursor_byte(pos.get_x()), to_cursor_byte(pos.get_y()) } );
+  }
+  for (const auto& p: g.get_pieces())
+  {
+    const int i{get_spectator_square_index(p.get_current_square())};
+    set_field(
+      i,
+      field::piece,
+      static_cast<std::uint8_t>(
+        1 + (static_cast<int>(p.get_type()) * 2) + static_cast<int>(p.get_color())
+      )
+    );
+    set_field(i, field::health, to_byte(::get_f_health(p)));
+    if (p.get_race() == race::rooxx)
+    {
+      set_field(i, field::shield, to_byte(get_f_shield(p)));
+    }
+    if (!p.get_actions().empty())
+    {
+      const auto& a{p.get_actions()[0]};
+      set_field(i, field::action_type, static_cast<std::uint8_t>(1 + static_cast<int>(a.get_action_type())));
+      set_field(i, field::action_target, static_cast<std::uint8_t>(get_spectator_square_index(a.get_to())));
+      set_field(i, field::action_progress, to_byte(p.get_current_action_progress().get()));
+    }
+  }
+}
+
+std::uint8_t spectator_state::get_field(const int square_index, const field f) const noexcept
+{
+  assert(square_index >= 0);
+  assert(square_index < get_spectator_n_squares());
+  return m_squares[(square_index * get_spectator_square_n_bytes()) + static_cast<int>(f)];
+}
+
+void spectator_state::set_cursor(const side s, const std::array<std::uint8_t, 2>& xy) noexcept
+{
+  m_cursors[static_cast<int>(s)] = xy;
+}
+
+void spectator_state::set_field(const int square_index, const field f, const std::uint8_t value) noexcept
+{
+  assert(square_index >= 0);
+  assert(square_index < get_spectator_n_squares());
+  m_squares[(square_index * get_spectator_square_n_bytes()) + static_cast<int>(f)] = value;
+}
+
+std::optional<piece_action_type> get_action_type(
+  const spectator_state& s,
+  const int square_index
+) noexcept
+{
+  const int value{s.get_field(square_index, spectator_state::field::action_type)};
+  if (value == 0) return {};
+  return static_cast<piece_action_type>(value - 1);
+}
+
+double get_f_health(const spectator_state& s, const int square_index) noexcept
+{
+  return static_cast<double>(s.get_field(square_index, spectator_state::field::health)) / 255.0;
+}
+
+std::optional<std::pair<chess_color, piece_type>> get_piece(
+  const spectator_state& s,
+  const int square_index
+) noexcept
+{
+  const int value{s.get_field(square_index, spectator_state::field::piece)};
+  if (value == 0) return {};
+  return std::make_pair(
+    static_cast<chess_color>((value - 1) % 2),
+    static_cast<piece_type>((value - 1) / 2)
+  );
+}
+
+int get_spectator_square_index(const square& s) noexcept
+{
+  assert(s.get_x() >= 0 && s.get_x() < 8);
+  assert(s.get_y() >= 0 && s.get_y() < 8);
+  return (s.get_x() * 8) + s.get_y();
+}
+
+void test_spectator_state()
+{
+#ifndef NDEBUG
+  // An empty board has no pieces
+  {
+    const spectator_state s;
+    for (int i{0}; i != get_spectator_n_squares(); ++i)
+    {
+      assert(!get_piece(s, i));
+    }
+  }
+  // The pieces of a game are on their squares
+  {
+    const game_controller c;
+    const spectator_state s(c);
+    const int e1{get_spectator_square_index(square("e1"))};
+    assert(get_piece(s, e1).has_value());
+    assert(get_piece(s, e1).value().first == chess_color::white);
+    assert(get_piece(s, e1).value().second == piece_type::king);
+    assert(get_f_health(s, e1) == 1.0);
+    assert(!get_action_type(s, e1));
+    assert(!get_piece(s, get_spectator_square_index(square("e4"))));
+    assert(!s.get_winner());
+  }
+  // The same game gives the same state
+  {
+    const game_controller c;
+    assert(spectator_state(c) == spectator_state(c));
+    assert(spectator_state(c) != spectator_state());
+  }
+  // A piece that is moving has its action and progress
+  {
+    game_controller c;
+    get_piece_at(c.get_game(), "e2").add_action(
+      piece_action(chess_color::white, piece_type::pawn, piece_action_type::move, "e2", "e4")
+    );
+    c.tick(delta_t(0.1));
+    const spectator_state s(c);
+    const int e2{get_spectator_square_index(square("e2"))};
+    assert(get_action_type(s, e2).has_value());
+    assert(get_action_type(s, e2).value() == piece_action_type::move);
+    assert(s.get_field(e2, spectator_state::field::action_target) == get_spectator_square_index(square("e4")));
+    assert(s.get_field(e2, spectator_state::field::action_progress) > 0);
+    assert(s.get_in_game_time() > 0.0);
+  }
+#endif // NDEBUG
+}
+
+bool operator==(const spectator_state& lhs, const spectator_state& rhs) noexcept
+{
+  if (lhs.get_in_game_time() != rhs.get_in_game_time()) return false;
+  if (lhs.get_winner() != rhs.get_winner()) return false;
+  for (const side s: get_all_sides())
+  {
+    if (lhs.get_cursor(s) != rhs.get_cursor(s)) return false;
+  }
+  for (int i{0}; i != get_spectator_n_squares(); ++i)
+  {
+    for (int f{0}; f != get_spectator_square_n_bytes(); ++f)
+    {
+      const auto field{static_cast<spectator_state::field>(f)};
+      if (lhs.get_field(i, field) != rhs.get_field(i, field)) return false;
+    }
+  }
+  return true;
+}
+
+bool operator!=(const spectator_state& lhs, const spectator_state& rhs) noexcept
+{
+  return !(lhs == rhs);
+}
@@ -0,0 +1,272 @@
+#include "spectator_stream.h"
+
+#include "game_controller.h"
+#include "net_bytes.h"
+#include "piece.h"
+#include "piece_action.h"
+#include "pieces.h"
+#include "side.h"
+#include "square.h"
+
+#include <cassert>
+
+namespace {
+
+/// The first bytes of every spectator message, 'CCSP'
+constexpr std::uint32_t get_spectator_message_magic() { return 0x50534343; }
+
+constexpr std::uint8_t get_spectator_keyframe_kind() { return 0; }
+constexpr std::uint8_t get_spectator_delta_kind() { return 1; }
+
+/// The flags of the values besides the squares in a delta
+constexpr std::uint8_t get_time_changed_flag() { return 1; }
+constexpr std::uint8_t get_winner_changed_flag() { return 2; }
+constexpr std::uint8_t get_cursors_changed_flag() { return 4; }
+
+std::uint8_t to_winner_byte(const std::optional<chess_color>& winner) noexcept
+{
+  return winner.has_value() ? 1 + static_cast<int>(winner.value()) : 0;
+}
+
+std::optional<chess_color> to_winner(const std::uint8_t b) noexcept
+{
+  if (b == 0) return {};
+  return static_cast<chess_color>(b - 1);
+}
+
+void add_cursors(byte_writer& w, const spectator_state& s)
+{
+  for (const side player: get_all_sides())
+  {
+    w.add_uint8(s.get_cursor(player)[0]);
+    w.add_uint8(s.get_cursor(player)[1]);
+  }
+}
+
+void read_cursors(byte_reader& r, spectator_state& s)
+{
+  for (const side player: get_all_sides())
+  {
+    const std::uint8_t x{r.read_uint8()};
+    const std::uint8_t y{r.read_uint8()};
+    s.set_cursor(player, { x, y } );
+  }
+}
+
+} // ~namespace
+
+bool spectator_decoder::add(const std::vector<std::uint8_t>& bytes)
+{
+  byte_reader r(bytes);
+  const std::uint32_t magic{r.read_uint32()};
+  const std::uint8_t kind{r.read_uint8()};
+  const int tick{r.read_int32()};
+  if (!r.is_valid() || magic != get_spectator_message_magic())
+  {
+    ++m_n_ignored;
+    return false;
+  }
+  if (kind == get_spectator_keyframe_kind())
+  {
+    spectator_state s;
+    s.set_in_game_time(r.read_double());
+    s.set_winner(to_winner(r.read_uint8()));
+    read_cursors(r, s);
+    for (int i{0}; i != get_spectator_n_squares(); ++i)
+    {
+      for (int f{0}; f != get_spectator_square_n_bytes(); ++f)
+      {
+        s.set_field(i, static_cast<spectator_state::field>(f), r.read_uint8());
+      }
+    }
+    if (!r.is_valid() || !r.is_done() || tick <= m_tick)
+    {
+      ++m_n_ignored;
+      return false;
+    }
+    m_state = s;
+    m_tick = tick;
+    ++m_n_keyframes;
+    return true;
+  }
+  // A delta only follows the tick before it
+  if (kind != get_spectator_delta_kind() || !m_state || tick != m_tick + 1)
+  {
+    ++m_n_ignored;
+    return false;
+  }
+  spectator_state s{m_state.value()};
+  const std::uint8_t flags{r.read_uint8()};
+  if (flags & get_time_changed_flag()) s.set_in_game_time(r.read_double());
+  if (flags & get_winner_changed_flag()) s.set_winner(to_winner(r.read_uint8()));
+  if (flags & get_cursors_changed_flag()) read_cursors(r, s);
+  const int n_squares{r.read_uint8()};
+  for (int j{0}; j != n_squares; ++j)
+  {
+    const int i{r.read_uint8()};
+    const std::uint8_t mask{r.read_uint8()};
+    if (i >= get_spectator_n_squares()) break;
+    for (int f{0}; f != get_spectator_square_n_bytes(); ++f)
+    {
+      if (mask & (1 << f))
+      {
+        s.set_field(i, static_cast<spectator_state::field>(f), r.read_uint8());
+      }
+    }
+  }
+  if (!r.is_valid() || !r.is_done())
+  {
+    ++m_n_ignored;
+    return false;
+  }
+  m_state = s;
+  m_tick = tick;
+  ++m_n_deltas;
+  return true;
+}
+
+std::vector<std::uint8_t> to_spectator_delta_bytes(
+  const spectator_state& from,
+  const spectator_state& to,
+  const int tick
+)
+{
+  assert(tick > 0);
+  byte_writer w;
+  w.add_uint32(get_spectator_message_magic());
+  w.add_uint8(get_spectator_delta_kind());
+  w.add_int32(tick);
+
+  const bool is_time_changed{from.get_in_game_time() != to.get_in_game_time()};
+  const bool is_winner_changed{from.get_winner() != to.get_winner()};
+  bool is_cursors_changed{false};
+  for (const side player: get_all_sides())
+  {
+    if (from.get_cursor(player) != to.get_cursor(player)) is_cursors_changed = true;
+  }
+  w.add_uint8(
+    (is_time_changed ? get_time_changed_flag() : 0)
+    | (is_winner_changed ? get_winner_changed_flag() : 0)
+    | (is_cursors_changed ? get_cursors_changed_flag() : 0)
+  );
+  if (is_time_changed) w.add_double(to.get_in_game_time());
+  if (is_winner_changed) w.add_uint8(to_winner_byte(to.get_winner()));
+  if (is_cursors_changed) add_cursors(w, to);
+
+  // The changed squares, each with a mask of its changed values
+  byte_writer squares;
+  int n_squares{0};
+  for (int i{0}; i != get_spectator_n_squares(); ++i)
+  {
+    std::uint8_t mask{0};
+    for (int f{0}; f != get_spectator_square_n_bytes(); ++f)
+    {
+      const auto field{static_cast<spectator_state::field>(f)};
+      if (from.get_field(i, field) != to.get_field(i, field)) mask |= 1 << f;
+    }
+    if (mask == 0) continue;
+    ++n_squares;
+    squares.add_uint8(static_cast<std::uint8_t>(i));
+    squares.add_uint8(mask);
+    for (int f{0}; f != get_spectator_square_n_bytes(); ++f)
+    {
+      if (mask & (1 << f))
+      {
+        squares.add_uint8(to.get_field(i, static_cast<spectator_state::field>(f)));
+      }
+    }
+  }
+  w.add_uint8(static_cast<std::uint8_t>(n_squares));
+  std::vector<std::uint8_t> bytes{w.get_bytes()};
+  bytes.insert(std::end(bytes), std::begin(squares.get_bytes()), std::end(squares.get_bytes()));
+  return bytes;
+}
+
+std::vector<std::uint8_t> to_spectator_keyframe_bytes(
+  const spectator_state& s,
+  const int tick
+)
+{
+  assert(tick >= 0);
+  byte_writer w;
+  w.add_uint32(get_spectator_message_magic());
+  w.add_uint8(get_spectator_keyframe_kind());
+  w.add_int32(tick);
+  w.add_double(s.get_in_game_time());
+  w.add_uint8(to_winner_byte(s.get_winner()));
+  add_cursors(w, s);
+  for (int i{0}; i != get_spectator_n_squares(); ++i)
+  {
+    for (int f{0}; f != get_spectator_square_n_bytes(); ++f)
+    {
+      w.add_uint8(s.get_field(i, static_cast<spectator_state::field>(f)));
+    }
+  }
+  return w.get_bytes();
+}
+
+void test_spectator_stream()
+{
+#ifndef NDEBUG
+  // A new decoder has no state
+  {
+    const spectator_decoder d;
+    assert(!d.get_state());
+    assert(d.get_tick() == -1);
+  }
+  // A keyframe gives the state
+  {
+    const spectator_state s(game_controller{});
+    spectator_decoder d;
+    assert(d.add(to_spectator_keyframe_bytes(s, 0)));
+    assert(d.get_state().value() == s);
+    assert(d.get_tick() == 0);
+    assert(d.get_n_keyframes() == 1);
+  }
+  // A delta changes the state to the next one
+  {
+    game_controller c;
+    const spectator_state a(c);
+    get_piece_at(c.get_game(), "e2").add_action(
+      piece_action(chess_color::white, piece_type::pawn, piece_action_type::move, "e2", "e4")
+    );
+    c.tick(delta_t(0.1));
+    const spectator_state b(c);
+    spectator_decoder d;
+    d.add(to_spectator_keyframe_bytes(a, 0));
+    const auto delta{to_spectator_delta_bytes(a, b, 1)};
+    assert(d.add(delta));
+    assert(d.get_state().value() == b);
+    assert(d.get_n_deltas() == 1);
+    // Only the changed values are sent
+    assert(delta.size() < to_spectator_keyframe_bytes(b, 1).size() / 10);
+  }
+  // A delta without changes is small
+  {
+    const spectator_state s(game_controller{});
+    assert(to_spectator_delta_bytes(s, s, 1).size() <= 12);
+  }
+  // A delta that does not follow the previous tick is ignored
+  {
+    const spectator_state s(game_controller{});
+    spectator_decoder d;
+    assert(!d.add(to_spectator_delta_bytes(s, s, 1)));
+    d.add(to_spectator_keyframe_bytes(s, 0));
+    assert(!d.add(to_spectator_delta_bytes(s, s, 2)));
+    assert(d.get_n_ignored() == 2);
+    // Until the next keyframe
+    assert(d.add(to_spectator_keyframe_bytes(s, 3)));
+    assert(d.add(to_spectator_delta_bytes(s, s, 4)));
+  }
+  // Something else is ignored
+  {
+    spectator_decoder d;
+    assert(!d.add( {} ));
+    assert(!d.add( { 1, 2, 3, 4, 5, 6, 7, 8, 9 } ));
+    auto bytes{to_spectator_keyframe_bytes(spectator_state(), 0)};
+    bytes.pop_back();
+    assert(!d.add(bytes));
+    assert(d.get_n_ignored() == 3);
+  }
+#endif // NDEBUG
+}
@@ -0,0 +1,73 @@
+#include "spsc_queue.h"
+
+#include <cassert>
+#include <thread>
+
+void test_spsc_queue()
+{
+#ifndef NDEBUG
+  // A new queue is empty
+  {
+    spsc_queue<int> q(4);
+    assert(q.get_capacity() == 4);
+    assert(q.is_empty());
+    int i{0};
+    assert(!q.try_pop(i));
+  }
+  // Values are popped in the order they are pushed
+  {
+    spsc_queue<int> q(4);
+    assert(q.try_push(1));
+    assert(q.try_push(2));
+    assert(q.get_size() == 2);
+    int i{0};
+    assert(q.try_pop(i));
+    assert(i == 1);
+    assert(q.try_pop(i));
+    assert(i == 2);
+    assert(q.is_empty());
+  }
+  // A full queue refuses new values
+  {
+    spsc_queue<int> q(2);
+    assert(q.try_push(1));
+    assert(q.try_push(2));
+    assert(!q.try_push(3));
+    int i{0};
+    assert(q.try_pop(i));
+    assert(q.try_push(3));
+  }
+#endif // NDEBUG
+}
+
+void test_spsc_queue_long()
+{
+#ifndef NDEBUG
+  // Values are passed between threads in order
+  {
+    spsc_queue<int> q(16);
+    const int n{10000};
+    std::thread producer(
+      [&q]()
+      {
+        for (int i{0}; i != n; ++i)
+        {
+          while (!q.try_push(i)) {}
+        }
+      }
+    );
+    int expected{0};
+    while (expected != n)
+    {
+      int i{0};
+      if (q.try_pop(i))
+      {
+        assert(i == expected);
+        ++expected;
+      }
+    }
+    producer.join();
+    assert(q.is_empty());
+  }
+#endif // NDEBUG
+}
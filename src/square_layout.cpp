@@ -4,6 +4,7 @@
 
 #include <cassert>
 #include <cmath>
+#include <stdexcept>
 
 square_layout::square_layout(const screen_rect& r)
   : m_square(r)
@@ -21,6 +22,17 @@ square_layout::square_layout(const screen_rect& r)
       screen_coordinate(x1, y1),
       screen_coordinate(x2, y2)
     );
+    // The bars are one pixel within the outline
+    if (get_width(m_health_bar) > 2 && get_height(m_health_bar) >= 3)
+    {
+      m_health_bar_inside = create_rect_inside(m_health_bar);
+    }
+    // The bars need at least two pixels in height to be split in halves
+    if (get_width(m_health_bar) > 2 && get_height(m_health_bar) >= 4)
+    {
+      m_health_bar_inside_rooxx = get_upper_half(m_health_bar_inside.value());
+      m_shield_bar_inside = get_lower_half(m_health_bar_inside.value());
+    }
   }
   // Piece
   {
@@ -50,18 +62,25 @@ screen_rect square_layout::get_health_bar_value(const double f, const race r) co
 {
   assert(f >= 0.0);
   assert(f <= 1.0);
-  auto health_bar{create_rect_inside(get_health_bar_outline())};
-  if (r == race::rooxx) health_bar = get_upper_half(health_bar);
-  return create_partial_rect_from_lhs(health_bar, f);
+  const auto& health_bar{
+    r == race::rooxx ? m_health_bar_inside_rooxx : m_health_bar_inside
+  };
+  if (!health_bar)
+  {
+    throw std::logic_error("Square is too small to show a health bar");
+  }
+  return create_partial_rect_from_lhs(health_bar.value(), f);
 }
 
 screen_rect square_layout::get_shield_bar_value(const double f) const
 {
   assert(f >= 0.0);
   assert(f <= 1.0);
-  auto shield_bar{create_rect_inside(get_health_bar_outline())};
-  shield_bar = get_lower_half(shield_bar);
-  return create_partial_rect_from_lhs(shield_bar, f);
+  if (!m_shield_bar_inside)
+  {
+    throw std::logic_error("Square is too small to show a shield bar");
+  }
+  return create_partial_rect_from_lhs(m_shield_bar_inside.value(), f);
 }
 
 void test_piece_layout()
@@ -99,6 +118,24 @@ void test_piece_layout()
       assert(r_classic == r_kingdom);
       assert(r_classic == r_spawn);
     }
+    // A square too small for the bars
+    {
+      const square_layout tiny(screen_rect(screen_coordinate(0, 0), screen_coordinate(20, 20)));
+      bool has_thrown{false};
+      try { tiny.get_shield_bar_value(0.5); }
+      catch (const std::logic_error&) { has_thrown = true; }
+      assert(has_thrown);
+    }
+    // A square with only room for the classic health bar
+    {
+      const square_layout small(screen_rect(screen_coordinate(0, 0), screen_coordinate(30, 30)));
+      assert(get_height(small.get_health_bar_outline()) == 3);
+      assert(get_width(small.get_health_bar_value(1.0, race::classic)) > 0);
+      bool has_thrown{false};
+      try { small.get_shield_bar_value(0.5); }
+      catch (const std::logic_error&) { has_thrown = true; }
+      assert(has_thrown);
+    }
     // Rooxx health and shield bar differ
     {
       const auto r_health{layout.get_health_bar_value(0.5, race::rooxx)};
@@ -3,6 +3,8 @@
 #ifndef LOGIC_ONLY
 
 
+#include "asset_cache.h"
+
 #include <functional>
 #include <cassert>
 #include <filesystem>
@@ -21,7 +23,7 @@ textures::textures()
       + p.second.c_str()
     };
     assert(std::filesystem::exists(filename));
-    if (!p.first.get().loadFromFile(filename))
+    if (!load_from_file(p.first.get(), filename))
     {
       auto msg{"Cannot find image file '" + filename + "'"};
       throw std::runtime_error(msg);
@@ -35,7 +37,7 @@ textures::textures()
       + get_square_filename(r)
     };
     assert(std::filesystem::exists(filename));
-    if (!m_squares[r].loadFromFile(filename))
+    if (!load_from_file(m_squares[r], filename))
     {
       auto msg{"Cannot find image file '" + filename + "'"};
       throw std::runtime_error(msg);
@@ -48,7 +50,7 @@ textures::textures()
       + get_square_semitransparent_filename(r)
     };
     assert(std::filesystem::exists(filename));
-    if (!m_semitransparent_squares[r].loadFromFile(filename))
+    if (!load_from_file(m_semitransparent_squares[r], filename))
     {
       auto msg{"Cannot find image file '" + filename + "'"};
       throw std::runtime_error(msg);
@@ -62,7 +64,7 @@ textures::textures()
       + get_strip_filename(r)
     };
     assert(std::filesystem::exists(filename));
-    if (!m_strips[r].loadFromFile(filename))
+    if (!load_from_file(m_strips[r], filename))
     {
       auto msg{"Cannot find image file '" + filename + "'"};
       throw std::runtime_error(msg);
@@ -80,7 +82,7 @@ textures::textures()
         )
       };
       assert(std::filesystem::exists(filename));
-      if (!m_occupied_squares[square_color][occupant_color].loadFromFile(filename))
+      if (!load_from_file(m_occupied_squares[square_color][occupant_color], filename))
       {
         auto msg{"Cannot find image file '" + filename + "'"};
         throw std::runtime_error(msg);
@@ -100,7 +102,7 @@ textures::textures()
         )
       };
       assert(std::filesystem::exists(filename));
-      if (!m_semitransparent_occupied_squares[square_color][occupant_color].loadFromFile(filename))
+      if (!load_from_file(m_semitransparent_occupied_squares[square_color][occupant_color], filename))
       {
         auto msg{"Cannot find image file '" + filename + "'"};
         throw std::runtime_error(msg);
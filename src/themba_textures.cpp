@@ -2,6 +2,8 @@
 
 #ifndef LOGIC_ONLY
 
+#include "asset_cache.h"
+
 #include <cassert>
 
 themba_textures::themba_textures()
@@ -13,7 +15,7 @@ themba_textures::themba_textures()
       std::string("resources/textures/themba/")
       + filename_str.c_str()
     };
-    if (!m_textures[i].loadFromFile(filename))
+    if (!load_from_file(m_textures[i], filename))
     {
       auto msg{"Cannot find image file '" + filename + "'"};
       throw std::runtime_error(msg);
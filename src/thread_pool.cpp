@@ -0,0 +1,221 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+namespace {
+
+/// The index of the worker of the current thread,
+/// or -1 if the current thread is not a worker
+thread_local int current_worker_index{-1};
+
+/// The pool of the worker of the current thread, if any
+thread_local const void* current_pool{nullptr};
+
+} // ~namespace
+
+thread_pool::thread_pool(const int n_threads)
+{
+  assert(n_threads >= 0);
+  const int n{
+    n_threads > 0
+    ? n_threads
+    : std::max(1, static_cast<int>(std::thread::hardware_concurrency()))
+  };
+  for (int i{0}; i != n; ++i)
+  {
+    m_queues.push_back(std::make_unique<task_queue>());
+  }
+  for (int i{0}; i != n; ++i)
+  {
+    m_workers.emplace_back(&thread_pool::run, this, i);
+  }
+}
+
+thread_pool::~thread_pool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_must_stop = true;
+  }
+  m_has_tasks.notify_all();
+  for (auto& worker: m_workers) worker.join();
+}
+
+void thread_pool::add_task(const std::function<void()>& task)
+{
+  const int n_queues{get_n_threads()};
+  const int queue_index{
+    current_pool == this
+    ? current_worker_index
+    : static_cast<int>(m_next_queue++ % static_cast<unsigned int>(n_queues))
+  };
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_n_pending;
+  }
+  {
+    task_queue& q{*m_queues[queue_index]};
+    std::lock_guard<std::mutex> lock(q.m_mutex);
+    q.m_tasks.push_back(task);
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_n_queued;
+  }
+  m_has_tasks.notify_one();
+}
+
+void thread_pool::run(const int worker_index)
+{
+  current_worker_index = worker_index;
+  current_pool = this;
+  std::function<void()> task;
+  while (1)
+  {
+    if (try_take_task(worker_index, task))
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_n_queued;
+      }
+      task();
+      task = nullptr;
+      ++m_n_tasks_done;
+      bool is_all_done{false};
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_n_pending;
+        is_all_done = m_n_pending == 0;
+      }
+      if (is_all_done) m_all_done.notify_all();
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_must_stop && m_n_queued == 0) return;
+    // A task may be counted as queued, while another worker
+    // is about to take it, so do not wait forever
+    m_has_tasks.wait_for(
+      lock,
+      std::chrono::milliseconds(10),
+      [this] { return m_n_queued > 0 || m_must_stop; }
+    );
+  }
+}
+
+bool thread_pool::try_take_task(const int worker_index, std::function<void()>& task)
+{
+  // The most recent task of its own queue,
+  // as it is most likely to still be in the cache
+  {
+    task_queue& q{*m_queues[worker_index]};
+    std::lock_guard<std::mutex> lock(q.m_mutex);
+    if (!q.m_tasks.empty())
+    {
+      task = std::move(q.m_tasks.back());
+      q.m_tasks.pop_back();
+      return true;
+    }
+  }
+  // The oldest task of another queue
+  const int n_queues{get_n_threads()};
+  for (int i{1}; i != n_queues; ++i)
+  {
+    task_queue& q{*m_queues[(worker_index + i) % n_queues]};
+    std::lock_guard<std::mutex> lock(q.m_mutex);
+    if (!q.m_tasks.empty())
+    {
+      task = std::move(q.m_tasks.front());
+      q.m_tasks.pop_front();
+      ++m_n_steals;
+      return true;
+    }
+  }
+  return false;
+}
+
+void thread_pool::wait()
+{
+  assert(current_pool != this);
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_all_done.wait(lock, [this] { return m_n_pending == 0; });
+}
+
+void test_thread_pool()
+{
+#ifndef NDEBUG
+  // A new pool has done nothing
+  {
+    const thread_pool p(2);
+    assert(p.get_n_threads() == 2);
+    assert(p.get_n_tasks_done() == 0);
+  }
+  // Zero threads is one per hardware thread
+  {
+    const thread_pool p;
+    assert(p.get_n_threads() >= 1);
+  }
+  // All tasks are done
+  {
+    thread_pool p(4);
+    std::atomic<int> sum{0};
+    for (int i{1}; i <= 100; ++i)
+    {
+      p.add_task([&sum, i] { sum += i; } );
+    }
+    p.wait();
+    assert(sum == 5050);
+    assert(p.get_n_tasks_done() == 100);
+  }
+  // Waiting without tasks returns at once
+  {
+    thread_pool p(2);
+    p.wait();
+  }
+  // A task can add tasks
+  {
+    thread_pool p(2);
+    std::atomic<int> n{0};
+    p.add_task(
+      [&p, &n]
+      {
+        for (int i{0}; i != 10; ++i) p.add_task([&n] { ++n; } );
+      }
+    );
+    p.wait();
+    assert(n == 10);
+  }
+  // The tasks added are done before the pool is destroyed
+  {
+    std::atomic<int> n{0};
+    {
+      thread_pool p(2);
+      for (int i{0}; i != 10; ++i) p.add_task([&n] { ++n; } );
+    }
+    assert(n == 10);
+  }
+#endif // NDEBUG
+}
+
+void test_thread_pool_long()
+{
+#ifndef NDEBUG
+  // An idle worker steals the tasks of a busy worker
+  {
+    thread_pool p(2);
+    std::atomic<int> n{0};
+    p.add_task(
+      [&p, &n]
+      {
+        // These are added to the queue of this busy worker
+        for (int i{0}; i != 10; ++i) p.add_task([&n] { ++n; } );
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      }
+    );
+    p.wait();
+    assert(n == 10);
+    assert(p.get_n_steals() > 0);
+  }
+#endif // NDEBUG
+}
@@ -0,0 +1,349 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/// The maximum number of events per thread.
+/// At 24 bytes per event, this is 1.5 MB per thread that traces.
+/// Beyond this, the oldest events are overwritten,
+/// see \link{get_n_overwritten_trace_events}
+constexpr int get_trace_buffer_capacity() { return 1 << 16; }
+
+/// A complete event, i.e. a scope with a start and a duration
+struct trace_event
+{
+  const char * m_name;
+  std::int64_t m_start_microseconds;
+  std::int64_t m_duration_microseconds;
+};
+
+/// The events of one thread, as a ring that
+/// overwrites the oldest events when full.
+///
+/// Only the owning thread adds events.
+/// The lock is only contended when another thread reads the events,
+/// e.g. in \link{stop_tracing}
+class trace_buffer
+{
+public:
+  explicit trace_buffer(const int thread_id)
+    : m_events(get_trace_buffer_capacity()),
+      m_thread_id{thread_id}
+  {
+
+  }
+
+  void add(const trace_event& e) noexcept
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_events[m_n_added % get_trace_buffer_capacity()] = e;
+    ++m_n_added;
+  }
+
+  /// Call 'f' on each event kept, oldest first
+  template <class Function>
+  void for_each_event(Function f) const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const std::int64_t first{
+      std::max(std::int64_t{0}, m_n_added - get_trace_buffer_capacity())
+    };
+    for (std::int64_t i{first}; i != m_n_added; ++i)
+    {
+      f(m_events[i % get_trace_buffer_capacity()]);
+    }
+  }
+
+  int get_n_overwritten() const noexcept
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<int>(
+      std::max(std::int64_t{0}, m_n_added - get_trace_buffer_capacity())
+    );
+  }
+
+  int get_size() const noexcept
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<int>(
+      std::min(m_n_added, std::int64_t{get_trace_buffer_capacity()})
+    );
+  }
+
+  int get_thread_id() const noexcept { return m_thread_id; }
+
+private:
+  std::vector<trace_event> m_events;
+
+  /// The number of events added, including the overwritten ones
+  std::int64_t m_n_added{0};
+
+  /// Protects m_events and m_n_added
+  mutable std::mutex m_mutex;
+
+  int m_thread_id;
+};
+
+/// The state of the tracing
+struct tracer
+{
+  std::atomic<bool> m_is_tracing{false};
+
+  /// Increases with each start of a trace,
+  /// so that threads know their buffer is outdated
+  std::atomic<int> m_generation{0};
+
+  std::chrono::steady_clock::time_point m_start;
+
+  std::string m_filename;
+
+  /// Protects m_buffers, only locked when a thread
+  /// adds its first event of a trace
+  std::mutex m_mutex;
+
+  /// Shared with the threads, so that a buffer a thread still adds to
+  /// outlives the trace it belongs to
+  std::vector<std::shared_ptr<trace_buffer>> m_buffers;
+};
+
+tracer& get_tracer() noexcept
+{
+  static tracer t;
+  return t;
+}
+
+thread_local std::shared_ptr<trace_buffer> t_buffer;
+thread_local int t_generation{-1};
+
+trace_buffer& get_thread_buffer()
+{
+  tracer& t{get_tracer()};
+  const int generation{t.m_generation.load(std::memory_order_acquire)};
+  if (t_buffer == nullptr || t_generation != generation)
+  {
+    std::lock_guard<std::mutex> lock(t.m_mutex);
+    const int thread_id{static_cast<int>(t.m_buffers.size()) + 1};
+    t_buffer = std::make_shared<trace_buffer>(thread_id);
+    t.m_buffers.push_back(t_buffer);
+    t_generation = generation;
+  }
+  return *t_buffer;
+}
+
+std::int64_t get_trace_time_microseconds() noexcept
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - get_tracer().m_start
+  ).count();
+}
+
+} // ~namespace
+
+trace_scope::trace_scope(const char * const name) noexcept
+  : m_name{name},
+    m_start_microseconds{is_tracing() ? get_trace_time_microseconds() : -1}
+{
+
+}
+
+trace_scope::~trace_scope()
+{
+  if (m_start_microseconds < 0) return;
+  if (!is_tracing()) return;
+  const std::int64_t now{get_trace_time_microseconds()};
+  get_thread_buffer().add(
+    trace_event{m_name, m_start_microseconds, now - m_start_microseconds}
+  );
+}
+
+int get_n_overwritten_trace_events()
+{
+  tracer& t{get_tracer()};
+  std::lock_guard<std::mutex> lock(t.m_mutex);
+  int n{0};
+  for (const auto& b: t.m_buffers) n += b->get_n_overwritten();
+  return n;
+}
+
+int get_n_trace_events()
+{
+  tracer& t{get_tracer()};
+  std::lock_guard<std::mutex> lock(t.m_mutex);
+  int n{0};
+  for (const auto& b: t.m_buffers) n += b->get_size();
+  return n;
+}
+
+bool is_tracing() noexcept
+{
+  return get_tracer().m_is_tracing.load(std::memory_order_acquire);
+}
+
+void start_tracing(const std::string& filename)
+{
+  assert(!is_tracing());
+  tracer& t{get_tracer()};
+  {
+    std::lock_guard<std::mutex> lock(t.m_mutex);
+    t.m_buffers.clear();
+    t.m_filename = filename;
+    t.m_start = std::chrono::steady_clock::now();
+  }
+  ++t.m_generation;
+  t.m_is_tracing.store(true, std::memory_order_release);
+}
+
+void stop_tracing()
+{
+  tracer& t{get_tracer()};
+  if (!is_tracing()) return;
+  t.m_is_tracing.store(false, std::memory_order_release);
+
+  std::lock_guard<std::mutex> lock(t.m_mutex);
+  std::ofstream f(t.m_filename);
+  f << "{\"traceEvents\":[";
+  bool is_first{true};
+  for (const auto& b: t.m_buffers)
+  {
+    // Locks the buffer, in case its thread is still adding an event
+    b->for_each_event(
+      [&f, &is_first, &b](const trace_event& e)
+      {
+        if (!is_first) f << ',';
+        is_first = false;
+        f << "\n{\"name\":\"" << e.m_name << "\","
+          << "\"cat\":\"conquer_chess\","
+          << "\"ph\":\"X\","
+          << "\"ts\":" << e.m_start_microseconds << ','
+          << "\"dur\":" << e.m_duration_microseconds << ','
+          << "\"pid\":1,"
+          << "\"tid\":" << b->get_thread_id() << '}'
+        ;
+      }
+    );
+  }
+  f << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+void test_trace()
+{
+#ifndef NDEBUG
+  // No events are recorded when tracing is disabled
+  {
+    assert(!is_tracing());
+    const int n_before{get_n_trace_events()};
+    {
+      const trace_scope scope("test_trace");
+    }
+    assert(get_n_trace_events() == n_before);
+  }
+  // Events of multiple threads are written to one file
+  {
+    const std::string filename{"tmp_trace.json"};
+    std::filesystem::remove(filename); // From an earlier test
+    start_tracing(filename);
+    assert(is_tracing());
+    {
+      const trace_scope scope("test_trace_main_thread");
+    }
+    std::thread t(
+      []()
+      {
+        const trace_scope scope("test_trace_other_thread");
+      }
+    );
+    t.join();
+    assert(get_n_trace_events() == 2);
+    assert(get_n_overwritten_trace_events() == 0);
+    stop_tracing();
+    assert(!is_tracing());
+    assert(std::filesystem::exists(filename));
+    std::ifstream f(filename);
+    std::stringstream s;
+    s << f.rdbuf();
+    const std::string text{s.str()};
+    assert(text.find("\"traceEvents\"") != std::string::npos);
+    assert(text.find("test_trace_main_thread") != std::string::npos);
+    assert(text.find("test_trace_other_thread") != std::string::npos);
+    assert(text.find("\"tid\":2") != std::string::npos);
+    f.close();
+    std::filesystem::remove(filename);
+  }
+  // A new trace removes the events of the earlier one
+  {
+    start_tracing("tmp_trace.json");
+    assert(get_n_trace_events() == 0);
+    {
+      const trace_scope scope("test_trace");
+    }
+    assert(get_n_trace_events() == 1);
+    stop_tracing();
+    std::filesystem::remove("tmp_trace.json");
+  }
+  // A full buffer overwrites its oldest events
+  {
+    const std::string filename{"tmp_trace.json"};
+    start_tracing(filename);
+    {
+      const trace_scope scope("test_trace_oldest");
+    }
+    for (int i{0}; i != get_trace_buffer_capacity(); ++i)
+    {
+      const trace_scope scope("test_trace_newest");
+    }
+    assert(get_n_trace_events() == get_trace_buffer_capacity());
+    assert(get_n_overwritten_trace_events() == 1);
+    stop_tracing();
+    std::ifstream f(filename);
+    std::stringstream s;
+    s << f.rdbuf();
+    const std::string text{s.str()};
+    assert(text.find("test_trace_oldest") == std::string::npos);
+    assert(text.find("test_trace_newest") != std::string::npos);
+    f.close();
+    std::filesystem::remove(filename);
+  }
+  // Tracing can be stopped while another thread is tracing
+  {
+    const std::string filename{"tmp_trace.json"};
+    start_tracing(filename);
+    std::atomic<bool> has_started{false};
+    std::atomic<bool> must_stop{false};
+    std::thread t(
+      [&has_started, &must_stop]()
+      {
+        while (!must_stop)
+        {
+          {
+            const trace_scope scope("test_trace_other_thread");
+          }
+          has_started = true;
+        }
+      }
+    );
+    while (!has_started) std::this_thread::yield();
+    stop_tracing();
+    must_stop = true;
+    t.join();
+    std::ifstream f(filename);
+    std::stringstream s;
+    s << f.rdbuf();
+    const std::string text{s.str()};
+    assert(text.find("test_trace_other_thread") != std::string::npos);
+    assert(text.find("\n],\"displayTimeUnit\"") != std::string::npos);
+    f.close();
+    std::filesystem::remove(filename);
+  }
+#endif // NDEBUG
+}
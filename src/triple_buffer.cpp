@@ -0,0 +1,68 @@
+#include "triple_buffer.h"
+
+#include <cassert>
+#include <thread>
+
+void test_triple_buffer()
+{
+#ifndef NDEBUG
+  // The initial value can be read
+  {
+    triple_buffer<int> b(42);
+    assert(!b.has_new());
+    assert(b.get_front() == 42);
+  }
+  // A published value can be read
+  {
+    triple_buffer<int> b;
+    b.get_back() = 1;
+    b.publish();
+    assert(b.has_new());
+    assert(b.get_front() == 1);
+    assert(!b.has_new());
+    assert(b.get_front() == 1);
+  }
+  // Only the most recently published value is read
+  {
+    triple_buffer<int> b;
+    b.get_back() = 1;
+    b.publish();
+    b.get_back() = 2;
+    b.publish();
+    b.get_back() = 3;
+    b.publish();
+    assert(b.get_front() == 3);
+  }
+  // An unpublished value is not read
+  {
+    triple_buffer<int> b;
+    b.get_back() = 1;
+    b.publish();
+    b.get_back() = 2;
+    assert(b.get_front() == 1);
+  }
+  // The reader never reads values that go back in time
+  {
+    triple_buffer<int> b(0);
+    const int n{100000};
+    std::thread writer(
+      [&b]()
+      {
+        for (int i{1}; i <= n; ++i)
+        {
+          b.get_back() = i;
+          b.publish();
+        }
+      }
+    );
+    int last{0};
+    while (last != n)
+    {
+      const int value{b.get_front()};
+      assert(value >= last);
+      last = value;
+    }
+    writer.join();
+  }
+#endif // NDEBUG
+}
@@ -4,9 +4,11 @@
 #include "game_controller.h"
 #include "square.h"
 #include "game_coordinate.h"
+#include "metrics.h"
 #include "piece.h"
 #include "piece_actions.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <sstream>
@@ -19,6 +21,46 @@ user_inputs::user_inputs(const std::vector<user_input>& inputs)
 
 void user_inputs::add(const user_input& action)
 {
+  static metric_counter& n_mouse_moves{
+    get_metrics().get_counter("mouse_moves_added")
+  };
+  static metric_counter& n_coalesced{
+    get_metrics().get_counter("mouse_moves_coalesced")
+  };
+  static metric_gauge& coalesced_ratio{
+    get_metrics().get_gauge("mouse_moves_coalesced_ratio")
+  };
+  if (action.get_user_input_type() == user_input_type::mouse_move)
+  {
+    n_mouse_moves.add();
+    // The most recent input of the same player
+    const auto last{
+      std::find_if(
+        std::rbegin(m_user_inputs),
+        std::rend(m_user_inputs),
+        [&action](const user_input& i) { return i.get_player() == action.get_player(); }
+      )
+    };
+    if (
+      last != std::rend(m_user_inputs)
+      && last->get_user_input_type() == user_input_type::mouse_move
+    )
+    {
+      // A mouse move outside of the board does nothing,
+      // so then the earlier mouse move is kept
+      assert(action.get_coordinat());
+      if (is_coordinat_on_board(action.get_coordinat().value()))
+      {
+        *last = action;
+      }
+      n_coalesced.add();
+      coalesced_ratio.set(
+        static_cast<double>(n_coalesced.get())
+        / static_cast<double>(n_mouse_moves.get())
+      );
+      return;
+    }
+  }
   m_user_inputs.push_back(action);
 }
 
@@ -187,6 +229,47 @@ void test_user_inputs()
     const user_inputs c;
     assert(c.get_user_inputs().empty());
   }
+  // Consecutive mouse moves of a player are coalesced into the last one
+  {
+    user_inputs inputs;
+    inputs.add(create_mouse_move_action(game_coordinate(0.5, 0.5), side::lhs));
+    inputs.add(create_mouse_move_action(game_coordinate(1.5, 1.5), side::rhs));
+    inputs.add(create_mouse_move_action(game_coordinate(2.5, 2.5), side::lhs));
+    assert(count_user_inputs(inputs) == 2);
+    assert(inputs.get_user_inputs()[0] == create_mouse_move_action(game_coordinate(2.5, 2.5), side::lhs));
+    assert(inputs.get_user_inputs()[1] == create_mouse_move_action(game_coordinate(1.5, 1.5), side::rhs));
+  }
+  // Mouse moves are not coalesced over an action of the same player
+  {
+    user_inputs inputs;
+    inputs.add(create_mouse_move_action(game_coordinate(0.5, 0.5), side::lhs));
+    inputs.add(create_press_action_1(side::lhs));
+    inputs.add(create_mouse_move_action(game_coordinate(2.5, 2.5), side::lhs));
+    assert(count_user_inputs(inputs) == 3);
+    assert(inputs.get_user_inputs()[1] == create_press_action_1(side::lhs));
+  }
+  // A mouse move outside of the board keeps the earlier mouse move
+  {
+    game_controller c;
+    c.add_user_input(create_mouse_move_action(game_coordinate(0.5, 0.5), side::lhs));
+    c.add_user_input(create_mouse_move_action(game_coordinate(314.15, 42.0), side::lhs));
+    assert(count_user_inputs(c) == 1);
+    c.apply_user_inputs_to_game();
+    assert(c.get_cursor_pos(side::lhs) == game_coordinate(0.5, 0.5));
+  }
+  // Coalesced mouse moves are counted
+  {
+    const metric_counter& n_coalesced{get_metrics().get_counter("mouse_moves_coalesced")};
+    const auto n_before{n_coalesced.get()};
+    user_inputs inputs;
+    for (int i{0}; i != 10; ++i)
+    {
+      inputs.add(create_mouse_move_action(game_coordinate(0.5 + (0.1 * i), 0.5), side::lhs));
+    }
+    assert(count_user_inputs(inputs) == 1);
+    assert(n_coalesced.get() == n_before + 9);
+    assert(get_metrics().get_gauge("mouse_moves_coalesced_ratio").get() > 0.0);
+  }
   // Move up does something
   {
     game_controller c;
@@ -3,6 +3,11 @@
 #ifndef LOGIC_ONLY
 
 #include "helper.h"
+#include "metrics.h"
+#include "render_window.h"
+
+#include <SFML/Graphics/Sprite.hpp>
+#include <SFML/Graphics/View.hpp>
 
 #include <cassert>
 #include <iostream>
@@ -31,17 +36,83 @@ void view::clear_next_state()
 
 void view::draw()
 {
-  draw_impl();
+  if (is_retained())
+  {
+    draw_retained();
+  }
+  else
+  {
+    draw_impl();
+  }
+}
+
+void view::draw_retained()
+{
+  static metric_counter& n_redraws{
+    get_metrics().get_counter("retained_view_redraws")
+  };
+  static metric_counter& n_reuses{
+    get_metrics().get_counter("retained_view_reuses")
+  };
+  render_window& w{get_render_window()};
+  const auto size{w.getSize()};
+  if (!m_retained_drawing || m_retained_drawing->getSize() != size)
+  {
+    m_retained_drawing = std::make_unique<sf::RenderTexture>();
+    if (!m_retained_drawing->create(size.x, size.y))
+    {
+      // Cannot retain the drawing, so draw everything every frame
+      m_retained_drawing.reset();
+      draw_impl();
+      return;
+    }
+    m_must_redraw = true;
+  }
+  if (m_must_redraw)
+  {
+    n_redraws.add();
+    m_retained_drawing->setView(w.getView());
+    m_retained_drawing->clear();
+    w.set_draw_target(m_retained_drawing.get());
+    draw_impl();
+    w.set_draw_target(nullptr);
+    m_retained_drawing->display();
+    m_must_redraw = false;
+  }
+  else
+  {
+    n_reuses.add();
+  }
+
+  // Draw the retained drawing pixel for pixel
+  const sf::View window_view{w.getView()};
+  w.setView(
+    sf::View(
+      sf::FloatRect(0.0f, 0.0f, static_cast<float>(size.x), static_cast<float>(size.y))
+    )
+  );
+  w.draw(sf::Sprite(m_retained_drawing->getTexture()));
+  w.setView(window_view);
 }
 
 bool view::process_event(sf::Event& e)
 {
+  // Only these events change a retained view by themselves.
+  // A mouse move, which happens often, only does so
+  // if the view invalidates itself
+  if (e.type == sf::Event::KeyPressed
+    || e.type == sf::Event::MouseButtonPressed
+  )
+  {
+    invalidate();
+  }
   return process_event_impl(e);
 }
 
 void view::process_resize_event(sf::Event& event)
 {
   assert(event.type == sf::Event::Resized);
+  invalidate();
   process_resize_event_impl(event);
 }
 
@@ -70,6 +141,7 @@ void view::set_next_state(const program_state next_state)
 void view::start()
 {
   assert(!m_is_active);
+  invalidate();
   start_impl();
 }
 
@@ -77,6 +149,8 @@ void view::stop()
 {
   assert(m_is_active);
   stop_impl();
+  // Only the active view needs its texture
+  m_retained_drawing.reset();
 }
 
 void view::tick(const delta_t dt)